@@ -19,7 +19,12 @@
 #include <benchmark/benchmark.h>
 #include <google/protobuf/text_format.h>
 
+#ifdef TCMALLOC
+#include <gperftools/malloc_hook.h>
+#endif
+
 #include <algorithm>
+#include <atomic>
 #include <random>
 #include <vector>
 
@@ -29,6 +34,8 @@
 #include "src/carnot/exec/local_grpc_result_server.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/funcs/funcs.h"
+#include "src/carnot/planner/compiler/compiler.h"
+#include "src/carnot/planner/distributed/annotate_abortable_sources_for_limits_rule.h"
 #include "src/carnot/udf/udf.h"
 #include "src/common/base/base.h"
 #include "src/common/benchmark/benchmark.h"
@@ -65,6 +72,31 @@ df = df.groupby(['col0', 'col1']).agg(sum=('col2', px.sum))
 px.display(df, '$0')
 )pxl";
 
+// Counts the heap allocations made while a query executes, so the benchmarks can report the
+// allocations per input row.
+class AllocationCounter {
+ public:
+  AllocationCounter() {
+#ifdef TCMALLOC
+    MallocHook::AddNewHook(&OnNew);
+#endif
+  }
+  ~AllocationCounter() {
+#ifdef TCMALLOC
+    MallocHook::RemoveNewHook(&OnNew);
+#endif
+  }
+
+  static int64_t count() { return count_.load(std::memory_order_relaxed); }
+
+ private:
+  static void OnNew(const void* /*ptr*/, size_t /*size*/) {
+    count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  inline static std::atomic<int64_t> count_ = 0;
+};
+
 std::unique_ptr<Carnot> SetUpCarnot(std::shared_ptr<table_store::TableStore> table_store,
                                     LocalGRPCResultSinkServer* server) {
   auto func_registry = std::make_unique<px::carnot::udf::Registry>("default_registry");
@@ -83,6 +115,22 @@ std::unique_ptr<Carnot> SetUpCarnot(std::shared_ptr<table_store::TableStore> tab
       .ConsumeValueOrDie();
 }
 
+// Compiles the query the way Carnot::ExecuteQuery does, so that the benchmark can execute the plan
+// separately and count only the allocations made while executing it.
+planpb::Plan CompileQuery(Carnot* carnot, const std::string& query) {
+  planner::compiler::Compiler compiler;
+  auto compiler_state =
+      carnot->GetEngineState()->CreateLocalExecutionCompilerState(CurrentTimeNS());
+  auto logical_plan = compiler.CompileToIR(query, compiler_state.get()).ConsumeValueOrDie();
+  planner::distributed::AnnotateAbortableSourcesForLimitsRule rule;
+  PX_CHECK_OK(rule.Execute(logical_plan.get()));
+  auto plan = logical_plan->ToProto().ConsumeValueOrDie();
+  auto dest = plan.add_execution_status_destinations();
+  dest->set_grpc_address(compiler_state->result_address());
+  dest->set_ssl_targetname(compiler_state->result_ssl_targetname());
+  return plan;
+}
+
 // NOLINTNEXTLINE : runtime/references.
 void BM_Query(benchmark::State& state, std::vector<types::DataType> types,
               std::vector<datagen::DistributionType> distribution_types, const std::string& query,
@@ -98,19 +146,28 @@ void BM_Query(benchmark::State& state, std::vector<types::DataType> types,
   table_store->AddTable("test_table", table);
 
   int64_t bytes_processed = 0;
+  int64_t num_allocs = 0;
   int i = 0;
   for (auto _ : state) {
+    AllocationCounter alloc_counter;
     auto queryWithTableName = absl::Substitute(query, "results_" + std::to_string(i));
-    auto res = carnot->ExecuteQuery(queryWithTableName, sole::uuid4(), CurrentTimeNS());
+    auto plan = CompileQuery(carnot.get(), queryWithTableName);
+    // Start counting after the compilation, whose allocations don't depend on the number of rows.
+    int64_t allocs_before = AllocationCounter::count();
+    auto res = carnot->ExecutePlan(plan, sole::uuid4());
     if (!res.ok()) {
       LOG(FATAL) << "Aggregate benchmark query did not execute successfully.";
     }
     bytes_processed += server.exec_stats().ConsumeValueOrDie().execution_stats().bytes_processed();
+    num_allocs += AllocationCounter::count() - allocs_before;
     server.ResetQueryResults();
     ++i;
   }
 
   state.SetBytesProcessed(int64_t(bytes_processed));
+  // Only meaningful when built with tcmalloc, which provides the allocation hooks.
+  state.counters["allocs_per_row"] = benchmark::Counter(
+      static_cast<double>(num_allocs) / (state.range(0) * num_batches * state.iterations()));
 }
 
 // NOLINTNEXTLINE : runtime/references.
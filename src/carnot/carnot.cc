@@ -16,14 +16,19 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
 
 #include "src/carnot/carnot.h"
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/engine_state.h"
 #include "src/carnot/exec/exec_graph.h"
+#include "src/carnot/exec/fragment_executor.h"
 #include "src/carnot/exec/grpc_router.h"
 #include "src/carnot/funcs/builtins/builtins.h"
 #include "src/carnot/plan/operators.h"
@@ -35,6 +40,15 @@
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_max_concurrent_fragments,
+             gflags::Int32FromEnv("PL_CARNOT_MAX_CONCURRENT_FRAGMENTS", 4),
+             "The maximum number of plan fragments of a query that execute concurrently. A "
+             "fragment only starts once the fragments it depends on have finished.");
+DEFINE_int64(carnot_query_memory_limit_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_MEMORY_LIMIT_BYTES", 0),
+             "The number of bytes of memory a query may use before it's cancelled. 0 means "
+             "unlimited.");
+
 namespace px {
 namespace carnot {
 
@@ -267,7 +281,8 @@ Status SendFinalExecutionStatsToOutgoingConns(
         outgoing_servers,
     std::function<void(grpc::ClientContext*)> add_auth_to_grpc_context_func,
     const queryresultspb::AgentExecutionStats& agent_stats,
-    const std::vector<queryresultspb::AgentExecutionStats>& all_agent_stats) {
+    const std::vector<queryresultspb::AgentExecutionStats>& all_agent_stats,
+    const std::vector<std::string>& warnings) {
   ::px::carnotpb::TransferResultChunkRequest req;
   ToProto(query_id, req.mutable_query_id());
 
@@ -286,6 +301,9 @@ Status SendFinalExecutionStatsToOutgoingConns(
   stats->mutable_timing()->set_execution_time_ns(agent_stats.execution_time_ns());
   stats->set_bytes_processed(total_bytes_processed);
   stats->set_records_processed(total_records_processed);
+  for (const auto& warning : warnings) {
+    stats->add_warnings(warning);
+  }
   return SendTransferResultChunkToOutgoingConns(outgoing_servers, add_auth_to_grpc_context_func,
                                                 std::move(req));
 }
@@ -327,7 +345,12 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
 
   // For each of the plan fragments in the plan, execute the query.
   std::vector<std::string> output_table_strs;
-  auto exec_state = engine_state_->CreateExecState(query_id);
+  auto exec_state =
+      engine_state_->CreateExecState(query_id, FLAGS_carnot_query_memory_limit_bytes);
+  exec_state->set_partial_result_flush_interval(
+      std::chrono::milliseconds(logical_plan.plan_options().partial_result_flush_interval_ms()));
+  exec_state->set_grpc_source_straggler_timeout(
+      std::chrono::milliseconds(logical_plan.plan_options().straggler_timeout_ms()));
   auto outgoing_conns = GetOutgoingConns(exec_state.get(), logical_plan);
   PX_RETURN_IF_ERROR(InitiateOutgoingConns(query_id, outgoing_conns,
                                            engine_state_->add_auth_to_grpc_context_func()));
@@ -351,60 +374,100 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   // Unclear how we'll use plan fragments in the future (they're currently unused). For now, we will
   // share the schema between plan fragments.
   auto schema = std::make_unique<table_store::schema::Schema>();
-  std::vector<statuspb::Status> incoming_errors;
-  auto s =
-      plan::PlanWalker()
-          .OnPlanFragment([&](auto* pf) {
-            auto exec_graph = exec::ExecutionGraph();
-            PX_RETURN_IF_ERROR(exec_graph.Init(schema.get(), plan_state.get(), exec_state.get(), pf,
-                                               /* collect_exec_node_stats */ analyze));
-            PX_RETURN_IF_ERROR(exec_graph.Execute());
-
-            // We must get this while exec_graph is alive. ExecutionGraph destructor calls
-            // GRPCRouter::DeleteQuery() which would delete this data.
-            auto errors = exec_state->grpc_router()->GetIncomingWorkerErrors(query_id);
-            incoming_errors.insert(incoming_errors.end(), errors.begin(), errors.end());
-            auto exec_stats = exec_graph.GetStats();
-            bytes_processed += exec_stats.bytes_processed;
-            rows_processed += exec_stats.rows_processed;
-
-            if (analyze) {
-              for (int64_t node_id : pf->dag().TopologicalSort()) {
-                PX_ASSIGN_OR_RETURN(auto exec_node, exec_graph.node(node_id));
-                std::string node_name =
-                    absl::Substitute("$0 (id=$1)", pf->nodes()[node_id]->DebugString(), node_id);
-                exec::ExecNodeStats* stats = exec_node->stats();
-                stats->AddExtraMetric("batches_output", stats->batches_output);
-                int64_t total_time_ns = stats->TotalExecTime();
-                int64_t self_time_ns = stats->SelfExecTime();
-                LOG(INFO) << absl::Substitute(
-                    "self_time:$1\ttotal_time: $2\tbytes_output: $3\trows_output: $4\tnode_id:$0",
-                    node_name, PrettyDuration(self_time_ns), PrettyDuration(total_time_ns),
-                    stats->bytes_output, stats->rows_output);
-
-                queryresultspb::OperatorExecutionStats* stats_pb =
-                    agent_operator_exec_stats.add_operator_execution_stats();
-                stats_pb->set_plan_fragment_id(pf->id());
-                stats_pb->set_node_id(node_id);
-                stats_pb->set_bytes_output(stats->bytes_output);
-                stats_pb->set_records_output(stats->rows_output);
-                stats_pb->set_total_execution_time_ns(total_time_ns);
-                stats_pb->set_self_execution_time_ns(self_time_ns);
-
-                for (const auto& [k, v] : stats->extra_metrics) {
-                  (*stats_pb->mutable_extra_metrics())[k] = v;
-                }
-
-                for (const auto& [k, v] : stats->extra_info) {
-                  (*stats_pb->mutable_extra_info())[k] = v;
-                }
-                (*stats_pb->mutable_extra_info())["DebugString"] =
-                    pf->nodes()[node_id]->DebugString();
-              }
-            }
-            return Status::OK();
-          })
-          .Walk(&plan);
+
+  // The execution graphs are all initialized before any fragment executes, since initialization
+  // writes to the shared schema. Each graph is released as soon as its fragment is done.
+  struct FragmentExecution {
+    plan::PlanFragment* pf = nullptr;
+    std::unique_ptr<exec::ExecutionGraph> exec_graph;
+    int64_t bytes_processed = 0;
+    int64_t rows_processed = 0;
+    std::vector<queryresultspb::OperatorExecutionStats> operator_exec_stats;
+  };
+  absl::flat_hash_map<int64_t, FragmentExecution> fragment_executions;
+  std::vector<int64_t> fragment_ids;
+
+  auto s = plan::PlanWalker()
+               .OnPlanFragment([&](auto* pf) {
+                 auto exec_graph = std::make_unique<exec::ExecutionGraph>();
+                 PX_RETURN_IF_ERROR(exec_graph->Init(schema.get(), plan_state.get(),
+                                                     exec_state.get(), pf,
+                                                     /* collect_exec_node_stats */ analyze));
+                 FragmentExecution& execution = fragment_executions[pf->id()];
+                 execution.pf = pf;
+                 execution.exec_graph = std::move(exec_graph);
+                 fragment_ids.push_back(pf->id());
+                 return Status::OK();
+               })
+               .Walk(&plan);
+
+  // Fragments that don't depend on each other execute concurrently. The workers only touch their
+  // own FragmentExecution, so fragment_executions must not be modified from here on.
+  auto execute_fragment = [&](int64_t fragment_id) -> Status {
+    auto iter = fragment_executions.find(fragment_id);
+    if (iter == fragment_executions.end()) {
+      // PlanWalker already warned about the missing fragment.
+      return Status::OK();
+    }
+    FragmentExecution& execution = iter->second;
+    plan::PlanFragment* pf = execution.pf;
+    exec::ExecutionGraph* exec_graph = execution.exec_graph.get();
+    PX_RETURN_IF_ERROR(exec_graph->Execute());
+
+    auto exec_stats = exec_graph->GetStats();
+    execution.bytes_processed = exec_stats.bytes_processed;
+    execution.rows_processed = exec_stats.rows_processed;
+
+    if (analyze) {
+      for (int64_t node_id : pf->dag().TopologicalSort()) {
+        PX_ASSIGN_OR_RETURN(auto exec_node, exec_graph->node(node_id));
+        std::string node_name =
+            absl::Substitute("$0 (id=$1)", pf->nodes()[node_id]->DebugString(), node_id);
+        exec::ExecNodeStats* stats = exec_node->stats();
+        stats->AddExtraMetric("batches_output", stats->batches_output);
+        stats->AddExtraMetric("bytes_allocated", stats->bytes_allocated);
+        int64_t total_time_ns = stats->TotalExecTime();
+        int64_t self_time_ns = stats->SelfExecTime();
+        LOG(INFO) << absl::Substitute(
+            "self_time:$1\ttotal_time: $2\tbytes_output: $3\trows_output: $4\tnode_id:$0",
+            node_name, PrettyDuration(self_time_ns), PrettyDuration(total_time_ns),
+            stats->bytes_output, stats->rows_output);
+
+        queryresultspb::OperatorExecutionStats& stats_pb =
+            execution.operator_exec_stats.emplace_back();
+        stats_pb.set_plan_fragment_id(pf->id());
+        stats_pb.set_node_id(node_id);
+        stats_pb.set_bytes_output(stats->bytes_output);
+        stats_pb.set_records_output(stats->rows_output);
+        stats_pb.set_total_execution_time_ns(total_time_ns);
+        stats_pb.set_self_execution_time_ns(self_time_ns);
+
+        for (const auto& [k, v] : stats->extra_metrics) {
+          (*stats_pb.mutable_extra_metrics())[k] = v;
+        }
+
+        for (const auto& [k, v] : stats->extra_info) {
+          (*stats_pb.mutable_extra_info())[k] = v;
+        }
+        (*stats_pb.mutable_extra_info())["DebugString"] = pf->nodes()[node_id]->DebugString();
+      }
+    }
+    execution.exec_graph.reset();
+    return Status::OK();
+  };
+  if (s.ok()) {
+    // The first fragment to fail stops the sources of the others, so they don't keep running
+    // for a query that has already failed.
+    s = exec::FragmentExecutor(plan.dag(), FLAGS_carnot_max_concurrent_fragments,
+                               [&exec_state] { exec_state->StopAllSources(); })
+            .Execute(execute_fragment);
+  }
+
+  // The errors reported by upstream agents are kept by the GRPC router until the exec state is
+  // destroyed, so they can all be collected once every fragment is done.
+  std::vector<statuspb::Status> incoming_errors =
+      exec_state->grpc_router()->GetIncomingWorkerErrors(query_id);
+
   if (!s.ok()) {
     PX_RETURN_IF_ERROR(SendErrorToOutgoingConns(query_id, outgoing_conns,
                                                 engine_state_->add_auth_to_grpc_context_func(), s));
@@ -424,6 +487,17 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
     return combined_status;
   }
 
+  // Aggregate the stats of the fragments in topological order, so they're reported in the same
+  // order regardless of the order in which the fragments completed.
+  for (int64_t fragment_id : fragment_ids) {
+    FragmentExecution& execution = fragment_executions[fragment_id];
+    bytes_processed += execution.bytes_processed;
+    rows_processed += execution.rows_processed;
+    for (auto& stats_pb : execution.operator_exec_stats) {
+      *agent_operator_exec_stats.add_operator_execution_stats() = std::move(stats_pb);
+    }
+  }
+
   std::vector<uuidpb::UUID> incoming_agents;
   for (const auto& id : logical_plan.incoming_agent_ids()) {
     incoming_agents.push_back(id);
@@ -462,7 +536,8 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
 
   return SendFinalExecutionStatsToOutgoingConns(query_id, outgoing_conns,
                                                 engine_state_->add_auth_to_grpc_context_func(),
-                                                agent_operator_exec_stats, all_agent_stats);
+                                                agent_operator_exec_stats, all_agent_stats,
+                                                exec_state->warnings());
 }
 
 CarnotImpl::~CarnotImpl() {
@@ -731,6 +731,116 @@ TEST_F(CarnotTest, empty_source_test) {
   }
 }
 
+// Two independent fragments, each writing to its own output table.
+constexpr char kIndependentFragmentsPlan[] = R"proto(
+dag {
+  nodes {
+    id: 1
+  }
+  nodes {
+    id: 2
+  }
+}
+nodes {
+  id: 1
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_parents: 1
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: EMPTY_SOURCE_OPERATOR
+      empty_source_op {
+        column_names: "cpu0"
+        column_types: INT64
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: GRPC_SINK_OPERATOR
+      grpc_sink_op {
+        address: "result_addr"
+        output_table {
+          table_name: "out_table1"
+          column_names: "cpu0"
+          column_types: INT64
+        }
+        connection_options {
+          ssl_targetname: "result_ssltarget"
+        }
+      }
+    }
+  }
+}
+nodes {
+  id: 2
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_parents: 1
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: EMPTY_SOURCE_OPERATOR
+      empty_source_op {
+        column_names: "cpu0"
+        column_types: INT64
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: GRPC_SINK_OPERATOR
+      grpc_sink_op {
+        address: "result_addr"
+        output_table {
+          table_name: "out_table2"
+          column_names: "cpu0"
+          column_types: INT64
+        }
+        connection_options {
+          ssl_targetname: "result_ssltarget"
+        }
+      }
+    }
+  }
+}
+)proto";
+
+TEST_F(CarnotTest, independent_fragments_test) {
+  planpb::Plan plan;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kIndependentFragmentsPlan, &plan));
+
+  ASSERT_OK(carnot_->ExecutePlan(plan, sole::uuid4()));
+
+  EXPECT_THAT(result_server_->output_tables(),
+              UnorderedElementsAre("out_table1", "out_table2"));
+  for (const auto& table_name : {"out_table1", "out_table2"}) {
+    auto output_batches = result_server_->query_results(table_name);
+    ASSERT_EQ(2, output_batches.size());
+    for (const auto& rb : output_batches) {
+      EXPECT_EQ(1, rb.num_columns());
+      EXPECT_EQ(0, rb.num_rows());
+    }
+  }
+}
+
 const char kPxCluster[] = R"pxl(
 import px
 
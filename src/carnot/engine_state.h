@@ -78,7 +78,8 @@ class EngineState : public NotCopyable {
   }
 
   table_store::TableStore* table_store() { return table_store_.get(); }
-  std::unique_ptr<exec::ExecState> CreateExecState(const sole::uuid& query_id) {
+  std::unique_ptr<exec::ExecState> CreateExecState(const sole::uuid& query_id,
+                                                   int64_t memory_limit_bytes = 0) {
     return std::make_unique<exec::ExecState>(
         func_registry_.get(), table_store_, stub_generator_,
         [this](const std::string& remote_addr, bool insecure) {
@@ -87,7 +88,8 @@ class EngineState : public NotCopyable {
         [this](const std::string& remote_addr, bool insecure) {
           return TraceStubGenerator(remote_addr, insecure);
         },
-        query_id, model_pool_.get(), grpc_router_, add_auth_to_grpc_context_func_, metrics_.get());
+        query_id, model_pool_.get(), grpc_router_, add_auth_to_grpc_context_func_, metrics_.get(),
+        memory_limit_bytes);
   }
   std::shared_ptr<grpc::Channel> CreateChannel(const std::string& remote_addr, bool insecure) {
     grpc::ChannelArguments args;
@@ -22,6 +22,7 @@
 #include <arrow/array/builder_base.h>
 #include <arrow/status.h>
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 
 #include <magic_enum.hpp>
@@ -149,6 +150,7 @@ Status AggNode::OpenImpl(ExecState* exec_state) {
   if (!plan_node_->partial_agg()) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_for_deserialize_, exec_state));
   }
+  last_flush_time_ = std::chrono::steady_clock::now();
   return Status::OK();
 }
 
@@ -178,6 +180,8 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
   agg_hash_map_.clear();
+  has_unflushed_rows_ = false;
+  last_flush_time_ = std::chrono::steady_clock::now();
   return Status::OK();
 }
 
@@ -191,34 +195,43 @@ Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb)
   } else {
     PX_RETURN_IF_ERROR(DeserializeAndMergeNoGroups(rb));
   }
+  has_unflushed_rows_ |= rb.num_rows() > 0;
 
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, 1);
-    for (size_t i = 0; i < values.size(); ++i) {
-      const auto& uda_info = udas_no_groups_[i];
-      std::unique_ptr<arrow::ArrayBuilder> builder;
-      if (plan_node_->finalize_results()) {
-        builder = types::MakeArrowBuilder(uda_info.def->finalize_return_type(),
-                                          exec_state->exec_mem_pool());
-        PX_RETURN_IF_ERROR(
-            uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
-      } else {
-        builder = types::MakeArrowBuilder(types::STRING, exec_state->exec_mem_pool());
-        PX_RETURN_IF_ERROR(
-            uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
-      }
-      SharedArray out_col;
-      PX_RETURN_IF_ERROR(builder->Finish(&out_col));
-      PX_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
-    }
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-    PX_RETURN_IF_ERROR(ClearAggState(exec_state));
+    return EmitNoGroupsBatch(exec_state, rb.eow(), rb.eos());
+  }
+  if (ShouldFlushPartialAggregates(exec_state)) {
+    return EmitNoGroupsBatch(exec_state, /*eow*/ false, /*eos*/ false);
   }
   return Status::OK();
 }
 
+Status AggNode::EmitNoGroupsBatch(ExecState* exec_state, bool eow, bool eos) {
+  auto values = plan_node_->values();
+  RowBatch output_rb(*output_descriptor_, 1);
+  for (size_t i = 0; i < values.size(); ++i) {
+    const auto& uda_info = udas_no_groups_[i];
+    std::unique_ptr<arrow::ArrayBuilder> builder;
+    if (plan_node_->finalize_results()) {
+      builder = types::MakeArrowBuilder(uda_info.def->finalize_return_type(),
+                                        exec_state->exec_mem_pool());
+      PX_RETURN_IF_ERROR(
+          uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
+    } else {
+      builder = types::MakeArrowBuilder(types::STRING, exec_state->exec_mem_pool());
+      PX_RETURN_IF_ERROR(
+          uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
+    }
+    SharedArray out_col;
+    PX_RETURN_IF_ERROR(builder->Finish(&out_col));
+    PX_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
+  }
+  output_rb.set_eow(eow);
+  output_rb.set_eos(eos);
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  return ClearAggState(exec_state);
+}
+
 Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
   // Grow the group_args_chunk_ to be the size of the RowBatch.
   size_t num_rows = rb.num_rows();
@@ -394,17 +407,36 @@ Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb
     PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
   }
   PX_RETURN_IF_ERROR(ResetGroupArgs());
+  has_unflushed_rows_ |= rb.num_rows() > 0;
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-    PX_RETURN_IF_ERROR(ClearAggState(exec_state));
+    return EmitGroupedBatch(exec_state, rb.eow(), rb.eos());
+  }
+  if (ShouldFlushPartialAggregates(exec_state)) {
+    return EmitGroupedBatch(exec_state, /*eow*/ false, /*eos*/ false);
   }
   return Status::OK();
 }
 
+Status AggNode::EmitGroupedBatch(ExecState* exec_state, bool eow, bool eos) {
+  RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
+  PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+  output_rb.set_eow(eow);
+  output_rb.set_eos(eos);
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  return ClearAggState(exec_state);
+}
+
+bool AggNode::ShouldFlushPartialAggregates(ExecState* exec_state) const {
+  // Only the partial aggregates that are merged downstream can hand over their state early, since
+  // merging it in several pieces gives the same result as merging it at once.
+  if (!plan_node_->partial_agg() || plan_node_->finalize_results() || plan_node_->windowed() ||
+      !has_unflushed_rows_) {
+    return false;
+  }
+  auto interval = exec_state->partial_result_flush_interval();
+  return interval.count() > 0 && std::chrono::steady_clock::now() - last_flush_time_ >= interval;
+}
+
 StatusOr<types::DataType> AggNode::GetTypeOfDep(const plan::ScalarExpression& expr) const {
   // Agg exprs can only be of type col, or  const.
   switch (expr.ExpressionType()) {
@@ -550,7 +582,7 @@ Status AggNode::CreateColumnMapping() {
 }
 
 AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state) {
-  auto* val = udas_pool_.Add(new AggHashValue);
+  auto* val = udas_pool_.New();
   PX_CHECK_OK(CreateUDAInfoValues(&(val->udas), exec_state));
   for (const auto& dt : stored_cols_data_types_) {
     val->agg_cols.emplace_back(types::ColumnWrapper::Make(dt, 0));
@@ -17,6 +17,7 @@
  */
 
 #pragma once
+#include <chrono>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -94,6 +95,12 @@ class AggNode : public ProcessingNode {
   bool ReadyToEmitBatches(const table_store::schema::RowBatch& rb) const;
   // When we see a new window, we need to be able to clear the aggregate state.
   Status ClearAggState(ExecState* exec_state);
+  // Emits the aggregate state as a row batch, and clears it.
+  Status EmitNoGroupsBatch(ExecState* exec_state, bool eow, bool eos);
+  Status EmitGroupedBatch(ExecState* exec_state, bool eow, bool eos);
+  // Whether a partial aggregate should flush its state downstream before end of stream. See
+  // ExecState::partial_result_flush_interval().
+  bool ShouldFlushPartialAggregates(ExecState* exec_state) const;
 
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
@@ -133,12 +140,18 @@ class AggNode : public ProcessingNode {
   // 3. The data type of the stored colums, by the index they are stored at.
   std::vector<types::DataType> stored_cols_data_types_;
 
-  ObjectPool group_args_pool_{"group_args_pool"};
-  ObjectPool udas_pool_{"udas_pool"};
+  // The group row tuples and per-group aggregate values are created for every new group, so they
+  // are bump-allocated in slabs rather than individually.
+  TypedArena<RowTuple> group_args_pool_;
+  TypedArena<AggHashValue> udas_pool_;
 
   std::vector<types::DataType> group_data_types_;
   std::vector<types::DataType> value_data_types_;
 
+  // Whether rows were aggregated since the state was last emitted, and when that was.
+  bool has_unflushed_rows_ = false;
+  std::chrono::steady_clock::time_point last_flush_time_;
+
   // We construct row-tuples in a batch, chunked by each column.
   // This vector holds pointers to the row_tuples which are managed by the group_args_pool_.
 
@@ -157,7 +170,7 @@ class AggNode : public ProcessingNode {
 
   AggHashValue* CreateAggHashValue(ExecState* exec_state);
   RowTuple* CreateGroupArgsRowTuple() {
-    return group_args_pool_.Add(new RowTuple(&group_data_types_));
+    return group_args_pool_.New(&group_data_types_);
   }
 
   Status CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state);
@@ -19,6 +19,8 @@
 #include "src/carnot/exec/agg_node.h"
 
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
@@ -891,6 +893,45 @@ TEST_F(AggNodeTest, single_group_partial) {
       .Close();
 }
 
+TEST_F(AggNodeTest, single_group_partial_flush) {
+  exec_state_->set_partial_result_flush_interval(std::chrono::milliseconds(1));
+  auto plan_node = PlanNodeFromPbtxt(kPartialSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+  // Once the flush interval has passed, the partial aggregate hands over its state without
+  // waiting for end of stream, and only emits the groups seen since then at eos.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::StringValue>({"2", "3"})
+                          .get(),
+                      false)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                       .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 4, true, true)
+                          .AddColumn<types::Int64Value>({3, 4, 5, 6})
+                          .AddColumn<types::StringValue>({"3", "4", "1", "5"})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, single_group_partial_finalize) {
   auto plan_node = PlanNodeFromPbtxt(kPartialSingleGroupAggFinalize);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
@@ -919,6 +960,38 @@ TEST_F(AggNodeTest, single_group_partial_finalize) {
       .Close();
 }
 
+TEST_F(AggNodeTest, single_group_partial_finalize_ignores_flush_interval) {
+  exec_state_->set_partial_result_flush_interval(std::chrono::milliseconds(1));
+  auto plan_node = PlanNodeFromPbtxt(kPartialSingleGroupAggFinalize);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+  // The merge emits its results once, at end of stream, so that every group reaches the result
+  // sink exactly once.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::StringValue>({"2", "3", "3", "1"})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                       .AddColumn<types::StringValue>({"1", "5", "3", "8"})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 6, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6})
+                          .AddColumn<types::Int64Value>({5, 4, 3, 8, 1, 5})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, multiple_groups_partial) {
   auto plan_node = PlanNodeFromPbtxt(kPartialMultipleGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
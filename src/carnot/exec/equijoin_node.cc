@@ -115,25 +115,27 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
   return Status::OK();
 }
 
-Status EquijoinNode::InitializeColumnBuilders() {
+Status EquijoinNode::InitializeColumnBuilders(ExecState* exec_state) {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     column_builders_[i] =
-        MakeArrowBuilder(output_descriptor_->type(i), arrow::default_memory_pool());
+        MakeArrowBuilder(output_descriptor_->type(i), exec_state->exec_mem_pool());
     PX_RETURN_IF_ERROR(column_builders_[i]->Reserve(output_rows_per_batch_));
   }
   return Status::OK();
 }
 
-Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
+Status EquijoinNode::PrepareImpl(ExecState* exec_state) {
   column_builders_.resize(output_descriptor_->size());
-  PX_RETURN_IF_ERROR(InitializeColumnBuilders());
+  PX_RETURN_IF_ERROR(InitializeColumnBuilders(exec_state));
 
   return Status::OK();
 }
 
 Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
 
-Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
+Status EquijoinNode::CloseImpl(ExecState* exec_state) {
+  exec_state->exec_mem_pool()->TrackRetainedBytes(-retained_bytes_);
+  retained_bytes_ = 0;
   join_keys_chunk_.clear();
   build_buffer_.clear();
   probed_keys_.clear();
@@ -155,7 +157,7 @@ Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch
   // Reset the row tuples
   for (auto& rt : join_keys_chunk_) {
     if (rt == nullptr) {
-      rt = key_values_pool_.Add(new RowTuple(&key_data_types_));
+      rt = key_values_pool_.New(&key_data_types_);
     } else {
       rt->Reset();
     }
@@ -167,7 +169,7 @@ Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch
     int prev_size = join_keys_chunk_.size();
     join_keys_chunk_.reserve(num_rows);
     for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      auto tuple_ptr = key_values_pool_.Add(new RowTuple(&key_data_types_));
+      auto tuple_ptr = key_values_pool_.New(&key_data_types_);
       join_keys_chunk_.emplace_back(tuple_ptr);
     }
   }
@@ -188,9 +190,10 @@ Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch
   return Status::OK();
 }
 
-std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
-                                                       const std::vector<types::DataType>& types) {
-  auto ptr = pool->Add(new std::vector<types::SharedColumnWrapper>(types.size()));
+std::vector<types::SharedColumnWrapper>* CreateWrapper(
+    TypedArena<std::vector<types::SharedColumnWrapper>>* pool,
+    const std::vector<types::DataType>& types) {
+  auto ptr = pool->New(types.size());
   for (size_t col_idx = 0; col_idx < types.size(); ++col_idx) {
     (*ptr)[col_idx] = types::ColumnWrapper::Make(types[col_idx], 0);
   }
@@ -272,7 +275,7 @@ Status EquijoinNode::NextOutputBatch(ExecState* exec_state) {
   }
   pending_output_batch_.swap(output_batch);
 
-  return InitializeColumnBuilders();
+  return InitializeColumnBuilders(exec_state);
 }
 
 Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
@@ -410,6 +413,11 @@ Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
   return Status::OK();
 }
 
+void EquijoinNode::TrackRetainedBytes(ExecState* exec_state, int64_t delta_bytes) {
+  retained_bytes_ += delta_bytes;
+  exec_state->exec_mem_pool()->TrackRetainedBytes(delta_bytes);
+}
+
 Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
                                        const table_store::schema::RowBatch& rb) {
   if (rb.eos()) {
@@ -418,10 +426,12 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
 
   PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
   PX_RETURN_IF_ERROR(HashRowBatch(rb));
+  TrackRetainedBytes(exec_state, rb.NumBytes());
 
   if (build_eos_) {
     while (probe_batches_.size()) {
       PX_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
+      TrackRetainedBytes(exec_state, -probe_batches_.front().NumBytes());
       probe_batches_.pop();
     }
   }
@@ -432,6 +442,7 @@ Status EquijoinNode::ConsumeProbeBatch(ExecState* exec_state,
                                        const table_store::schema::RowBatch& rb) {
   if (!build_eos_) {
     probe_batches_.push(rb);
+    TrackRetainedBytes(exec_state, rb.NumBytes());
     return Status::OK();
   }
   return DoProbe(exec_state, rb);
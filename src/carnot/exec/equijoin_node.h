@@ -74,7 +74,7 @@ class EquijoinNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  Status InitializeColumnBuilders();
+  Status InitializeColumnBuilders(ExecState* exec_state);
   bool IsProbeTable(size_t parent_index);
   Status FlushChunkedRows(ExecState* exec_state);
   Status ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb, bool is_probe);
@@ -89,6 +89,8 @@ class EquijoinNode : public ProcessingNode {
   Status NextOutputBatch(ExecState* exec_state);
   Status ConsumeBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConsumeProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  // Accounts for the row batches held by the join in the query memory pool.
+  void TrackRetainedBytes(ExecState* exec_state, int64_t delta_bytes);
 
   bool build_eos_ = false;
   bool probe_eos_ = false;
@@ -127,11 +129,13 @@ class EquijoinNode : public ProcessingNode {
   // Memory/column building members
   // If the build stage isn't complete, we need to buffer the probe batches.
   std::queue<table_store::schema::RowBatch> probe_batches_;
+  // The bytes of the build and probe batches held by the join.
+  int64_t retained_bytes_ = 0;
   // Column builders will flush a batch once they hit output_rows_per_batch_ rows.
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
   // Manages the RowTuples containing the keys for the join.
-  ObjectPool key_values_pool_{"equijoin_kv_pool"};
-  ObjectPool column_values_pool_{"equijoin_col_vals_pool"};
+  TypedArena<RowTuple> key_values_pool_;
+  TypedArena<std::vector<types::SharedColumnWrapper>> column_values_pool_;
 
   // Chunk of data to use when extracting join keys.
   std::vector<RowTuple*> join_keys_chunk_;
@@ -174,10 +174,58 @@ Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth() {
   return Status::OK();
 }
 
+void ExecutionGraph::RemoveCompletedSources(
+    const absl::flat_hash_set<SourceNode*>& completed_sources,
+    absl::flat_hash_set<SourceNode*>* running_sources) {
+  for (SourceNode* source : completed_sources) {
+    running_sources->erase(source);
+    if (!first_grpc_source_completed_time_.has_value() &&
+        grpc_sources_.contains(source_to_id_.at(source))) {
+      first_grpc_source_completed_time_ = std::chrono::steady_clock::now();
+    }
+  }
+}
+
+StatusOr<absl::flat_hash_set<SourceNode*>> ExecutionGraph::EndStragglingGRPCSources(
+    const absl::flat_hash_set<SourceNode*>& running_sources) {
+  absl::flat_hash_set<SourceNode*> stragglers;
+  auto timeout = exec_state_->grpc_source_straggler_timeout();
+  if (timeout.count() <= 0 || !first_grpc_source_completed_time_.has_value() ||
+      std::chrono::steady_clock::now() - *first_grpc_source_completed_time_ < timeout) {
+    return stragglers;
+  }
+
+  for (SourceNode* source : running_sources) {
+    const int64_t source_id = source_to_id_.at(source);
+    if (!grpc_sources_.contains(source_id)) {
+      continue;
+    }
+    LOG(WARNING) << absl::Substitute(
+        "Query $0: $1 didn't finish within $2 ms of the first GRPC source, ending it and "
+        "proceeding with the rest of the query.",
+        exec_state_->query_id().str(), source->DebugString(), timeout.count());
+    source->stats()->AddExtraInfo("ended_early", "straggler");
+    // The straggler is stopped the same way a limit stops the sources it no longer needs, and its
+    // stream is ended so that blocking operators downstream emit what they have so far.
+    exec_state_->StopSource(source_id);
+    PX_RETURN_IF_ERROR(source->SendEndOfStream(exec_state_));
+    if (exec_state_->exec_metrics() != nullptr) {
+      exec_state_->exec_metrics()->grpc_source_stragglers_counter.Increment();
+    }
+    stragglers.insert(source);
+  }
+  if (!stragglers.empty()) {
+    exec_state_->AddWarning(absl::Substitute(
+        "Results are incomplete: $0 of the $1 GRPC sources of a plan fragment didn't finish "
+        "within $2 ms of the first one, so the rest of their results were left out.",
+        stragglers.size(), grpc_sources_.size(), timeout.count()));
+  }
+  return stragglers;
+}
+
 Status ExecutionGraph::ExecuteSources() {
   absl::flat_hash_set<SourceNode*> running_sources;
 
-  absl::flat_hash_map<SourceNode*, int64_t> source_to_id;
   for (auto node_id : sources_) {
     auto node = nodes_.find(node_id);
     if (node == nodes_.end()) {
@@ -185,7 +233,7 @@ Status ExecutionGraph::ExecuteSources() {
     }
     SourceNode* n = static_cast<SourceNode*>(node->second);
     running_sources.insert(n);
-    source_to_id[n] = node_id;
+    source_to_id_[n] = node_id;
   }
 
   // Run all sources to completion, or exit if the query encounters an error.
@@ -193,7 +241,7 @@ Status ExecutionGraph::ExecuteSources() {
     absl::flat_hash_set<SourceNode*> completed_sources_execute_loop;
 
     for (SourceNode* source : running_sources) {
-      if (grpc_sources_.contains(source_to_id.at(source))) {
+      if (grpc_sources_.contains(source_to_id_.at(source))) {
         auto s = CheckUpstreamGRPCConnectionHealth(static_cast<GRPCSourceNode*>(source));
         if (!s.ok()) {
           LOG(ERROR) << absl::Substitute(
@@ -206,18 +254,19 @@ Status ExecutionGraph::ExecuteSources() {
         }
       }
 
-      exec_state_->SetCurrentSource(source_to_id[source]);
+      const int64_t source_id = source_to_id_[source];
 
       for (auto i = 0; i < consecutive_generate_calls_per_source_; ++i) {
-        if (!source->NextBatchReady() || !exec_state_->keep_running()) {
+        if (!source->NextBatchReady() || !exec_state_->keep_running(source_id)) {
           break;
         }
         PX_RETURN_IF_ERROR(source->GenerateNext(exec_state_));
+        PX_RETURN_IF_ERROR(exec_state_->CheckMemoryLimit());
       }
 
       // keep_running will be set to false when a downstream limit for this particular
       // source (set in exec_state) has been reached.
-      if (!source->HasBatchesRemaining() || !exec_state_->keep_running()) {
+      if (!source->HasBatchesRemaining() || !exec_state_->keep_running(source_id)) {
         completed_sources_execute_loop.insert(source);
         break;
       }
@@ -225,9 +274,9 @@ Status ExecutionGraph::ExecuteSources() {
     PX_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth());
 
     // Flush all of the completed sources.
-    for (SourceNode* source : completed_sources_execute_loop) {
-      running_sources.erase(source);
-    }
+    RemoveCompletedSources(completed_sources_execute_loop, &running_sources);
+    PX_ASSIGN_OR_RETURN(auto stragglers, EndStragglingGRPCSources(running_sources));
+    RemoveCompletedSources(stragglers, &running_sources);
 
     // If all sources are complete, the query is done executing.
     if (!running_sources.size()) {
@@ -256,11 +305,16 @@ Status ExecutionGraph::ExecuteSources() {
       // have a mechanism to call Yield() on them while they are waiting.
       // Once we introduce Carnot ETL, we can have the ingest phase of Carnot ETL call yield.
       for (SourceNode* source : running_sources) {
+        // A source can be stopped while it waits, e.g. when another plan fragment fails.
+        if (!exec_state_->keep_running(source_to_id_.at(source))) {
+          completed_sources_wait_loop.insert(source);
+          continue;
+        }
         if (source->NextBatchReady()) {
           wait_for_more_data = false;
         }
         // Check the upstream connection health of all running GRPC sources after each yield.
-        if (grpc_sources_.contains(source_to_id.at(source))) {
+        if (grpc_sources_.contains(source_to_id_.at(source))) {
           auto s = CheckUpstreamGRPCConnectionHealth(static_cast<GRPCSourceNode*>(source));
           if (!s.ok()) {
             LOG(ERROR) << absl::Substitute(
@@ -276,9 +330,9 @@ Status ExecutionGraph::ExecuteSources() {
       PX_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth());
 
       // Flush all of the completed sources after this phase of source deletion.
-      for (SourceNode* source : completed_sources_wait_loop) {
-        running_sources.erase(source);
-      }
+      RemoveCompletedSources(completed_sources_wait_loop, &running_sources);
+      PX_ASSIGN_OR_RETURN(auto stragglers, EndStragglingGRPCSources(running_sources));
+      RemoveCompletedSources(stragglers, &running_sources);
       if (!running_sources.size()) {
         return Status::OK();
       }
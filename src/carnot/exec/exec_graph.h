@@ -23,6 +23,7 @@
 #include <condition_variable>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -209,6 +210,16 @@ class ExecutionGraph {
 
   Status ExecuteSources();
 
+  // Removes the completed sources from the running ones, and keeps track of when the first GRPC
+  // source completed.
+  void RemoveCompletedSources(const absl::flat_hash_set<SourceNode*>& completed_sources,
+                              absl::flat_hash_set<SourceNode*>* running_sources);
+
+  // Ends the GRPC sources that are still running once the straggler timeout has passed since the
+  // first GRPC source completed. Returns the sources that were ended.
+  StatusOr<absl::flat_hash_set<SourceNode*>> EndStragglingGRPCSources(
+      const absl::flat_hash_set<SourceNode*>& running_sources);
+
   ExecState* exec_state_;
   ObjectPool pool_{"exec_graph_pool"};
   table_store::schema::Schema* schema_;
@@ -220,6 +231,10 @@ class ExecutionGraph {
   std::unordered_map<int64_t, ExecNode*> nodes_;
 
   SystemTimePoint query_start_time_;
+  // When the first GRPC source of the fragment reached end of stream. A steady clock, so that
+  // wall clock adjustments can't end the other sources early or hold them up.
+  std::optional<std::chrono::steady_clock::time_point> first_grpc_source_completed_time_;
+  absl::flat_hash_map<SourceNode*, int64_t> source_to_id_;
 
   // How long to wait for any upstream result to make the initial connection to this query.
   std::chrono::milliseconds upstream_result_connection_timeout_ms_;
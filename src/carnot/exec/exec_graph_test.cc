@@ -681,6 +681,70 @@ constexpr char kGRPCSourcePlanFragment[] = R"(
   }
 )";
 
+constexpr char kTwoGRPCSourcesPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 3
+    }
+    nodes {
+      id: 2
+      sorted_children: 4
+    }
+    nodes {
+      id: 3
+      sorted_parents: 1
+    }
+    nodes {
+      id: 4
+      sorted_parents: 2
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: GRPC_SOURCE_OPERATOR
+      grpc_source_op {
+        column_types: INT64
+        column_names: "test"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: GRPC_SOURCE_OPERATOR
+      grpc_source_op {
+        column_types: INT64
+        column_names: "test"
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "mem_sink1"
+        column_types: INT64
+        column_names: "test"
+      }
+    }
+  }
+  nodes {
+    id: 4
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "mem_sink2"
+        column_types: INT64
+        column_names: "test"
+      }
+    }
+  }
+)";
+
 class GRPCExecGraphTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -867,6 +931,48 @@ TEST_F(GRPCExecGraphTest, infinite_source_and_error_source) {
   EXPECT_NOT_OK(s);
 }
 
+TEST_F(GRPCExecGraphTest, straggling_grpc_source_is_ended) {
+  planpb::PlanFragment pf_pb;
+  ASSERT_TRUE(TextFormat::MergeFromString(kTwoGRPCSourcesPlanFragment, &pf_pb));
+  auto plan_fragment = std::make_shared<plan::PlanFragment>(1);
+  ASSERT_OK(plan_fragment->Init(pf_pb));
+  exec_state_->set_grpc_source_straggler_timeout(std::chrono::milliseconds(10));
+
+  ExecutionGraph e{std::chrono::milliseconds(1), std::chrono::milliseconds(60000)};
+  ASSERT_OK(e.Init(schema_.get(), plan_state_.get(), exec_state_.get(), plan_fragment.get(),
+                   /* collect_exec_node_stats */ true));
+  auto finished_src = static_cast<GRPCSourceNode*>(e.node(1).ConsumeValueOrDie());
+  auto straggling_src = static_cast<GRPCSourceNode*>(e.node(2).ConsumeValueOrDie());
+  finished_src->set_upstream_initiated_connection();
+  straggling_src->set_upstream_initiated_connection();
+
+  RowDescriptor output_rd({types::DataType::INT64});
+  auto rb1 = RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+                 .AddColumn<types::Int64Value>({1, 2})
+                 .get();
+  auto rb2 = RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Int64Value>({3})
+                 .get();
+  auto req1 = std::make_unique<carnotpb::TransferResultChunkRequest>();
+  auto req2 = std::make_unique<carnotpb::TransferResultChunkRequest>();
+  ASSERT_OK(rb1.ToProto(req1->mutable_query_result()->mutable_row_batch()));
+  ASSERT_OK(rb2.ToProto(req2->mutable_query_result()->mutable_row_batch()));
+  ASSERT_OK(finished_src->EnqueueRowBatch(std::move(req1)));
+  ASSERT_OK(straggling_src->EnqueueRowBatch(std::move(req2)));
+
+  // The second source never reaches end of stream, so without the straggler timeout this would
+  // never return.
+  EXPECT_OK(e.Execute());
+  EXPECT_FALSE(straggling_src->HasBatchesRemaining());
+  EXPECT_EQ(1, straggling_src->stats()->rows_output);
+  EXPECT_EQ("straggler", straggling_src->stats()->extra_info["ended_early"]);
+  EXPECT_FALSE(finished_src->stats()->extra_info.contains("ended_early"));
+  EXPECT_FALSE(exec_state_->keep_running(2));
+  auto warnings = exec_state_->warnings();
+  ASSERT_EQ(1, warnings.size());
+  EXPECT_THAT(warnings[0], ::testing::HasSubstr("1 of the 2 GRPC sources"));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
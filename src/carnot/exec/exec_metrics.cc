@@ -32,4 +32,30 @@ ExecMetrics::ExecMetrics(prometheus::Registry* registry)
               .Name("otlp_timeouts")
               .Help("Total number of timeouts which occurred when exporting data to an OTLP client")
               .Register(*registry)
-              .Add({{"name", "spans"}})) {}
+              .Add({{"name", "spans"}})),
+      query_memory_allocated_bytes_counter(
+          prometheus::BuildCounter()
+              .Name("query_memory_allocated_bytes")
+              .Help("Total number of bytes allocated by queries from their memory pool")
+              .Register(*registry)
+              .Add({})),
+      query_memory_recycled_bytes_counter(
+          prometheus::BuildCounter()
+              .Name("query_memory_recycled_bytes")
+              .Help("Total number of bytes allocated by queries from buffers recycled by their "
+                    "memory pool")
+              .Register(*registry)
+              .Add({})),
+      query_memory_limit_exceeded_counter(
+          prometheus::BuildCounter()
+              .Name("query_memory_limit_exceeded")
+              .Help("Total number of queries cancelled for exceeding their memory limit")
+              .Register(*registry)
+              .Add({})),
+      grpc_source_stragglers_counter(
+          prometheus::BuildCounter()
+              .Name("grpc_source_stragglers")
+              .Help("Total number of GRPC sources ended early because their upstream agent took "
+                    "too long to finish")
+              .Register(*registry)
+              .Add({})) {}
@@ -27,4 +27,8 @@ struct ExecMetrics {
 
   prometheus::Counter& otlp_metrics_timeout_counter;
   prometheus::Counter& otlp_spans_timeout_counter;
+  prometheus::Counter& query_memory_allocated_bytes_counter;
+  prometheus::Counter& query_memory_recycled_bytes_counter;
+  prometheus::Counter& query_memory_limit_exceeded_counter;
+  prometheus::Counter& grpc_source_stragglers_counter;
 };
@@ -115,6 +115,9 @@ struct ExecNodeStats {
   int64_t rows_output = 0;
   // Total batches input to this exec node.
   int64_t batches_output = 0;
+  // Total bytes allocated from the query memory pool by this exec node. Unlike the other stats,
+  // this is always collected.
+  int64_t bytes_allocated = 0;
   // Total timer for the node = children_time + self_time.
   ElapsedTimer total_timer;
   // Total timer for the children of the ndoe.
@@ -160,6 +163,7 @@ class ExecNode {
    */
   Status Prepare(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    QueryMemoryPool::NodeScope mem_scope(&stats_->bytes_allocated);
     return PrepareImpl(exec_state);
   }
 
@@ -170,6 +174,7 @@ class ExecNode {
    */
   Status Open(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    QueryMemoryPool::NodeScope mem_scope(&stats_->bytes_allocated);
     return OpenImpl(exec_state);
   }
 
@@ -194,6 +199,7 @@ class ExecNode {
   Status GenerateNext(ExecState* exec_state) {
     DCHECK(is_initialized_);
     DCHECK(type() == ExecNodeType::kSourceNode);
+    QueryMemoryPool::NodeScope mem_scope(&stats_->bytes_allocated);
     stats_->ResumeTotalTimer();
     PX_RETURN_IF_ERROR(GenerateNextImpl(exec_state));
     stats_->StopTotalTimer();
@@ -219,6 +225,7 @@ class ExecNode {
           "ConsumeNext received row batch with end of stream set but not end of window.");
     }
     stats_->AddInputStats(rb);
+    QueryMemoryPool::NodeScope mem_scope(&stats_->bytes_allocated);
     stats_->ResumeTotalTimer();
     PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
     stats_->StopTotalTimer();
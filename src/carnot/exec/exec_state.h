@@ -20,8 +20,11 @@
 
 #include <arrow/memory_pool.h>
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -31,6 +34,7 @@
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/exec_metrics.h"
 #include "src/carnot/exec/grpc_router.h"
+#include "src/carnot/exec/query_memory_pool.h"
 #include "src/carnot/udf/model_pool.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
@@ -72,7 +76,7 @@ class ExecState {
       const TraceStubGenerator& trace_stub_generator, const sole::uuid& query_id,
       udf::ModelPool* model_pool, GRPCRouter* grpc_router = nullptr,
       std::function<void(grpc::ClientContext*)> add_auth_func = [](grpc::ClientContext*) {},
-      ExecMetrics* exec_metrics = nullptr)
+      ExecMetrics* exec_metrics = nullptr, int64_t memory_limit_bytes = 0)
       : func_registry_(func_registry),
         table_store_(std::move(table_store)),
         stub_generator_(stub_generator),
@@ -82,16 +86,37 @@ class ExecState {
         model_pool_(model_pool),
         grpc_router_(grpc_router),
         add_auth_to_grpc_client_context_func_(add_auth_func),
-        exec_metrics_(exec_metrics) {}
+        exec_metrics_(exec_metrics),
+        exec_mem_pool_(QueryMemoryPool::Create(memory_limit_bytes)) {}
 
   ~ExecState() {
     if (grpc_router_ != nullptr) {
       grpc_router_->DeleteQuery(query_id_);
     }
+    VLOG(1) << absl::Substitute("Query $0 used at most $1 bytes of memory.", query_id_.str(),
+                                exec_mem_pool_->max_memory());
+    if (exec_metrics_ != nullptr) {
+      exec_metrics_->query_memory_allocated_bytes_counter.Increment(
+          exec_mem_pool_->total_allocated_bytes());
+      exec_metrics_->query_memory_recycled_bytes_counter.Increment(
+          exec_mem_pool_->recycled_bytes());
+    }
   }
-  arrow::MemoryPool* exec_mem_pool() {
-    // TOOD(zasgar): Make this the correct pool.
-    return arrow::default_memory_pool();
+
+  // The pool that the exec nodes of the query allocate their arrow buffers from.
+  QueryMemoryPool* exec_mem_pool() { return exec_mem_pool_.get(); }
+
+  // Returns an error once the query has used more memory than its limit. The exec graph checks
+  // this between row batches, since allocations themselves don't fail.
+  Status CheckMemoryLimit() {
+    if (!exec_mem_pool_->limit_exceeded()) {
+      return Status::OK();
+    }
+    if (!memory_limit_reported_.exchange(true) && exec_metrics_ != nullptr) {
+      exec_metrics_->query_memory_limit_exceeded_counter.Increment();
+    }
+    return error::ResourceUnavailable("Query $0 exceeded its memory limit of $1 bytes.",
+                                      query_id_.str(), exec_mem_pool_->limit_bytes());
   }
 
   udf::Registry* func_registry() { return func_registry_; }
@@ -119,6 +144,7 @@ class ExecState {
   // Currently, it will either be a Kelvin instance or a query broker.
   carnotpb::ResultSinkService::StubInterface* ResultSinkServiceStub(
       const std::string& remote_address, const std::string& ssl_targetname) {
+    std::lock_guard<std::mutex> lock(stubs_lock_);
     if (result_sink_stub_map_.contains(remote_address)) {
       return result_sink_stub_map_[remote_address];
     }
@@ -133,6 +159,7 @@ class ExecState {
 
   opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface* MetricsServiceStub(
       const std::string& remote_address, bool insecure) {
+    std::lock_guard<std::mutex> lock(stubs_lock_);
     if (metrics_service_stub_map_.contains(remote_address)) {
       return metrics_service_stub_map_[remote_address];
     }
@@ -146,6 +173,7 @@ class ExecState {
   }
   opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* TraceServiceStub(
       const std::string& remote_address, bool insecure) {
+    std::lock_guard<std::mutex> lock(stubs_lock_);
     if (trace_service_stub_map_.contains(remote_address)) {
       return trace_service_stub_map_[remote_address];
     }
@@ -173,20 +201,27 @@ class ExecState {
 
   // A node (ie. Limit) can call this method to say no more records will be processed for this
   // source. That node is responsible for setting eos.
-  void StopSource(int64_t src_id) { source_id_to_keep_running_map_[src_id] = false; }
+  void StopSource(int64_t src_id) {
+    std::lock_guard<std::mutex> lock(keep_running_lock_);
+    source_id_to_keep_running_map_[src_id] = false;
+  }
 
-  bool keep_running() {
-    DCHECK(current_source_set_);
-    return source_id_to_keep_running_map_[current_source_];
+  // Stops every source of the query, including the ones of plan fragments that haven't started
+  // yet. Used to end the fragments still running once another one fails.
+  void StopAllSources() {
+    std::lock_guard<std::mutex> lock(keep_running_lock_);
+    all_sources_stopped_ = true;
   }
 
-  void SetCurrentSource(int64_t source_id) {
-    current_source_ = source_id;
-    current_source_set_ = true;
-    if (source_id_to_keep_running_map_.find(current_source_) ==
-        source_id_to_keep_running_map_.end()) {
-      source_id_to_keep_running_map_[current_source_] = true;
+  // Whether the given source should keep producing records. This doesn't depend on any per-thread
+  // state, so it can be used by plan fragments executing concurrently.
+  bool keep_running(int64_t source_id) {
+    std::lock_guard<std::mutex> lock(keep_running_lock_);
+    if (all_sources_stopped_) {
+      return false;
     }
+    auto it = source_id_to_keep_running_map_.find(source_id);
+    return it == source_id_to_keep_running_map_.end() || it->second;
   }
 
   void set_metadata_state(std::shared_ptr<const md::AgentMetadataState> metadata_state) {
@@ -202,6 +237,38 @@ class ExecState {
 
   ExecMetrics* exec_metrics() { return exec_metrics_; }
 
+  // How often partial aggregates that feed a remote merge (ie. the PEM side of a distributed
+  // aggregate) flush their state downstream, rather than holding it until end of stream. Set from
+  // PlanOptions.partial_result_flush_interval_ms. A zero interval disables the flushes.
+  std::chrono::milliseconds partial_result_flush_interval() const {
+    return partial_result_flush_interval_;
+  }
+  void set_partial_result_flush_interval(std::chrono::milliseconds interval) {
+    partial_result_flush_interval_ = interval;
+  }
+
+  // Once a GRPC source of a plan fragment has reached end of stream, how long the fragment waits
+  // for its other GRPC sources before ending them, so that a single slow agent can't hold up the
+  // query. Set from PlanOptions.straggler_timeout_ms. A zero timeout waits for all of them.
+  std::chrono::milliseconds grpc_source_straggler_timeout() const {
+    return grpc_source_straggler_timeout_;
+  }
+  void set_grpc_source_straggler_timeout(std::chrono::milliseconds timeout) {
+    grpc_source_straggler_timeout_ = timeout;
+  }
+
+  // Conditions that don't fail the query but that its results should be read with, such as GRPC
+  // sources that were ended before they finished. They are reported in the query's execution
+  // stats.
+  void AddWarning(std::string warning) {
+    std::lock_guard<std::mutex> lock(warnings_lock_);
+    warnings_.push_back(std::move(warning));
+  }
+  std::vector<std::string> warnings() {
+    std::lock_guard<std::mutex> lock(warnings_lock_);
+    return warnings_;
+  }
+
  private:
   udf::Registry* func_registry_;
   std::shared_ptr<table_store::TableStore> table_store_;
@@ -216,10 +283,19 @@ class ExecState {
   GRPCRouter* grpc_router_ = nullptr;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
   ExecMetrics* exec_metrics_;
+  QueryMemoryPoolPtr exec_mem_pool_;
+  std::atomic<bool> memory_limit_reported_ = false;
+  std::chrono::milliseconds partial_result_flush_interval_{0};
+  std::chrono::milliseconds grpc_source_straggler_timeout_{0};
+
+  // Plan fragments of the query may execute concurrently; these guard the state they share.
+  std::mutex keep_running_lock_;
+  std::mutex stubs_lock_;
+  std::mutex warnings_lock_;
 
-  int64_t current_source_ = 0;
-  bool current_source_set_ = false;
   std::map<int64_t, bool> source_id_to_keep_running_map_;
+  bool all_sources_stopped_ = false;
+  std::vector<std::string> warnings_;
 
   std::vector<std::unique_ptr<carnotpb::ResultSinkService::StubInterface>> result_sink_stubs_pool_;
   // Mapping of remote address to stub that serves that address.
@@ -320,7 +320,7 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
         auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
         auto udf = id_to_udf_map_[fn.udf_id()].get();
 
-        auto output = MakeArrowBuilder(def->exec_return_type(), arrow::default_memory_pool());
+        auto output = MakeArrowBuilder(def->exec_return_type(), exec_state->exec_mem_pool());
 
         std::vector<arrow::Array*> raw_children;
         raw_children.reserve(children.size());
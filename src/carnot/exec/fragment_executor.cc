@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fragment_executor.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+Status FragmentExecutor::Execute(const ExecuteFragmentFn& execute_fn) {
+  const std::vector<int64_t> fragment_ids = dag_.TopologicalSort();
+
+  // Fragments are tracked by their position in the topological order, and the ready fragment
+  // that comes first in that order is started first.
+  absl::flat_hash_map<int64_t, size_t> positions;
+  for (size_t i = 0; i < fragment_ids.size(); ++i) {
+    positions[fragment_ids[i]] = i;
+  }
+  std::vector<size_t> num_pending_parents(fragment_ids.size());
+  std::set<size_t> ready;
+  for (size_t i = 0; i < fragment_ids.size(); ++i) {
+    num_pending_parents[i] = dag_.ParentsOf(fragment_ids[i]).size();
+    if (num_pending_parents[i] == 0) {
+      ready.insert(i);
+    }
+  }
+
+  std::mutex mu;
+  std::condition_variable cv;
+  int num_running = 0;
+  Status status;
+
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> lock(mu);
+    while (true) {
+      cv.wait(lock, [&] { return !ready.empty() || num_running == 0 || !status.ok(); });
+      // With nothing ready and nothing running, no fragment can become ready anymore.
+      if (!status.ok() || ready.empty()) {
+        return;
+      }
+      const size_t pos = *ready.begin();
+      ready.erase(ready.begin());
+      ++num_running;
+
+      lock.unlock();
+      Status s = execute_fn(fragment_ids[pos]);
+      lock.lock();
+
+      --num_running;
+      if (!s.ok()) {
+        if (status.ok()) {
+          status = s;
+          if (stop_fn_ != nullptr) {
+            stop_fn_();
+          }
+        }
+      } else {
+        for (int64_t child_id : dag_.DependenciesOf(fragment_ids[pos])) {
+          const size_t child_pos = positions.at(child_id);
+          if (--num_pending_parents[child_pos] == 0) {
+            ready.insert(child_pos);
+          }
+        }
+      }
+      cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  const size_t num_threads = std::min(static_cast<size_t>(max_concurrency_), fragment_ids.size());
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return status;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
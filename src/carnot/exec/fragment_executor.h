@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "src/carnot/dag/dag.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * FragmentExecutor runs the plan fragments of a query, following the fragment DAG of the plan.
+ * A fragment starts once all of its parents have completed, so independent fragments execute
+ * concurrently, on up to max_concurrency threads (the calling thread being one of them).
+ *
+ * With a max_concurrency of 1, fragments run one after the other in topological order.
+ */
+class FragmentExecutor {
+ public:
+  using ExecuteFragmentFn = std::function<Status(int64_t fragment_id)>;
+  // Asks the fragments that are still running to finish early.
+  using StopFragmentsFn = std::function<void()>;
+
+  FragmentExecutor(const plan::DAG& dag, int max_concurrency, StopFragmentsFn stop_fn = nullptr)
+      : dag_(dag), max_concurrency_(std::max(max_concurrency, 1)), stop_fn_(std::move(stop_fn)) {}
+
+  /**
+   * Calls execute_fn for every fragment of the DAG, and blocks until they have all returned.
+   * After the first error, no new fragments are started and stop_fn is called, so that the
+   * fragments already running end early. Those are waited for, and the first error is returned.
+   */
+  Status Execute(const ExecuteFragmentFn& execute_fn);
+
+ private:
+  const plan::DAG& dag_;
+  const int max_concurrency_;
+  const StopFragmentsFn stop_fn_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
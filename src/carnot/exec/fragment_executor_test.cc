@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fragment_executor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using ::testing::ElementsAreArray;
+using ::testing::UnorderedElementsAre;
+
+class FragmentExecutorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dag_.AddNode(5);
+    dag_.AddNode(8);
+    dag_.AddNode(3);
+    dag_.AddNode(6);
+    dag_.AddNode(20);
+
+    dag_.AddEdge(5, 8);
+    dag_.AddEdge(5, 3);
+    dag_.AddEdge(8, 3);
+    dag_.AddEdge(3, 6);
+  }
+
+  plan::DAG dag_;
+};
+
+TEST_F(FragmentExecutorTest, SerialExecutionFollowsTopologicalOrder) {
+  std::vector<int64_t> executed;
+  ASSERT_OK(FragmentExecutor(dag_, 1).Execute([&](int64_t id) {
+    executed.push_back(id);
+    return Status::OK();
+  }));
+  EXPECT_THAT(executed, ElementsAreArray(dag_.TopologicalSort()));
+}
+
+TEST_F(FragmentExecutorTest, FragmentsStartAfterTheirParents) {
+  std::mutex mu;
+  std::vector<int64_t> started;
+  std::vector<int64_t> finished;
+
+  ASSERT_OK(FragmentExecutor(dag_, 4).Execute([&](int64_t id) {
+    {
+      std::lock_guard<std::mutex> lock(mu);
+      for (int64_t parent : dag_.ParentsOf(id)) {
+        EXPECT_NE(std::find(finished.begin(), finished.end(), parent), finished.end())
+            << absl::Substitute("Fragment $0 started before its parent $1 finished.", id, parent);
+      }
+      started.push_back(id);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::lock_guard<std::mutex> lock(mu);
+    finished.push_back(id);
+    return Status::OK();
+  }));
+  EXPECT_THAT(finished, UnorderedElementsAre(5, 8, 3, 6, 20));
+}
+
+TEST_F(FragmentExecutorTest, IndependentFragmentsRunConcurrently) {
+  plan::DAG dag;
+  dag.AddNode(1);
+  dag.AddNode(2);
+  dag.AddNode(3);
+
+  // Every fragment waits for all of them to have started, which only completes if they run
+  // concurrently.
+  std::mutex mu;
+  std::condition_variable cv;
+  int num_started = 0;
+  ASSERT_OK(FragmentExecutor(dag, 3).Execute([&](int64_t) {
+    std::unique_lock<std::mutex> lock(mu);
+    ++num_started;
+    cv.notify_all();
+    if (!cv.wait_for(lock, std::chrono::seconds(10), [&] { return num_started == 3; })) {
+      return error::DeadlineExceeded("Fragments did not run concurrently.");
+    }
+    return Status::OK();
+  }));
+}
+
+TEST_F(FragmentExecutorTest, ErrorStopsDependentFragments) {
+  std::vector<int64_t> executed;
+  Status s = FragmentExecutor(dag_, 1).Execute([&](int64_t id) {
+    executed.push_back(id);
+    if (id == 8) {
+      return error::Internal("Fragment $0 failed.", id);
+    }
+    return Status::OK();
+  });
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ(s.msg(), "Fragment 8 failed.");
+  EXPECT_THAT(executed, ::testing::Not(::testing::Contains(3)));
+  EXPECT_THAT(executed, ::testing::Not(::testing::Contains(6)));
+}
+
+TEST_F(FragmentExecutorTest, ErrorStopsRunningFragments) {
+  plan::DAG dag;
+  dag.AddNode(1);
+  dag.AddNode(2);
+
+  // Fragment 1 runs until it is stopped, and fragment 2 fails once fragment 1 has started.
+  std::mutex mu;
+  std::condition_variable cv;
+  bool started = false;
+  bool stopped = false;
+  int num_stops = 0;
+  auto stop_fn = [&] {
+    std::lock_guard<std::mutex> lock(mu);
+    stopped = true;
+    ++num_stops;
+    cv.notify_all();
+  };
+  Status s = FragmentExecutor(dag, 2, stop_fn).Execute([&](int64_t id) {
+    std::unique_lock<std::mutex> lock(mu);
+    if (id == 1) {
+      started = true;
+      cv.notify_all();
+      if (!cv.wait_for(lock, std::chrono::seconds(10), [&] { return stopped; })) {
+        return error::DeadlineExceeded("Fragment 1 was not stopped.");
+      }
+      return Status::OK();
+    }
+    if (!cv.wait_for(lock, std::chrono::seconds(10), [&] { return started; })) {
+      return error::DeadlineExceeded("Fragment 1 did not start.");
+    }
+    return error::Internal("Fragment $0 failed.", id);
+  });
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ(s.msg(), "Fragment 2 failed.");
+  EXPECT_EQ(num_stops, 1);
+}
+
+TEST_F(FragmentExecutorTest, EmptyDAG) {
+  plan::DAG dag;
+  EXPECT_OK(
+      FragmentExecutor(dag, 4).Execute([](int64_t) { return error::Internal("unexpected"); }));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/query_memory_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+void internal::QueryMemoryPoolCloser::operator()(QueryMemoryPool* pool) const { pool->Close(); }
+
+QueryMemoryPoolPtr QueryMemoryPool::Create(int64_t limit_bytes, arrow::MemoryPool* parent) {
+  return QueryMemoryPoolPtr(new QueryMemoryPool(limit_bytes, parent));
+}
+
+QueryMemoryPool::~QueryMemoryPool() {
+  DCHECK_EQ(free_list_bytes_, 0);
+  DCHECK_EQ(num_outstanding_buffers_, 0);
+}
+
+int QueryMemoryPool::SizeClass(int64_t size) {
+  DCHECK(IsPooled(size));
+  return std::max(kMinSizeClass, 64 - __builtin_clzll(static_cast<uint64_t>(size - 1)));
+}
+
+void QueryMemoryPool::AccountAllocation(int64_t bytes) {
+  bytes_allocated_ += bytes;
+  total_allocated_bytes_ += bytes;
+  ++num_outstanding_buffers_;
+  max_memory_ = std::max(max_memory_, bytes_allocated_);
+  if (limit_bytes_ > 0 && bytes_allocated_ > limit_bytes_) {
+    limit_exceeded_ = true;
+  }
+  if (current_node_bytes_ != nullptr) {
+    *current_node_bytes_ += bytes;
+  }
+}
+
+void QueryMemoryPool::AccountFree(int64_t bytes) {
+  bytes_allocated_ -= bytes;
+  --num_outstanding_buffers_;
+  DCHECK_GE(num_outstanding_buffers_, 0);
+}
+
+bool QueryMemoryPool::ShouldDelete() const { return closed_ && num_outstanding_buffers_ == 0; }
+
+arrow::Status QueryMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  if (size < 0) {
+    return arrow::Status::Invalid("Negative allocation size requested.");
+  }
+  if (!IsPooled(size)) {
+    arrow::Status s = parent_->Allocate(size, out);
+    if (!s.ok()) {
+      return s;
+    }
+    std::lock_guard<std::mutex> lock(lock_);
+    AccountAllocation(size);
+    return arrow::Status::OK();
+  }
+
+  const int size_class = SizeClass(size);
+  const int64_t class_bytes = int64_t{1} << size_class;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto& free_list = free_lists_[size_class - kMinSizeClass];
+    if (!free_list.empty()) {
+      *out = free_list.back();
+      free_list.pop_back();
+      free_list_bytes_ -= class_bytes;
+      recycled_bytes_ += class_bytes;
+      AccountAllocation(class_bytes);
+      return arrow::Status::OK();
+    }
+  }
+  arrow::Status s = parent_->Allocate(class_bytes, out);
+  if (!s.ok()) {
+    return s;
+  }
+  std::lock_guard<std::mutex> lock(lock_);
+  AccountAllocation(class_bytes);
+  return arrow::Status::OK();
+}
+
+arrow::Status QueryMemoryPool::Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) {
+  if (new_size < 0) {
+    return arrow::Status::Invalid("Negative reallocation size requested.");
+  }
+  // The rounded up buffer already has room for the new size.
+  if (IsPooled(old_size) && IsPooled(new_size) && SizeClass(old_size) == SizeClass(new_size)) {
+    return arrow::Status::OK();
+  }
+  if (old_size > kMaxPooledBytes && new_size > kMaxPooledBytes) {
+    arrow::Status s = parent_->Reallocate(old_size, new_size, ptr);
+    if (!s.ok()) {
+      return s;
+    }
+    std::lock_guard<std::mutex> lock(lock_);
+    AccountFree(old_size);
+    AccountAllocation(new_size);
+    return arrow::Status::OK();
+  }
+
+  uint8_t* new_buffer = nullptr;
+  arrow::Status s = Allocate(new_size, &new_buffer);
+  if (!s.ok()) {
+    return s;
+  }
+  std::memcpy(new_buffer, *ptr, std::min(old_size, new_size));
+  Free(*ptr, old_size);
+  *ptr = new_buffer;
+  return arrow::Status::OK();
+}
+
+void QueryMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  // Once the buffer is accounted as freed, another thread freeing the last buffer of a closed pool
+  // can delete it, so members must not be accessed after the lock is released.
+  arrow::MemoryPool* parent = parent_;
+  bool should_delete = false;
+  if (!IsPooled(size)) {
+    parent->Free(buffer, size);
+    std::lock_guard<std::mutex> lock(lock_);
+    AccountFree(size);
+    should_delete = ShouldDelete();
+  } else {
+    const int size_class = SizeClass(size);
+    const int64_t class_bytes = int64_t{1} << size_class;
+    bool recycle = false;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      AccountFree(class_bytes);
+      recycle = !closed_ && free_list_bytes_ + class_bytes <= kMaxRecycledBytes;
+      if (recycle) {
+        free_lists_[size_class - kMinSizeClass].push_back(buffer);
+        free_list_bytes_ += class_bytes;
+      }
+      should_delete = ShouldDelete();
+    }
+    if (!recycle) {
+      parent->Free(buffer, class_bytes);
+    }
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+void QueryMemoryPool::TrackRetainedBytes(int64_t delta_bytes) {
+  std::lock_guard<std::mutex> lock(lock_);
+  bytes_allocated_ += delta_bytes;
+  if (delta_bytes <= 0) {
+    return;
+  }
+  max_memory_ = std::max(max_memory_, bytes_allocated_);
+  if (limit_bytes_ > 0 && bytes_allocated_ > limit_bytes_) {
+    limit_exceeded_ = true;
+  }
+  if (current_node_bytes_ != nullptr) {
+    *current_node_bytes_ += delta_bytes;
+  }
+}
+
+void QueryMemoryPool::Close() {
+  // As in Free(), the pool can be deleted by another thread as soon as it is closed and the lock
+  // is released.
+  arrow::MemoryPool* parent = parent_;
+  std::vector<std::pair<uint8_t*, int64_t>> to_free;
+  bool should_delete = false;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    closed_ = true;
+    for (size_t i = 0; i < free_lists_.size(); ++i) {
+      const int64_t class_bytes = int64_t{1} << (kMinSizeClass + i);
+      for (uint8_t* buffer : free_lists_[i]) {
+        to_free.emplace_back(buffer, class_bytes);
+      }
+      free_lists_[i].clear();
+    }
+    free_list_bytes_ = 0;
+    should_delete = ShouldDelete();
+  }
+  for (const auto& [buffer, size] : to_free) {
+    parent->Free(buffer, size);
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+int64_t QueryMemoryPool::bytes_allocated() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return bytes_allocated_;
+}
+
+int64_t QueryMemoryPool::max_memory() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return max_memory_;
+}
+
+bool QueryMemoryPool::limit_exceeded() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return limit_exceeded_;
+}
+
+int64_t QueryMemoryPool::total_allocated_bytes() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return total_allocated_bytes_;
+}
+
+int64_t QueryMemoryPool::recycled_bytes() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return recycled_bytes_;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
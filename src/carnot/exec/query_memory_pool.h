@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+class QueryMemoryPool;
+
+namespace internal {
+struct QueryMemoryPoolCloser {
+  void operator()(QueryMemoryPool* pool) const;
+};
+}  // namespace internal
+
+using QueryMemoryPoolPtr = std::unique_ptr<QueryMemoryPool, internal::QueryMemoryPoolCloser>;
+
+/**
+ * QueryMemoryPool is the arrow::MemoryPool that the exec nodes of a single query allocate their
+ * arrow buffers from.
+ *
+ * Allocations of up to kMaxPooledBytes are rounded up to a power of two, and the buffers freed by
+ * one row batch are recycled for the next ones instead of going back to the parent pool. Growing a
+ * buffer within its rounded up size doesn't need to copy it.
+ *
+ * The pool keeps track of the bytes in use by the query, and of the bytes allocated by each exec
+ * node (see NodeScope). Once the bytes in use go over the limit, limit_exceeded() is set and the
+ * query is expected to cancel itself at the next row batch boundary. Allocations themselves never
+ * fail because of the limit, since several allocation paths in the exec nodes can't handle that.
+ *
+ * Row batches produced by a query can outlive it (e.g. the ones a memory sink writes to the table
+ * store), so the pool is closed rather than destroyed when the query is done, and only deletes
+ * itself once its last buffer has been freed.
+ */
+class QueryMemoryPool : public arrow::MemoryPool {
+ public:
+  // Allocations of up to this size are rounded up to a power of two and recycled.
+  static constexpr int64_t kMaxPooledBytes = 1 << 20;
+  // The total size of the freed buffers kept for reuse. Anything beyond that is returned to the
+  // parent pool.
+  static constexpr int64_t kMaxRecycledBytes = 16 << 20;
+
+  /**
+   * @param limit_bytes the number of bytes in use above which limit_exceeded() is set. 0 means
+   * unlimited.
+   * @param parent the pool to allocate from.
+   */
+  static QueryMemoryPoolPtr Create(int64_t limit_bytes,
+                                   arrow::MemoryPool* parent = arrow::default_memory_pool());
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+  void Free(uint8_t* buffer, int64_t size) override;
+
+  // The bytes in use by the query: its live arrow buffers and the retained bytes tracked by its
+  // exec nodes.
+  int64_t bytes_allocated() const override;
+  // The peak of bytes_allocated().
+  int64_t max_memory() const override;
+  std::string backend_name() const override { return "query"; }
+
+  /**
+   * Accounts for memory that an exec node holds on to beyond its own allocations, e.g. the row
+   * batches buffered by a join. delta_bytes is negative when the memory is released.
+   */
+  void TrackRetainedBytes(int64_t delta_bytes);
+
+  bool limit_exceeded() const;
+  int64_t limit_bytes() const { return limit_bytes_; }
+  // Total bytes requested from the pool, including recycled buffers.
+  int64_t total_allocated_bytes() const;
+  // Total bytes served from recycled buffers.
+  int64_t recycled_bytes() const;
+
+  /**
+   * While in scope, attributes the bytes allocated on this thread to the given counter, which
+   * usually belongs to the exec node being executed. Scopes nest, so that the bytes allocated
+   * by the children of a node are attributed to them.
+   */
+  class NodeScope : public NotCopyable {
+   public:
+    explicit NodeScope(int64_t* node_bytes_allocated) : prev_(current_node_bytes_) {
+      current_node_bytes_ = node_bytes_allocated;
+    }
+    ~NodeScope() { current_node_bytes_ = prev_; }
+
+   private:
+    int64_t* prev_;
+  };
+
+ private:
+  friend struct internal::QueryMemoryPoolCloser;
+
+  static constexpr int kMinSizeClass = 6;
+  static constexpr int kMaxSizeClass = 20;
+  static_assert(int64_t{1} << kMaxSizeClass == kMaxPooledBytes);
+
+  QueryMemoryPool(int64_t limit_bytes, arrow::MemoryPool* parent)
+      : parent_(parent), limit_bytes_(limit_bytes) {}
+  ~QueryMemoryPool() override;
+
+  // Returns the buffers kept for reuse to the parent pool, and deletes the pool once it has no
+  // outstanding buffers.
+  void Close();
+
+  void AccountAllocation(int64_t bytes);
+  void AccountFree(int64_t bytes);
+  // Returns whether the pool should delete itself.
+  bool ShouldDelete() const;
+
+  static bool IsPooled(int64_t size) { return size > 0 && size <= kMaxPooledBytes; }
+  // Returns log2 of the rounded up size of a pooled allocation.
+  static int SizeClass(int64_t size);
+
+  static thread_local inline int64_t* current_node_bytes_ = nullptr;
+
+  arrow::MemoryPool* const parent_;
+  const int64_t limit_bytes_;
+
+  mutable std::mutex lock_;
+  // Freed buffers, by size class.
+  std::array<std::vector<uint8_t*>, kMaxSizeClass - kMinSizeClass + 1> free_lists_;
+  int64_t free_list_bytes_ = 0;
+  int64_t bytes_allocated_ = 0;
+  int64_t max_memory_ = 0;
+  int64_t total_allocated_bytes_ = 0;
+  int64_t recycled_bytes_ = 0;
+  int64_t num_outstanding_buffers_ = 0;
+  bool limit_exceeded_ = false;
+  bool closed_ = false;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
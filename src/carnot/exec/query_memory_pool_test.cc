@@ -0,0 +1,205 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/query_memory_pool.h"
+
+#include <arrow/memory_pool.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+class QueryMemoryPoolTest : public ::testing::Test {
+ protected:
+  arrow::ProxyMemoryPool parent_{arrow::default_memory_pool()};
+};
+
+TEST_F(QueryMemoryPoolTest, RecyclesFreedBuffers) {
+  auto pool = QueryMemoryPool::Create(0, &parent_);
+
+  uint8_t* buffer = nullptr;
+  ASSERT_TRUE(pool->Allocate(100, &buffer).ok());
+  // Rounded up to the next power of two.
+  EXPECT_EQ(128, pool->bytes_allocated());
+  EXPECT_EQ(128, parent_.bytes_allocated());
+  pool->Free(buffer, 100);
+  EXPECT_EQ(0, pool->bytes_allocated());
+  // Kept for reuse rather than returned to the parent.
+  EXPECT_EQ(128, parent_.bytes_allocated());
+
+  uint8_t* reused = nullptr;
+  ASSERT_TRUE(pool->Allocate(120, &reused).ok());
+  EXPECT_EQ(buffer, reused);
+  EXPECT_EQ(128, pool->recycled_bytes());
+  EXPECT_EQ(256, pool->total_allocated_bytes());
+  EXPECT_EQ(128, parent_.bytes_allocated());
+  pool->Free(reused, 120);
+
+  pool.reset();
+  EXPECT_EQ(0, parent_.bytes_allocated());
+}
+
+TEST_F(QueryMemoryPoolTest, LargeAllocationsBypassThePool) {
+  auto pool = QueryMemoryPool::Create(0, &parent_);
+
+  const int64_t size = QueryMemoryPool::kMaxPooledBytes + 1;
+  uint8_t* buffer = nullptr;
+  ASSERT_TRUE(pool->Allocate(size, &buffer).ok());
+  EXPECT_EQ(size, pool->bytes_allocated());
+  ASSERT_TRUE(pool->Reallocate(size, 2 * size, &buffer).ok());
+  EXPECT_EQ(2 * size, pool->bytes_allocated());
+  EXPECT_EQ(2 * size, pool->max_memory());
+  pool->Free(buffer, 2 * size);
+  EXPECT_EQ(0, pool->bytes_allocated());
+  EXPECT_EQ(0, parent_.bytes_allocated());
+}
+
+TEST_F(QueryMemoryPoolTest, ReallocateWithinSizeClassIsInPlace) {
+  auto pool = QueryMemoryPool::Create(0, &parent_);
+
+  uint8_t* buffer = nullptr;
+  ASSERT_TRUE(pool->Allocate(70, &buffer).ok());
+  buffer[0] = 42;
+  uint8_t* original = buffer;
+  ASSERT_TRUE(pool->Reallocate(70, 128, &buffer).ok());
+  EXPECT_EQ(original, buffer);
+  EXPECT_EQ(128, pool->bytes_allocated());
+
+  ASSERT_TRUE(pool->Reallocate(128, 1000, &buffer).ok());
+  EXPECT_EQ(42, buffer[0]);
+  EXPECT_EQ(1024, pool->bytes_allocated());
+  pool->Free(buffer, 1000);
+}
+
+TEST_F(QueryMemoryPoolTest, LimitExceeded) {
+  auto pool = QueryMemoryPool::Create(1024, &parent_);
+
+  uint8_t* buffer = nullptr;
+  ASSERT_TRUE(pool->Allocate(1024, &buffer).ok());
+  EXPECT_FALSE(pool->limit_exceeded());
+
+  pool->TrackRetainedBytes(1);
+  EXPECT_TRUE(pool->limit_exceeded());
+  pool->TrackRetainedBytes(-1);
+  // The limit stays exceeded, so that the query is cancelled even if it freed memory since.
+  EXPECT_TRUE(pool->limit_exceeded());
+  pool->Free(buffer, 1024);
+}
+
+TEST_F(QueryMemoryPoolTest, NodeScopeAttributesAllocations) {
+  auto pool = QueryMemoryPool::Create(0, &parent_);
+
+  int64_t parent_node_bytes = 0;
+  int64_t child_node_bytes = 0;
+  uint8_t* a = nullptr;
+  uint8_t* b = nullptr;
+  uint8_t* c = nullptr;
+  {
+    QueryMemoryPool::NodeScope parent_scope(&parent_node_bytes);
+    ASSERT_TRUE(pool->Allocate(64, &a).ok());
+    {
+      QueryMemoryPool::NodeScope child_scope(&child_node_bytes);
+      ASSERT_TRUE(pool->Allocate(256, &b).ok());
+    }
+    pool->TrackRetainedBytes(10);
+  }
+  ASSERT_TRUE(pool->Allocate(64, &c).ok());
+
+  EXPECT_EQ(74, parent_node_bytes);
+  EXPECT_EQ(256, child_node_bytes);
+
+  pool->TrackRetainedBytes(-10);
+  pool->Free(a, 64);
+  pool->Free(b, 256);
+  pool->Free(c, 64);
+}
+
+TEST_F(QueryMemoryPoolTest, OutlivesItsOwnerUntilLastBufferIsFreed) {
+  auto pool = QueryMemoryPool::Create(0, &parent_);
+  QueryMemoryPool* raw_pool = pool.get();
+
+  uint8_t* cached = nullptr;
+  uint8_t* outstanding = nullptr;
+  ASSERT_TRUE(pool->Allocate(64, &cached).ok());
+  ASSERT_TRUE(pool->Allocate(4096, &outstanding).ok());
+  pool->Free(cached, 64);
+
+  // Closing the pool returns its cached buffers, but not the outstanding one.
+  pool.reset();
+  EXPECT_EQ(4096, parent_.bytes_allocated());
+
+  // The buffer is still usable and is returned to the parent (and the pool deleted) once freed.
+  outstanding[4095] = 1;
+  raw_pool->Free(outstanding, 4096);
+  EXPECT_EQ(0, parent_.bytes_allocated());
+}
+
+// Row batches that outlive a query are freed by other threads (e.g. table store compaction),
+// possibly while the query closes its pool. Whichever thread frees the last buffer deletes the
+// pool, and none of the others may touch it after that. Run under TSAN/ASAN to catch regressions.
+TEST_F(QueryMemoryPoolTest, ConcurrentFreesRaceWithClose) {
+  constexpr int kNumThreads = 4;
+  constexpr int kBuffersPerThread = 64;
+  constexpr int kIterations = 200;
+
+  for (int iter = 0; iter < kIterations; ++iter) {
+    auto pool = QueryMemoryPool::Create(0, &parent_);
+
+    std::vector<std::vector<std::pair<uint8_t*, int64_t>>> buffers(kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      for (int i = 0; i < kBuffersPerThread; ++i) {
+        // Mix recycled and unpooled sizes.
+        const int64_t size = (i % 8 == 0) ? QueryMemoryPool::kMaxPooledBytes + 1 : 64 << (i % 5);
+        uint8_t* buffer = nullptr;
+        ASSERT_TRUE(pool->Allocate(size, &buffer).ok());
+        buffers[t].emplace_back(buffer, size);
+      }
+    }
+    // Leave some buffers in the free lists, so that Close() has some to return to the parent.
+    uint8_t* cached = nullptr;
+    ASSERT_TRUE(pool->Allocate(128, &cached).ok());
+    pool->Free(cached, 128);
+
+    QueryMemoryPool* raw_pool = pool.get();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([raw_pool, &thread_buffers = buffers[t]] {
+        for (const auto& [buffer, size] : thread_buffers) {
+          raw_pool->Free(buffer, size);
+        }
+      });
+    }
+    pool.reset();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(0, parent_.bytes_allocated());
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
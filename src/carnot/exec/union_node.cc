@@ -56,16 +56,16 @@ Status UnionNode::InitImpl(const plan::Operator& plan_node) {
   return Status::OK();
 }
 
-Status UnionNode::InitializeColumnBuilders() {
+Status UnionNode::InitializeColumnBuilders(ExecState* exec_state) {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     column_builders_[i] =
-        MakeArrowBuilder(output_descriptor_->type(i), arrow::default_memory_pool());
+        MakeArrowBuilder(output_descriptor_->type(i), exec_state->exec_mem_pool());
     PX_RETURN_IF_ERROR(column_builders_[i]->Reserve(output_rows_per_batch_));
   }
   return Status::OK();
 }
 
-Status UnionNode::PrepareImpl(ExecState*) {
+Status UnionNode::PrepareImpl(ExecState* exec_state) {
   size_t num_output_cols = output_descriptor_->size();
 
   flushed_parent_eoses_.resize(num_parents_);
@@ -78,7 +78,7 @@ Status UnionNode::PrepareImpl(ExecState*) {
     data_columns_.resize(num_parents_, std::vector<arrow::Array*>(num_output_cols));
 
     column_builders_.resize(num_output_cols);
-    PX_RETURN_IF_ERROR(InitializeColumnBuilders());
+    PX_RETURN_IF_ERROR(InitializeColumnBuilders(exec_state));
   }
 
   return Status::OK();
@@ -164,7 +164,7 @@ Status UnionNode::FlushBatch(ExecState* exec_state) {
   bool eos = InputsComplete();
   PX_ASSIGN_OR_RETURN(auto rb, RowBatch::FromColumnBuilders(*output_descriptor_, /*eow*/ eos,
                                                             /*eos*/ eos, &column_builders_));
-  PX_RETURN_IF_ERROR(InitializeColumnBuilders());
+  PX_RETURN_IF_ERROR(InitializeColumnBuilders(exec_state));
   last_data_flush_time_ = std::chrono::system_clock::now();
   return SendRowBatchToChildren(exec_state, *rb);
 }
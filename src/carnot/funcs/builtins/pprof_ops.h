@@ -21,6 +21,7 @@
 #include <absl/container/flat_hash_map.h>
 
 #include <string>
+#include <utility>
 
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/udf.h"
@@ -73,19 +74,7 @@ class CreatePProfRowAggregate : public udf::UDA {
     }
   }
 
-  StringValue Serialize(FunctionContext*) {
-    if (multiple_profiler_periods_found_) {
-      return "Protobuf `SerializeToString` failed, multiple profiling periods found.";
-    }
-
-    const auto pprof = px::shared::CreatePProfProfile(profiler_period_ms_, histo_);
-    std::string output;
-    const bool ok = pprof.SerializeToString(&output);
-    if (!ok) {
-      return "Protobuf `SerializeToString` failed.";
-    }
-    return output;
-  }
+  StringValue Serialize(FunctionContext*) { return SerializeHisto(histo_); }
 
   Status Deserialize(FunctionContext*, const StringValue& pprof_str) {
     // Parse serialized input a pprof proto object.
@@ -109,6 +98,20 @@ class CreatePProfRowAggregate : public udf::UDA {
   StringValue Finalize(FunctionContext* ctx) { return Serialize(ctx); }
 
  protected:
+  StringValue SerializeHisto(const absl::flat_hash_map<std::string, uint64_t>& histo) const {
+    if (multiple_profiler_periods_found_) {
+      return "Protobuf `SerializeToString` failed, multiple profiling periods found.";
+    }
+
+    const auto pprof = px::shared::CreatePProfProfile(profiler_period_ms_, histo);
+    std::string output;
+    const bool ok = pprof.SerializeToString(&output);
+    if (!ok) {
+      return "Protobuf `SerializeToString` failed.";
+    }
+    return output;
+  }
+
   void UpdateOrCheckSamplingPeriod(const int32_t profiler_period_ms) {
     // Initialize profiler_period_ms_ if needed.
     if (profiler_period_ms_ == -1) {
@@ -126,6 +129,115 @@ class CreatePProfRowAggregate : public udf::UDA {
   bool multiple_profiler_periods_found_ = false;
 };
 
+/**
+ * Like CreatePProfRowAggregate, but aggregates on the integer stack trace ID instead of on the
+ * stack trace string. This is intended for use with interned stack traces, where the samples in
+ * stack_traces.beta carry only an ID, and the string is joined in from stack_trace_dict.beta:
+ * each distinct stack trace string is stored only once per (upid, stack_trace_id), and per-row
+ * work is an integer hash instead of a string hash.
+ */
+class CreatePProfFromIDsRowAggregate : public CreatePProfRowAggregate {
+ public:
+  static constexpr std::string_view kUnknownStackTrace = "<unknown stack trace>";
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Convert interned perf profiling data to pprof format.")
+        .Details(
+            "Converts perf profiling stack trace IDs into pprof format. Stack trace IDs are only "
+            "unique per UPID, so the UPID must be provided as well. The stack trace string for an "
+            "ID only needs to be present on one of the rows with that ID.")
+        .Example(
+            R"doc(
+        | samples = px.DataFrame(table='stack_traces.beta', start_time='-1m')
+        | samples.asid = px.asid()
+        | dict = px.DataFrame(table='stack_trace_dict.beta', start_time='-10m')
+        | dict = dict.groupby(['upid', 'stack_trace_id']).agg(stack_trace=('stack_trace', px.any))
+        | df = samples.merge(dict, how='left', left_on=['upid', 'stack_trace_id'],
+        |                    right_on=['upid', 'stack_trace_id'], suffixes=['', '_dict'])
+        | sample_period = px.GetProfilerSamplingPeriodMS()
+        | df = df.merge(sample_period, how='inner', left_on=['asid'], right_on=['asid'])
+        | df = df.groupby(['profiler_sampling_period_ms']).agg(
+        |     pprof=('upid', 'stack_trace_id', 'stack_trace_dict', 'count',
+        |            'profiler_sampling_period_ms', px.pprof_from_ids))
+        )doc")
+        .Arg("upid", "UPID of the sampled process.")
+        .Arg("stack_trace_id", "Stack trace ID, unique within the UPID.")
+        .Arg("stack_trace", "Stack trace string, or empty if not known on this row.")
+        .Arg("count", "Count of the stack trace.")
+        .Arg("profiler_period_ms", "Profiler stack trace sampling period in ms.")
+        .Returns("A single row that aggregates all the stack traces and counts into pprof format.");
+  }
+
+  void Update(FunctionContext*, const UInt128Value upid, const Int64Value stack_trace_id,
+              const StringValue stack_trace, const Int64Value count,
+              const Int64Value profiler_period_ms) {
+    UpdateOrCheckSamplingPeriod(profiler_period_ms.val);
+
+    auto& entry = id_histo_[StackTraceKey{upid.val, stack_trace_id.val}];
+    if (entry.stack_trace.empty() && !stack_trace.empty()) {
+      entry.stack_trace = stack_trace;
+    }
+    entry.count += count.val;
+  }
+
+  void Merge(FunctionContext*, const CreatePProfFromIDsRowAggregate& other) {
+    UpdateOrCheckSamplingPeriod(other.profiler_period_ms_);
+
+    for (const auto& [key, other_entry] : other.id_histo_) {
+      auto& entry = id_histo_[key];
+      if (entry.stack_trace.empty()) {
+        entry.stack_trace = other_entry.stack_trace;
+      }
+      entry.count += other_entry.count;
+    }
+    for (const auto& [stack_trace, count] : other.histo_) {
+      histo_[stack_trace] += count;
+    }
+  }
+
+  StringValue Serialize(FunctionContext*) {
+    // Stack trace IDs are not stable across PEMs, so partial aggregates are exchanged as pprof
+    // (keyed by stack trace string), and merged through Deserialize().
+    absl::flat_hash_map<std::string, uint64_t> histo = histo_;
+    for (const auto& [key, entry] : id_histo_) {
+      if (entry.stack_trace.empty()) {
+        histo[std::string(kUnknownStackTrace)] += entry.count;
+      } else {
+        histo[entry.stack_trace] += entry.count;
+      }
+    }
+    return SerializeHisto(histo);
+  }
+
+  Status Deserialize(FunctionContext* ctx, const StringValue& pprof_str) {
+    return CreatePProfRowAggregate::Deserialize(ctx, pprof_str);
+  }
+
+  StringValue Finalize(FunctionContext* ctx) { return Serialize(ctx); }
+
+ private:
+  struct StackTraceKey {
+    absl::uint128 upid;
+    int64_t stack_trace_id;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const StackTraceKey& k) {
+      return H::combine(std::move(h), k.upid, k.stack_trace_id);
+    }
+
+    bool operator==(const StackTraceKey& other) const {
+      return upid == other.upid && stack_trace_id == other.stack_trace_id;
+    }
+  };
+
+  struct StackTraceEntry {
+    std::string stack_trace;
+    uint64_t count = 0;
+  };
+
+  absl::flat_hash_map<StackTraceKey, StackTraceEntry> id_histo_;
+};
+
 void RegisterPProfOpsOrDie(udf::Registry* registry);
 
 }  // namespace builtins
@@ -153,6 +153,57 @@ TEST(PProf, uda_fails_with_multiple_sample_periods) {
   EXPECT_FALSE(pprof.ParseFromString(result));
 }
 
+TEST(PProf, interned_profiling_rows_to_pprof_test) {
+  const types::UInt128Value upid_a(1, 100);
+  const types::UInt128Value upid_b(2, 100);
+
+  // Stack trace IDs are only unique per UPID: ID 1 maps to different stacks in upid_a & upid_b.
+  // The stack trace string is only present on some of the rows, as with a left join against
+  // the dictionary table.
+  auto pprof_uda_tester = udf::UDATester<CreatePProfFromIDsRowAggregate>();
+  pprof_uda_tester.ForInput(upid_a, 1, "foo;bar;baz", 1, profiler_period_ms);
+  pprof_uda_tester.ForInput(upid_a, 1, "", 2, profiler_period_ms);
+  pprof_uda_tester.ForInput(upid_a, 2, "foo;bar", 3, profiler_period_ms);
+  pprof_uda_tester.ForInput(upid_b, 1, "", 4, profiler_period_ms);
+  pprof_uda_tester.ForInput(upid_b, 1, "main;compute", 5, profiler_period_ms);
+  pprof_uda_tester.ForInput(upid_b, 2, "", 6, profiler_period_ms);
+
+  const absl::flat_hash_map<std::string, uint64_t> expected = {
+      {"foo;bar;baz", 1 + 2},
+      {"foo;bar", 3},
+      {"main;compute", 4 + 5},
+      {std::string(CreatePProfFromIDsRowAggregate::kUnknownStackTrace), 6},
+  };
+
+  PProfProfile pprof;
+  EXPECT_TRUE(pprof.ParseFromString(pprof_uda_tester.Result()));
+  EXPECT_EQ(DeserializePProfProfile(pprof), expected);
+}
+
+TEST(PProf, interned_pprof_merge_test) {
+  const types::UInt128Value upid(1, 100);
+
+  auto pprof_uda_tester_a = udf::UDATester<CreatePProfFromIDsRowAggregate>();
+  auto pprof_uda_tester_b = udf::UDATester<CreatePProfFromIDsRowAggregate>();
+  auto pprof_uda_tester_merge = udf::UDATester<CreatePProfFromIDsRowAggregate>();
+
+  pprof_uda_tester_a.ForInput(upid, 1, "foo;bar;baz", 1, profiler_period_ms);
+  pprof_uda_tester_a.ForInput(upid, 2, "foo;bar;qux", 2, profiler_period_ms);
+  pprof_uda_tester_b.ForInput(upid, 1, "foo;bar;baz", 10, profiler_period_ms);
+
+  EXPECT_OK(pprof_uda_tester_merge.Deserialize(pprof_uda_tester_a.Serialize()));
+  EXPECT_OK(pprof_uda_tester_merge.Deserialize(pprof_uda_tester_b.Serialize()));
+
+  const absl::flat_hash_map<std::string, uint64_t> expected = {
+      {"foo;bar;baz", 11},
+      {"foo;bar;qux", 2},
+  };
+
+  PProfProfile pprof;
+  EXPECT_TRUE(pprof.ParseFromString(pprof_uda_tester_merge.Result()));
+  EXPECT_EQ(DeserializePProfProfile(pprof), expected);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <google/protobuf/text_format.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sole.hpp>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/funcs/funcs.h"
+#include "src/carnot/udf/udf.h"
+#include "src/common/base/base.h"
+#include "src/common/benchmark/benchmark.h"
+#include "src/datagen/datagen.h"
+#include "src/table_store/test_utils.h"
+
+DECLARE_int32(carnot_max_concurrent_fragments);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// A plan fragment that streams the whole test table to its own output table.
+constexpr char kFragmentTmpl[] = R"proto(
+id: $0
+dag {
+  nodes {
+    id: 1
+    sorted_children: 2
+  }
+  nodes {
+    id: 2
+    sorted_parents: 1
+  }
+}
+nodes {
+  id: 1
+  op {
+    op_type: MEMORY_SOURCE_OPERATOR
+    mem_source_op {
+      name: "test_table"
+      column_idxs: 0
+      column_types: INT64
+      column_names: "col0"
+      column_idxs: 1
+      column_types: FLOAT64
+      column_names: "col1"
+    }
+  }
+}
+nodes {
+  id: 2
+  op {
+    op_type: GRPC_SINK_OPERATOR
+    grpc_sink_op {
+      address: "result_addr"
+      output_table {
+        table_name: "out_table$0"
+        column_names: "col0"
+        column_names: "col1"
+        column_types: INT64
+        column_types: FLOAT64
+      }
+      connection_options {
+        ssl_targetname: "result_ssltarget"
+      }
+    }
+  }
+}
+)proto";
+
+planpb::Plan IndependentFragmentsPlan(int64_t num_fragments) {
+  planpb::Plan plan;
+  for (int64_t id = 1; id <= num_fragments; ++id) {
+    plan.mutable_dag()->add_nodes()->set_id(id);
+    CHECK(google::protobuf::TextFormat::MergeFromString(absl::Substitute(kFragmentTmpl, id),
+                                                        plan.add_nodes()))
+        << "Failed to parse proto";
+  }
+  return plan;
+}
+
+std::unique_ptr<Carnot> SetUpCarnot(std::shared_ptr<table_store::TableStore> table_store,
+                                    LocalGRPCResultSinkServer* server) {
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("default_registry");
+  funcs::RegisterFuncsOrDie(func_registry.get());
+  auto clients_config = std::make_unique<Carnot::ClientsConfig>(Carnot::ClientsConfig{
+      [server](const std::string& address, const std::string&) {
+        return server->StubGenerator(address);
+      },
+      [](grpc::ClientContext*) {},
+  });
+  auto server_config = std::make_unique<Carnot::ServerConfig>();
+  server_config->grpc_server_port = 0;
+
+  return px::carnot::Carnot::Create(sole::uuid4(), std::move(func_registry), table_store,
+                                    std::move(clients_config), std::move(server_config))
+      .ConsumeValueOrDie();
+}
+
+// Measures the wall-clock time of a plan made of state.range(0) independent fragments, with at
+// most state.range(1) of them executing at once.
+// NOLINTNEXTLINE : runtime/references.
+void BM_IndependentFragments(benchmark::State& state) {
+  const int64_t num_fragments = state.range(0);
+  FLAGS_carnot_max_concurrent_fragments = state.range(1);
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  auto server = LocalGRPCResultSinkServer();
+  auto carnot = SetUpCarnot(table_store, &server);
+  auto table = table_store::CreateTable(
+                   {types::DataType::INT64, types::DataType::FLOAT64},
+                   {datagen::DistributionType::kUniform, datagen::DistributionType::kUniform},
+                   /* rb_size */ 1024, /* num_batches */ 256, nullptr, nullptr)
+                   .ConsumeValueOrDie();
+  table_store->AddTable("test_table", table);
+
+  planpb::Plan plan = IndependentFragmentsPlan(num_fragments);
+  int64_t bytes_processed = 0;
+  for (auto _ : state) {
+    auto s = carnot->ExecutePlan(plan, sole::uuid4());
+    if (!s.ok()) {
+      LOG(FATAL) << "Multi-fragment benchmark plan did not execute successfully: " << s.msg();
+    }
+    bytes_processed += server.exec_stats().ConsumeValueOrDie().execution_stats().bytes_processed();
+    server.ResetQueryResults();
+  }
+
+  state.SetBytesProcessed(bytes_processed);
+}
+
+BENCHMARK(BM_IndependentFragments)
+    ->UseRealTime()
+    ->ArgNames({"fragments", "concurrency"})
+    ->ArgsProduct({{1, 4, 8}, {1, 2, 4}});
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
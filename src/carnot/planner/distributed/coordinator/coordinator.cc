@@ -40,8 +40,10 @@ namespace planner {
 namespace distributed {
 
 StatusOr<std::unique_ptr<Coordinator>> Coordinator::Create(
-    CompilerState* compiler_state, const distributedpb::DistributedState& distributed_state) {
+    CompilerState* compiler_state, const distributedpb::DistributedState& distributed_state,
+    AgentMetadataFilterCache* md_filter_cache) {
   std::unique_ptr<Coordinator> coordinator(new CoordinatorImpl());
+  coordinator->SetMetadataFilterCache(md_filter_cache);
   PX_RETURN_IF_ERROR(coordinator->Init(compiler_state, distributed_state));
   return coordinator;
 }
@@ -81,10 +83,10 @@ Status CoordinatorImpl::InitImpl(CompilerState* compiler_state,
 
 Status CoordinatorImpl::ProcessConfigImpl(const CarnotInfo& carnot_info) {
   if (carnot_info.has_data_store() && carnot_info.processes_data()) {
-    data_store_nodes_.push_back(carnot_info);
+    data_store_nodes_.push_back(&carnot_info);
   }
   if (carnot_info.processes_data() && carnot_info.accepts_remote_sources()) {
-    remote_processor_nodes_.push_back(carnot_info);
+    remote_processor_nodes_.push_back(&carnot_info);
   }
   return Status::OK();
 }
@@ -102,7 +104,7 @@ bool CoordinatorImpl::HasExecutableNodes(const IR* plan) {
 const distributedpb::CarnotInfo& CoordinatorImpl::GetRemoteProcessor() const {
   // TODO(philkuz) update this with a more sophisticated strategy in the future.
   DCHECK_GT(remote_processor_nodes_.size(), 0UL);
-  return remote_processor_nodes_[0];
+  return *remote_processor_nodes_[0];
 }
 
 /**
@@ -183,6 +185,7 @@ StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const
   PX_ASSIGN_OR_RETURN(std::unique_ptr<BlockingSplitPlan> split_plan,
                       splitter->SplitKelvinAndAgents(logical_plan));
   auto distributed_plan = std::make_unique<DistributedPlan>();
+  distributed_plan->SetMetadataFilterCache(md_filter_cache_);
   PX_ASSIGN_OR_RETURN(int64_t remote_node_id, distributed_plan->AddCarnot(GetRemoteProcessor()));
   // TODO(philkuz) Need to update the Blocking Split Plan to better represent what we expect.
   // TODO(philkuz) (PL-1469) Future support for grabbing data from multiple Kelvin nodes.
@@ -196,7 +199,7 @@ StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const
 
   std::vector<int64_t> source_node_ids;
   for (const auto& [i, data_store_info] : Enumerate(data_store_nodes_)) {
-    PX_ASSIGN_OR_RETURN(int64_t source_node_id, distributed_plan->AddCarnot(data_store_info));
+    PX_ASSIGN_OR_RETURN(int64_t source_node_id, distributed_plan->AddCarnot(*data_store_info));
     distributed_plan->AddEdge(source_node_id, remote_node_id);
     source_node_ids.push_back(source_node_id);
   }
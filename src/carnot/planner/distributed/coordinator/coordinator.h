@@ -48,7 +48,8 @@ class Coordinator : public NotCopyable {
  public:
   virtual ~Coordinator() = default;
   static StatusOr<std::unique_ptr<Coordinator>> Create(
-      CompilerState* compiler_state, const distributedpb::DistributedState& distributed_state);
+      CompilerState* compiler_state, const distributedpb::DistributedState& distributed_state,
+      AgentMetadataFilterCache* md_filter_cache = nullptr);
 
   /**
    * @brief Using the physical state and the current plan, assembles a proto Distributed Plan. This
@@ -61,6 +62,14 @@ class Coordinator : public NotCopyable {
   Status Init(CompilerState* compiler_state,
               const distributedpb::DistributedState& distributed_state);
 
+  /**
+   * @brief Sets the cache that the metadata filters of the agents are looked up in, so that they
+   * don't have to be decoded for every query.
+   */
+  void SetMetadataFilterCache(AgentMetadataFilterCache* md_filter_cache) {
+    md_filter_cache_ = md_filter_cache;
+  }
+
  protected:
   Status ProcessConfig(const CarnotInfo& carnot_info);
 
@@ -76,6 +85,8 @@ class Coordinator : public NotCopyable {
   virtual StatusOr<std::unique_ptr<DistributedPlan>> CoordinateImpl(const IR* logical_plan) = 0;
 
   virtual Status ProcessConfigImpl(const CarnotInfo& carnot_info) = 0;
+
+  AgentMetadataFilterCache* md_filter_cache_ = nullptr;
 };
 
 /**
@@ -94,10 +105,10 @@ class CoordinatorImpl : public Coordinator {
   const distributedpb::CarnotInfo& GetRemoteProcessor() const;
   bool HasExecutableNodes(const IR* plan);
 
-  // Nodes that have a source of data.
-  std::vector<CarnotInfo> data_store_nodes_;
-  // Nodes that remotely prcoess data.
-  std::vector<CarnotInfo> remote_processor_nodes_;
+  // Nodes that have a source of data. Points into the distributed state.
+  std::vector<const CarnotInfo*> data_store_nodes_;
+  // Nodes that remotely prcoess data. Points into the distributed state.
+  std::vector<const CarnotInfo*> remote_processor_nodes_;
   // The distributed state object.
   const distributedpb::DistributedState* distributed_state_ = nullptr;
   // The compiler state.
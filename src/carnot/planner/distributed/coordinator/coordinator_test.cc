@@ -276,6 +276,30 @@ TEST_F(CoordinatorTest, prune_agents_simple) {
   EXPECT_EQ(2, kelvin_sources.size());
 }
 
+// Tests that the agents are pruned the same way when their metadata filters come from the cache.
+TEST_F(CoordinatorTest, prune_agents_with_cached_metadata_filters) {
+  auto ps = ThreeAgentOneKelvinStateWithMetadataInfo();
+  AgentMetadataFilterCache md_filter_cache(10);
+  compiler::Compiler compiler;
+
+  for (int i = 0; i < 2; ++i) {
+    auto coordinator =
+        Coordinator::Create(compiler_state_.get(), ps, &md_filter_cache).ConsumeValueOrDie();
+    auto graph =
+        compiler.CompileToIR(kPruneAgentsSimple, compiler_state_.get()).ConsumeValueOrDie();
+    auto physical_plan = coordinator->Coordinate(graph.get()).ConsumeValueOrDie();
+
+    std::vector<std::string> qb_addrs;
+    for (int64_t carnot_id : physical_plan->dag().nodes()) {
+      qb_addrs.push_back(physical_plan->Get(carnot_id)->QueryBrokerAddress());
+    }
+    EXPECT_THAT(qb_addrs, UnorderedElementsAre("pem1", "pem2", "kelvin"));
+  }
+  // The three PEMs have metadata filters, which are decoded on the first query only.
+  EXPECT_EQ(md_filter_cache.misses(), 3);
+  EXPECT_EQ(md_filter_cache.hits(), 3);
+}
+
 constexpr char kPruneAgentsDoesNotExist[] = R"pxl(
 import px
 
@@ -125,26 +125,8 @@ class StringBloomFilterMatcher : public FilterExpressionMatcher {
     if (!md_filter->metadata_types().contains(md_type_)) {
       return true;
     }
-
-    // For cases like the following,
-    // df.ctx['service'] == '["pl/svc1", "pl/svc2"]',
-    // We would still like the expression to work.
-    // However, the metadata filters will only store individual services,
-    // not the JSON array. As a result, in the planner we will check for the
-    // presence for either service in the Carnot instance when pruning the plan.
-
-    rapidjson::Document doc;
-    doc.Parse(val_.c_str());
-    if (!doc.IsArray()) {
-      return md_filter->ContainsEntity(md_type_, val_);
-    }
-
-    for (rapidjson::SizeType i = 0; i < doc.Size(); ++i) {
-      if (!doc[i].IsString()) {
-        return false;
-      }
-      auto str = doc[i].GetString();
-      if (md_filter->ContainsEntity(md_type_, str)) {
+    for (const auto& probe : probes_) {
+      if (md_filter->ContainsEntity(probe)) {
         return true;
       }
     }
@@ -159,13 +141,37 @@ class StringBloomFilterMatcher : public FilterExpressionMatcher {
       val_idx = 1;
       md_idx = 0;
     }
-    val_ = static_cast<StringIR*>(func->args()[val_idx])->str();
+    const std::string& val = static_cast<StringIR*>(func->args()[val_idx])->str();
     md_type_ = static_cast<ExpressionIR*>(func->args()[md_idx])->annotations().metadata_type;
+
+    // The values are looked up in the filters of every agent, so they are parsed and hashed once
+    // here rather than for each agent.
+    probes_.clear();
+
+    // For cases like the following,
+    // df.ctx['service'] == '["pl/svc1", "pl/svc2"]',
+    // We would still like the expression to work.
+    // However, the metadata filters will only store individual services,
+    // not the JSON array. As a result, in the planner we will check for the
+    // presence for either service in the Carnot instance when pruning the plan.
+    rapidjson::Document doc;
+    doc.Parse(val.c_str());
+    if (!doc.IsArray()) {
+      probes_.push_back(md::AgentMetadataFilter::PrepareProbe(md_type_, val));
+      return;
+    }
+    for (rapidjson::SizeType i = 0; i < doc.Size(); ++i) {
+      // The values that follow a non-string value are never looked up.
+      if (!doc[i].IsString()) {
+        break;
+      }
+      probes_.push_back(md::AgentMetadataFilter::PrepareProbe(md_type_, doc[i].GetString()));
+    }
   }
 
  private:
-  std::string val_;
   MetadataType md_type_;
+  std::vector<md::AgentMetadataFilter::EntityProbe> probes_;
 };
 
 MapRemovableOperatorsRule::MapRemovableOperatorsRule(
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/distributed/distributed_plan/agent_metadata_filter_cache.h"
+
+#include <utility>
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+StatusOr<std::shared_ptr<const md::AgentMetadataFilter>> AgentMetadataFilterCache::GetOrDecode(
+    const sole::uuid& agent_id, const distributedpb::MetadataInfo& metadata_info) {
+  {
+    absl::MutexLock lock(&lock_);
+    ++clock_;
+    auto it = entries_.find(agent_id);
+    if (it != entries_.end() && it->second.filter->MatchesProto(metadata_info)) {
+      ++hits_;
+      it->second.last_used = clock_;
+      return it->second.filter;
+    }
+    ++misses_;
+  }
+
+  // Decode outside of the lock, filters can be large.
+  PX_ASSIGN_OR_RETURN(std::shared_ptr<const md::AgentMetadataFilter> filter,
+                      md::AgentMetadataFilter::FromProto(metadata_info));
+  if (capacity_ == 0) {
+    return filter;
+  }
+
+  absl::MutexLock lock(&lock_);
+  if (!entries_.contains(agent_id) && entries_.size() >= capacity_) {
+    EvictLeastRecentlyUsed();
+  }
+  entries_[agent_id] = Entry{filter, clock_};
+  return filter;
+}
+
+void AgentMetadataFilterCache::EvictLeastRecentlyUsed() {
+  // Only happens once more agents than the capacity have been seen, e.g. as agents get replaced,
+  // so a scan is good enough.
+  auto lru = entries_.begin();
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->second.last_used < lru->second.last_used) {
+      lru = it;
+    }
+  }
+  if (lru != entries_.end()) {
+    entries_.erase(lru);
+  }
+}
+
+size_t AgentMetadataFilterCache::size() const {
+  absl::MutexLock lock(&lock_);
+  return entries_.size();
+}
+
+int64_t AgentMetadataFilterCache::hits() const {
+  absl::MutexLock lock(&lock_);
+  return hits_;
+}
+
+int64_t AgentMetadataFilterCache::misses() const {
+  absl::MutexLock lock(&lock_);
+  return misses_;
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
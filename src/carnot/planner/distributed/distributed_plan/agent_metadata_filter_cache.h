@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include <memory>
+
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/common/uuid/uuid.h"
+#include "src/shared/metadata/metadata_filter.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+/**
+ * AgentMetadataFilterCache keeps the metadata filters of agents decoded across queries. Every
+ * query comes with the filters of all agents, which only change when the metadata of an agent
+ * does, so most of them would otherwise get decoded over and over again.
+ *
+ * A cached filter is reused as long as the filter sent for its agent is the same, i.e. for as long
+ * as the agent hasn't sent a new version of it. Once the cache is full, the least recently used
+ * filter is evicted.
+ */
+class AgentMetadataFilterCache : public NotCopyable {
+ public:
+  /**
+   * @param capacity the maximum number of agents to keep the filters of.
+   */
+  explicit AgentMetadataFilterCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Returns the filter decoded from the metadata info sent for the agent, reusing the cached one
+   * if it's the same.
+   */
+  StatusOr<std::shared_ptr<const md::AgentMetadataFilter>> GetOrDecode(
+      const sole::uuid& agent_id, const distributedpb::MetadataInfo& metadata_info);
+
+  size_t size() const;
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<const md::AgentMetadataFilter> filter;
+    int64_t last_used = 0;
+  };
+
+  void EvictLeastRecentlyUsed() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const size_t capacity_;
+
+  mutable absl::Mutex lock_;
+  absl::flat_hash_map<sole::uuid, Entry> entries_ ABSL_GUARDED_BY(lock_);
+  // Incremented on every lookup, to order the entries by their last use.
+  int64_t clock_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t hits_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+
+#include "src/carnot/planner/distributed/distributed_plan/agent_metadata_filter_cache.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+using md::AgentMetadataFilter;
+using md::MetadataType;
+
+distributedpb::MetadataInfo FilterProto(std::string_view pod) {
+  auto filter =
+      AgentMetadataFilter::Create(100, 0.01, {MetadataType::POD_NAME}).ConsumeValueOrDie();
+  EXPECT_OK(filter->InsertEntity(MetadataType::POD_NAME, pod));
+  return filter->ToProto();
+}
+
+TEST(AgentMetadataFilterCacheTest, ReusesFilterUntilItChanges) {
+  AgentMetadataFilterCache cache(10);
+  sole::uuid agent1 = sole::rebuild("00000001-0000-0000-0000-000000000001");
+  sole::uuid agent2 = sole::rebuild("00000001-0000-0000-0000-000000000002");
+
+  ASSERT_OK_AND_ASSIGN(auto filter1, cache.GetOrDecode(agent1, FilterProto("pod1")));
+  EXPECT_TRUE(filter1->ContainsEntity(MetadataType::POD_NAME, "pod1"));
+  ASSERT_OK_AND_ASSIGN(auto filter2, cache.GetOrDecode(agent2, FilterProto("pod2")));
+  EXPECT_TRUE(filter2->ContainsEntity(MetadataType::POD_NAME, "pod2"));
+  EXPECT_EQ(cache.misses(), 2);
+  EXPECT_EQ(cache.size(), 2);
+
+  ASSERT_OK_AND_ASSIGN(auto filter1_again, cache.GetOrDecode(agent1, FilterProto("pod1")));
+  EXPECT_EQ(filter1_again, filter1);
+  EXPECT_EQ(cache.hits(), 1);
+
+  // The agent sends a new version of its filter.
+  ASSERT_OK_AND_ASSIGN(auto filter1_new, cache.GetOrDecode(agent1, FilterProto("pod3")));
+  EXPECT_NE(filter1_new, filter1);
+  EXPECT_TRUE(filter1_new->ContainsEntity(MetadataType::POD_NAME, "pod3"));
+  EXPECT_FALSE(filter1_new->ContainsEntity(MetadataType::POD_NAME, "pod1"));
+  EXPECT_EQ(cache.misses(), 3);
+  EXPECT_EQ(cache.size(), 2);
+  // The filter handed out before is still valid.
+  EXPECT_TRUE(filter1->ContainsEntity(MetadataType::POD_NAME, "pod1"));
+}
+
+TEST(AgentMetadataFilterCacheTest, EvictsLeastRecentlyUsed) {
+  AgentMetadataFilterCache cache(2);
+  sole::uuid agent1 = sole::rebuild("00000001-0000-0000-0000-000000000001");
+  sole::uuid agent2 = sole::rebuild("00000001-0000-0000-0000-000000000002");
+  sole::uuid agent3 = sole::rebuild("00000001-0000-0000-0000-000000000003");
+  auto proto = FilterProto("pod");
+
+  ASSERT_OK(cache.GetOrDecode(agent1, proto));
+  ASSERT_OK(cache.GetOrDecode(agent2, proto));
+  ASSERT_OK(cache.GetOrDecode(agent1, proto));
+  ASSERT_OK(cache.GetOrDecode(agent3, proto));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.misses(), 3);
+
+  // agent2 was evicted.
+  ASSERT_OK(cache.GetOrDecode(agent1, proto));
+  ASSERT_OK(cache.GetOrDecode(agent3, proto));
+  EXPECT_EQ(cache.hits(), 3);
+  ASSERT_OK(cache.GetOrDecode(agent2, proto));
+  EXPECT_EQ(cache.misses(), 4);
+}
+
+TEST(AgentMetadataFilterCacheTest, InvalidFilter) {
+  AgentMetadataFilterCache cache(2);
+  sole::uuid agent1 = sole::rebuild("00000001-0000-0000-0000-000000000001");
+  EXPECT_NOT_OK(cache.GetOrDecode(agent1, distributedpb::MetadataInfo()));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -63,7 +63,8 @@ StatusOr<distributedpb::DistributedPlan> DistributedPlan::ToProto() const {
 StatusOr<int64_t> DistributedPlan::AddCarnot(const distributedpb::CarnotInfo& carnot_info) {
   int64_t carnot_id = id_counter_;
   ++id_counter_;
-  PX_ASSIGN_OR_RETURN(auto instance, CarnotInstance::Create(carnot_id, carnot_info, this));
+  PX_ASSIGN_OR_RETURN(auto instance,
+                      CarnotInstance::Create(carnot_id, carnot_info, this, md_filter_cache_));
   id_to_node_map_.emplace(carnot_id, std::move(instance));
   PX_ASSIGN_OR_RETURN(sole::uuid uuid, ParseUUID(carnot_info.agent_id()));
   uuid_to_id_map_[uuid] = carnot_id;
@@ -72,9 +73,16 @@ StatusOr<int64_t> DistributedPlan::AddCarnot(const distributedpb::CarnotInfo& ca
 }
 
 StatusOr<std::unique_ptr<CarnotInstance>> CarnotInstance::Create(
-    int64_t id, const distributedpb::CarnotInfo& carnot_info, DistributedPlan* parent_plan) {
+    int64_t id, const distributedpb::CarnotInfo& carnot_info, DistributedPlan* parent_plan,
+    AgentMetadataFilterCache* md_filter_cache) {
   if (carnot_info.has_metadata_info()) {
-    PX_ASSIGN_OR_RETURN(auto bf, md::AgentMetadataFilter::FromProto(carnot_info.metadata_info()));
+    std::shared_ptr<const md::AgentMetadataFilter> bf;
+    if (md_filter_cache != nullptr) {
+      PX_ASSIGN_OR_RETURN(sole::uuid agent_id, ParseUUID(carnot_info.agent_id()));
+      PX_ASSIGN_OR_RETURN(bf, md_filter_cache->GetOrDecode(agent_id, carnot_info.metadata_info()));
+    } else {
+      PX_ASSIGN_OR_RETURN(bf, md::AgentMetadataFilter::FromProto(carnot_info.metadata_info()));
+    }
     return std::unique_ptr<CarnotInstance>(
         new CarnotInstance(id, carnot_info, parent_plan, std::move(bf)));
   }
@@ -26,6 +26,7 @@
 #include <absl/container/flat_hash_map.h>
 
 #include "src/carnot/planner/compiler_state/registry_info.h"
+#include "src/carnot/planner/distributed/distributed_plan/agent_metadata_filter_cache.h"
 #include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/ir/pattern_match.h"
@@ -49,7 +50,8 @@ class DistributedPlan;
 class CarnotInstance {
  public:
   static StatusOr<std::unique_ptr<CarnotInstance>> Create(
-      int64_t id, const distributedpb::CarnotInfo& carnot_info, DistributedPlan* parent_plan);
+      int64_t id, const distributedpb::CarnotInfo& carnot_info, DistributedPlan* parent_plan,
+      AgentMetadataFilterCache* md_filter_cache = nullptr);
 
   const std::string& QueryBrokerAddress() const { return carnot_info_.query_broker_address(); }
   int64_t id() const { return id_; }
@@ -67,11 +69,12 @@ class CarnotInstance {
     return absl::Substitute("Carnot(id=$0, qb_address=$1)", id(), QueryBrokerAddress());
   }
 
-  md::AgentMetadataFilter* metadata_filter() { return md_filter_.get(); }
+  const md::AgentMetadataFilter* metadata_filter() const { return md_filter_.get(); }
 
  private:
   CarnotInstance(int64_t id, const distributedpb::CarnotInfo& carnot_info,
-                 DistributedPlan* parent_plan, std::unique_ptr<md::AgentMetadataFilter> md_filter)
+                 DistributedPlan* parent_plan,
+                 std::shared_ptr<const md::AgentMetadataFilter> md_filter)
       : id_(id),
         carnot_info_(carnot_info),
         distributed_plan_(parent_plan),
@@ -84,8 +87,9 @@ class CarnotInstance {
   IR* plan_;
   // The distributed plan that this instance belongs to.
   DistributedPlan* distributed_plan_;
-  // A filter containing the metadata entities stored on a particular Carnot.
-  std::unique_ptr<md::AgentMetadataFilter> md_filter_ = nullptr;
+  // A filter containing the metadata entities stored on a particular Carnot. May be shared with
+  // the plans of other queries through the AgentMetadataFilterCache.
+  std::shared_ptr<const md::AgentMetadataFilter> md_filter_ = nullptr;
 };
 
 // Note: this can be refactored to share a common base class with IR for shared
@@ -100,6 +104,14 @@ class DistributedPlan {
    */
   StatusOr<int64_t> AddCarnot(const distributedpb::CarnotInfo& carnot_instance);
 
+  /**
+   * @brief Sets the cache that the metadata filters of the Carnot instances added afterwards are
+   * looked up in, instead of decoding them from their proto.
+   */
+  void SetMetadataFilterCache(AgentMetadataFilterCache* md_filter_cache) {
+    md_filter_cache_ = md_filter_cache;
+  }
+
   /**
    * @brief Gets the carnot instance at the index i.
    *
@@ -176,6 +188,7 @@ class DistributedPlan {
   planpb::PlanOptions plan_options_;
   std::string exec_complete_address_;
   std::string exec_complete_ssl_targetname_;
+  AgentMetadataFilterCache* md_filter_cache_ = nullptr;
 };
 
 }  // namespace distributed
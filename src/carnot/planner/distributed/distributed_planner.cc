@@ -73,7 +73,7 @@ StatusOr<std::unique_ptr<DistributedPlan>> DistributedPlanner::Plan(
     const distributedpb::DistributedState& distributed_state, CompilerState* compiler_state,
     const IR* logical_plan) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Coordinator> coordinator,
-                      Coordinator::Create(compiler_state, distributed_state));
+                      Coordinator::Create(compiler_state, distributed_state, &md_filter_cache_));
 
   PX_ASSIGN_OR_RETURN(std::unique_ptr<DistributedPlan> distributed_plan,
                       coordinator->Coordinate(logical_plan));
@@ -84,10 +84,17 @@ class DistributedPlanner : public NotCopyable, public Planner {
       const distributedpb::DistributedState& distributed_state, CompilerState* compiler_state,
       const IR* logical_plan) override;
 
+  const AgentMetadataFilterCache& md_filter_cache() const { return md_filter_cache_; }
+
  private:
+  // The number of agents whose metadata filters are kept decoded across queries.
+  static constexpr size_t kMetadataFilterCacheCapacity = 4096;
+
   DistributedPlanner() {}
 
   Status Init();
+
+  AgentMetadataFilterCache md_filter_cache_{kMetadataFilterCacheCapacity};
 };
 
 }  // namespace distributed
@@ -18,6 +18,8 @@
 
 #include "src/carnot/planner/logical_planner.h"
 
+#include <algorithm>
+#include <string>
 #include <utility>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
@@ -26,6 +28,10 @@
 #include "src/carnot/planner/parser/parser.h"
 #include "src/shared/scriptspb/scripts.pb.h"
 
+DEFINE_int32(planner_plan_cache_size, gflags::Int32FromEnv("PL_PLANNER_PLAN_CACHE_SIZE", 64),
+             "The number of distinct queries whose distributed plans the logical planner keeps "
+             "track of for caching. 0 disables the plan cache.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -65,6 +71,13 @@ static inline RedactionOptions RedactionOptionsFromPb(
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
     const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
     int64_t max_output_rows_per_table) {
+  return CreateCompilerState(logical_state, registry_info, max_output_rows_per_table,
+                             px::CurrentTimeNS());
+}
+
+StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
+    const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
+    int64_t max_output_rows_per_table, int64_t time_now_ns) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<RelationMap> rel_map,
                       MakeRelationMapFromDistributedState(logical_state.distributed_state()));
 
@@ -97,9 +110,9 @@ StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
   for (const auto& debug_info_pb : logical_state.debug_info().otel_debug_attributes()) {
     debug_info.otel_debug_attrs.push_back({debug_info_pb.name(), debug_info_pb.value()});
   }
-  // Create a CompilerState obj using the relation map and grabbing the current time.
+  // Create a CompilerState obj using the relation map and the given time.
   return std::make_unique<planner::CompilerState>(
-      std::move(rel_map), sensitive_columns, registry_info, px::CurrentTimeNS(),
+      std::move(rel_map), sensitive_columns, registry_info, time_now_ns,
       max_output_rows_per_table, logical_state.result_address(),
       logical_state.result_ssl_targetname(),
       // TODO(philkuz) add an endpoint config to logical_state and pass that in here.
@@ -108,6 +121,9 @@ StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
       std::move(plugin_config), debug_info);
 }
 
+LogicalPlanner::LogicalPlanner()
+    : plan_cache_(static_cast<size_t>(std::max(FLAGS_planner_plan_cache_size, 0))) {}
+
 StatusOr<std::unique_ptr<LogicalPlanner>> LogicalPlanner::Create(const udfspb::UDFInfo& udf_info) {
   auto planner = std::unique_ptr<LogicalPlanner>(new LogicalPlanner());
   PX_RETURN_IF_ERROR(planner->Init(udf_info));
@@ -125,13 +141,18 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
 
 StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
     const plannerpb::QueryRequest& query_request) {
+  return Plan(query_request, px::CurrentTimeNS());
+}
+
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
+    const plannerpb::QueryRequest& query_request, int64_t time_now_ns) {
   // Compile into the IR.
 
   auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
   VLOG(1) << "Max output rows: " << ms;
-  PX_ASSIGN_OR_RETURN(
-      std::unique_ptr<CompilerState> compiler_state,
-      CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  PX_ASSIGN_OR_RETURN(std::unique_ptr<CompilerState> compiler_state,
+                      CreateCompilerState(query_request.logical_planner_state(),
+                                          registry_info_.get(), ms, time_now_ns));
 
   std::vector<plannerpb::FuncToExecute> exec_funcs(query_request.exec_funcs().begin(),
                                                    query_request.exec_funcs().end());
@@ -149,6 +170,46 @@ StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
   return distributed_plan;
 }
 
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::CompilePlanProto(
+    const plannerpb::QueryRequest& query_request, int64_t time_now_ns) {
+  PX_ASSIGN_OR_RETURN(auto distributed_plan, Plan(query_request, time_now_ns));
+  // In the future, if we actually have plan options that will actually determine how the plan is
+  // constructed, we may want to pass the planOptions to planner.Plan. However, this
+  // will need to go through many more layers (such as the coordinator), so this is fine for now.
+  distributed_plan->SetPlanOptions(query_request.logical_planner_state().plan_options());
+  return distributed_plan->ToProto();
+}
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanProto(
+    const plannerpb::QueryRequest& query_request) {
+  return PlanProto(query_request, px::CurrentTimeNS());
+}
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanProto(
+    const plannerpb::QueryRequest& query_request, int64_t time_now_ns) {
+  const PlanCacheKey key = PlanCache::Key(query_request);
+  bool should_insert = false;
+  auto cached_plan = plan_cache_.Lookup(key, time_now_ns, &should_insert);
+  if (cached_plan.has_value()) {
+    return std::move(cached_plan.value());
+  }
+
+  PX_ASSIGN_OR_RETURN(distributedpb::DistributedPlan plan_pb,
+                      CompilePlanProto(query_request, time_now_ns));
+  if (should_insert) {
+    // The query repeats, compile it once more at the probe time to find the fields that depend on
+    // the compile time.
+    const int64_t probe_time_ns = time_now_ns - PlanCache::kProbeOffsetNs;
+    auto probe_plan_or_s = CompilePlanProto(query_request, probe_time_ns);
+    if (probe_plan_or_s.ok()) {
+      plan_cache_.Insert(key, time_now_ns, plan_pb, probe_time_ns, probe_plan_or_s.ValueOrDie());
+    } else {
+      plan_cache_.Reject(key);
+    }
+  }
+  return plan_pb;
+}
+
 StatusOr<std::unique_ptr<compiler::MutationsIR>> LogicalPlanner::CompileTrace(
     const plannerpb::CompileMutationsRequest& mutations_req) {
   // Compile into the IR.
@@ -25,6 +25,7 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
 #include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/plan_cache.h"
 #include "src/carnot/planner/plannerpb/service.pb.h"
 #include "src/carnot/planner/probes/probes.h"
 #include "src/shared/scriptspb/scripts.pb.h"
@@ -57,6 +58,21 @@ class LogicalPlanner : public NotCopyable {
   StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
       const plannerpb::QueryRequest& query);
 
+  /**
+   * @brief Plans the query like Plan(), and returns the distributed plan proto with the plan
+   * options of the query set. The plans of queries that get executed repeatedly, e.g. by live
+   * views, are cached, with the times they depend on shifted to the current time.
+   *
+   * @param query: QueryRequest
+   * @param time_now_ns: the time that relative times in the query are resolved against.
+   * @return distributedpb::DistributedPlan or error if one occurs during compilation.
+   */
+  StatusOr<distributedpb::DistributedPlan> PlanProto(const plannerpb::QueryRequest& query);
+  StatusOr<distributedpb::DistributedPlan> PlanProto(const plannerpb::QueryRequest& query,
+                                                     int64_t time_now_ns);
+
+  const PlanCache& plan_cache() const { return plan_cache_; }
+
   StatusOr<std::unique_ptr<compiler::MutationsIR>> CompileTrace(
       const plannerpb::CompileMutationsRequest& mutations_req);
 
@@ -67,18 +83,28 @@ class LogicalPlanner : public NotCopyable {
   Status Init(const udfspb::UDFInfo& udf_info);
 
  protected:
-  LogicalPlanner() {}
+  LogicalPlanner();
 
  private:
+  StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
+      const plannerpb::QueryRequest& query, int64_t time_now_ns);
+  StatusOr<distributedpb::DistributedPlan> CompilePlanProto(const plannerpb::QueryRequest& query,
+                                                            int64_t time_now_ns);
+
   compiler::Compiler compiler_;
   std::unique_ptr<distributed::Planner> distributed_planner_;
   std::unique_ptr<planner::RegistryInfo> registry_info_;
+  PlanCache plan_cache_;
 };
 
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
     const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
     int64_t max_output_rows_per_table);
 
+StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
+    const distributedpb::LogicalPlannerState& logical_state, RegistryInfo* registry_info,
+    int64_t max_output_rows_per_table, int64_t time_now_ns);
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
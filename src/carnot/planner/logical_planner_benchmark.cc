@@ -18,11 +18,15 @@
 
 #include <benchmark/benchmark.h>
 
+#include <string>
+#include <vector>
+
 #include "src/carnot/planner/logical_planner.h"
 #include "src/carnot/planner/test_utils.h"
 #include "src/carnot/udf_exporter/udf_exporter.h"
 #include "src/common/perf/perf.h"
 #include "src/common/testing/testing.h"
+#include "src/shared/metadata/metadata_filter.h"
 
 namespace px {
 namespace carnot {
@@ -43,7 +47,77 @@ void BM_Query(benchmark::State& state) {
   }
 }
 
+// A query that is re-run like a live view would, so that all but the first two runs hit the plan
+// cache.
+// NOLINTNEXTLINE : runtime/references.
+void BM_RepeatedQuery(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  *query_request.mutable_logical_planner_state() =
+      testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_OK(planner->PlanProto(query_request));
+  }
+  for (auto _ : state) {
+    auto plan_or_s = planner->PlanProto(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+  state.counters["hits"] = planner->plan_cache().hits();
+}
+
+constexpr char kPodFilterQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time='-5m', select=['upid'])
+df = df[df.ctx['pod_id'] == 'pod-500-0']
+px.display(df)
+)pxl";
+
+// A cluster of num_pems PEMs, each with the metadata filter of the pods running on it. Filters are
+// sized like the ones the agents send.
+distributedpb::LogicalPlannerState CreateManyPEMsPlannerState(int num_pems) {
+  constexpr int kPodsPerPEM = 20;
+  std::vector<std::string> carnot_infos;
+  for (int i = 0; i < num_pems; ++i) {
+    carnot_infos.push_back(testutils::MakePEMCarnotInfo(
+        absl::StrCat("pem", i), absl::StrFormat("00000001-0000-0000-0000-%012d", i + 1), i, {}));
+  }
+  carnot_infos.push_back(testutils::MakeKelvinCarnotInfo(
+      "kelvin", "00000002-0000-0000-0000-000000000001", "1111", num_pems));
+  auto logical_state = testutils::LoadLogicalPlannerStatePB(
+      testutils::MakeDistributedState(carnot_infos), testutils::kHttpEventsSchema);
+
+  for (int i = 0; i < num_pems; ++i) {
+    auto filter = md::AgentMetadataFilter::Create(/*max_entries*/ 10000, /*error_rate*/ 0.0001,
+                                                  {md::MetadataType::POD_ID})
+                      .ConsumeValueOrDie();
+    for (int j = 0; j < kPodsPerPEM; ++j) {
+      PX_CHECK_OK(filter->InsertEntity(md::MetadataType::POD_ID, absl::StrCat("pod-", i, "-", j)));
+    }
+    *logical_state.mutable_distributed_state()->mutable_carnot_info(i)->mutable_metadata_info() =
+        filter->ToProto();
+  }
+  return logical_state;
+}
+
+// A query that filters on a pod, so that all but one PEM get pruned with their metadata filters.
+// NOLINTNEXTLINE : runtime/references.
+void BM_PodFilterQuery(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(kPodFilterQuery);
+  *query_request.mutable_logical_planner_state() = CreateManyPEMsPlannerState(state.range(0));
+  for (auto _ : state) {
+    auto plan_or_s = planner->Plan(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+}
+
 BENCHMARK(BM_Query);
+BENCHMARK(BM_RepeatedQuery);
+BENCHMARK(BM_PodFilterQuery)->Arg(10)->Arg(1000)->Unit(benchmark::kMillisecond);
 
 }  // namespace logical_planner
 }  // namespace planner
@@ -18,6 +18,7 @@
 
 #include <gmock/gmock.h>
 #include <google/protobuf/text_format.h>
+#include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
 
 #include <utility>
@@ -108,6 +109,29 @@ TEST_F(LogicalPlannerTest, distributed_plan_test_basic_queries) {
   EXPECT_EQ(pem1_plan->second.execution_status_destinations()[0].ssl_targetname(), "kelvin.pl.svc");
 }
 
+TEST_F(LogicalPlannerTest, plan_proto_caches_repeated_queries) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto query_request =
+      MakeQueryRequest(testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema),
+                       testutils::kHttpRequestStats);
+  const int64_t time_now_ns = 1'600'000'000'000'000'000;
+  const int64_t second_ns = 1'000'000'000;
+
+  // The second run of the query fills the cache, the third one hits it.
+  ASSERT_OK(planner->PlanProto(query_request, time_now_ns));
+  ASSERT_OK(planner->PlanProto(query_request, time_now_ns + second_ns));
+  ASSERT_OK_AND_ASSIGN(auto cached_plan,
+                       planner->PlanProto(query_request, time_now_ns + 2 * second_ns));
+  EXPECT_EQ(1, planner->plan_cache().hits());
+
+  // The start time of the cached plan moves with the compile time, so it matches a fresh compile.
+  auto uncached_planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  ASSERT_OK_AND_ASSIGN(auto plan,
+                       uncached_planner->PlanProto(query_request, time_now_ns + 2 * second_ns));
+  EXPECT_EQ(0, uncached_planner->plan_cache().hits());
+  EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(plan, cached_plan));
+}
+
 constexpr char kSimpleQueryDefaultLimit[] = R"pxl(
 import px
 t1 = px.DataFrame(table='http_events', start_time='-120s', select=['time_'])
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/plan_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/util/message_differencer.h>
+
+#include <algorithm>
+
+#include "xxhash.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+namespace {
+
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Message;
+using google::protobuf::Reflection;
+using google::protobuf::util::MessageDifferencer;
+using FieldPath = std::vector<std::pair<const FieldDescriptor*, int>>;
+
+// Seeds of the two halves of the key digest.
+constexpr uint64_t kKeySeedHi = 0x5c3b0f3e8a1d7b29ULL;
+constexpr uint64_t kKeySeedLo = 0x93e6d1a4f27c05b1ULL;
+
+// Compares a non-message value of a field. The index is -1 for singular fields.
+bool ScalarEquals(const Message& a, const Message& b, const FieldDescriptor* field, int index) {
+  const Reflection* refl_a = a.GetReflection();
+  const Reflection* refl_b = b.GetReflection();
+#define PX_SCALAR_EQUALS(type)                                                  \
+  return index < 0 ? refl_a->Get##type(a, field) == refl_b->Get##type(b, field) \
+                   : refl_a->GetRepeated##type(a, field, index) ==              \
+                         refl_b->GetRepeated##type(b, field, index)
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+      PX_SCALAR_EQUALS(Int32);
+    case FieldDescriptor::CPPTYPE_INT64:
+      PX_SCALAR_EQUALS(Int64);
+    case FieldDescriptor::CPPTYPE_UINT32:
+      PX_SCALAR_EQUALS(UInt32);
+    case FieldDescriptor::CPPTYPE_UINT64:
+      PX_SCALAR_EQUALS(UInt64);
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      PX_SCALAR_EQUALS(Double);
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      PX_SCALAR_EQUALS(Float);
+    case FieldDescriptor::CPPTYPE_BOOL:
+      PX_SCALAR_EQUALS(Bool);
+    case FieldDescriptor::CPPTYPE_ENUM:
+      PX_SCALAR_EQUALS(EnumValue);
+    case FieldDescriptor::CPPTYPE_STRING:
+      PX_SCALAR_EQUALS(String);
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      break;
+  }
+#undef PX_SCALAR_EQUALS
+  LOG(DFATAL) << "Unexpected message field " << field->full_name();
+  return false;
+}
+
+// Returns the serialized entries of a map field, sorted. Map entries don't have a defined order.
+std::vector<std::string> SortedMapEntries(const Message& msg, const FieldDescriptor* field) {
+  const Reflection* refl = msg.GetReflection();
+  std::vector<std::string> entries;
+  for (int i = 0; i < refl->FieldSize(msg, field); ++i) {
+    entries.push_back(refl->GetRepeatedMessage(msg, field, i).SerializeAsString());
+  }
+  std::sort(entries.begin(), entries.end());
+  return entries;
+}
+
+bool CollectShiftedFields(const Message& a, const Message& b, int64_t delta_ns, FieldPath* path,
+                          std::vector<FieldPath>* shifted);
+
+// Compares a value of a field, see CollectShiftedFields().
+bool CollectShiftedValue(const Message& a, const Message& b, const FieldDescriptor* field,
+                         int index, int64_t delta_ns, FieldPath* path,
+                         std::vector<FieldPath>* shifted) {
+  const Reflection* refl_a = a.GetReflection();
+  const Reflection* refl_b = b.GetReflection();
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_MESSAGE: {
+      path->emplace_back(field, index);
+      bool ok = index < 0 ? CollectShiftedFields(refl_a->GetMessage(a, field),
+                                                 refl_b->GetMessage(b, field), delta_ns, path,
+                                                 shifted)
+                          : CollectShiftedFields(refl_a->GetRepeatedMessage(a, field, index),
+                                                 refl_b->GetRepeatedMessage(b, field, index),
+                                                 delta_ns, path, shifted);
+      path->pop_back();
+      return ok;
+    }
+    case FieldDescriptor::CPPTYPE_INT64: {
+      int64_t value_a =
+          index < 0 ? refl_a->GetInt64(a, field) : refl_a->GetRepeatedInt64(a, field, index);
+      int64_t value_b =
+          index < 0 ? refl_b->GetInt64(b, field) : refl_b->GetRepeatedInt64(b, field, index);
+      if (value_a == value_b) {
+        return true;
+      }
+      // Unsigned, so that arbitrary values can't overflow.
+      if (static_cast<uint64_t>(value_a) - static_cast<uint64_t>(value_b) !=
+          static_cast<uint64_t>(delta_ns)) {
+        return false;
+      }
+      path->emplace_back(field, index);
+      shifted->push_back(*path);
+      path->pop_back();
+      return true;
+    }
+    default:
+      return ScalarEquals(a, b, field, index);
+  }
+}
+
+// Walks a and b in parallel and collects the paths of the int64 fields whose value in a is
+// delta_ns larger than in b. Returns false if a and b differ in any other way.
+bool CollectShiftedFields(const Message& a, const Message& b, int64_t delta_ns, FieldPath* path,
+                          std::vector<FieldPath>* shifted) {
+  const Reflection* refl_a = a.GetReflection();
+  const Reflection* refl_b = b.GetReflection();
+  const auto* descriptor = a.GetDescriptor();
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    const FieldDescriptor* field = descriptor->field(i);
+    if (field->is_map()) {
+      // Time fields are never nested in a map, which would leave them without a stable path.
+      if (SortedMapEntries(a, field) != SortedMapEntries(b, field)) {
+        return false;
+      }
+      continue;
+    }
+    if (field->is_repeated()) {
+      int size = refl_a->FieldSize(a, field);
+      if (size != refl_b->FieldSize(b, field)) {
+        return false;
+      }
+      for (int j = 0; j < size; ++j) {
+        if (!CollectShiftedValue(a, b, field, j, delta_ns, path, shifted)) {
+          return false;
+        }
+      }
+      continue;
+    }
+    if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE ||
+        field->containing_oneof() != nullptr) {
+      bool has_field = refl_a->HasField(a, field);
+      if (has_field != refl_b->HasField(b, field)) {
+        return false;
+      }
+      if (!has_field) {
+        continue;
+      }
+    }
+    if (!CollectShiftedValue(a, b, field, -1, delta_ns, path, shifted)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ShiftField(Message* msg, const FieldPath& path, int64_t delta_ns) {
+  DCHECK(!path.empty());
+  for (size_t i = 0; i + 1 < path.size(); ++i) {
+    const auto& [field, index] = path[i];
+    const Reflection* refl = msg->GetReflection();
+    msg = index < 0 ? refl->MutableMessage(msg, field)
+                    : refl->MutableRepeatedMessage(msg, field, index);
+  }
+  const auto& [field, index] = path.back();
+  const Reflection* refl = msg->GetReflection();
+  if (index < 0) {
+    uint64_t value = static_cast<uint64_t>(refl->GetInt64(*msg, field));
+    refl->SetInt64(msg, field, static_cast<int64_t>(value + static_cast<uint64_t>(delta_ns)));
+  } else {
+    uint64_t value = static_cast<uint64_t>(refl->GetRepeatedInt64(*msg, field, index));
+    refl->SetRepeatedInt64(msg, field, index,
+                           static_cast<int64_t>(value + static_cast<uint64_t>(delta_ns)));
+  }
+}
+
+}  // namespace
+
+PlanCacheKey PlanCache::Key(const plannerpb::QueryRequest& query_request) {
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    // The logical planner state has maps, which must serialize the same way every time.
+    coded_stream.SetSerializationDeterministic(true);
+    query_request.SerializeToCodedStream(&coded_stream);
+  }
+  PlanCacheKey key;
+  key.hi = XXH64(serialized.data(), serialized.size(), kKeySeedHi);
+  key.lo = XXH64(serialized.data(), serialized.size(), kKeySeedLo);
+  return key;
+}
+
+bool PlanCache::FindTimeFields(const distributedpb::DistributedPlan& plan,
+                               const distributedpb::DistributedPlan& probe_plan, int64_t delta_ns,
+                               std::vector<TimeField>* time_fields) {
+  // The plans of the query brokers are compared key by key. Everything else must be equal.
+  MessageDifferencer differencer;
+  differencer.IgnoreField(
+      distributedpb::DistributedPlan::descriptor()->FindFieldByName("qb_address_to_plan"));
+  if (!differencer.Compare(plan, probe_plan)) {
+    return false;
+  }
+  if (plan.qb_address_to_plan_size() != probe_plan.qb_address_to_plan_size()) {
+    return false;
+  }
+  for (const auto& [qb_address, qb_plan] : plan.qb_address_to_plan()) {
+    auto probe_it = probe_plan.qb_address_to_plan().find(qb_address);
+    if (probe_it == probe_plan.qb_address_to_plan().end()) {
+      return false;
+    }
+    FieldPath path;
+    std::vector<FieldPath> shifted;
+    if (!CollectShiftedFields(qb_plan, probe_it->second, delta_ns, &path, &shifted)) {
+      return false;
+    }
+    for (auto& field_path : shifted) {
+      time_fields->push_back(TimeField{qb_address, std::move(field_path)});
+    }
+  }
+  return true;
+}
+
+PlanCache::Entry* PlanCache::Touch(const PlanCacheKey& key) {
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+    return &it->second;
+  }
+  lru_.push_front(key);
+  Entry* entry = &entries_[key];
+  entry->lru_pos = lru_.begin();
+  if (entries_.size() > capacity_) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  return entry;
+}
+
+std::optional<distributedpb::DistributedPlan> PlanCache::Lookup(const PlanCacheKey& key,
+                                                                int64_t time_now_ns,
+                                                                bool* should_insert) {
+  *should_insert = false;
+  absl::MutexLock lock(&lock_);
+  if (capacity_ == 0) {
+    ++misses_;
+    return std::nullopt;
+  }
+  bool seen = entries_.contains(key);
+  Entry* entry = Touch(key);
+  if (entry->state != EntryState::kCached) {
+    ++misses_;
+    *should_insert = seen && entry->state == EntryState::kSeen;
+    return std::nullopt;
+  }
+
+  ++hits_;
+  distributedpb::DistributedPlan plan = entry->plan;
+  const int64_t delta_ns = time_now_ns - entry->time_now_ns;
+  for (const TimeField& time_field : entry->time_fields) {
+    auto& qb_plan = (*plan.mutable_qb_address_to_plan())[time_field.qb_address];
+    ShiftField(&qb_plan, time_field.path, delta_ns);
+  }
+  return plan;
+}
+
+void PlanCache::Insert(const PlanCacheKey& key, int64_t time_now_ns,
+                       const distributedpb::DistributedPlan& plan, int64_t probe_time_ns,
+                       const distributedpb::DistributedPlan& probe_plan) {
+  DCHECK_NE(time_now_ns, probe_time_ns);
+  std::vector<TimeField> time_fields;
+  if (!FindTimeFields(plan, probe_plan, time_now_ns - probe_time_ns, &time_fields)) {
+    VLOG(1) << "Query plan depends on the compile time in ways other than an offset, not caching.";
+    Reject(key);
+    return;
+  }
+
+  absl::MutexLock lock(&lock_);
+  if (capacity_ == 0) {
+    return;
+  }
+  Entry* entry = Touch(key);
+  entry->state = EntryState::kCached;
+  entry->time_now_ns = time_now_ns;
+  entry->plan = plan;
+  entry->time_fields = std::move(time_fields);
+}
+
+void PlanCache::Reject(const PlanCacheKey& key) {
+  absl::MutexLock lock(&lock_);
+  if (capacity_ == 0) {
+    return;
+  }
+  Entry* entry = Touch(key);
+  entry->state = EntryState::kUncacheable;
+  entry->plan.Clear();
+  entry->time_fields.clear();
+}
+
+size_t PlanCache::size() const {
+  absl::MutexLock lock(&lock_);
+  return entries_.size();
+}
+
+int64_t PlanCache::hits() const {
+  absl::MutexLock lock(&lock_);
+  return hits_;
+}
+
+int64_t PlanCache::misses() const {
+  absl::MutexLock lock(&lock_);
+  return misses_;
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
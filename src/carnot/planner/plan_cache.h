@@ -0,0 +1,159 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <google/protobuf/descriptor.h>
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plannerpb/service.pb.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * A 128-bit digest of a query request, which the plan cache keys on instead of the request itself.
+ */
+struct PlanCacheKey {
+  bool operator==(const PlanCacheKey& other) const { return hi == other.hi && lo == other.lo; }
+  bool operator!=(const PlanCacheKey& other) const { return !(*this == other); }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const PlanCacheKey& key) {
+    return H::combine(std::move(h), key.hi, key.lo);
+  }
+
+  uint64_t hi = 0;
+  uint64_t lo = 0;
+};
+
+/**
+ * PlanCache keeps the distributed plans of repeatedly executed queries, such as the scripts of a
+ * live view which get re-run every few seconds, so that they don't have to go through the full
+ * compile and distribute path each time.
+ *
+ * A plan is keyed on a digest of the entire query request: the script, the functions to execute
+ * along with their arguments, and the logical planner state (including the distributed state). The
+ * only input that differs between two runs with the same key is the compile time, which relative
+ * time arguments (e.g. start_time='-5m') and px.now() are resolved against. To find the values that
+ * derive from it, a plan is only cached after it has been compiled a second time at a probe time,
+ * kProbeOffsetNs earlier. Fields that differ by exactly the offset between the two plans are the
+ * time fields, which get shifted on every hit. If the two plans differ in any other way, the query
+ * is marked uncacheable.
+ *
+ * Queries are only cached when they repeat: a query is recorded on its first miss, and only
+ * compiled at the probe time on its second one. The least recently used key is evicted once the
+ * cache is full.
+ */
+class PlanCache : public NotCopyable {
+ public:
+  // 1d 1h 1m 1s 1ns: not a multiple of any granularity a script could round the time to, so time
+  // values that don't move with the compile time can't go unnoticed.
+  static constexpr int64_t kProbeOffsetNs = 90'061'000'000'001;
+
+  /**
+   * @param capacity the maximum number of queries to keep track of. 0 disables the cache.
+   */
+  explicit PlanCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Returns the key of the plan for the given request, a digest of its deterministic serialization.
+   */
+  static PlanCacheKey Key(const plannerpb::QueryRequest& query_request);
+
+  /**
+   * Returns the cached plan for the key, with its time fields shifted to time_now_ns, or
+   * std::nullopt on a miss. On a miss, should_insert is set if the query has been seen before and
+   * isn't known to be uncacheable; the caller should then compile it a second time at
+   * (time_now_ns - kProbeOffsetNs) and call Insert() or Reject().
+   */
+  std::optional<distributedpb::DistributedPlan> Lookup(const PlanCacheKey& key, int64_t time_now_ns,
+                                                       bool* should_insert);
+
+  /**
+   * Caches the plan compiled at time_now_ns, given the same query compiled at probe_time_ns. The
+   * query is marked uncacheable if the two plans differ in anything but their time fields.
+   */
+  void Insert(const PlanCacheKey& key, int64_t time_now_ns,
+              const distributedpb::DistributedPlan& plan, int64_t probe_time_ns,
+              const distributedpb::DistributedPlan& probe_plan);
+
+  /**
+   * Marks the query uncacheable, e.g. because it failed to compile at the probe time.
+   */
+  void Reject(const PlanCacheKey& key);
+
+  size_t size() const;
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  // The path from a message to one of its (possibly nested) fields, one step per message level.
+  // The index is -1 for singular fields.
+  using FieldPath = std::vector<std::pair<const google::protobuf::FieldDescriptor*, int>>;
+
+  // An int64 field of the plan of one query broker address that holds a time.
+  struct TimeField {
+    std::string qb_address;
+    FieldPath path;
+  };
+
+  // Finds the fields of plan that differ from probe_plan by exactly delta_ns. Returns false if the
+  // plans differ in any other way.
+  static bool FindTimeFields(const distributedpb::DistributedPlan& plan,
+                             const distributedpb::DistributedPlan& probe_plan, int64_t delta_ns,
+                             std::vector<TimeField>* time_fields);
+
+  enum class EntryState { kSeen, kCached, kUncacheable };
+
+  struct Entry {
+    EntryState state = EntryState::kSeen;
+    int64_t time_now_ns = 0;
+    distributedpb::DistributedPlan plan;
+    std::vector<TimeField> time_fields;
+    // Position in lru_.
+    std::list<PlanCacheKey>::iterator lru_pos;
+  };
+
+  // Returns the entry for the key, creating it if needed, and marks it as most recently used.
+  Entry* Touch(const PlanCacheKey& key) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const size_t capacity_;
+
+  mutable absl::Mutex lock_;
+  absl::flat_hash_map<PlanCacheKey, Entry> entries_ ABSL_GUARDED_BY(lock_);
+  // Keys from most to least recently used.
+  std::list<PlanCacheKey> lru_ ABSL_GUARDED_BY(lock_);
+  int64_t hits_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <google/protobuf/text_format.h>
+
+#include <string>
+
+#include "src/carnot/planner/plan_cache.h"
+#include "src/common/testing/protobuf.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+using ::px::testing::proto::EqualsProto;
+
+constexpr char kPlanTmpl[] = R"proto(
+qb_address_to_plan {
+  key: "pem"
+  value {
+    nodes {
+      id: 1
+      nodes {
+        id: 1
+        op {
+          op_type: MEMORY_SOURCE_OPERATOR
+          mem_source_op {
+            name: "$0"
+            start_time {
+              value: $1
+            }
+            stop_time {
+              value: $2
+            }
+          }
+        }
+      }
+    }
+  }
+}
+qb_address_to_dag_id {
+  key: "pem"
+  value: 0
+}
+)proto";
+
+constexpr int64_t kFiveMinutesNs = 5L * 60 * 1000 * 1000 * 1000;
+
+std::string PlanText(const std::string& table, int64_t start_time_ns, int64_t stop_time_ns) {
+  return absl::Substitute(kPlanTmpl, table, start_time_ns, stop_time_ns);
+}
+
+distributedpb::DistributedPlan MakePlan(const std::string& table, int64_t start_time_ns,
+                                        int64_t stop_time_ns) {
+  distributedpb::DistributedPlan plan;
+  CHECK(google::protobuf::TextFormat::ParseFromString(
+      PlanText(table, start_time_ns, stop_time_ns), &plan));
+  return plan;
+}
+
+// The plan of a query over the last five minutes, compiled at time_now_ns.
+distributedpb::DistributedPlan MakeRelativePlan(int64_t time_now_ns) {
+  return MakePlan("http_events", time_now_ns - kFiveMinutesNs, time_now_ns);
+}
+
+plannerpb::QueryRequest MakeQueryRequest(const std::string& query) {
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(query);
+  return query_request;
+}
+
+TEST(PlanCacheTest, CachesRepeatedQueries) {
+  PlanCache cache(/* capacity */ 8);
+  const PlanCacheKey key = PlanCache::Key(MakeQueryRequest("query"));
+  bool should_insert = true;
+
+  // The first miss only records the query.
+  EXPECT_FALSE(cache.Lookup(key, 1000, &should_insert).has_value());
+  EXPECT_FALSE(should_insert);
+
+  const int64_t time_now_ns = 2 * PlanCache::kProbeOffsetNs;
+  EXPECT_FALSE(cache.Lookup(key, time_now_ns, &should_insert).has_value());
+  EXPECT_TRUE(should_insert);
+
+  const int64_t probe_time_ns = time_now_ns - PlanCache::kProbeOffsetNs;
+  cache.Insert(key, time_now_ns, MakeRelativePlan(time_now_ns), probe_time_ns,
+               MakeRelativePlan(probe_time_ns));
+
+  const int64_t later_ns = time_now_ns + 5'000'000'123;
+  auto plan = cache.Lookup(key, later_ns, &should_insert);
+  ASSERT_TRUE(plan.has_value());
+  EXPECT_FALSE(should_insert);
+  EXPECT_THAT(plan.value(),
+              EqualsProto(PlanText("http_events", later_ns - kFiveMinutesNs, later_ns)));
+
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(2, cache.misses());
+}
+
+TEST(PlanCacheTest, AbsoluteTimesAreNotShifted) {
+  PlanCache cache(/* capacity */ 8);
+  const PlanCacheKey key = PlanCache::Key(MakeQueryRequest("query"));
+  bool should_insert;
+  cache.Lookup(key, 0, &should_insert);
+
+  const int64_t start_time_ns = 1'000'000;
+  const int64_t time_now_ns = 2 * PlanCache::kProbeOffsetNs;
+  const int64_t probe_time_ns = time_now_ns - PlanCache::kProbeOffsetNs;
+  cache.Insert(key, time_now_ns, MakePlan("http_events", start_time_ns, time_now_ns),
+               probe_time_ns, MakePlan("http_events", start_time_ns, probe_time_ns));
+
+  const int64_t later_ns = time_now_ns + 1;
+  auto plan = cache.Lookup(key, later_ns, &should_insert);
+  ASSERT_TRUE(plan.has_value());
+  EXPECT_THAT(plan.value(), EqualsProto(PlanText("http_events", start_time_ns, later_ns)));
+}
+
+TEST(PlanCacheTest, RejectsPlansThatDifferOtherwise) {
+  PlanCache cache(/* capacity */ 8);
+  const PlanCacheKey key = PlanCache::Key(MakeQueryRequest("query"));
+  bool should_insert;
+  cache.Lookup(key, 0, &should_insert);
+
+  const int64_t time_now_ns = 2 * PlanCache::kProbeOffsetNs;
+  const int64_t probe_time_ns = time_now_ns - PlanCache::kProbeOffsetNs;
+  cache.Insert(key, time_now_ns, MakePlan("http_events", 0, time_now_ns), probe_time_ns,
+               MakePlan("conn_stats", 0, probe_time_ns));
+
+  EXPECT_FALSE(cache.Lookup(key, time_now_ns, &should_insert).has_value());
+  // Known to be uncacheable, so it shouldn't be compiled at the probe time again.
+  EXPECT_FALSE(should_insert);
+}
+
+TEST(PlanCacheTest, RejectsTimesThatDontMoveWithTheCompileTime) {
+  PlanCache cache(/* capacity */ 8);
+  const PlanCacheKey key = PlanCache::Key(MakeQueryRequest("query"));
+  bool should_insert;
+  cache.Lookup(key, 0, &should_insert);
+
+  // A start time rounded down to the hour moves by less than the probe offset.
+  const int64_t hour_ns = 12 * kFiveMinutesNs;
+  const int64_t time_now_ns = 2 * PlanCache::kProbeOffsetNs;
+  const int64_t probe_time_ns = time_now_ns - PlanCache::kProbeOffsetNs;
+  cache.Insert(key, time_now_ns, MakePlan("http_events", time_now_ns / hour_ns * hour_ns, 0),
+               probe_time_ns, MakePlan("http_events", probe_time_ns / hour_ns * hour_ns, 0));
+
+  EXPECT_FALSE(cache.Lookup(key, time_now_ns, &should_insert).has_value());
+  EXPECT_FALSE(should_insert);
+}
+
+TEST(PlanCacheTest, EvictsLeastRecentlyUsed) {
+  PlanCache cache(/* capacity */ 2);
+  const PlanCacheKey key_a = PlanCache::Key(MakeQueryRequest("a"));
+  const PlanCacheKey key_b = PlanCache::Key(MakeQueryRequest("b"));
+  const PlanCacheKey key_c = PlanCache::Key(MakeQueryRequest("c"));
+  bool should_insert;
+
+  cache.Lookup(key_a, 0, &should_insert);
+  cache.Lookup(key_b, 0, &should_insert);
+  cache.Lookup(key_a, 0, &should_insert);
+  EXPECT_TRUE(should_insert);
+  cache.Lookup(key_c, 0, &should_insert);
+  EXPECT_EQ(2, cache.size());
+
+  // b was the least recently used query, so it's new again.
+  cache.Lookup(key_b, 0, &should_insert);
+  EXPECT_FALSE(should_insert);
+  // Looking b up evicted a.
+  cache.Lookup(key_a, 0, &should_insert);
+  EXPECT_FALSE(should_insert);
+}
+
+TEST(PlanCacheTest, ZeroCapacityDisablesTheCache) {
+  PlanCache cache(/* capacity */ 0);
+  const PlanCacheKey key = PlanCache::Key(MakeQueryRequest("query"));
+  bool should_insert;
+  cache.Lookup(key, 0, &should_insert);
+  cache.Lookup(key, 0, &should_insert);
+  EXPECT_FALSE(should_insert);
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(PlanCacheTest, KeyCoversTheWholeRequest) {
+  plannerpb::QueryRequest query_request = MakeQueryRequest("query");
+  auto* arg = query_request.add_exec_funcs()->add_arg_values();
+  arg->set_name("start_time");
+  arg->set_value("-5m");
+  const PlanCacheKey key = PlanCache::Key(query_request);
+  EXPECT_EQ(key, PlanCache::Key(query_request));
+
+  arg->set_value("-10m");
+  EXPECT_NE(key, PlanCache::Key(query_request));
+  EXPECT_NE(key, PlanCache::Key(MakeQueryRequest("query")));
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
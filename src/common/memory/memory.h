@@ -23,3 +23,4 @@
  */
 
 #include "src/common/memory/object_pool.h"  // IWYU pragma: export
+#include "src/common/memory/typed_arena.h"  // IWYU pragma: export
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/memory/typed_arena.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace px {
+
+class TestObject {
+ public:
+  TestObject() = delete;
+  TestObject(int id, std::vector<int>* destroyed) : id_(id), destroyed_(destroyed) {}
+  ~TestObject() { destroyed_->push_back(id_); }
+
+  int id() const { return id_; }
+
+ private:
+  int id_;
+  std::vector<int>* destroyed_;
+};
+
+TEST(TypedArenaTest, DestroysInReverseOrder) {
+  std::vector<int> destroyed;
+  {
+    TypedArena<TestObject> arena;
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(arena.New(i, &destroyed)->id(), i);
+    }
+    EXPECT_EQ(arena.size(), 100);
+    // Slabs of 32, 64 and 128 objects.
+    EXPECT_EQ(arena.num_slabs(), 3);
+    EXPECT_TRUE(destroyed.empty());
+  }
+  ASSERT_EQ(destroyed.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(destroyed[i], 99 - i);
+  }
+}
+
+TEST(TypedArenaTest, Clear) {
+  std::vector<int> destroyed;
+  TypedArena<TestObject> arena;
+  arena.New(0, &destroyed);
+  arena.New(1, &destroyed);
+  arena.Clear();
+  EXPECT_EQ(destroyed, std::vector<int>({1, 0}));
+  EXPECT_EQ(arena.size(), 0);
+  EXPECT_EQ(arena.num_slabs(), 0);
+
+  // The arena can be reused after being cleared.
+  arena.New(2, &destroyed);
+  EXPECT_EQ(arena.size(), 1);
+  arena.Clear();
+  EXPECT_EQ(destroyed, std::vector<int>({1, 0, 2}));
+}
+
+TEST(TypedArenaTest, ObjectsAreStable) {
+  TypedArena<std::string> arena;
+  std::vector<std::string*> strs;
+  for (int i = 0; i < 10000; ++i) {
+    strs.push_back(arena.New(std::to_string(i)));
+  }
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_EQ(*strs[i], std::to_string(i));
+  }
+}
+
+struct alignas(64) AlignedObject {
+  int64_t value;
+};
+
+TEST(TypedArenaTest, TriviallyDestructibleAndAligned) {
+  TypedArena<AlignedObject> arena;
+  for (int i = 0; i < 100; ++i) {
+    AlignedObject* obj = arena.New(AlignedObject{i});
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(obj) % 64, 0);
+    EXPECT_EQ(obj->value, i);
+  }
+}
+
+}  // namespace px
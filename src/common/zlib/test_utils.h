@@ -0,0 +1,51 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <zlib.h>
+
+#include <string>
+#include <string_view>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace zlib {
+
+/**
+ * Compresses the data into the gzip format, which px::zlib::Inflate() reads. For tests only.
+ */
+inline std::string GZip(std::string_view data) {
+  z_stream zs = {};
+  CHECK_EQ(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8,
+                        Z_DEFAULT_STRATEGY),
+           Z_OK);
+  std::string compressed(deflateBound(&zs, data.size()), '\0');
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  zs.avail_in = data.size();
+  zs.next_out = reinterpret_cast<Bytef*>(compressed.data());
+  zs.avail_out = compressed.size();
+  CHECK_EQ(deflate(&zs, Z_FINISH), Z_STREAM_END);
+  compressed.resize(zs.total_out);
+  deflateEnd(&zs);
+  return compressed;
+}
+
+}  // namespace zlib
+}  // namespace px
@@ -17,6 +17,8 @@
  */
 
 #include <zlib.h>
+#include <algorithm>
+#include <limits>
 #include <string>
 
 #include "src/common/base/base.h"
@@ -25,6 +27,37 @@
 namespace px {
 namespace zlib {
 
+namespace {
+
+constexpr size_t kOutputBlockSize = 16384;
+
+// A z_stream for gzip decompression that is reset instead of re-created for each input, which keeps
+// the inflate state and window allocated across calls.
+class GZipInflateStream {
+ public:
+  GZipInflateStream() : init_ret_(inflateInit2(&zs_, MAX_WBITS + 16)) {}
+
+  ~GZipInflateStream() {
+    if (init_ret_ == Z_OK) {
+      inflateEnd(&zs_);
+    }
+  }
+
+  // Returns the stream ready for a new input, or nullptr if it could not be initialized.
+  z_stream* Reset() {
+    if (init_ret_ != Z_OK || inflateReset(&zs_) != Z_OK) {
+      return nullptr;
+    }
+    return &zs_;
+  }
+
+ private:
+  z_stream zs_ = {};
+  const int init_ret_;
+};
+
+}  // namespace
+
 StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
   z_stream zs = {};
 
@@ -60,5 +93,46 @@ StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
   return out;
 }
 
+StatusOr<std::string> InflatePrefix(std::string_view in, size_t max_output_bytes,
+                                    bool* output_truncated) {
+  thread_local GZipInflateStream stream;
+
+  z_stream* zs = stream.Reset();
+  if (zs == nullptr) {
+    return error::Internal("inflateInit2 failed while decompressing.");
+  }
+
+  zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs->avail_in = in.size();
+
+  // Decompress one byte beyond the limit, to tell if the content is longer than the limit.
+  const size_t out_limit = max_output_bytes < std::numeric_limits<size_t>::max()
+                               ? max_output_bytes + 1
+                               : max_output_bytes;
+
+  int ret;
+  std::string out;
+
+  // The output is only allocated up to the limit, so it is written to directly.
+  do {
+    out.resize(out.size() + std::min(kOutputBlockSize, out_limit - out.size()));
+    zs->next_out = reinterpret_cast<Bytef*>(out.data() + zs->total_out);
+    zs->avail_out = out.size() - zs->total_out;
+
+    ret = inflate(zs, Z_NO_FLUSH);
+  } while (ret == Z_OK && zs->total_out < out_limit);
+
+  const bool truncated = zs->total_out > max_output_bytes;
+  if (ret != Z_STREAM_END && !truncated) {
+    return error::Internal("Exception during zlib decompression: $0", zs->msg);
+  }
+
+  out.resize(std::min<size_t>(zs->total_out, max_output_bytes));
+  if (output_truncated != nullptr) {
+    *output_truncated = truncated;
+  }
+  return out;
+}
+
 }  // namespace zlib
 }  // namespace px
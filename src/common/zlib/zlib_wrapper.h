@@ -35,5 +35,21 @@ namespace zlib {
  */
 StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384);
 
+/**
+ * @brief Inflates (gunzip) a source buffer like Inflate(), but stops after max_output_bytes bytes
+ * of decompressed content. Use this when only a prefix of the content is kept, so that large
+ * compressed inputs do not cost the CPU and memory to decompress them entirely.
+ *
+ * The z_stream is reused by the calls on the same thread.
+ *
+ * @param in A view into the source buffer.
+ * @param max_output_bytes The maximal size of the returned content.
+ * @param output_truncated If not null, set to whether the content is longer than max_output_bytes.
+ * @return Status or the first max_output_bytes bytes of the decompressed content. Errors in the
+ *         source buffer after that point are not detected.
+ */
+StatusOr<std::string> InflatePrefix(std::string_view in, size_t max_output_bytes,
+                                    bool* output_truncated = nullptr);
+
 }  // namespace zlib
 }  // namespace px
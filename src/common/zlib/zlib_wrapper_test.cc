@@ -17,10 +17,10 @@
  */
 
 #include "src/common/zlib/zlib_wrapper.h"
-#include <zlib.h>
 #include <string>
 
 #include "src/common/testing/testing.h"
+#include "src/common/zlib/test_utils.h"
 
 namespace px {
 
@@ -46,4 +46,46 @@ TEST_F(ZlibTest, inflate_test) {
   EXPECT_OK_AND_EQ(result, GetExpectedResult());
 }
 
+TEST_F(ZlibTest, inflate_prefix_test) {
+  bool truncated = true;
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(GetCompressedString(), 100, &truncated),
+                   GetExpectedResult());
+  EXPECT_FALSE(truncated);
+
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(GetCompressedString(), GetExpectedResult().size(),
+                                           &truncated),
+                   GetExpectedResult());
+  EXPECT_FALSE(truncated);
+
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(GetCompressedString(), 7, &truncated), "This is");
+  EXPECT_TRUE(truncated);
+
+  // Corruption after the prefix is not detected.
+  std::string corrupted = GetCompressedString();
+  corrupted.resize(corrupted.size() - 4);
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(corrupted, 4, &truncated), "This");
+  EXPECT_TRUE(truncated);
+  EXPECT_NOT_OK(px::zlib::InflatePrefix(corrupted, 100));
+
+  // The stream reused by the next call is not affected by the error.
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(GetCompressedString(), 100), GetExpectedResult());
+}
+
+TEST_F(ZlibTest, inflate_prefix_of_large_content) {
+  std::string content;
+  for (int i = 0; content.size() < 100000; ++i) {
+    content.append(std::to_string(i));
+  }
+  const std::string compressed = px::zlib::GZip(content);
+
+  bool truncated = false;
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(compressed, 512, &truncated), content.substr(0, 512));
+  EXPECT_TRUE(truncated);
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(compressed, 50000, &truncated),
+                   content.substr(0, 50000));
+  EXPECT_TRUE(truncated);
+  EXPECT_OK_AND_EQ(px::zlib::InflatePrefix(compressed, content.size(), &truncated), content);
+  EXPECT_FALSE(truncated);
+}
+
 }  // namespace px
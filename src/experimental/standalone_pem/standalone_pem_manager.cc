@@ -123,6 +123,9 @@ Status StandalonePEMManager::Init() {
   stirling_->RegisterDataPushCallback(std::bind(&table_store::TableStore::AppendData, table_store_,
                                                 std::placeholders::_1, std::placeholders::_2,
                                                 std::placeholders::_3));
+  stirling_->RegisterArrowDataPushCallback(
+      std::bind(&table_store::TableStore::AppendArrowData, table_store_, std::placeholders::_1,
+                std::placeholders::_2, std::placeholders::_3));
 
   // Enable use of USR1/USR2 for controlling Stirling debug.
   stirling_->RegisterUserDebugSignalHandlers();
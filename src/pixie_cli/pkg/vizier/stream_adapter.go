@@ -351,6 +351,9 @@ func (v *StreamOutputAdapter) parseError(ctx context.Context, s *vizierpb.Status
 
 func (v *StreamOutputAdapter) handleExecutionStats(ctx context.Context, es *vizierpb.QueryExecutionStats) error {
 	v.execStats = es
+	for _, w := range es.Warnings {
+		utils.Errorf("Warning: %s", w)
+	}
 	return nil
 }
 
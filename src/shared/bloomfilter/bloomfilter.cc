@@ -17,8 +17,12 @@
  */
 
 #include <math.h>
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "src/common/base/base.h"
 #include "src/shared/bloomfilter/bloomfilter.h"
@@ -31,16 +35,54 @@ PX_SUPPRESS_WARNINGS_END()
 namespace px {
 namespace bloomfilter {
 
-StatusOr<std::unique_ptr<XXHash64BloomFilter>> XXHash64BloomFilter::Create(int64_t max_entries,
-                                                                           double error_rate) {
+namespace {
+
+// Odd constants from the Parquet split block bloom filter, that scatter the bit each word gets.
+constexpr uint32_t kSalt[SplitBlockBloomFilter::kWordsPerBlock] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+constexpr uint64_t kSplitBlockSeed = 3091990;
+
+// Beyond this many bits per entry, the error rate of a split block filter (about 1e-6 here) only
+// falls slowly, and XXHash64BloomFilter is much smaller for the same error rate.
+constexpr double kMaxSplitBlockBitsPerEntry = 64;
+
+// The expected false positive rate of a split block filter with the given number of bits per
+// entry. The number of entries that land in a block is Poisson distributed, and a block holding k
+// entries answers a lookup with a false positive with probability (1 - (31/32)^k)^8.
+double SplitBlockErrorRate(double bits_per_entry) {
+  constexpr int kBitsPerBlock = SplitBlockBloomFilter::kBytesPerBlock * 8;
+  double lambda = kBitsPerBlock / bits_per_entry;
+  // Sum up to well past the mean, where the remaining terms no longer matter.
+  int max_k = static_cast<int>(lambda + 10 * std::sqrt(lambda) + 10);
+  double poisson = std::exp(-lambda);
+  double rate = 0;
+  for (int k = 1; k <= max_k; ++k) {
+    poisson *= lambda / k;
+    double bit_set = 1 - std::pow(1 - 1.0 / 32, k);
+    rate += poisson * std::pow(bit_set, SplitBlockBloomFilter::kWordsPerBlock);
+  }
+  return rate;
+}
+
+Status CheckSizeArgs(int64_t max_entries, double error_rate) {
   if (error_rate <= 0.0 || error_rate >= 1.0) {
     return error::Internal(
-        "Bloom filter error rate must be greater than 0 and less than 1, received %e", error_rate);
+        "Bloom filter error rate must be greater than 0 and less than 1, received $0", error_rate);
   }
   if (max_entries <= 0) {
-    return error::Internal("Bloom filter must have a maximum of at least 1 entry, received %d",
+    return error::Internal("Bloom filter must have a maximum of at least 1 entry, received $0",
                            max_entries);
   }
+  return Status::OK();
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<XXHash64BloomFilter>> XXHash64BloomFilter::Create(int64_t max_entries,
+                                                                           double error_rate) {
+  PX_RETURN_IF_ERROR(CheckSizeArgs(max_entries, error_rate));
 
   // From Wikipedia: https://en.wikipedia.org/wiki/Bloom_filter
   // bits per entry = ln(error_rate)/ln(2)^2
@@ -89,9 +131,19 @@ bool XXHash64BloomFilter::HasBitSet(int bit_number) const {
   return buffer_[byte_index] & mask;
 }
 
-void XXHash64BloomFilter::Insert(std::string_view item) {
-  uint64_t a = XXH64(item.data(), item.size(), seed_);
+XXHash64BloomFilter::HashedItem XXHash64BloomFilter::Hash(std::string_view item) {
+  uint64_t a = XXH64(item.data(), item.size(), kSeed);
   uint64_t b = XXH64(item.data(), item.size(), a);
+  return {a, b};
+}
+
+bool XXHash64BloomFilter::MatchesProto(const XXHash64BloomFilterPB& pb) const {
+  return pb.num_hashes() == num_hashes_ && pb.data().size() == buffer_.size() &&
+         std::memcmp(pb.data().data(), buffer_.data(), buffer_.size()) == 0;
+}
+
+void XXHash64BloomFilter::Insert(std::string_view item) {
+  auto [a, b] = Hash(item);
 
   for (auto i = 0; i < num_hashes_; ++i) {
     // Use int128 because the combination of uint64s below (the underyling type of XXH64) could
@@ -102,12 +154,11 @@ void XXHash64BloomFilter::Insert(std::string_view item) {
   }
 }
 
-bool XXHash64BloomFilter::Contains(std::string_view item) const {
-  uint64_t a = XXH64(item.data(), item.size(), seed_);
-  uint64_t b = XXH64(item.data(), item.size(), a);
+bool XXHash64BloomFilter::Contains(std::string_view item) const { return Contains(Hash(item)); }
 
+bool XXHash64BloomFilter::Contains(const HashedItem& item) const {
   for (auto i = 0; i < num_hashes_; ++i) {
-    absl::uint128 x = a + i * b;
+    absl::uint128 x = item.a + i * item.b;
     int bit_number = static_cast<int>(x % (buffer_.size() << 3));
     if (!HasBitSet(bit_number)) {
       return false;
@@ -116,5 +167,115 @@ bool XXHash64BloomFilter::Contains(std::string_view item) const {
   return true;
 }
 
+StatusOr<std::unique_ptr<SplitBlockBloomFilter>> SplitBlockBloomFilter::Create(int64_t max_entries,
+                                                                               double error_rate) {
+  PX_RETURN_IF_ERROR(CheckSizeArgs(max_entries, error_rate));
+  // The uneven load of the blocks makes the classic bloom filter sizing too optimistic, so search
+  // for the smallest bits per entry that meets the error rate instead.
+  double lo = 1;
+  double hi = kMaxSplitBlockBitsPerEntry;
+  if (SplitBlockErrorRate(hi) > error_rate) {
+    return error::InvalidArgument(
+        "SplitBlockBloomFilter can't meet an error rate of $0 with at most $1 bits per entry, the "
+        "lowest error rate it supports is $2",
+        error_rate, kMaxSplitBlockBitsPerEntry, SplitBlockErrorRate(hi));
+  }
+  for (int i = 0; i < 32; ++i) {
+    double mid = (lo + hi) / 2;
+    if (SplitBlockErrorRate(mid) > error_rate) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  int64_t num_bits = static_cast<int64_t>(std::ceil(max_entries * hi));
+  int64_t bits_per_block = kBytesPerBlock * 8;
+  int64_t num_blocks = std::max<int64_t>(1, (num_bits + bits_per_block - 1) / bits_per_block);
+  return std::unique_ptr<SplitBlockBloomFilter>(new SplitBlockBloomFilter(num_blocks));
+}
+
+StatusOr<std::unique_ptr<SplitBlockBloomFilter>> SplitBlockBloomFilter::FromProto(
+    const SplitBlockBloomFilterPB& pb) {
+  if (pb.version() != kVersion) {
+    return error::Internal("Unsupported SplitBlockBloomFilter version $0, expected $1",
+                           pb.version(), kVersion);
+  }
+  const std::string& data = pb.data();
+  if (data.empty() || data.size() % kBytesPerBlock != 0) {
+    return error::Internal("SplitBlockBloomFilter data must be a non-zero multiple of $0 bytes, "
+                           "received $1 bytes",
+                           kBytesPerBlock, data.size());
+  }
+  std::unique_ptr<SplitBlockBloomFilter> bf(
+      new SplitBlockBloomFilter(data.size() / kBytesPerBlock));
+  // The words are serialized in little-endian order, which is the native order on the supported
+  // platforms.
+  std::memcpy(bf->blocks_.data(), data.data(), data.size());
+  return bf;
+}
+
+SplitBlockBloomFilterPB SplitBlockBloomFilter::ToProto() const {
+  SplitBlockBloomFilterPB output;
+  output.set_version(kVersion);
+  output.set_data(reinterpret_cast<const char*>(blocks_.data()), buffer_size_bytes());
+  return output;
+}
+
+uint64_t SplitBlockBloomFilter::Hash(std::string_view item) {
+  return XXH64(item.data(), item.size(), kSplitBlockSeed);
+}
+
+void SplitBlockBloomFilter::Mask(uint32_t key, Block* mask) {
+  // Written as independent lanes so that the compiler vectorizes it.
+  for (int i = 0; i < kWordsPerBlock; ++i) {
+    mask->words[i] = uint32_t{1} << ((key * kSalt[i]) >> 27);
+  }
+}
+
+void SplitBlockBloomFilter::InsertHash(uint64_t hash) {
+  Block mask;
+  Mask(static_cast<uint32_t>(hash), &mask);
+  Block& block = blocks_[BlockIndex(hash)];
+  for (int i = 0; i < kWordsPerBlock; ++i) {
+    block.words[i] |= mask.words[i];
+  }
+}
+
+bool SplitBlockBloomFilter::ContainsHash(uint64_t hash) const {
+  Block mask;
+  Mask(static_cast<uint32_t>(hash), &mask);
+  const Block& block = blocks_[BlockIndex(hash)];
+  uint32_t missing = 0;
+  for (int i = 0; i < kWordsPerBlock; ++i) {
+    missing |= ~block.words[i] & mask.words[i];
+  }
+  return missing == 0;
+}
+
+void SplitBlockBloomFilter::InsertBatch(const std::vector<std::string_view>& items) {
+  std::vector<uint64_t> hashes(items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    hashes[i] = Hash(items[i]);
+    __builtin_prefetch(&blocks_[BlockIndex(hashes[i])], /*rw*/ 1);
+  }
+  for (uint64_t hash : hashes) {
+    InsertHash(hash);
+  }
+}
+
+std::vector<bool> SplitBlockBloomFilter::ContainsBatch(
+    const std::vector<std::string_view>& items) const {
+  std::vector<uint64_t> hashes(items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    hashes[i] = Hash(items[i]);
+    __builtin_prefetch(&blocks_[BlockIndex(hashes[i])]);
+  }
+  std::vector<bool> result(items.size());
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    result[i] = ContainsHash(hashes[i]);
+  }
+  return result;
+}
+
 }  // namespace bloomfilter
 }  // namespace px
@@ -30,9 +30,19 @@ namespace px {
 namespace bloomfilter {
 
 using XXHash64BloomFilterPB = shared::bloomfilterpb::XXHash64BloomFilter;
+using SplitBlockBloomFilterPB = shared::bloomfilterpb::SplitBlockBloomFilter;
 
 class XXHash64BloomFilter {
  public:
+  /**
+   * The hashes of an item. They don't depend on the filter, so an item that is looked up in many
+   * filters only needs to be hashed once.
+   */
+  struct HashedItem {
+    uint64_t a;
+    uint64_t b;
+  };
+
   /**
    * Create creates a bloom filter which is sized to meet the criteria for maximum number of
    * entries and the false positive error rate. The false negative error rate is always 0.
@@ -54,6 +64,17 @@ class XXHash64BloomFilter {
    */
   bool Contains(std::string_view item) const;
   bool Contains(const std::string& item) const { return Contains(std::string_view(item)); }
+  bool Contains(const HashedItem& item) const;
+
+  /**
+   * Hash computes the hashes of an item that are used for Insert and Contains.
+   */
+  static HashedItem Hash(std::string_view item);
+
+  /**
+   * Returns true if the proto encodes exactly this bloom filter.
+   */
+  bool MatchesProto(const XXHash64BloomFilterPB& pb) const;
 
   /**
    * Get the buffer size in bytes of the bloom filter.
@@ -78,7 +99,83 @@ class XXHash64BloomFilter {
 
   const int num_hashes_;
   std::vector<uint8_t> buffer_;
-  const uint64_t seed_ = 3091990;
+  static constexpr uint64_t kSeed = 3091990;
+};
+
+/**
+ * SplitBlockBloomFilter is a bloom filter that is split into blocks of 256 bits. An item is mapped
+ * to one block, in which it sets one bit in each of the 8 32-bit words. A lookup therefore costs a
+ * single cache miss, rather than one per hash like in XXHash64BloomFilter, and the 8 words are
+ * checked with a few vector instructions.
+ *
+ * For the same size, the false positive rate is a bit higher than that of XXHash64BloomFilter, so
+ * Create() sizes the filter slightly larger for the same error rate.
+ */
+class SplitBlockBloomFilter {
+ public:
+  // The version of the layout written to the proto.
+  static constexpr uint32_t kVersion = 1;
+  static constexpr int kWordsPerBlock = 8;
+  static constexpr int kBytesPerBlock = kWordsPerBlock * sizeof(uint32_t);
+
+  /**
+   * Create creates a bloom filter which is sized to meet the criteria for maximum number of
+   * entries and the false positive error rate. The false negative error rate is always 0.
+   * Error rates below about 1e-6 are rejected with InvalidArgument; use XXHash64BloomFilter for
+   * those.
+   */
+  static StatusOr<std::unique_ptr<SplitBlockBloomFilter>> Create(int64_t max_entries,
+                                                                 double error_rate);
+  static StatusOr<std::unique_ptr<SplitBlockBloomFilter>> FromProto(
+      const SplitBlockBloomFilterPB& pb);
+  SplitBlockBloomFilterPB ToProto() const;
+
+  /**
+   * Hash computes the hash of an item. It doesn't depend on the filter, so an item that is looked
+   * up in many filters only needs to be hashed once.
+   */
+  static uint64_t Hash(std::string_view item);
+
+  void Insert(std::string_view item) { InsertHash(Hash(item)); }
+  void InsertHash(uint64_t hash);
+
+  /**
+   * Contains checks for the presence of an item in the bloom filter. May return a false positive,
+   * but will not return a false negative.
+   */
+  bool Contains(std::string_view item) const { return ContainsHash(Hash(item)); }
+  bool ContainsHash(uint64_t hash) const;
+
+  /**
+   * Batch versions of Insert and Contains. All the items are hashed first, and their blocks are
+   * prefetched before they are accessed, so that the cache misses of different items overlap.
+   */
+  void InsertBatch(const std::vector<std::string_view>& items);
+  std::vector<bool> ContainsBatch(const std::vector<std::string_view>& items) const;
+
+  /**
+   * Get the buffer size in bytes of the bloom filter.
+   */
+  size_t buffer_size_bytes() const { return blocks_.size() * kBytesPerBlock; }
+
+  size_t num_blocks() const { return blocks_.size(); }
+
+ private:
+  struct alignas(kBytesPerBlock) Block {
+    uint32_t words[kWordsPerBlock];
+  };
+
+  explicit SplitBlockBloomFilter(size_t num_blocks) : blocks_(num_blocks) {}
+
+  // Picks the block of a hash from its upper 32 bits.
+  size_t BlockIndex(uint64_t hash) const {
+    return static_cast<size_t>(((hash >> 32) * blocks_.size()) >> 32);
+  }
+
+  // Sets the mask of the bits within each word of the block from the lower 32 bits of a hash.
+  static void Mask(uint32_t key, Block* mask);
+
+  std::vector<Block> blocks_;
 };
 
 }  // namespace bloomfilter
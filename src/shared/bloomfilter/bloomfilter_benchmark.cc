@@ -21,6 +21,8 @@
 #include <absl/container/flat_hash_map.h>
 #include <map>
 #include <random>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -74,10 +76,82 @@ BENCHMARK_DEFINE_F(BloomFilterBenchmark, LookupTest)(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations() * random_strs_.size());
 }
 
+class SplitBlockBloomFilterBenchmark : public benchmark::Fixture {
+  void SetUp(const ::benchmark::State& state) {
+    auto num_items = state.range(0);
+    auto error_rate = 1.0 / state.range(1);
+    auto strlen = state.range(2);
+    insert_bf_ = SplitBlockBloomFilter::Create(num_items * 2, error_rate).ConsumeValueOrDie();
+    lookup_bf_ = SplitBlockBloomFilter::Create(num_items * 2, error_rate).ConsumeValueOrDie();
+    random_strs_.reserve(num_items);
+    for (auto i = 0; i < num_items; ++i) {
+      random_strs_.push_back(datagen::RandomString(strlen));
+      lookup_bf_->Insert(random_strs_[i]);
+    }
+    random_str_views_.assign(random_strs_.begin(), random_strs_.end());
+  }
+
+ protected:
+  std::vector<std::string> random_strs_;
+  std::vector<std::string_view> random_str_views_;
+  std::unique_ptr<SplitBlockBloomFilter> insert_bf_;
+  std::unique_ptr<SplitBlockBloomFilter> lookup_bf_;
+};
+
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_DEFINE_F(SplitBlockBloomFilterBenchmark, InsertTest)(benchmark::State& state) {
+  for (auto _ : state) {
+    for (const auto& random_str : random_strs_) {
+      insert_bf_->Insert(random_str);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * random_strs_.size() * random_strs_[0].size());
+  state.SetItemsProcessed(state.iterations() * random_strs_.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_DEFINE_F(SplitBlockBloomFilterBenchmark, LookupTest)(benchmark::State& state) {
+  bool result = false;
+  for (auto _ : state) {
+    for (const auto& random_str : random_strs_) {
+      result = lookup_bf_->Contains(random_str);
+    }
+  }
+  PX_UNUSED(result);
+  state.SetBytesProcessed(state.iterations() * random_strs_.size() * random_strs_[0].size());
+  state.SetItemsProcessed(state.iterations() * random_strs_.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_DEFINE_F(SplitBlockBloomFilterBenchmark, BatchInsertTest)(benchmark::State& state) {
+  for (auto _ : state) {
+    insert_bf_->InsertBatch(random_str_views_);
+  }
+  state.SetBytesProcessed(state.iterations() * random_strs_.size() * random_strs_[0].size());
+  state.SetItemsProcessed(state.iterations() * random_strs_.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+BENCHMARK_DEFINE_F(SplitBlockBloomFilterBenchmark, BatchLookupTest)(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(lookup_bf_->ContainsBatch(random_str_views_));
+  }
+  state.SetBytesProcessed(state.iterations() * random_strs_.size() * random_strs_[0].size());
+  state.SetItemsProcessed(state.iterations() * random_strs_.size());
+}
+
 BENCHMARK_REGISTER_F(BloomFilterBenchmark, InsertTest)
     ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
 BENCHMARK_REGISTER_F(BloomFilterBenchmark, LookupTest)
     ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
+BENCHMARK_REGISTER_F(SplitBlockBloomFilterBenchmark, InsertTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
+BENCHMARK_REGISTER_F(SplitBlockBloomFilterBenchmark, LookupTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
+BENCHMARK_REGISTER_F(SplitBlockBloomFilterBenchmark, BatchInsertTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
+BENCHMARK_REGISTER_F(SplitBlockBloomFilterBenchmark, BatchLookupTest)
+    ->Ranges({{1 << 10, 1 << 20}, {10, 100000}, {8, 256}});
 
 }  // namespace bloomfilter
 }  // namespace px
@@ -18,6 +18,10 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
 #include "src/shared/bloomfilter/bloomfilter.h"
 
 namespace px {
@@ -113,5 +117,102 @@ TEST(XXHash64BloomFilter, test_create_from_proto) {
   }
 }
 
+TEST(SplitBlockBloomFilter, test_create) {
+  auto bf1 = SplitBlockBloomFilter::Create(10, 0.1).ConsumeValueOrDie();
+  EXPECT_EQ(bf1->num_blocks(), 1);
+  EXPECT_EQ(bf1->buffer_size_bytes(), 32);
+
+  auto bf2 = SplitBlockBloomFilter::Create(100000, 0.01).ConsumeValueOrDie();
+  EXPECT_EQ(bf2->num_blocks(), 4113);
+
+  EXPECT_NOT_OK(SplitBlockBloomFilter::Create(0, 0.01));
+  EXPECT_NOT_OK(SplitBlockBloomFilter::Create(10, 1.0));
+}
+
+TEST(SplitBlockBloomFilter, test_create_rejects_unreachable_error_rate) {
+  // The largest supported filter still has an error rate of about 1e-6.
+  auto bf_or = SplitBlockBloomFilter::Create(1000, 1e-7);
+  ASSERT_NOT_OK(bf_or);
+  EXPECT_EQ(bf_or.code(), px::statuspb::INVALID_ARGUMENT);
+
+  EXPECT_OK(SplitBlockBloomFilter::Create(1000, 2e-6));
+}
+
+TEST(SplitBlockBloomFilter, test_insert_contains) {
+  auto bf = SplitBlockBloomFilter::Create(10, 0.01).ConsumeValueOrDie();
+  EXPECT_FALSE(bf->Contains("foo"));
+  EXPECT_FALSE(bf->Contains("bar"));
+  bf->Insert("foo");
+  bf->Insert(std::string("bar"));
+  EXPECT_TRUE(bf->Contains("foo"));
+  EXPECT_TRUE(bf->Contains(std::string("bar")));
+  EXPECT_TRUE(bf->ContainsHash(SplitBlockBloomFilter::Hash("foo")));
+  EXPECT_FALSE(bf->Contains("not_present"));
+  EXPECT_FALSE(bf->Contains(""));
+}
+
+TEST(SplitBlockBloomFilter, test_batch) {
+  auto bf = SplitBlockBloomFilter::Create(1000, 0.001).ConsumeValueOrDie();
+  std::vector<std::string> strs;
+  for (int i = 0; i < 1000; ++i) {
+    strs.push_back(absl::StrCat("item-", i));
+  }
+  std::vector<std::string_view> inserted(strs.begin(), strs.begin() + 500);
+  std::vector<std::string_view> all(strs.begin(), strs.end());
+  bf->InsertBatch(inserted);
+
+  std::vector<bool> found = bf->ContainsBatch(all);
+  ASSERT_EQ(found.size(), all.size());
+  for (size_t i = 0; i < all.size(); ++i) {
+    EXPECT_EQ(found[i], bf->Contains(all[i]));
+    if (i < inserted.size()) {
+      EXPECT_TRUE(found[i]);
+    }
+  }
+}
+
+TEST(SplitBlockBloomFilter, test_error_rate) {
+  constexpr int kNumEntries = 10000;
+  for (double error_rate : {0.1, 0.01, 0.001, 0.0001}) {
+    auto bf = SplitBlockBloomFilter::Create(kNumEntries, error_rate).ConsumeValueOrDie();
+    for (int i = 0; i < kNumEntries; ++i) {
+      bf->Insert(absl::StrCat("present-", i));
+    }
+    constexpr int kNumLookups = 1000000;
+    int false_positives = 0;
+    for (int i = 0; i < kNumLookups; ++i) {
+      false_positives += bf->Contains(absl::StrCat("absent-", i));
+    }
+    // The filter is sized for the expected error rate, so leave some room for sampling noise.
+    EXPECT_LE(false_positives, kNumLookups * error_rate * 1.25) << error_rate;
+    EXPECT_GE(false_positives, kNumLookups * error_rate * 0.5) << error_rate;
+  }
+}
+
+TEST(SplitBlockBloomFilter, test_create_from_proto) {
+  auto bf = SplitBlockBloomFilter::Create(1000, 0.01).ConsumeValueOrDie();
+  bf->Insert("foo");
+  bf->Insert("bar");
+
+  auto proto = bf->ToProto();
+  EXPECT_EQ(proto.version(), SplitBlockBloomFilter::kVersion);
+  EXPECT_EQ(proto.data().size(), bf->buffer_size_bytes());
+  auto reconstructed = SplitBlockBloomFilter::FromProto(proto).ConsumeValueOrDie();
+  EXPECT_EQ(reconstructed->num_blocks(), bf->num_blocks());
+  EXPECT_TRUE(reconstructed->Contains("foo"));
+  EXPECT_TRUE(reconstructed->Contains("bar"));
+  EXPECT_FALSE(reconstructed->Contains("123"));
+
+  auto unknown_version = proto;
+  unknown_version.set_version(SplitBlockBloomFilter::kVersion + 1);
+  EXPECT_NOT_OK(SplitBlockBloomFilter::FromProto(unknown_version));
+
+  auto partial_block = proto;
+  partial_block.mutable_data()->pop_back();
+  EXPECT_NOT_OK(SplitBlockBloomFilter::FromProto(partial_block));
+
+  EXPECT_NOT_OK(SplitBlockBloomFilter::FromProto(SplitBlockBloomFilterPB()));
+}
+
 }  // namespace bloomfilter
 }  // namespace px
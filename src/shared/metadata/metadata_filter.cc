@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -62,6 +63,36 @@ bool AgentMetadataFilter::ContainsEntity(MetadataType key, std::string_view valu
   return Contains(ToEntityKeyPair(key, value));
 }
 
+AgentMetadataFilter::EntityProbe AgentMetadataFilter::PrepareProbe(MetadataType key,
+                                                                    std::string_view value) {
+  EntityProbe probe{key, ToEntityKeyPair(key, value), {}};
+  probe.hashed_entry = XXHash64BloomFilter::Hash(probe.entry);
+  return probe;
+}
+
+bool AgentMetadataFilter::ContainsEntity(const EntityProbe& probe) const {
+  if (!metadata_types_.contains(probe.key)) {
+    return false;
+  }
+  return ContainsProbe(probe);
+}
+
+bool AgentMetadataFilter::MatchesProto(const MetadataInfo& proto) const {
+  // The types are a set, but may be repeated in the proto.
+  for (const auto& type : proto.metadata_fields()) {
+    if (!metadata_types_.contains(static_cast<MetadataType>(type))) {
+      return false;
+    }
+  }
+  for (const auto& type : metadata_types_) {
+    if (std::find(proto.metadata_fields().begin(), proto.metadata_fields().end(), type) ==
+        proto.metadata_fields().end()) {
+      return false;
+    }
+  }
+  return MatchesProtoImpl(proto);
+}
+
 MetadataInfo AgentMetadataFilter::ToProto() {
   auto output = ToProtoImpl();
   for (const auto& type : metadata_types_) {
@@ -76,6 +107,15 @@ bool AgentMetadataFilterImpl::Contains(std::string_view val) const {
   return bloomfilter_->Contains(val);
 }
 
+bool AgentMetadataFilterImpl::ContainsProbe(const EntityProbe& probe) const {
+  return bloomfilter_->Contains(probe.hashed_entry);
+}
+
+bool AgentMetadataFilterImpl::MatchesProtoImpl(const MetadataInfo& proto) const {
+  return proto.filter_case() == MetadataInfo::FilterCase::kXxhash64BloomFilter &&
+         bloomfilter_->MatchesProto(proto.xxhash64_bloom_filter());
+}
+
 MetadataInfo AgentMetadataFilterImpl::ToProtoImpl() const {
   MetadataInfo output;
   *(output.mutable_xxhash64_bloom_filter()) = bloomfilter_->ToProto();
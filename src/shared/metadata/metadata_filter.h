@@ -79,16 +79,39 @@ class AgentMetadataFilter {
    */
   bool ContainsEntity(MetadataType key, std::string_view value) const;
 
+  /**
+   * A key/value pair prepared for lookups in the filters of many agents, so that the work that
+   * doesn't depend on the filter (building and hashing the entry) is only done once.
+   */
+  struct EntityProbe {
+    MetadataType key;
+    std::string entry;
+    XXHash64BloomFilter::HashedItem hashed_entry;
+  };
+  static EntityProbe PrepareProbe(MetadataType key, std::string_view value);
+
+  /**
+   * Same as ContainsEntity(probe.key, value) for the value the probe was prepared with.
+   */
+  bool ContainsEntity(const EntityProbe& probe) const;
+
+  /**
+   * Returns true if the proto encodes exactly this filter, so that it needn't be decoded again.
+   */
+  bool MatchesProto(const MetadataInfo& proto) const;
+
   /**
    * Get the registered metadata keys that are stored in this filter.
    */
-  absl::flat_hash_set<MetadataType> metadata_types() const { return metadata_types_; }
+  const absl::flat_hash_set<MetadataType>& metadata_types() const { return metadata_types_; }
   // Used to track changes in the filter.
   int64_t epoch_id() const { return epoch_id_; }
 
  protected:
   virtual void Insert(std::string_view value) = 0;
   virtual bool Contains(std::string_view value) const = 0;
+  virtual bool ContainsProbe(const EntityProbe& probe) const { return Contains(probe.entry); }
+  virtual bool MatchesProtoImpl(const MetadataInfo& proto) const = 0;
 
   /**
    * Creates an proto, excluding the metadata_fields field which is taken care of by the
@@ -117,6 +140,8 @@ class AgentMetadataFilterImpl : public AgentMetadataFilter {
  protected:
   void Insert(std::string_view entity) override;
   bool Contains(std::string_view entity) const override;
+  bool ContainsProbe(const EntityProbe& probe) const override;
+  bool MatchesProtoImpl(const MetadataInfo& proto) const override;
   MetadataInfo ToProtoImpl() const override;
 
  private:
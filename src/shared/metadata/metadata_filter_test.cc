@@ -58,5 +58,51 @@ TEST(AgentMetadataFilter, test_proto) {
   EXPECT_FALSE(deserialized->ContainsEntity(MetadataType::POD_NAME, "bar"));
 }
 
+TEST(AgentMetadataFilter, test_probe) {
+  auto filter =
+      AgentMetadataFilter::Create(100, 0.01, {MetadataType::POD_NAME, MetadataType::CONTAINER_ID})
+          .ConsumeValueOrDie();
+  EXPECT_OK(filter->InsertEntity(MetadataType::POD_NAME, "foo"));
+
+  auto probe = AgentMetadataFilter::PrepareProbe(MetadataType::POD_NAME, "foo");
+  EXPECT_TRUE(filter->ContainsEntity(probe));
+  EXPECT_FALSE(
+      filter->ContainsEntity(AgentMetadataFilter::PrepareProbe(MetadataType::POD_NAME, "bar")));
+  EXPECT_FALSE(
+      filter->ContainsEntity(AgentMetadataFilter::PrepareProbe(MetadataType::CONTAINER_ID, "foo")));
+  // The type is not stored in the filter, even though the entry for it would be.
+  EXPECT_FALSE(
+      filter->ContainsEntity(AgentMetadataFilter::PrepareProbe(MetadataType::SERVICE_NAME, "foo")));
+
+  auto deserialized = AgentMetadataFilter::FromProto(filter->ToProto()).ConsumeValueOrDie();
+  EXPECT_TRUE(deserialized->ContainsEntity(probe));
+}
+
+TEST(AgentMetadataFilter, test_matches_proto) {
+  auto filter =
+      AgentMetadataFilter::Create(100, 0.01, {MetadataType::POD_NAME, MetadataType::CONTAINER_ID})
+          .ConsumeValueOrDie();
+  EXPECT_OK(filter->InsertEntity(MetadataType::POD_NAME, "foo"));
+  auto proto = filter->ToProto();
+  EXPECT_TRUE(filter->MatchesProto(proto));
+
+  auto repeated_type = proto;
+  repeated_type.add_metadata_fields(MetadataType::POD_NAME);
+  EXPECT_TRUE(filter->MatchesProto(repeated_type));
+
+  auto missing_type = proto;
+  missing_type.clear_metadata_fields();
+  missing_type.add_metadata_fields(MetadataType::POD_NAME);
+  EXPECT_FALSE(filter->MatchesProto(missing_type));
+
+  auto extra_type = proto;
+  extra_type.add_metadata_fields(MetadataType::SERVICE_NAME);
+  EXPECT_FALSE(filter->MatchesProto(extra_type));
+
+  EXPECT_OK(filter->InsertEntity(MetadataType::POD_NAME, "bar"));
+  EXPECT_FALSE(filter->MatchesProto(proto));
+  EXPECT_TRUE(filter->MatchesProto(filter->ToProto()));
+}
+
 }  // namespace md
 }  // namespace px
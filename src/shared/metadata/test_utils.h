@@ -38,6 +38,7 @@ class TestAgentMetadataFilter : public AgentMetadataFilter {
     return std::find(inserted_entities_.begin(), inserted_entities_.end(), value) !=
            inserted_entities_.end();
   }
+  bool MatchesProtoImpl(const MetadataInfo&) const override { return false; }
   MetadataInfo ToProtoImpl() const override {
     CHECK(false) << "Unimplemented method ToProtoImpl for test class TestAgentMetadataFilter.";
   }
@@ -44,6 +44,9 @@ inline Status StatusAdapter<arrow::Status>(const arrow::Status& s) noexcept {
 
 namespace types {
 
+// A record batch as a vector of arrow arrays, one per column, all of the same length.
+using ArrowArrayRecordBatch = std::vector<std::shared_ptr<arrow::Array>>;
+
 // The functions convert vector of UDF values to an arrow representation on
 // the given MemoryPool.
 template <typename TUDFValue>
@@ -21,20 +21,30 @@
 #include <linux/perf_event.h>
 #include <sys/mount.h>
 
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include <magic_enum.hpp>
 
 #include "src/common/base/base.h"
 #include "src/common/fs/fs_wrapper.h"
+#include "src/common/metrics/metrics.h"
+#include "src/common/perf/elapsed_timer.h"
 #include "src/common/perf/scoped_timer.h"
 #include "src/common/system/config.h"
 #include "src/common/system/kernel_version.h"
 #include "src/stirling/bpf_tools/rr/rr.h"
+#include "src/stirling/bpf_tools/task_struct_offsets_cache.h"
 #include "src/stirling/bpf_tools/task_struct_resolver.h"
 #include "src/stirling/utils/linux_headers.h"
 
+DEFINE_string(stirling_task_struct_offsets_cache_dir,
+              gflags::StringFromEnv("PL_STIRLING_TASK_STRUCT_OFFSETS_CACHE_DIR", ""),
+              "If set, the task_struct offsets that a BPF program resolves are kept in this local "
+              "directory, and reused across restarts while the kernel doesn't change.");
+
 namespace px {
 namespace stirling {
 namespace bpf_tools {
@@ -72,6 +82,39 @@ Status MountDebugFS() {
   return Status::OK();
 }
 
+namespace {
+
+// Returns the task_struct offsets cache, or nullptr if it is disabled or could not be opened.
+TaskStructOffsetsCache* GetTaskStructOffsetsCache() {
+  static std::unique_ptr<TaskStructOffsetsCache> cache =
+      []() -> std::unique_ptr<TaskStructOffsetsCache> {
+    if (FLAGS_stirling_task_struct_offsets_cache_dir.empty()) {
+      return nullptr;
+    }
+    auto cache_or = TaskStructOffsetsCache::Create(FLAGS_stirling_task_struct_offsets_cache_dir);
+    if (!cache_or.ok()) {
+      LOG(WARNING) << absl::Substitute(
+          "Could not open task_struct offsets cache, continuing without: $0", cache_or.msg());
+      return nullptr;
+    }
+    return cache_or.ConsumeValueOrDie();
+  }();
+  return cache.get();
+}
+
+// Adds the time spent in a phase of BPF program initialization to its counter.
+// The phases are few and fixed, so they are exported as a label.
+void RecordInitPhaseTime(std::string_view phase, const ElapsedTimer& timer) {
+  static auto& family =
+      BuildCounterFamily("stirling_bpf_init_phase_time_us",
+                         "Total time (in microseconds) spent in each phase of initializing BPF "
+                         "programs: finding linux headers, resolving task_struct offsets and "
+                         "compiling.");
+  family.Add({{"phase", std::string(phase)}}).Increment(timer.ElapsedTime_us());
+}
+
+}  // namespace
+
 StatusOr<utils::TaskStructOffsets> ResolveTaskStructOffsetsWithRetry() {
   constexpr int kNumAttempts = 3;
 
@@ -91,8 +134,21 @@ StatusOr<utils::TaskStructOffsets> BCCWrapper::ComputeTaskStructOffsets() {
     return task_struct_offsets_opt_.value();
   }
 
-  LOG(INFO) << "Resolving task_struct offsets.";
-  PX_ASSIGN_OR_RETURN(task_struct_offsets_opt_, ResolveTaskStructOffsetsWithRetry());
+  TaskStructOffsetsCache* cache = GetTaskStructOffsetsCache();
+  StatusOr<std::string> kernel_id = RunningKernelIdentity();
+  if (cache == nullptr || !kernel_id.ok()) {
+    LOG(INFO) << "Resolving task_struct offsets.";
+    PX_ASSIGN_OR_RETURN(task_struct_offsets_opt_, ResolveTaskStructOffsetsWithRetry());
+  } else {
+    // Resolving the offsets compiles and runs a BPF program, but they only depend on the kernel
+    // build, so they are cached.
+    auto resolve = []() -> StatusOr<utils::TaskStructOffsets> {
+      LOG(INFO) << "Resolving task_struct offsets.";
+      return ResolveTaskStructOffsetsWithRetry();
+    };
+    PX_ASSIGN_OR_RETURN(task_struct_offsets_opt_,
+                        cache->GetOrResolve(kernel_id.ValueOrDie(), resolve));
+  }
 
   LOG(INFO) << absl::Substitute("Successfully resolved task_struct offsets: $0",
                                 task_struct_offsets_opt_.value().ToString());
@@ -115,7 +171,10 @@ Status BCCWrapperImpl::InitBPFProgram(std::string_view bpf_program, std::vector<
     // already run this function, it will find the same headers as found or installed previously.
     // NOTE: Considered calling from  Stirling Init(), but this requires test cases to explicitly
     // call FindOrInstallLinuxHeaders(), thus it is deemed to be better here.
+    ElapsedTimer headers_timer;
+    headers_timer.Start();
     PX_RETURN_IF_ERROR(utils::FindOrInstallLinuxHeaders());
+    RecordInitPhaseTime("linux_headers", headers_timer);
 
     // When Linux headers are requested, the BPF code requires various defines to compile:
     //  - START_BOOTTIME_VARNAME: The name of the task_struct variable containing the boottime.
@@ -142,7 +201,10 @@ Status BCCWrapperImpl::InitBPFProgram(std::string_view bpf_program, std::vector<
     // There is a flag to force the task struct fields resolution, in case we don't trust the
     // local headers, and for testing purposes.
     if (utils::g_packaged_headers_installed || always_infer_task_struct_offsets) {
+      ElapsedTimer offsets_timer;
+      offsets_timer.Start();
       auto offsets_or = ComputeTaskStructOffsets();
+      RecordInitPhaseTime("task_struct_offsets", offsets_timer);
       if (offsets_or.ok()) {
         offsets = offsets_or.ConsumeValueOrDie();
       } else {
@@ -165,7 +227,10 @@ Status BCCWrapperImpl::InitBPFProgram(std::string_view bpf_program, std::vector<
   {
     LOG(INFO) << "Initializing BPF program ...";
     ScopedTimer timer("init_bpf_program");
+    ElapsedTimer compile_timer;
+    compile_timer.Start();
     auto init_res = bpf_.init(std::string(bpf_program), cflags);
+    RecordInitPhaseTime("compile", compile_timer);
     if (!init_res.ok()) {
       return error::Internal("Unable to initialize BCC BPF program: $0", init_res.msg());
     }
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/bpf_tools/task_struct_offsets_cache.h"
+
+#include <cstring>
+#include <utility>
+
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/common/system/proc_pid_path.h"
+
+#include "xxhash.h"
+
+namespace px {
+namespace stirling {
+namespace bpf_tools {
+
+using utils::TaskStructOffsets;
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'X', 'T', 'S', 'O', 'F', 'F', 'S'};
+// Bump whenever the resolution of the offsets changes, so that offsets cached by older agents are
+// resolved again.
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t offsets_size;
+  uint64_t kernel_id_digest;
+  uint64_t checksum;
+};
+
+uint64_t KernelIdDigest(std::string_view kernel_id) {
+  return XXH64(kernel_id.data(), kernel_id.size(), 0);
+}
+
+}  // namespace
+
+StatusOr<std::string> RunningKernelIdentity() {
+  return ReadFileToString(system::ProcPath("version"));
+}
+
+StatusOr<std::unique_ptr<TaskStructOffsetsCache>> TaskStructOffsetsCache::Create(
+    const std::filesystem::path& dir) {
+  PX_RETURN_IF_ERROR(fs::CreateDirectories(dir));
+  return std::unique_ptr<TaskStructOffsetsCache>(new TaskStructOffsetsCache(dir / kFileName));
+}
+
+std::optional<TaskStructOffsets> TaskStructOffsetsCache::Lookup(std::string_view kernel_id) {
+  StatusOr<std::string> contents_or = ReadFileToString(path_.string());
+  if (!contents_or.ok()) {
+    ++stat_misses_;
+    return std::nullopt;
+  }
+  const std::string& contents = contents_or.ValueOrDie();
+
+  FileHeader header;
+  TaskStructOffsets offsets;
+  if (contents.size() != sizeof(header) + sizeof(offsets)) {
+    ++stat_misses_;
+    return std::nullopt;
+  }
+  std::memcpy(&header, contents.data(), sizeof(header));
+  std::memcpy(&offsets, contents.data() + sizeof(header), sizeof(offsets));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+      header.offsets_size != sizeof(offsets) ||
+      header.kernel_id_digest != KernelIdDigest(kernel_id) ||
+      header.checksum != XXH64(&offsets, sizeof(offsets), 0)) {
+    ++stat_misses_;
+    return std::nullopt;
+  }
+
+  ++stat_hits_;
+  return offsets;
+}
+
+Status TaskStructOffsetsCache::Store(std::string_view kernel_id,
+                                     const TaskStructOffsets& offsets) {
+  FileHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.offsets_size = sizeof(offsets);
+  header.kernel_id_digest = KernelIdDigest(kernel_id);
+  header.checksum = XXH64(&offsets, sizeof(offsets), 0);
+
+  std::string contents(reinterpret_cast<const char*>(&header), sizeof(header));
+  contents.append(reinterpret_cast<const char*>(&offsets), sizeof(offsets));
+
+  // Write to a temporary file first, so a crash never leaves a truncated file behind.
+  const std::filesystem::path tmp_path = absl::StrCat(path_.string(), ".tmp");
+  PX_RETURN_IF_ERROR(WriteFileFromString(tmp_path.string(), contents));
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path_, ec);
+  if (ec) {
+    return error::Internal("Could not rename $0 to $1: $2", tmp_path.string(), path_.string(),
+                           ec.message());
+  }
+  return Status::OK();
+}
+
+StatusOr<TaskStructOffsets> TaskStructOffsetsCache::GetOrResolve(std::string_view kernel_id,
+                                                                 const ResolveFn& resolve) {
+  std::optional<TaskStructOffsets> offsets = Lookup(kernel_id);
+  if (offsets.has_value()) {
+    return offsets.value();
+  }
+
+  PX_ASSIGN_OR_RETURN(TaskStructOffsets resolved, resolve());
+  Status s = Store(kernel_id, resolved);
+  LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to store task_struct offsets in $0: $1",
+                                               path_.string(), s.msg());
+  return resolved;
+}
+
+}  // namespace bpf_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "src/common/base/base.h"
+#include "src/stirling/bpf_tools/task_struct_resolver.h"
+
+namespace px {
+namespace stirling {
+namespace bpf_tools {
+
+/**
+ * Returns the identity of the running kernel build, from /proc/version, which includes the
+ * release, the compiler and the build number and time.
+ */
+StatusOr<std::string> RunningKernelIdentity();
+
+/**
+ * An on-disk cache of the task_struct offsets (see BCCWrapper::ComputeTaskStructOffsets()), so
+ * that restarts of the PEM on the same node don't compile and run the BPF program that resolves
+ * them again.
+ *
+ * The cache is a single file in the given directory, since a node only runs one kernel at a time.
+ * The file is written to a temporary file and renamed into place, so a crash never leaves a
+ * partial file behind. It starts with a header holding a format version, a digest of the kernel
+ * identity it was resolved on, the size of TaskStructOffsets and a checksum; a file that doesn't
+ * match the running kernel or binary is treated as a miss, and replaced by the next Store().
+ *
+ * Not thread-safe.
+ */
+class TaskStructOffsetsCache : public NotCopyMoveable {
+ public:
+  static constexpr std::string_view kFileName = "task_struct_offsets";
+
+  /**
+   * Opens the cache in the given directory, creating the directory if needed.
+   */
+  static StatusOr<std::unique_ptr<TaskStructOffsetsCache>> Create(const std::filesystem::path& dir);
+
+  /**
+   * Returns the cached offsets, if they were resolved on the given kernel.
+   */
+  std::optional<utils::TaskStructOffsets> Lookup(std::string_view kernel_id);
+
+  /**
+   * Stores the offsets resolved on the given kernel, replacing any previous ones.
+   */
+  Status Store(std::string_view kernel_id, const utils::TaskStructOffsets& offsets);
+
+  using ResolveFn = std::function<StatusOr<utils::TaskStructOffsets>()>;
+
+  /**
+   * Returns the cached offsets, or resolves and stores them on a miss. A failure to store the
+   * resolved offsets is logged, but doesn't fail the call.
+   */
+  StatusOr<utils::TaskStructOffsets> GetOrResolve(std::string_view kernel_id,
+                                                  const ResolveFn& resolve);
+
+  const std::filesystem::path& path() const { return path_; }
+
+  int64_t stat_hits() const { return stat_hits_; }
+  int64_t stat_misses() const { return stat_misses_; }
+
+ private:
+  explicit TaskStructOffsetsCache(std::filesystem::path path) : path_(std::move(path)) {}
+
+  const std::filesystem::path path_;
+
+  int64_t stat_hits_ = 0;
+  int64_t stat_misses_ = 0;
+};
+
+}  // namespace bpf_tools
+}  // namespace stirling
+}  // namespace px
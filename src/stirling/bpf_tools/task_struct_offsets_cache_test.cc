@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/bpf_tools/task_struct_offsets_cache.h"
+
+#include <string>
+
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace bpf_tools {
+
+using ::px::stirling::utils::TaskStructOffsets;
+using ::px::testing::TempDir;
+
+constexpr TaskStructOffsets kOffsets = {
+    .real_start_time_offset = 1560, .group_leader_offset = 1320, .exit_code_offset = 1140};
+
+TEST(TaskStructOffsetsCacheTest, StoreAndLookup) {
+  TempDir tmp_dir;
+  ASSERT_OK_AND_ASSIGN(auto cache, TaskStructOffsetsCache::Create(tmp_dir.path() / "cache"));
+  EXPECT_EQ(cache->path(), tmp_dir.path() / "cache" / "task_struct_offsets");
+
+  EXPECT_EQ(cache->Lookup("kernel"), std::nullopt);
+  ASSERT_OK(cache->Store("kernel", kOffsets));
+  EXPECT_EQ(cache->Lookup("kernel"), kOffsets);
+  EXPECT_EQ(cache->stat_hits(), 1);
+  EXPECT_EQ(cache->stat_misses(), 1);
+
+  // The offsets survive reopening the cache, as they would a restart.
+  ASSERT_OK_AND_ASSIGN(auto reopened, TaskStructOffsetsCache::Create(tmp_dir.path() / "cache"));
+  EXPECT_EQ(reopened->Lookup("kernel"), kOffsets);
+
+  // Offsets resolved on another kernel are a miss, and are replaced by the next Store().
+  EXPECT_EQ(reopened->Lookup("kernel2"), std::nullopt);
+  TaskStructOffsets offsets2 = kOffsets;
+  offsets2.exit_code_offset = 1144;
+  ASSERT_OK(reopened->Store("kernel2", offsets2));
+  EXPECT_EQ(reopened->Lookup("kernel2"), offsets2);
+  EXPECT_EQ(reopened->Lookup("kernel"), std::nullopt);
+}
+
+TEST(TaskStructOffsetsCacheTest, GetOrResolve) {
+  TempDir tmp_dir;
+  ASSERT_OK_AND_ASSIGN(auto cache, TaskStructOffsetsCache::Create(tmp_dir.path()));
+
+  int num_resolves = 0;
+  auto resolve = [&num_resolves]() -> StatusOr<TaskStructOffsets> {
+    ++num_resolves;
+    return kOffsets;
+  };
+  ASSERT_OK_AND_EQ(cache->GetOrResolve("kernel", resolve), kOffsets);
+  ASSERT_OK_AND_EQ(cache->GetOrResolve("kernel", resolve), kOffsets);
+  EXPECT_EQ(num_resolves, 1);
+
+  // Errors are returned, and nothing is cached.
+  auto fail = []() -> StatusOr<TaskStructOffsets> { return error::Internal("resolution error"); };
+  EXPECT_NOT_OK(cache->GetOrResolve("kernel2", fail));
+  EXPECT_EQ(cache->Lookup("kernel2"), std::nullopt);
+  EXPECT_EQ(cache->Lookup("kernel"), kOffsets);
+}
+
+TEST(TaskStructOffsetsCacheTest, CorruptFilesAreMisses) {
+  TempDir tmp_dir;
+  ASSERT_OK_AND_ASSIGN(auto cache, TaskStructOffsetsCache::Create(tmp_dir.path()));
+  ASSERT_OK(cache->Store("kernel", kOffsets));
+  const std::string path = cache->path().string();
+
+  // Flip the last byte of the offsets.
+  ASSERT_OK_AND_ASSIGN(std::string contents, ReadFileToString(path));
+  contents.back() ^= 1;
+  ASSERT_OK(WriteFileFromString(path, contents));
+  EXPECT_EQ(cache->Lookup("kernel"), std::nullopt);
+
+  // A truncated file.
+  ASSERT_OK(WriteFileFromString(path, "PXTSOFFS"));
+  EXPECT_EQ(cache->Lookup("kernel"), std::nullopt);
+
+  // A file written by another format version.
+  ASSERT_OK(cache->Store("kernel", kOffsets));
+  ASSERT_OK_AND_ASSIGN(contents, ReadFileToString(path));
+  contents[8] ^= 1;
+  ASSERT_OK(WriteFileFromString(path, contents));
+  EXPECT_EQ(cache->Lookup("kernel"), std::nullopt);
+
+  // The next Store() replaces the corrupt file.
+  ASSERT_OK(cache->Store("kernel", kOffsets));
+  EXPECT_EQ(cache->Lookup("kernel"), kOffsets);
+}
+
+}  // namespace bpf_tools
+}  // namespace stirling
+}  // namespace px
@@ -22,18 +22,30 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/core/types.h"
 #include "src/stirling/utils/index_sorted_vector.h"
 
+DEFINE_bool(stirling_data_table_arrow_builders,
+            gflags::BoolFromEnv("PL_STIRLING_DATA_TABLE_ARROW_BUILDERS", false),
+            "If true, data tables build arrow arrays directly as records are appended, "
+            "so that pushed records do not need to be converted by the table store.");
+
 namespace px {
 namespace stirling {
 
 using types::ColumnWrapper;
 using types::DataType;
 
-DataTable::DataTable(uint64_t id, const DataTableSchema& schema) : id_(id), table_schema_(schema) {}
+DataTable::DataTable(uint64_t id, const DataTableSchema& schema)
+    : DataTable(id, schema,
+                FLAGS_stirling_data_table_arrow_builders ? arrow::default_memory_pool()
+                                                         : nullptr) {}
+
+DataTable::DataTable(uint64_t id, const DataTableSchema& schema, arrow::MemoryPool* arrow_mem_pool)
+    : id_(id), table_schema_(schema), arrow_mem_pool_(arrow_mem_pool) {}
 
 void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
   DCHECK(record_batch_ptr != nullptr);
@@ -51,76 +63,230 @@ void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
   }
 }
 
+void DataTable::InitBuilders(std::vector<std::unique_ptr<arrow::ArrayBuilder>>* builders) {
+  DCHECK(builders != nullptr);
+  DCHECK(builders->empty());
+
+  for (const auto& element : table_schema_.elements()) {
+    auto builder = types::MakeArrowBuilder(element.type(), arrow_mem_pool_);
+    PX_CHECK_OK(builder->Reserve(kTargetCapacity));
+    builders->push_back(std::move(builder));
+  }
+}
+
 Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
   auto& tablet = tablets_[tablet_id];
-  if (tablet.records.empty()) {
+  if (arrow_builders_enabled()) {
+    if (tablet.builders.empty()) {
+      InitBuilders(&tablet.builders);
+    }
+  } else if (tablet.records.empty()) {
     InitBuffers(&tablet.records);
   }
   return &tablet;
 }
 
+DataTable::TabletSplit DataTable::SplitTablet(const Tablet& tablet) const {
+  // Sort based on times.
+  std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
+
+  // End time is cutoff time + 1, so call to SplitSortedVector() produces the following
+  // classification: which classified according to:
+  //   expired < start_time
+  //   pushable <= end_time
+  uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
+                                               : std::numeric_limits<uint64_t>::max();
+
+  // Split the indexes into three groups:
+  // 1) Expired indexes: these are too old to return.
+  // 2) Pushable indexes: these are the ones that we return.
+  // 3) Carryover indexes: these are too new to return, so hold on to them until the next round.
+  auto positions = utils::SplitSortedVector<2>(tablet.times, sort_indexes, {start_time_, end_time});
+  int num_expired = positions[0];
+
+  // Case 1: Expired records. Just print a message.
+  VLOG_IF(1, num_expired > 0) << absl::Substitute(
+      "$0 records for table $1 dropped due to late arrival [cutoff time=$2, oldest event "
+      "time=$3].",
+      num_expired, table_schema_.name(), end_time, tablet.times[sort_indexes[0]]);
+
+  // TODO(oazizi): Consider VectorView to avoid copying.
+  TabletSplit split;
+  split.push_indexes.assign(sort_indexes.begin() + positions[0],
+                            sort_indexes.begin() + positions[1]);
+  split.carryover_indexes.assign(sort_indexes.begin() + positions[1], sort_indexes.end());
+  return split;
+}
+
+std::vector<uint64_t> DataTable::CarryoverTimes(const Tablet& tablet,
+                                                const std::vector<size_t>& carryover_indexes) {
+  std::vector<uint64_t> times(carryover_indexes.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    times[i] = tablet.times[carryover_indexes[i]];
+  }
+  return times;
+}
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
+  if (arrow_builders_enabled()) {
+    // Records are held as arrow builders; convert the output for ColumnWrapper consumers.
+    std::vector<TaggedRecordBatch> tablets_out;
+    for (auto& arrow_batch : ConsumeArrowRecords()) {
+      types::ColumnWrapperRecordBatch records;
+      for (size_t i = 0; i < arrow_batch.records.size(); ++i) {
+        records.push_back(
+            ColumnWrapper::FromArrow(table_schema_.elements()[i].type(), arrow_batch.records[i]));
+      }
+      tablets_out.push_back(
+          TaggedRecordBatch{std::move(arrow_batch.tablet_id), std::move(records)});
+    }
+    return tablets_out;
+  }
+
   std::vector<TaggedRecordBatch> tablets_out;
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
   uint64_t next_start_time = start_time_;
 
   for (auto& [tablet_id, tablet] : tablets_) {
-    // Sort based on times.
-    std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
-
-    // End time is cutoff time + 1, so call to SplitSortedVector() produces the following
-    // classification: which classified according to:
-    //   expired < start_time
-    //   pushable <= end_time
-    uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
-                                                 : std::numeric_limits<uint64_t>::max();
-
-    // Split the indexes into three groups:
-    // 1) Expired indexes: these are too old to return.
-    // 2) Pushable indexes: these are the ones that we return.
-    // 3) Carryover indexes: these are too new to return, so hold on to them until the next round.
-    auto positions =
-        utils::SplitSortedVector<2>(tablet.times, sort_indexes, {start_time_, end_time});
-    int num_expired = positions[0];
-    int num_pushable = positions[1] - positions[0];
-    int num_carryover = tablet.times.size() - positions[1];
-
-    // Case 1: Expired records. Just print a message.
-    VLOG_IF(1, num_expired > 0) << absl::Substitute(
-        "$0 records for table $1 dropped due to late arrival [cutoff time=$2, oldest event "
-        "time=$3].",
-        num_expired, table_schema_.name(), end_time, tablet.times[sort_indexes[0]]);
+    TabletSplit split = SplitTablet(tablet);
 
     // Case 2: Pushable records. Copy to output.
-    if (num_pushable > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> push_indexes(sort_indexes.begin() + num_expired,
-                                       sort_indexes.end() - num_carryover);
+    if (!split.push_indexes.empty()) {
       types::ColumnWrapperRecordBatch pushable_records;
       for (auto& col : tablet.records) {
-        pushable_records.push_back(col->MoveIndexes(push_indexes));
+        pushable_records.push_back(col->MoveIndexes(split.push_indexes));
       }
-      uint64_t last_time = tablet.times[push_indexes.back()];
+      uint64_t last_time = tablet.times[split.push_indexes.back()];
       next_start_time = std::max(next_start_time, last_time);
       tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
     }
 
     // Case 3: Carryover records.
-    if (num_carryover > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> carryover_indexes(sort_indexes.begin() + num_pushable,
-                                            sort_indexes.end());
+    if (!split.carryover_indexes.empty()) {
       types::ColumnWrapperRecordBatch carryover_records;
       for (auto& col : tablet.records) {
-        carryover_records.push_back(col->MoveIndexes(carryover_indexes));
+        carryover_records.push_back(col->MoveIndexes(split.carryover_indexes));
+      }
+      carryover_tablets[tablet_id] =
+          Tablet{tablet_id, CarryoverTimes(tablet, split.carryover_indexes),
+                 std::move(carryover_records)};
+    }
+  }
+  tablets_ = std::move(carryover_tablets);
+
+  start_time_ = next_start_time;
+
+  return tablets_out;
+}
+
+namespace {
+
+// Returns true if indexes is a run of consecutive values, in which case the rows can be sliced
+// out of an array instead of copied.
+bool IsConsecutive(const std::vector<size_t>& indexes) {
+  for (size_t i = 1; i < indexes.size(); ++i) {
+    if (indexes[i] != indexes[0] + i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <DataType TDataType>
+void AppendArrowRows(const arrow::Array& src, const std::vector<size_t>& indexes,
+                     arrow::ArrayBuilder* dst) {
+  using TArray = typename types::DataTypeTraits<TDataType>::arrow_array_type;
+  using TBuilder = typename types::DataTypeTraits<TDataType>::arrow_builder_type;
+  const auto& typed_src = static_cast<const TArray&>(src);
+  auto* typed_dst = static_cast<TBuilder*>(dst);
+
+  PX_CHECK_OK(typed_dst->Reserve(indexes.size()));
+  for (size_t idx : indexes) {
+    if constexpr (TDataType == DataType::STRING) {
+      PX_CHECK_OK(typed_dst->Append(typed_src.GetView(idx)));
+    } else {
+      PX_CHECK_OK(typed_dst->Append(typed_src.Value(idx)));
+    }
+  }
+}
+
+// Appends the rows of src selected by indexes to dst.
+void AppendArrowRows(DataType data_type, const arrow::Array& src,
+                     const std::vector<size_t>& indexes, arrow::ArrayBuilder* dst) {
+#define TYPE_CASE(_dt_) AppendArrowRows<_dt_>(src, indexes, dst);
+  PX_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+}
+
+}  // namespace
+
+std::vector<TaggedArrowRecordBatch> DataTable::ConsumeArrowRecords() {
+  if (!arrow_builders_enabled()) {
+    // Records are held as ColumnWrappers; convert the output.
+    std::vector<TaggedArrowRecordBatch> tablets_out;
+    for (auto& batch : ConsumeRecords()) {
+      types::ArrowArrayRecordBatch records;
+      for (auto& col : batch.records) {
+        records.push_back(col->ConvertToArrow(arrow::default_memory_pool()));
       }
+      tablets_out.push_back(
+          TaggedArrowRecordBatch{std::move(batch.tablet_id), std::move(records)});
+    }
+    return tablets_out;
+  }
+
+  std::vector<TaggedArrowRecordBatch> tablets_out;
+  absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
+  uint64_t next_start_time = start_time_;
+
+  for (auto& [tablet_id, tablet] : tablets_) {
+    TabletSplit split = SplitTablet(tablet);
+
+    if (split.push_indexes.empty() && split.carryover_indexes.empty()) {
+      continue;
+    }
 
-      std::vector<uint64_t> times(carryover_indexes.size());
-      for (size_t i = 0; i < times.size(); ++i) {
-        times[i] = tablet.times[carryover_indexes[i]];
+    types::ArrowArrayRecordBatch arrays(tablet.builders.size());
+    for (size_t i = 0; i < tablet.builders.size(); ++i) {
+      PX_CHECK_OK(tablet.builders[i]->Finish(&arrays[i]));
+    }
+
+    // Pushable records. Records that were appended in time order (the common case) are sliced out
+    // of the finished arrays without copying; otherwise, they are gathered into new arrays.
+    if (!split.push_indexes.empty()) {
+      types::ArrowArrayRecordBatch pushable_records;
+      if (IsConsecutive(split.push_indexes)) {
+        for (auto& arr : arrays) {
+          pushable_records.push_back(
+              split.push_indexes.size() == static_cast<size_t>(arr->length())
+                  ? arr
+                  : arr->Slice(split.push_indexes.front(), split.push_indexes.size()));
+        }
+      } else {
+        for (size_t i = 0; i < arrays.size(); ++i) {
+          DataType type = table_schema_.elements()[i].type();
+          auto builder = types::MakeArrowBuilder(type, arrow_mem_pool_);
+          AppendArrowRows(type, *arrays[i], split.push_indexes, builder.get());
+          std::shared_ptr<arrow::Array> arr;
+          PX_CHECK_OK(builder->Finish(&arr));
+          pushable_records.push_back(std::move(arr));
+        }
       }
-      carryover_tablets[tablet_id] =
-          Tablet{tablet_id, std::move(times), std::move(carryover_records)};
+      uint64_t last_time = tablet.times[split.push_indexes.back()];
+      next_start_time = std::max(next_start_time, last_time);
+      tablets_out.push_back(TaggedArrowRecordBatch{tablet_id, std::move(pushable_records)});
+    }
+
+    // Carryover records are copied into fresh builders, so the finished arrays can be released
+    // once the pushed records are.
+    if (!split.carryover_indexes.empty()) {
+      Tablet carryover_tablet{tablet_id, CarryoverTimes(tablet, split.carryover_indexes), {}, {}};
+      InitBuilders(&carryover_tablet.builders);
+      for (size_t i = 0; i < arrays.size(); ++i) {
+        AppendArrowRows(table_schema_.elements()[i].type(), *arrays[i], split.carryover_indexes,
+                        carryover_tablet.builders[i].get());
+      }
+      carryover_tablets[tablet_id] = std::move(carryover_tablet);
     }
   }
   tablets_ = std::move(carryover_tablets);
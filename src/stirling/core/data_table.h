@@ -18,6 +18,10 @@
 
 #pragma once
 
+#include <arrow/builder.h>
+#include <arrow/memory_pool.h>
+#include <gflags/gflags.h>
+
 #include <algorithm>
 #include <limits>
 #include <memory>
@@ -28,8 +32,11 @@
 
 #include "src/common/base/base.h"
 #include "src/common/base/mixins.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/stirling/core/types.h"
 
+DECLARE_bool(stirling_data_table_arrow_builders);
+
 namespace px {
 namespace stirling {
 
@@ -41,17 +48,33 @@ struct TaggedRecordBatch {
   types::ColumnWrapperRecordBatch records;
 };
 
+/**
+ * A tagged record batch whose columns are finished arrow arrays.
+ */
+struct TaggedArrowRecordBatch {
+  types::TabletID tablet_id;
+  types::ArrowArrayRecordBatch records;
+};
+
 struct Tablet {
   types::TabletID tablet_id;
   // TODO(oazizi): Convert this vector into a heap of {time, index} objects.
   std::vector<uint64_t> times;
   types::ColumnWrapperRecordBatch records;
+  // Used instead of records when the DataTable builds arrow arrays directly.
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
 };
 
 class DataTable : public NotCopyable {
  public:
   // Global unique ID identifies the table store to which this DataTable's data should be pushed.
+  // Records are built into arrow arrays (on the default arrow memory pool) if
+  // --stirling_data_table_arrow_builders is set, and into ColumnWrappers otherwise.
   DataTable(uint64_t id, const DataTableSchema& schema);
+
+  // Builds records into arrow arrays allocated from arrow_mem_pool, or into ColumnWrappers if
+  // arrow_mem_pool is nullptr.
+  DataTable(uint64_t id, const DataTableSchema& schema, arrow::MemoryPool* arrow_mem_pool);
   virtual ~DataTable() = default;
 
   /**
@@ -69,6 +92,18 @@ class DataTable : public NotCopyable {
    */
   std::vector<TaggedRecordBatch> ConsumeRecords();
 
+  /**
+   * Same as ConsumeRecords(), but returns the records as arrow arrays.
+   * When the table builds arrow arrays directly, records that are already in time order are
+   * handed out without copying. Otherwise, the records are converted.
+   */
+  std::vector<TaggedArrowRecordBatch> ConsumeArrowRecords();
+
+  /**
+   * Whether records are built directly into arrow arrays.
+   */
+  bool arrow_builders_enabled() const { return arrow_mem_pool_ != nullptr; }
+
   /**
    * Sets a cutoff time for the table. Any records that appear after this time
    * will not be pushed out on a call to ConsumeRecords(). Instead, they will
@@ -91,20 +126,11 @@ class DataTable : public NotCopyable {
   size_t Occupancy() const {
     size_t occupancy = 0;
     for (auto& [tablet_id, tablet] : tablets_) {
-      if (!tablet.records.empty()) {
-        occupancy += tablet.records[0]->Size();
-      }
+      occupancy += tablet.times.size();
     }
     return occupancy;
   }
 
-  /**
-   * Occupancy of the Data Table as a percentage of size.
-   *
-   * @return double percent occupancy
-   */
-  double OccupancyPct() const { return 1.0 * Occupancy() / kTargetCapacity; }
-
   // Example usage:
   // DataTable::RecordBuilder<&kTable> r(data_table, time);
   // r.Append<r.ColIndex("field0")>(val0);
@@ -162,10 +188,14 @@ class DataTable : public NotCopyable {
           val.resize(max_string_bytes);
           val.append(kTruncatedMsg);
         }
-        val.shrink_to_fit();
+        // ColumnWrappers keep each string around until conversion, so trim any excess capacity.
+        // Arrow builders copy the bytes right away, so there is no need to.
+        if (tablet_.builders.empty()) {
+          val.shrink_to_fit();
+        }
       }
 
-      tablet_.records[TIndex]->Append(std::move(val));
+      AppendToTablet(&tablet_, TIndex, std::move(val));
       DCHECK(!signature_[TIndex]) << absl::Substitute(
           "Attempt to Append() to column $0 (name=$1) multiple times", TIndex,
           schema->ColName(TIndex));
@@ -190,7 +220,8 @@ class DataTable : public NotCopyable {
 
    private:
     void Init(uint64_t time) {
-      DCHECK_EQ(schema->elements().size(), tablet_.records.size());
+      DCHECK_EQ(schema->elements().size(),
+                std::max(tablet_.records.size(), tablet_.builders.size()));
       tablet_.times.push_back(time);
     }
 
@@ -230,7 +261,7 @@ class DataTable : public NotCopyable {
         }
       }
 
-      tablet_.records[col_index]->Append(std::move(val));
+      AppendToTablet(&tablet_, col_index, std::move(val));
 
       DCHECK(!signature_[col_index])
           << absl::Substitute("Attempt to Append() to column $0 (name=$1) multiple times",
@@ -246,7 +277,8 @@ class DataTable : public NotCopyable {
 
    private:
     void Init(uint64_t time) {
-      DCHECK_EQ(schema_.elements().size(), tablet_.records.size());
+      DCHECK_EQ(schema_.elements().size(),
+                std::max(tablet_.records.size(), tablet_.builders.size()));
       tablet_.times.push_back(time);
       LOG_IF(DFATAL, schema_.elements().size() > kMaxSupportedColumns) << absl::Substitute(
           "Tables with more than $0 columns are not supported.", kMaxSupportedColumns);
@@ -271,12 +303,46 @@ class DataTable : public NotCopyable {
   // Initialize a new Active record batch.
   void InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr);
 
+  // Initialize the arrow builders of a new tablet.
+  void InitBuilders(std::vector<std::unique_ptr<arrow::ArrayBuilder>>* builders);
+
+  // Appends a value to a column of the tablet, in whichever representation the tablet uses.
+  template <typename TValueType>
+  static void AppendToTablet(Tablet* tablet, size_t col_index, TValueType val) {
+    if (tablet->builders.empty()) {
+      tablet->records[col_index]->Append(std::move(val));
+      return;
+    }
+
+    using TBuilder = typename types::ValueTypeTraits<TValueType>::arrow_builder_type;
+    auto* builder = static_cast<TBuilder*>(tablet->builders[col_index].get());
+    if constexpr (std::is_same_v<TValueType, types::StringValue>) {
+      PX_CHECK_OK(builder->Append(val));
+    } else {
+      PX_CHECK_OK(builder->Append(val.val));
+    }
+  }
+
   // Get a pointer to the Tablet, for appending. Used by RecordBuilder.
   Tablet* GetTablet(types::TabletIDView tablet_id);
 
+  // The indexes of a tablet's records to push out, and to carry over to the next round, each in
+  // time order. Records that arrived too late are in neither.
+  struct TabletSplit {
+    std::vector<size_t> push_indexes;
+    std::vector<size_t> carryover_indexes;
+  };
+  TabletSplit SplitTablet(const Tablet& tablet) const;
+
+  static std::vector<uint64_t> CarryoverTimes(const Tablet& tablet,
+                                              const std::vector<size_t>& carryover_indexes);
+
   // Table schema: a DataElement to describe each column.
   const DataTableSchema& table_schema_;
 
+  // If set, records are built directly into arrow arrays allocated from this pool.
+  arrow::MemoryPool* arrow_mem_pool_ = nullptr;
+
   // Key is tablet id, value is tablet records.
   absl::flat_hash_map<types::TabletID, Tablet> tablets_;
 
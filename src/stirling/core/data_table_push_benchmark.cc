@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/numeric/int128.h>
+#include <absl/strings/substitute.h>
+
+#include "src/stirling/core/data_table.h"
+#include "src/table_store/table/table_store.h"
+
+namespace px {
+namespace stirling {
+
+// Benchmark of the path from records appended to a DataTable by a source connector to the table
+// store, including the compaction that turns the pushed batches into cold arrow batches. Record
+// building is timed too, since that is where the arrow builders do their work. The first
+// argument selects whether the DataTable builds arrow arrays directly (and pushes them with
+// AppendArrowData) or builds ColumnWrappers (pushed with AppendData and converted to arrow during
+// compaction). The second argument is the number of records per push.
+
+namespace {
+
+constexpr DataElement kElements[] = {
+    {"time_", "time", types::DataType::TIME64NS, types::SemanticType::ST_NONE,
+     types::PatternType::METRIC_COUNTER},
+    {"upid", "upid", types::DataType::UINT128, types::SemanticType::ST_UPID,
+     types::PatternType::GENERAL},
+    {"remote_addr", "remote address", types::DataType::STRING, types::SemanticType::ST_IP_ADDRESS,
+     types::PatternType::GENERAL},
+    {"remote_port", "remote port", types::DataType::INT64, types::SemanticType::ST_PORT,
+     types::PatternType::GENERAL},
+    {"req_path", "request path", types::DataType::STRING, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"resp_status", "response status", types::DataType::INT64, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"latency", "latency", types::DataType::INT64, types::SemanticType::ST_DURATION_NS,
+     types::PatternType::METRIC_GAUGE},
+};
+constexpr auto kSchema = DataTableSchema("bench_table", "Benchmark table", kElements);
+
+constexpr uint64_t kTableID = 1;
+constexpr int64_t kMaxTableSize = 64 * 1024 * 1024;
+constexpr int64_t kCompactedBatchSize = 64 * 1024;
+
+table_store::schema::Relation SchemaRelation() {
+  table_store::schema::Relation rel;
+  for (const auto& element : kSchema.elements()) {
+    rel.AddColumn(element.type(), std::string(element.name()));
+  }
+  return rel;
+}
+
+void FillDataTable(DataTable* data_table, int64_t num_records, uint64_t* time) {
+  for (int64_t i = 0; i < num_records; ++i, ++*time) {
+    DataTable::RecordBuilder<&kSchema> r(data_table, *time);
+    r.Append<r.ColIndex("time_")>(*time);
+    r.Append<r.ColIndex("upid")>(absl::MakeUint128(1234, i % 16));
+    r.Append<r.ColIndex("remote_addr")>(absl::Substitute("10.0.$0.$1", i % 8, i % 256));
+    r.Append<r.ColIndex("remote_port")>(50000 + i % 1000);
+    r.Append<r.ColIndex("req_path")>(absl::Substitute("/api/v1/resource/$0", i % 100));
+    r.Append<r.ColIndex("resp_status")>(200);
+    r.Append<r.ColIndex("latency")>(1000 + i);
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_DataTablePush(benchmark::State& state) {
+  const bool arrow_builders = state.range(0);
+  const int64_t num_records = state.range(1);
+
+  DataTable data_table(kTableID, kSchema, arrow_builders ? arrow::default_memory_pool() : nullptr);
+  table_store::TableStore table_store;
+  auto table = std::make_shared<table_store::Table>(kSchema.name(), SchemaRelation(),
+                                                    kMaxTableSize, kCompactedBatchSize);
+  table_store.AddTable(table, std::string(kSchema.name()), kTableID);
+
+  uint64_t time = 0;
+  for (auto _ : state) {
+    FillDataTable(&data_table, num_records, &time);
+    if (arrow_builders) {
+      for (auto& batch : data_table.ConsumeArrowRecords()) {
+        PX_CHECK_OK(table_store.AppendArrowData(
+            kTableID, batch.tablet_id,
+            std::make_unique<types::ArrowArrayRecordBatch>(std::move(batch.records))));
+      }
+    } else {
+      for (auto& batch : data_table.ConsumeRecords()) {
+        PX_CHECK_OK(table_store.AppendData(
+            kTableID, batch.tablet_id,
+            std::make_unique<types::ColumnWrapperRecordBatch>(std::move(batch.records))));
+      }
+    }
+    PX_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_records);
+}
+
+BENCHMARK(BM_DataTablePush)
+    ->ArgNames({"arrow_builders", "records"})
+    ->ArgsProduct({{0, 1}, {64, 1024, 16384}});
+
+}  // namespace stirling
+}  // namespace px
@@ -20,13 +20,15 @@
 #include <random>
 #include <string>
 
+#include "src/shared/types/arrow_adapter.h"
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/source_connectors/seq_gen/sequence_generator.h"
 
 namespace px {
 namespace stirling {
 
-class DataTableTest : public ::testing::Test {
+// Parameterized on whether the DataTable builds arrow arrays directly.
+class DataTableTest : public ::testing::TestWithParam<bool> {
  protected:
   // The test uses a pre-defined schema.
   static constexpr DataElement kElements[] = {
@@ -40,12 +42,14 @@ class DataTableTest : public ::testing::Test {
   static constexpr auto kSchema =
       DataTableSchema("test_table", "This is the table description", kElements);
 
-  DataTableTest() : data_table_(std::make_unique<DataTable>(/*id*/ 0, kSchema)) {}
+  DataTableTest()
+      : data_table_(std::make_unique<DataTable>(
+            /*id*/ 0, kSchema, GetParam() ? arrow::default_memory_pool() : nullptr)) {}
 
   std::unique_ptr<DataTable> data_table_;
 };
 
-TEST_F(DataTableTest, ResultIsSorted) {
+TEST_P(DataTableTest, ResultIsSorted) {
   std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
   std::vector<int> x_vals = {0, 1, 4, 2, 3, 5, 9, 7, 6, 8};
   std::vector<std::string> s_vals = {"a", "b", "e", "c", "d", "f", "j", "h", "g", "i"};
@@ -72,7 +76,7 @@ TEST_F(DataTableTest, ResultIsSorted) {
 // No time passed to RecordBuilder, so all timestamps should be zero.
 // That means there should never be any expired or carry-over records.
 // Also, nothing should be sorted in any way.
-TEST_F(DataTableTest, FixedTimeMode) {
+TEST_P(DataTableTest, FixedTimeMode) {
   std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
   std::vector<int> x_vals = {0, 1, 4, 2, 3, 5, 9, 7, 6, 8};
   std::vector<std::string> s_vals = {"a", "b", "e", "c", "d", "f", "j", "h", "g", "i"};
@@ -96,7 +100,7 @@ TEST_F(DataTableTest, FixedTimeMode) {
   }
 }
 
-TEST_F(DataTableTest, FixedTimeModeV2) {
+TEST_P(DataTableTest, FixedTimeModeV2) {
   std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
   std::vector<int> x_vals = {0, 1, 4, 2, 3, 5, 9, 7, 6, 8};
   std::vector<std::string> s_vals = {"a", "b", "e", "c", "d", "f", "j", "h", "g", "i"};
@@ -122,7 +126,7 @@ TEST_F(DataTableTest, FixedTimeModeV2) {
   }
 }
 
-TEST_F(DataTableTest, Expiry) {
+TEST_P(DataTableTest, Expiry) {
   std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
   std::vector<int> x_vals = {0, 1, 4, 2, 3, 5, 9, 7, 6, 8};
   std::vector<std::string> s_vals = {"a", "b", "e", "c", "d", "f", "j", "h", "g", "i"};
@@ -203,7 +207,7 @@ TEST_F(DataTableTest, Expiry) {
 
 // This test has scrambled entries, but ConsumeRecords is called with end times
 // that should cause carryover. This test also causes no expirations for simplicity.
-TEST_F(DataTableTest, Carryover) {
+TEST_P(DataTableTest, Carryover) {
   std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
   std::vector<int> x_vals = {0, 1, 4, 2, 3, 5, 9, 7, 6, 8};
   std::vector<std::string> s_vals = {"a", "b", "e", "c", "d", "f", "j", "h", "g", "i"};
@@ -314,6 +318,62 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+TEST_P(DataTableTest, ConsumeArrowRecords) {
+  // Appended in time order, then out of order.
+  std::vector<int> time_vals = {0, 10, 20, 30, 50, 40};
+  std::vector<std::string> s_vals = {"a", "b", "c", "d", "f", "e"};
+
+  auto append_records = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      DataTable::RecordBuilder<&kSchema> r(data_table_.get(), time_vals[i]);
+      r.Append<r.ColIndex("time_")>(time_vals[i]);
+      r.Append<r.ColIndex("x")>(time_vals[i] / 10);
+      r.Append<r.ColIndex("s")>(s_vals[i]);
+    }
+  };
+
+  // In order, with the last record carried over.
+  append_records(0, 4);
+  data_table_->SetConsumeRecordsCutoffTime(20);
+  {
+    std::vector<TaggedArrowRecordBatch> tablets = data_table_->ConsumeArrowRecords();
+    ASSERT_EQ(tablets.size(), 1);
+    types::ArrowArrayRecordBatch& rb = tablets[0].records;
+    ASSERT_EQ(rb.size(), 3);
+    ASSERT_EQ(rb[0]->length(), 3);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb[0].get(), i), 10 * i);
+      EXPECT_EQ(types::GetValueFromArrowArray<types::DataType::INT64>(rb[1].get(), i), i);
+      EXPECT_EQ(types::GetValueFromArrowArray<types::DataType::STRING>(rb[2].get(), i),
+                s_vals[i]);
+    }
+  }
+
+  // Out of order, together with the carried over record.
+  append_records(4, 6);
+  data_table_->SetConsumeRecordsCutoffTime(100);
+  {
+    std::vector<TaggedArrowRecordBatch> tablets = data_table_->ConsumeArrowRecords();
+    ASSERT_EQ(tablets.size(), 1);
+    types::ArrowArrayRecordBatch& rb = tablets[0].records;
+    ASSERT_EQ(rb[0]->length(), 3);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb[0].get(), i),
+                30 + 10 * i);
+      EXPECT_EQ(types::GetValueFromArrowArray<types::DataType::INT64>(rb[1].get(), i), 3 + i);
+      EXPECT_EQ(types::GetValueFromArrowArray<types::DataType::STRING>(rb[2].get(), i),
+                std::string(1, 'd' + i));
+    }
+  }
+
+  EXPECT_EQ(data_table_->Occupancy(), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(DataTableModes, DataTableTest, ::testing::Bool(),
+                         [](const ::testing::TestParamInfo<bool>& info) {
+                           return info.param ? "ArrowBuilders" : "ColumnWrappers";
+                         });
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
@@ -51,8 +51,22 @@ void SourceConnector::TransferData(ConnectorContext* ctx) {
   TransferDataImpl(ctx);
 }
 
-void SourceConnector::PushData(DataPushCallback agent_callback) {
+void SourceConnector::PushData(DataPushCallback agent_callback,
+                               ArrowDataPushCallback arrow_callback) {
   for (auto* data_table : data_tables_) {
+    if (arrow_callback != nullptr && data_table->arrow_builders_enabled()) {
+      for (auto& record_batch : data_table->ConsumeArrowRecords()) {
+        if (record_batch.records.empty()) {
+          continue;
+        }
+        Status s = arrow_callback(
+            data_table->id(), record_batch.tablet_id,
+            std::make_unique<types::ArrowArrayRecordBatch>(std::move(record_batch.records)));
+        LOG_IF(DFATAL, !s.ok()) << absl::Substitute("Failed to push data. Message = $0", s.msg());
+      }
+      continue;
+    }
+
     auto record_batches = data_table->ConsumeRecords();
     for (auto& record_batch : record_batches) {
       if (record_batch.records.empty()) {
@@ -66,6 +80,15 @@ void SourceConnector::PushData(DataPushCallback agent_callback) {
   }
 }
 
+std::vector<size_t> SourceConnector::TableOccupancies() const {
+  std::vector<size_t> occupancies;
+  occupancies.reserve(data_tables_.size());
+  for (const auto* data_table : data_tables_) {
+    occupancies.push_back(data_table->Occupancy());
+  }
+  return occupancies;
+}
+
 Status SourceConnector::Stop() {
   if (state_ != State::kActive) {
     return Status::OK();
@@ -31,6 +31,7 @@
 #include "src/stirling/core/data_table.h"
 #include "src/stirling/core/frequency_manager.h"
 #include "src/stirling/core/info_class_manager.h"
+#include "src/stirling/utils/push_scheduler.h"
 
 /**
  * These are the steps to follow to add a new data source connector.
@@ -74,8 +75,9 @@ class SourceConnector : public NotCopyable {
 
   /**
    * Pushes data in data tables into table store.
+   * Data tables that build arrow arrays push through arrow_callback, if one is provided.
    */
-  void PushData(DataPushCallback agent_callback);
+  void PushData(DataPushCallback agent_callback, ArrowDataPushCallback arrow_callback = nullptr);
 
   /**
    * Stops the source connector and releases any acquired resources.
@@ -124,8 +126,14 @@ class SourceConnector : public NotCopyable {
 
   FrequencyManager& sampling_freq_mgr() { return sampling_freq_mgr_; }
   FrequencyManager& push_freq_mgr() { return push_freq_mgr_; }
+  PushScheduler& push_scheduler() { return push_scheduler_; }
   const std::vector<DataTable*>& data_tables() const { return data_tables_; }
 
+  /**
+   * Returns the number of records buffered in each of the data tables.
+   */
+  std::vector<size_t> TableOccupancies() const;
+
   void set_data_tables(std::vector<DataTable*> data_tables) {
     data_tables_ = std::move(data_tables);
   }
@@ -162,6 +170,9 @@ class SourceConnector : public NotCopyable {
   FrequencyManager sampling_freq_mgr_;
   FrequencyManager push_freq_mgr_;
 
+  // Decides when to push ahead of push_freq_mgr_, whose period bounds how long records wait.
+  PushScheduler push_scheduler_;
+
   std::vector<DataTable*> data_tables_;
 
   // Debug members.
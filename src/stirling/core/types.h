@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "src/shared/metadata/metadata_state.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/type_utils.h"
 #include "src/stirling/proto/stirling.pb.h"
@@ -36,6 +37,12 @@ namespace stirling {
 using DataPushCallback = std::function<Status(uint32_t, types::TabletID,
                                               std::unique_ptr<types::ColumnWrapperRecordBatch>)>;
 
+/**
+ * Same as DataPushCallback, but the data is pushed as arrow arrays.
+ */
+using ArrowDataPushCallback = std::function<Status(
+    uint32_t, types::TabletID, std::unique_ptr<types::ArrowArrayRecordBatch>)>;
+
 using AgentMetadataType = std::shared_ptr<const px::md::AgentMetadataState>;
 
 /**
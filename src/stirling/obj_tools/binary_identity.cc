@@ -0,0 +1,44 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/stirling/obj_tools/binary_identity.h"
+
+#include <sys/stat.h>
+
+#include <cstring>
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+StatusOr<BinaryIdentity> GetBinaryIdentity(const std::filesystem::path& binary_path) {
+  struct stat st;
+  if (stat(binary_path.c_str(), &st) != 0) {
+    return error::Internal("Could not stat $0: $1", binary_path.string(), std::strerror(errno));
+  }
+
+  BinaryIdentity id;
+  id.dev = st.st_dev;
+  id.inode = st.st_ino;
+  id.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000 * 1000 * 1000 + st.st_mtim.tv_nsec;
+  id.size = st.st_size;
+  return id;
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
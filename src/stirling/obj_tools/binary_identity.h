@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <sys/types.h>
+
+#include <filesystem>
+#include <string>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+/**
+ * Identifies the on-disk contents of a binary without reading it.
+ *
+ * Two processes that exec the same file (e.g. replicas of the same container image that share an
+ * overlay lower layer) resolve to the same identity, even when reached through different
+ * /proc/<pid>/root paths. The mtime and size guard against in-place rewrites of the same inode.
+ */
+struct BinaryIdentity {
+  dev_t dev = 0;
+  ino_t inode = 0;
+  int64_t mtime_ns = 0;
+  int64_t size = 0;
+
+  bool operator==(const BinaryIdentity& other) const {
+    return dev == other.dev && inode == other.inode && mtime_ns == other.mtime_ns &&
+           size == other.size;
+  }
+  bool operator!=(const BinaryIdentity& other) const { return !(*this == other); }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const BinaryIdentity& id) {
+    return H::combine(std::move(h), id.dev, id.inode, id.mtime_ns, id.size);
+  }
+
+  std::string ToString() const {
+    return absl::Substitute("[dev=$0 inode=$1 mtime_ns=$2 size=$3]", dev, inode, mtime_ns, size);
+  }
+};
+
+/**
+ * Returns the identity of the file at the given path. Symlinks are followed.
+ */
+StatusOr<BinaryIdentity> GetBinaryIdentity(const std::filesystem::path& binary_path);
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
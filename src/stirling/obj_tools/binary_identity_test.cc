@@ -0,0 +1,47 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/stirling/obj_tools/binary_identity.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+TEST(GetBinaryIdentityTest, SameFileSameIdentity) {
+  const std::filesystem::path self = "/proc/self/exe";
+
+  ASSERT_OK_AND_ASSIGN(BinaryIdentity id1, GetBinaryIdentity(self));
+  ASSERT_OK_AND_ASSIGN(BinaryIdentity id2, GetBinaryIdentity(std::filesystem::read_symlink(self)));
+  EXPECT_EQ(id1, id2);
+  EXPECT_GT(id1.size, 0);
+}
+
+TEST(GetBinaryIdentityTest, DifferentFilesDifferentIdentity) {
+  ASSERT_OK_AND_ASSIGN(BinaryIdentity id1, GetBinaryIdentity("/proc/self/exe"));
+  ASSERT_OK_AND_ASSIGN(BinaryIdentity id2, GetBinaryIdentity("/bin/sh"));
+  EXPECT_NE(id1, id2);
+}
+
+TEST(GetBinaryIdentityTest, MissingFile) {
+  EXPECT_NOT_OK(GetBinaryIdentity("/bogus/path/to/binary"));
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -25,6 +25,8 @@
 
 #include <absl/container/flat_hash_set.h>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include <llvm/DebugInfo/DIContext.h>
 #include <llvm/Object/ObjectFile.h>
@@ -111,6 +113,14 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithSelectiveIndexing(
   return dwarf_reader;
 }
 
+StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithLazyIndexing(
+    const std::filesystem::path& path, int num_threads) {
+  PX_ASSIGN_OR_RETURN(auto dwarf_reader, CreateWithoutIndexing(path));
+  dwarf_reader->lazy_index_ = std::make_unique<LazyIndex>();
+  dwarf_reader->lazy_index_->num_threads = std::max(num_threads, 1);
+  return dwarf_reader;
+}
+
 DwarfReader::DwarfReader(std::unique_ptr<llvm::MemoryBuffer> buffer,
                          std::unique_ptr<llvm::DWARFContext> dwarf_context)
     : memory_buffer_(std::move(buffer)), dwarf_context_(std::move(dwarf_context)) {
@@ -152,6 +162,52 @@ bool IsIndexedType(llvm::dwarf::Tag tag) {
 
 bool IsNamespace(llvm::dwarf::Tag tag) { return tag == llvm::dwarf::DW_TAG_namespace; }
 
+// Runs fn(i) for every i in [0, n), on up to num_threads threads including the calling one.
+template <typename TFn>
+void ParallelFor(size_t n, int num_threads, const TFn& fn) {
+  std::atomic<size_t> next = 0;
+  auto worker = [&]() {
+    for (size_t i = next++; i < n; i = next++) {
+      fn(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < std::min(static_cast<size_t>(num_threads), n); ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Returns the name under which IndexDIEs() records the DIE: its short name, prefixed by the names
+// of the enclosing namespaces and indexed types.
+std::string QualifiedName(const DWARFDie& die) {
+  std::string name(GetShortName(die));
+  for (DWARFDie parent = die.getParent(); parent.isValid(); parent = parent.getParent()) {
+    std::string_view parent_name = GetShortName(parent);
+    if (!(IsIndexedType(parent.getTag()) || IsNamespace(parent.getTag())) || parent_name.empty()) {
+      break;
+    }
+    name = absl::StrCat(parent_name, "::", name);
+  }
+  return name;
+}
+
+// Returns the short names a DIE could have for QualifiedName() to produce the given name: the name
+// itself, and every suffix following a "::". Splitting only at the last "::" is not enough, since
+// template arguments can contain "::" as well.
+std::vector<std::string_view> ShortNameCandidates(std::string_view name) {
+  std::vector<std::string_view> candidates = {name};
+  for (size_t pos = name.find("::"); pos != std::string_view::npos;
+       pos = name.find("::", pos + 1)) {
+    candidates.push_back(name.substr(pos + 2));
+  }
+  return candidates;
+}
+
 }  // namespace
 
 Status DwarfReader::DetectSourceLanguage() {
@@ -264,10 +320,133 @@ void DwarfReader::IndexDIEs(
   }
 }
 
+void DwarfReader::BuildLazyIndex() {
+  struct UnitScan {
+    std::vector<std::tuple<llvm::dwarf::Tag, std::string_view, uint32_t>> named_dies;
+    // DIEs that take their name from the DIE they refer to, which may be in another unit.
+    std::vector<std::pair<llvm::dwarf::Tag, uint32_t>> unnamed_dies;
+    std::vector<std::pair<uint64_t, uint32_t>> fn_specs;
+  };
+
+  std::vector<llvm::DWARFUnit*> units;
+  for (const std::unique_ptr<llvm::DWARFUnit>& unit : dwarf_context_->normal_units()) {
+    // The abbreviations are parsed into a table shared by all units, and the unit DIE is needed to
+    // set up the unit; do both before the units are scanned concurrently.
+    unit->getAbbreviations();
+    unit->getUnitDIE(/*ExtractUnitDIEOnly*/ true);
+    units.push_back(unit.get());
+  }
+
+  // Each unit is only ever touched by the thread scanning it. In particular, no attribute
+  // references are followed, since that could parse a unit being scanned by another thread.
+  std::vector<UnitScan> scans(units.size());
+  ParallelFor(units.size(), lazy_index_->num_threads, [&units, &scans](size_t i) {
+    llvm::DWARFUnit* unit = units[i];
+    UnitScan& scan = scans[i];
+
+    uint32_t die_index = 0;
+    for (const llvm::DWARFDebugInfoEntry& entry : unit->dies()) {
+      DWARFDie die = {unit, &entry};
+      const uint32_t index = die_index++;
+
+      llvm::dwarf::Tag tag = die.getTag();
+      if (!IsIndexedType(tag)) {
+        continue;
+      }
+
+      if (die.isSubprogramDIE()) {
+        auto spec = llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification));
+        if (spec.hasValue()) {
+          scan.fn_specs.emplace_back(spec.getValue(), index);
+        }
+      }
+
+      const char* name = llvm::dwarf::toString(die.find(llvm::dwarf::DW_AT_name), nullptr);
+      if (name != nullptr) {
+        if (*name != '\0') {
+          scan.named_dies.emplace_back(tag, name, index);
+        }
+      } else if (die.find({llvm::dwarf::DW_AT_specification, llvm::dwarf::DW_AT_abstract_origin})
+                     .hasValue()) {
+        scan.unnamed_dies.emplace_back(tag, index);
+      }
+    }
+  });
+
+  // Merge in unit order, so that the same DW_AT_specification wins as in IndexDIEs().
+  for (uint32_t i = 0; i < scans.size(); ++i) {
+    for (const auto& [tag, name, die_index] : scans[i].named_dies) {
+      lazy_index_->dies[tag][name].emplace_back(i, die_index);
+    }
+    for (const auto& [tag, die_index] : scans[i].unnamed_dies) {
+      std::string_view name = GetShortName(units[i]->getDIEAtIndex(die_index));
+      if (!name.empty()) {
+        lazy_index_->dies[tag][name].emplace_back(i, die_index);
+      }
+    }
+    for (const auto& [spec_offset, die_index] : scans[i].fn_specs) {
+      lazy_index_->fn_spec_offsets[spec_offset] = {i, die_index};
+    }
+  }
+  lazy_index_->built = true;
+}
+
+std::optional<DWARFDie> DwarfReader::FindInLazyIndex(const std::string& name,
+                                                     llvm::dwarf::Tag tag) {
+  std::optional<DWARFDie> die_opt = FindInDIEMap(name, tag);
+  if (die_opt.has_value()) {
+    return die_opt;
+  }
+  if (lazy_index_->misses[tag].contains(name)) {
+    return std::nullopt;
+  }
+  if (!lazy_index_->built) {
+    BuildLazyIndex();
+  }
+
+  std::vector<DIERef> candidates;
+  const auto& short_name_dies = lazy_index_->dies[tag];
+  for (std::string_view short_name : ShortNameCandidates(name)) {
+    auto iter = short_name_dies.find(short_name);
+    if (iter != short_name_dies.end()) {
+      candidates.insert(candidates.end(), iter->second.begin(), iter->second.end());
+    }
+  }
+  // Like IndexDIEs(), keep the first match in the order of the DWARF info.
+  std::sort(candidates.begin(), candidates.end());
+
+  for (const auto& [unit_index, die_index] : candidates) {
+    DWARFDie die = dwarf_context_->getUnitAtIndex(unit_index)->getDIEAtIndex(die_index);
+    if (QualifiedName(die) != name) {
+      continue;
+    }
+    if (die.isSubprogramDIE()) {
+      auto spec_iter = lazy_index_->fn_spec_offsets.find(die.getOffset());
+      if (spec_iter != lazy_index_->fn_spec_offsets.end()) {
+        const auto& [spec_unit_index, spec_die_index] = spec_iter->second;
+        die = dwarf_context_->getUnitAtIndex(spec_unit_index)->getDIEAtIndex(spec_die_index);
+      }
+    }
+    InsertToDIEMap(name, tag, die);
+    return die;
+  }
+
+  lazy_index_->misses[tag].insert(name);
+  return std::nullopt;
+}
+
 StatusOr<std::vector<DWARFDie>> DwarfReader::GetMatchingDIEs(
     std::string_view name, std::optional<llvm::dwarf::Tag> type_opt) {
   DCHECK(dwarf_context_ != nullptr);
 
+  if (type_opt.has_value() && IsIndexedType(type_opt.value()) && lazy_index_ != nullptr) {
+    auto die_opt = FindInLazyIndex(std::string(name), type_opt.value());
+    if (die_opt.has_value()) {
+      return std::vector<DWARFDie>{die_opt.value()};
+    }
+    return std::vector<DWARFDie>{};
+  }
+
   // Special case for types that are indexed.
   if (type_opt.has_value() && IsIndexedType(type_opt.value()) && !die_map_.empty()) {
     auto die_opt = FindInDIEMap(std::string(name), type_opt.value());
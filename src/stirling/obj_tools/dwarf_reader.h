@@ -22,6 +22,7 @@
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
 #include <filesystem>
 #include <limits>
@@ -161,6 +162,16 @@ class DwarfReader {
   static StatusOr<std::unique_ptr<DwarfReader>> CreateWithSelectiveIndexing(
       const std::filesystem::path& path, const std::vector<SymbolSearchPattern>& symbol_patterns);
 
+  /**
+   * Creates a DwarfReader whose index is built on the first lookup of an indexed DIE type.
+   * Compilation units are scanned on up to num_threads threads, recording only the short names and
+   * positions of the indexed DIEs; full names are assembled, and the DIEs cached, only for the
+   * names that are actually looked up. Preferable to CreateIndexingAll() when only a handful of
+   * symbols are needed from a large binary.
+   */
+  static StatusOr<std::unique_ptr<DwarfReader>> CreateWithLazyIndexing(
+      const std::filesystem::path& path, int num_threads = 1);
+
   /**
    * Searches the debug information for Debugging information entries (DIEs)
    * that match the name.
@@ -314,6 +325,14 @@ class DwarfReader {
   Status FlattenedStructSpec(const llvm::DWARFDie& struct_die, std::vector<StructSpecEntry>* output,
                              const std::string& path_prefix, int offset);
 
+  // Scans all units for the DIEs of the indexed types, and records their positions by short name.
+  // Used by the lazy indexing mode; see CreateWithLazyIndexing().
+  void BuildLazyIndex();
+
+  // Looks up a DIE in the lazy index, building the index first if needed. Resolved DIEs are cached
+  // in die_map_, so the qualified names only need to be assembled once.
+  std::optional<llvm::DWARFDie> FindInLazyIndex(const std::string& name, llvm::dwarf::Tag tag);
+
   void InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, llvm::DWARFDie die);
   std::optional<llvm::DWARFDie> FindInDIEMap(const std::string& name, llvm::dwarf::Tag tag) const;
 
@@ -328,6 +347,29 @@ class DwarfReader {
 
   // Nested map: [tag][symbol_name] -> DWARFDie
   absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, llvm::DWARFDie>> die_map_;
+
+  // Position of a DIE: the index of its unit, and its index within the unit.
+  using DIERef = std::pair<uint32_t, uint32_t>;
+
+  struct LazyIndex {
+    int num_threads = 1;
+    bool built = false;
+
+    // Nested map: [tag][short_name] -> positions of the DIEs, in no particular order.
+    // The names point into the DWARF string sections, which live as long as dwarf_context_.
+    absl::flat_hash_map<llvm::dwarf::Tag,
+                        absl::flat_hash_map<std::string_view, std::vector<DIERef>>>
+        dies;
+
+    // Map from DW_AT_specification to the DW_TAG_subprogram DIE carrying it.
+    absl::flat_hash_map<uint64_t, DIERef> fn_spec_offsets;
+
+    // Names that have been looked up without a match, so the search is not repeated.
+    absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_set<std::string>> misses;
+  };
+
+  // Only set when the reader was created with CreateWithLazyIndexing().
+  std::unique_ptr<LazyIndex> lazy_index_;
 };
 
 }  // namespace obj_tools
@@ -25,9 +25,12 @@
 using px::stirling::obj_tools::DwarfReader;
 using px::testing::BazelRunfilePath;
 
-constexpr std::string_view kBinary =
+constexpr std::string_view kGRPCServerBinary =
     "src/stirling/testing/demo_apps/go_grpc_tls_pl/server/golang_1_19_grpc_tls_server_binary_/"
     "golang_1_19_grpc_tls_server_binary";
+// A real-world service, with considerably more debug info than the demo app.
+constexpr std::string_view kSockShopBinary =
+    "src/stirling/obj_tools/testdata/go/sockshop_payments_service";
 
 struct SymAddrs {
   // Members of net/http.http2serverConn.
@@ -72,14 +75,15 @@ void GetSymAddrs(DwarfReader* dwarf_reader, SymAddrs* symaddrs) {
 }
 
 // NOLINTNEXTLINE : runtime/references.
-static void BM_noindex(benchmark::State& state) {
+static void BM_noindex(benchmark::State& state, std::string_view binary) {
   size_t num_lookup_iterations = state.range(0);
+  const std::string path = BazelRunfilePath(binary);
 
   for (auto _ : state) {
     SymAddrs symaddrs;
 
     PX_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
-                      DwarfReader::CreateWithoutIndexing(kBinary));
+                      DwarfReader::CreateWithoutIndexing(path));
 
     for (size_t i = 0; i < num_lookup_iterations; ++i) {
       GetSymAddrs(dwarf_reader.get(), &symaddrs);
@@ -89,14 +93,15 @@ static void BM_noindex(benchmark::State& state) {
 }
 
 // NOLINTNEXTLINE : runtime/references.
-static void BM_indexed(benchmark::State& state) {
+static void BM_indexed(benchmark::State& state, std::string_view binary) {
   size_t num_lookup_iterations = state.range(0);
+  const std::string path = BazelRunfilePath(binary);
 
   for (auto _ : state) {
     SymAddrs symaddrs;
 
     PX_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
-                      DwarfReader::CreateIndexingAll(kBinary));
+                      DwarfReader::CreateIndexingAll(path));
 
     for (size_t i = 0; i < num_lookup_iterations; ++i) {
       GetSymAddrs(dwarf_reader.get(), &symaddrs);
@@ -105,5 +110,31 @@ static void BM_indexed(benchmark::State& state) {
   }
 }
 
-BENCHMARK(BM_noindex)->RangeMultiplier(2)->Range(1, 16);
-BENCHMARK(BM_indexed)->RangeMultiplier(2)->Range(1, 16);
+// Arguments: number of lookup iterations, number of indexing threads.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_lazy_indexed(benchmark::State& state, std::string_view binary) {
+  size_t num_lookup_iterations = state.range(0);
+  int num_threads = state.range(1);
+  const std::string path = BazelRunfilePath(binary);
+
+  for (auto _ : state) {
+    SymAddrs symaddrs;
+
+    PX_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateWithLazyIndexing(path, num_threads));
+
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      GetSymAddrs(dwarf_reader.get(), &symaddrs);
+      benchmark::DoNotOptimize(symaddrs);
+    }
+  }
+}
+
+BENCHMARK_CAPTURE(BM_noindex, grpc_server, kGRPCServerBinary)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK_CAPTURE(BM_indexed, grpc_server, kGRPCServerBinary)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK_CAPTURE(BM_lazy_indexed, grpc_server, kGRPCServerBinary)
+    ->ArgsProduct({{1, 16}, {1, 2, 4}});
+
+BENCHMARK_CAPTURE(BM_noindex, sockshop, kSockShopBinary)->Arg(1);
+BENCHMARK_CAPTURE(BM_indexed, sockshop, kSockShopBinary)->RangeMultiplier(4)->Range(1, 16);
+BENCHMARK_CAPTURE(BM_lazy_indexed, sockshop, kSockShopBinary)->ArgsProduct({{1, 16}, {1, 2, 4}});
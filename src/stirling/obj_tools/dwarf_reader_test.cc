@@ -64,14 +64,25 @@ using ::testing::UnorderedElementsAre;
 // Automatically converts ToString() to stream operator for gtest.
 using ::px::operator<<;
 
+enum class Indexing {
+  kNone,
+  kAll,
+  kLazy,
+};
+
 struct DwarfReaderTestParam {
   std::string binary_path;
-  bool index;
+  Indexing index;
 };
 
-auto CreateDwarfReader(const std::filesystem::path& path, bool indexing) {
-  if (indexing) {
-    return DwarfReader::CreateIndexingAll(path);
+auto CreateDwarfReader(const std::filesystem::path& path, Indexing indexing) {
+  switch (indexing) {
+    case Indexing::kAll:
+      return DwarfReader::CreateIndexingAll(path);
+    case Indexing::kLazy:
+      return DwarfReader::CreateWithLazyIndexing(path, /*num_threads*/ 4);
+    case Indexing::kNone:
+      break;
   }
   return DwarfReader::CreateWithoutIndexing(path);
 }
@@ -108,7 +119,7 @@ class GolangDwarfReaderTest : public ::testing::TestWithParam<DwarfReaderTestPar
   std::unique_ptr<DwarfReader> dwarf_reader;
 };
 
-class GolangDwarfReaderIndexTest : public ::testing::TestWithParam<bool> {
+class GolangDwarfReaderIndexTest : public ::testing::TestWithParam<Indexing> {
   std::unique_ptr<DwarfReader> dwarf_reader;
 };
 
@@ -520,7 +531,7 @@ TEST_P(GolangDwarfReaderTest, DISABLED_FunctionVarLocationConsistency) {
 
 // Inspired from a real life case.
 TEST_P(GolangDwarfReaderIndexTest, UnconventionalGetStructMemberOffset) {
-  bool index = GetParam();
+  Indexing index = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
                        CreateDwarfReader(kGoBinaryUnconventionalPath, index));
 
@@ -528,7 +539,7 @@ TEST_P(GolangDwarfReaderIndexTest, UnconventionalGetStructMemberOffset) {
 }
 
 TEST_P(GolangDwarfReaderIndexTest, FunctionArgInfo) {
-  bool index = GetParam();
+  Indexing index = GetParam();
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<DwarfReader> dwarf_reader,
                        CreateDwarfReader(kGoServerBinaryPath, index));
 
@@ -559,23 +570,30 @@ TEST_P(GolangDwarfReaderIndexTest, FunctionArgInfo) {
 }
 
 INSTANTIATE_TEST_SUITE_P(CppDwarfReaderParameterizedTest, CppDwarfReaderTest,
-                         ::testing::Values(DwarfReaderTestParam{kCPPBinaryPath, true},
-                                           DwarfReaderTestParam{kCPPBinaryPath, false}));
+                         ::testing::Values(DwarfReaderTestParam{kCPPBinaryPath, Indexing::kAll},
+                                           DwarfReaderTestParam{kCPPBinaryPath, Indexing::kNone},
+                                           DwarfReaderTestParam{kCPPBinaryPath, Indexing::kLazy}));
 
 INSTANTIATE_TEST_SUITE_P(GolangDwarfReaderParameterizedTest, GolangDwarfReaderTest,
-                         ::testing::Values(DwarfReaderTestParam{kGo1_17BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_17BinaryPath, false},
-                                           DwarfReaderTestParam{kGo1_18BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_18BinaryPath, false},
-                                           DwarfReaderTestParam{kGo1_19BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_19BinaryPath, false},
-                                           DwarfReaderTestParam{kGo1_20BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_20BinaryPath, false},
-                                           DwarfReaderTestParam{kGo1_21BinaryPath, true},
-                                           DwarfReaderTestParam{kGo1_21BinaryPath, false}));
+                         ::testing::Values(DwarfReaderTestParam{kGo1_17BinaryPath, Indexing::kAll},
+                                           DwarfReaderTestParam{kGo1_17BinaryPath, Indexing::kNone},
+                                           DwarfReaderTestParam{kGo1_17BinaryPath, Indexing::kLazy},
+                                           DwarfReaderTestParam{kGo1_18BinaryPath, Indexing::kAll},
+                                           DwarfReaderTestParam{kGo1_18BinaryPath, Indexing::kNone},
+                                           DwarfReaderTestParam{kGo1_18BinaryPath, Indexing::kLazy},
+                                           DwarfReaderTestParam{kGo1_19BinaryPath, Indexing::kAll},
+                                           DwarfReaderTestParam{kGo1_19BinaryPath, Indexing::kNone},
+                                           DwarfReaderTestParam{kGo1_19BinaryPath, Indexing::kLazy},
+                                           DwarfReaderTestParam{kGo1_20BinaryPath, Indexing::kAll},
+                                           DwarfReaderTestParam{kGo1_20BinaryPath, Indexing::kNone},
+                                           DwarfReaderTestParam{kGo1_20BinaryPath, Indexing::kLazy},
+                                           DwarfReaderTestParam{kGo1_21BinaryPath, Indexing::kAll},
+                                           DwarfReaderTestParam{kGo1_21BinaryPath, Indexing::kNone},
+                                           DwarfReaderTestParam{kGo1_21BinaryPath,
+                                                                Indexing::kLazy}));
 
 INSTANTIATE_TEST_SUITE_P(GolangDwarfReaderParameterizedIndexTest, GolangDwarfReaderIndexTest,
-                         ::testing::Values(true, false));
+                         ::testing::Values(Indexing::kAll, Indexing::kNone, Indexing::kLazy));
 }  // namespace obj_tools
 }  // namespace stirling
 }  // namespace px
@@ -44,8 +44,54 @@ struct LowercaseHex {
   static inline constexpr int kSizePerByte = 2;
   static inline constexpr bool kKeepPrintableChars = false;
 };
+
+// Returns the "desc" field of the first note in a SHT_NOTE section, or an empty view if the
+// section is malformed. Structure of a note:
+//    namesz :   32-bit, size of "name" field
+//    descsz :   32-bit, size of "desc" field
+//    type   :   32-bit, vendor specific "type"
+//    name   :   "namesz" bytes, null-terminated string, padded to 4 bytes
+//    desc   :   "descsz" bytes, binary data
+std::string_view NoteDesc(const ELFIO::section* psec) {
+  constexpr size_t kHeaderSize = 3 * sizeof(int32_t);
+  const size_t section_size = psec->get_size();
+  if (psec->get_data() == nullptr || section_size < kHeaderSize) {
+    return {};
+  }
+  uint32_t name_size =
+      utils::LEndianBytesToInt<uint32_t>(std::string_view(psec->get_data(), sizeof(int32_t)));
+  uint32_t desc_size = utils::LEndianBytesToInt<uint32_t>(
+      std::string_view(psec->get_data() + sizeof(int32_t), sizeof(int32_t)));
+
+  size_t desc_pos = kHeaderSize + ((static_cast<size_t>(name_size) + 3) & ~size_t{3});
+  if (desc_pos > section_size || desc_size > section_size - desc_pos) {
+    return {};
+  }
+  return std::string_view(psec->get_data() + desc_pos, desc_size);
+}
 }  // namespace
 
+StatusOr<std::string> ElfReader::BuildID() {
+  // Prefer the linker's build-id, which is a hash over the binary contents.
+  // Go binaries that are linked internally don't carry one, but the Go toolchain records its own
+  // content-derived build ID in a separate note.
+  for (std::string_view section_name : {".note.gnu.build-id", ".note.go.buildid"}) {
+    StatusOr<ELFIO::section*> psec_or = SectionWithName(section_name);
+    if (!psec_or.ok()) {
+      continue;
+    }
+    std::string_view desc = NoteDesc(psec_or.ValueOrDie());
+    if (desc.empty()) {
+      continue;
+    }
+    if (section_name == ".note.go.buildid") {
+      return absl::StrCat("go:", desc);
+    }
+    return absl::StrCat("gnu:", BytesToString<LowercaseHex>(desc));
+  }
+  return error::NotFound("Binary $0 has no build-id.", binary_path_);
+}
+
 Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir) {
   std::string build_id;
   std::string debug_link;
@@ -66,21 +112,7 @@ Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir
 
     // Method 1: build-id.
     if (psec->get_name() == ".note.gnu.build-id") {
-      // Structure of this section:
-      //    namesz :   32-bit, size of "name" field
-      //    descsz :   32-bit, size of "desc" field
-      //    type   :   32-bit, vendor specific "type"
-      //    name   :   "namesz" bytes, null-terminated string
-      //    desc   :   "descsz" bytes, binary data
-      int32_t name_size =
-          utils::LEndianBytesToInt<int32_t>(std::string_view(psec->get_data(), sizeof(int32_t)));
-      int32_t desc_size = utils::LEndianBytesToInt<int32_t>(
-          std::string_view(psec->get_data() + sizeof(int32_t), sizeof(int32_t)));
-
-      int32_t desc_pos = 3 * sizeof(int32_t) + name_size;
-      std::string_view desc = std::string_view(psec->get_data() + desc_pos, desc_size);
-
-      build_id = BytesToString<LowercaseHex>(desc);
+      build_id = BytesToString<LowercaseHex>(NoteDesc(psec));
       VLOG(1) << absl::Substitute("Found build-id: $0", build_id);
     }
 
@@ -406,6 +438,14 @@ void ElfReader::Symbolizer::AddEntry(size_t addr, size_t size, std::string name)
   symbols_.emplace(addr, SymbolAddrInfo{size, std::move(name)});
 }
 
+size_t ElfReader::Symbolizer::MemoryUsageBytes() const {
+  size_t bytes = sizeof(*this);
+  for (const auto& [addr, info] : symbols_) {
+    bytes += sizeof(addr) + sizeof(info) + info.name.capacity();
+  }
+  return bytes;
+}
+
 std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
   static std::string symbol_str;
 
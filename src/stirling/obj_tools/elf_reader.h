@@ -138,6 +138,16 @@ class ElfReader {
      */
     std::string_view Lookup(uintptr_t addr) const;
 
+    /**
+     * Number of symbols held by the symbolizer.
+     */
+    size_t NumSymbols() const { return symbols_.size(); }
+
+    /**
+     * Approximate number of bytes held by the symbolizer (used for memory stats only).
+     */
+    size_t MemoryUsageBytes() const;
+
    private:
     struct SymbolAddrInfo {
       size_t size;
@@ -171,6 +181,14 @@ class ElfReader {
    */
   StatusOr<ELFIO::section*> SectionWithName(std::string_view section_name);
 
+  /**
+   * Returns an identifier for the contents of this binary, taken from its .note.gnu.build-id
+   * section or, for Go binaries without one, its .note.go.buildid section. The result is prefixed
+   * with the kind of note it came from (e.g. "gnu:0123abcd").
+   * Returns NotFound if the binary carries neither note.
+   */
+  StatusOr<std::string> BuildID();
+
   /**
    * Returns the ELF type of this binary. (eg. ELFIO::ET_EXEC or ELFIO::ET_DYN).
    */
@@ -195,6 +195,22 @@ TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
                      ElementsAre(SymbolNameIs("CanYouFindThis")));
 }
 
+TEST(ElfReaderTest, BuildID) {
+  const std::string stripped_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(stripped_bin));
+  EXPECT_OK_AND_EQ(elf_reader->BuildID(), "gnu:7deb0e3f89deba61");
+}
+
+TEST(ElfReaderTest, GolangBuildID) {
+  const std::string kPath =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/go/test_go_1_19_binary");
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(kPath));
+  ASSERT_OK_AND_ASSIGN(std::string build_id, elf_reader->BuildID());
+  EXPECT_THAT(build_id, ::testing::StartsWith("go:"));
+  EXPECT_GT(build_id.size(), std::string_view("go:").size());
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsDebugLink) {
   const std::string stripped_bin =
       px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/test_exe_debuglink");
@@ -65,25 +65,39 @@ void JVMStatsConnector::FindJavaUPIDs(const ConnectorContext& ctx) {
       continue;
     }
     PX_ASSIGN_OR(auto hsperf_data_path, java::HsperfdataPath(pid), continue);
-    java_procs_[upid].hsperf_data_path = hsperf_data_path;
+    JavaProcInfo& java_proc = java_procs_[upid];
+    if (java_proc.hsperf_data_path != hsperf_data_path) {
+      java_proc.hsperf_data_path = hsperf_data_path;
+      java_proc.hsperf_data.reset();
+    }
   }
 }
 
-Status JVMStatsConnector::ExportStats(const md::UPID& upid,
-                                      const std::filesystem::path& hsperf_data_path,
+Status JVMStatsConnector::ExportStats(const md::UPID& upid, JavaProcInfo* java_proc,
                                       DataTable* data_table) const {
-  PX_ASSIGN_OR_RETURN(std::string hsperf_data_str, ReadFileToString(hsperf_data_path));
+  // The file is mapped once, and afterwards only the exported counters are read from it.
+  if (java_proc->hsperf_data == nullptr) {
+    PX_ASSIGN_OR_RETURN(java_proc->hsperf_data,
+                        java::hsperf::MappedHsperfData::Open(java_proc->hsperf_data_path,
+                                                             &java::Stats::IsExportedStat));
+  }
 
-  if (hsperf_data_str.empty()) {
-    // Assume this is a transient failure.
+  StatusOr<std::vector<java::hsperf::Counter>> counters_or = java_proc->hsperf_data->Read();
+  if (error::IsInvalidArgument(counters_or.status())) {
+    // Assumes this is a transient failure, for example the JVM has not initialized the file yet.
     return Status::OK();
   }
+  if (!counters_or.ok()) {
+    java_proc->hsperf_data.reset();
+    return counters_or.status();
+  }
 
-  java::Stats stats(std::move(hsperf_data_str));
-  if (!stats.Parse().ok()) {
-    // Assumes this is a transient failure.
-    return Status::OK();
+  std::vector<java::Stats::Stat> stat_vec;
+  stat_vec.reserve(counters_or.ValueOrDie().size());
+  for (const auto& counter : counters_or.ValueOrDie()) {
+    stat_vec.push_back({counter.name, counter.value});
   }
+  java::Stats stats(std::move(stat_vec));
 
   uint64_t time = AdjustedSteadyClockNowNS();
 
@@ -114,7 +128,7 @@ void JVMStatsConnector::TransferDataImpl(ConnectorContext* ctx) {
     JavaProcInfo& java_proc = iter->second;
 
     md::UPID upid_with_asid(ctx->GetASID(), upid.pid(), upid.start_ts());
-    auto status = ExportStats(upid_with_asid, java_proc.hsperf_data_path, data_table);
+    auto status = ExportStats(upid_with_asid, &java_proc, data_table);
     if (!status.ok()) {
       ++java_proc.export_failure_count;
     }
@@ -30,6 +30,7 @@
 #include "src/shared/upid/upid.h"
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/source_connectors/jvm_stats/jvm_stats_table.h"
+#include "src/stirling/source_connectors/jvm_stats/utils/hsperfdata.h"
 #include "src/stirling/source_connectors/jvm_stats/utils/java.h"
 #include "src/stirling/utils/proc_tracker.h"
 
@@ -64,9 +65,10 @@ class JVMStatsConnector : public SourceConnector {
   // Finds the UPIDs of newly-created processes as monitoring targets.
   void FindJavaUPIDs(const ConnectorContext& ctx);
 
+  struct JavaProcInfo;
+
   // Exports JVM performance metrics to data table.
-  Status ExportStats(const md::UPID& upid, const std::filesystem::path& hsperf_data_path,
-                     DataTable* data_table) const;
+  Status ExportStats(const md::UPID& upid, JavaProcInfo* java_proc, DataTable* data_table) const;
 
   // Keeps track of the currently-running processes. Used to find the newly-created processes.
   ProcTracker proc_tracker_;
@@ -77,6 +79,8 @@ class JVMStatsConnector : public SourceConnector {
     // the process will no longer be monitored.
     int export_failure_count = 0;
     std::filesystem::path hsperf_data_path;
+    // The hsperfdata file, mapped on the first export.
+    std::unique_ptr<java::hsperf::MappedHsperfData> hsperf_data;
   };
   absl::flat_hash_map<md::UPID, JavaProcInfo> java_procs_;
 };
@@ -19,12 +19,17 @@
 #include "src/stirling/source_connectors/jvm_stats/utils/hsperfdata.h"
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <absl/strings/substitute.h>
 #include <algorithm>
 #include <utility>
 
 #include "src/common/base/base.h"
+#include "src/common/base/byte_utils.h"
 
 namespace px {
 namespace stirling {
@@ -32,6 +37,7 @@ namespace java {
 namespace hsperf {
 
 constexpr uint8_t kExpectedMagic[] = {0xCA, 0xFE, 0xC0, 0xC0};
+constexpr size_t kLongByteSize = 8;
 
 namespace {
 
@@ -52,7 +58,6 @@ Status ParseDataEntry(std::string_view buf_view, DataEntry* entry) {
   // jdk.hotspot.agent/share/classes/sun/jvm/hotspot/runtime/PerfDataEntry.java
   if (entry->header->vector_length == 0) {
     if (entry->header->data_type == static_cast<uint8_t>(DataType::kLong)) {
-      constexpr int kLongByteSize = 8;
       entry->data = buf_view.substr(entry->header->data_offset, kLongByteSize);
     } else {
       return error::InvalidArgument("Invalid data type for scalar data");
@@ -106,6 +111,109 @@ Status ParseHsperfData(std::string_view buf_view, HsperfData* data) {
   return Status::OK();
 }
 
+StatusOr<std::unique_ptr<MappedHsperfData>> MappedHsperfData::Open(std::filesystem::path path,
+                                                                   NameFilter name_filter) {
+  std::unique_ptr<MappedHsperfData> data(
+      new MappedHsperfData(std::move(path), std::move(name_filter)));
+  PX_RETURN_IF_ERROR(data->Map());
+  return data;
+}
+
+MappedHsperfData::~MappedHsperfData() { Unmap(); }
+
+Status MappedHsperfData::Map() {
+  Unmap();
+
+  int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Failed to open $0: $1", path_.string(), strerror(errno));
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return error::Internal("Failed to stat $0: $1", path_.string(), strerror(errno));
+  }
+  dev_ = st.st_dev;
+  ino_ = st.st_ino;
+  map_size_ = st.st_size;
+  ++num_maps_;
+
+  // An empty file is left unmapped; Read() reports it as not holding valid data yet.
+  if (map_size_ == 0) {
+    return Status::OK();
+  }
+  void* map = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    map_size_ = 0;
+    return error::Internal("Failed to mmap $0: $1", path_.string(), strerror(errno));
+  }
+  map_ = map;
+  return Status::OK();
+}
+
+void MappedHsperfData::Unmap() {
+  if (map_ != nullptr) {
+    munmap(map_, map_size_);
+  }
+  map_ = nullptr;
+  map_size_ = 0;
+  indexed_ = false;
+  index_.clear();
+}
+
+Status MappedHsperfData::Index() {
+  indexed_ = false;
+  index_.clear();
+
+  HsperfData data = {};
+  PX_RETURN_IF_ERROR(ParseHsperfData(buf(), &data));
+  for (const auto& entry : data.data_entries) {
+    if (entry.header->data_type != static_cast<uint8_t>(DataType::kLong) ||
+        entry.header->vector_length != 0 || entry.data.size() != kLongByteSize ||
+        !name_filter_(entry.name)) {
+      continue;
+    }
+    const size_t offset = entry.data.data() - buf().data();
+    index_.push_back({std::string(entry.name), offset});
+  }
+  indexed_num_entries_ = data.prologue->num_entries;
+  indexed_used_ = data.prologue->used;
+  indexed_ = true;
+  ++num_indexes_;
+  return Status::OK();
+}
+
+StatusOr<std::vector<Counter>> MappedHsperfData::Read() {
+  // The JVM doesn't resize its file, but a new JVM can replace it. Checking this before reading
+  // also avoids touching pages past the end of a file that was truncated (which would be a
+  // SIGBUS).
+  struct stat st;
+  if (stat(path_.c_str(), &st) != 0) {
+    return error::Internal("Failed to stat $0: $1", path_.string(), strerror(errno));
+  }
+  if (st.st_dev != dev_ || st.st_ino != ino_ || static_cast<size_t>(st.st_size) != map_size_) {
+    PX_RETURN_IF_ERROR(Map());
+  }
+
+  if (map_size_ < sizeof(Prologue)) {
+    return error::InvalidArgument("Not enough data");
+  }
+  const auto* prologue = reinterpret_cast<const Prologue*>(map_);
+  if (!indexed_ || prologue->num_entries != indexed_num_entries_ ||
+      prologue->used != indexed_used_) {
+    PX_RETURN_IF_ERROR(Index());
+  }
+
+  std::vector<Counter> counters;
+  counters.reserve(index_.size());
+  for (const auto& counter : index_) {
+    counters.push_back({counter.name, ::px::utils::LEndianBytesToInt<uint64_t>(
+                                          buf().substr(counter.offset, kLongByteSize))});
+  }
+  return counters;
+}
+
 }  // namespace hsperf
 }  // namespace java
 }  // namespace stirling
@@ -18,8 +18,14 @@
 
 #pragma once
 
+#include <sys/types.h>
+
 #include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/common/base/base.h"
@@ -100,6 +106,76 @@ struct HsperfData {
  */
 Status ParseHsperfData(std::string_view buf_view, HsperfData* data);
 
+struct Counter {
+  std::string_view name;
+  uint64_t value;
+};
+
+/**
+ * Reads selected long counters from a hsperfdata file, without reading and parsing the whole file
+ * each time.
+ *
+ * The JVM updates the counters in place in its hsperfdata file, which it maps into memory. This
+ * maps the file as well, indexes the offsets of the counters selected by the name filter on the
+ * first read, and afterwards only reads those offsets. The file is mapped again if it is replaced
+ * or resized, and re-indexed if the JVM adds entries.
+ */
+class MappedHsperfData : public NotCopyMoveable {
+ public:
+  using NameFilter = std::function<bool(std::string_view name)>;
+
+  /**
+   * Maps the hsperfdata file at the given path. The file is only parsed by the first Read().
+   */
+  static StatusOr<std::unique_ptr<MappedHsperfData>> Open(std::filesystem::path path,
+                                                          NameFilter name_filter);
+
+  ~MappedHsperfData();
+
+  /**
+   * Returns the current values of the selected counters. The names are valid until the next call.
+   * Returns an InvalidArgument error if the file does not hold valid hsperfdata (yet), and other
+   * errors if the file could not be read.
+   */
+  StatusOr<std::vector<Counter>> Read();
+
+  // The number of times the file was mapped and indexed. Exposed for testing.
+  int num_maps() const { return num_maps_; }
+  int num_indexes() const { return num_indexes_; }
+
+ private:
+  struct IndexedCounter {
+    std::string name;
+    size_t offset;
+  };
+
+  MappedHsperfData(std::filesystem::path path, NameFilter name_filter)
+      : path_(std::move(path)), name_filter_(std::move(name_filter)) {}
+
+  Status Map();
+  void Unmap();
+  Status Index();
+
+  std::string_view buf() const { return {static_cast<const char*>(map_), map_size_}; }
+
+  const std::filesystem::path path_;
+  const NameFilter name_filter_;
+
+  void* map_ = nullptr;
+  size_t map_size_ = 0;
+  dev_t dev_ = 0;
+  ino_t ino_ = 0;
+
+  // The number of entries and bytes used by the JVM when the file was indexed.
+  uint32_t indexed_num_entries_ = 0;
+  uint32_t indexed_used_ = 0;
+  std::vector<IndexedCounter> index_;
+  bool indexed_ = false;
+
+  int num_maps_ = 0;
+  int num_indexes_ = 0;
+};
+
 }  // namespace hsperf
 }  // namespace java
 }  // namespace stirling
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+
+#include "src/common/base/base.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/test_environment.h"
+#include "src/stirling/source_connectors/jvm_stats/utils/hsperfdata.h"
+#include "src/stirling/source_connectors/jvm_stats/utils/java.h"
+
+using ::px::ReadFileToString;
+using ::px::stirling::java::Stats;
+using ::px::stirling::java::hsperf::Counter;
+using ::px::stirling::java::hsperf::MappedHsperfData;
+using ::px::testing::BazelRunfilePath;
+using ::px::testing::TempDir;
+
+const std::filesystem::path kTestHsperfdataPath =
+    BazelRunfilePath("src/stirling/source_connectors/jvm_stats/utils/test_hsperfdata");
+
+// Exports the stats the way JVMStatsConnector used to: reads and parses the whole file.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ReadAndParse(benchmark::State& state) {
+  for (auto _ : state) {
+    std::string content = ReadFileToString(kTestHsperfdataPath).ConsumeValueOrDie();
+    Stats stats(std::move(content));
+    PX_CHECK_OK(stats.Parse());
+    benchmark::DoNotOptimize(stats.UsedHeapSizeBytes());
+  }
+}
+
+// Exports the stats from the mapped file, which is indexed on the first read.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_MappedRead(benchmark::State& state) {
+  // Reads a copy, as the mapped file is stat'ed on each read, like the connector does.
+  TempDir temp_dir;
+  const std::filesystem::path path = temp_dir.path() / "hsperfdata";
+  std::filesystem::copy_file(kTestHsperfdataPath, path);
+
+  auto mapped = MappedHsperfData::Open(path, &Stats::IsExportedStat).ConsumeValueOrDie();
+  for (auto _ : state) {
+    std::vector<Counter> counters = mapped->Read().ConsumeValueOrDie();
+    std::vector<Stats::Stat> stat_vec;
+    stat_vec.reserve(counters.size());
+    for (const auto& counter : counters) {
+      stat_vec.push_back({counter.name, counter.value});
+    }
+    Stats stats(std::move(stat_vec));
+    benchmark::DoNotOptimize(stats.UsedHeapSizeBytes());
+  }
+}
+
+BENCHMARK(BM_ReadAndParse);
+BENCHMARK(BM_MappedRead);
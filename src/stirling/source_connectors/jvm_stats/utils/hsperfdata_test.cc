@@ -22,12 +22,16 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
 #include <string>
 #include <utility>
 
 #include "src/common/base/base.h"
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/test_environment.h"
 #include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/jvm_stats/utils/java.h"
 
 namespace px {
 namespace stirling {
@@ -35,13 +39,18 @@ namespace java {
 namespace hsperf {
 
 using ::px::testing::BazelRunfilePath;
+using ::px::testing::TempDir;
+using ::testing::IsEmpty;
+using ::testing::Not;
 using ::testing::SizeIs;
 using ::testing::StrEq;
 
+constexpr std::string_view kTestHsperfdataPath =
+    "src/stirling/source_connectors/jvm_stats/utils/test_hsperfdata";
+
 TEST(PerfDataHeaderTest, ReadFromBytes) {
   ASSERT_OK_AND_ASSIGN(const std::string content,
-                       ReadFileToString(BazelRunfilePath(
-                           "src/stirling/source_connectors/jvm_stats/utils/test_hsperfdata")));
+                       ReadFileToString(BazelRunfilePath(kTestHsperfdataPath)));
 
   HsperfData data;
   EXPECT_OK(ParseHsperfData(std::move(content), &data));
@@ -94,6 +103,106 @@ TEST(PerfDataHeaderTest, NotEnoughData) {
   }
 }
 
+class MappedHsperfDataTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_OK_AND_ASSIGN(content_, ReadFileToString(BazelRunfilePath(kTestHsperfdataPath)));
+    path_ = temp_dir_.path() / "hsperfdata";
+    ASSERT_OK(WriteFileFromString(path_, content_));
+  }
+
+  // Returns the offset of the value of the long entry with the given name in content_.
+  size_t ValueOffset(std::string_view name) {
+    HsperfData data = {};
+    PX_CHECK_OK(ParseHsperfData(content_, &data));
+    for (const auto& entry : data.data_entries) {
+      if (entry.name == name) {
+        return entry.data.data() - content_.data();
+      }
+    }
+    LOG(FATAL) << "No entry named " << name;
+  }
+
+  TempDir temp_dir_;
+  std::filesystem::path path_;
+  std::string content_;
+};
+
+// Tests that the mapped counters match the ones parsed from the whole file.
+TEST_F(MappedHsperfDataTest, ReadMatchesFullParse) {
+  ASSERT_OK_AND_ASSIGN(auto mapped, MappedHsperfData::Open(path_, &Stats::IsExportedStat));
+  ASSERT_OK_AND_ASSIGN(std::vector<Counter> counters, mapped->Read());
+  EXPECT_THAT(counters, Not(IsEmpty()));
+
+  std::vector<Stats::Stat> stat_vec;
+  for (const auto& counter : counters) {
+    EXPECT_TRUE(Stats::IsExportedStat(counter.name));
+    stat_vec.push_back({counter.name, counter.value});
+  }
+  Stats mapped_stats(std::move(stat_vec));
+
+  Stats stats(content_);
+  ASSERT_OK(stats.Parse());
+  EXPECT_EQ(mapped_stats.YoungGCTimeNanos(), stats.YoungGCTimeNanos());
+  EXPECT_EQ(mapped_stats.FullGCTimeNanos(), stats.FullGCTimeNanos());
+  EXPECT_EQ(mapped_stats.UsedHeapSizeBytes(), stats.UsedHeapSizeBytes());
+  EXPECT_EQ(mapped_stats.TotalHeapSizeBytes(), stats.TotalHeapSizeBytes());
+  EXPECT_EQ(mapped_stats.MaxHeapSizeBytes(), stats.MaxHeapSizeBytes());
+}
+
+// Tests that values updated in place are read without indexing the file again, and that a
+// replaced file is mapped and indexed again.
+TEST_F(MappedHsperfDataTest, ReadsUpdatesAndReplacedFile) {
+  constexpr std::string_view kName = "sun.gc.collector.0.time";
+  auto name_filter = [kName](std::string_view name) { return name == kName; };
+  ASSERT_OK_AND_ASSIGN(auto mapped, MappedHsperfData::Open(path_, name_filter));
+
+  ASSERT_OK_AND_ASSIGN(std::vector<Counter> counters, mapped->Read());
+  ASSERT_THAT(counters, SizeIs(1));
+  EXPECT_EQ(counters[0].name, kName);
+  const uint64_t value = counters[0].value;
+
+  // Updates the value in place, like the JVM does.
+  {
+    std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+    const uint64_t new_value = value + 1;
+    file.seekp(ValueOffset(kName));
+    file.write(reinterpret_cast<const char*>(&new_value), sizeof(new_value));
+  }
+  ASSERT_OK_AND_ASSIGN(counters, mapped->Read());
+  ASSERT_THAT(counters, SizeIs(1));
+  EXPECT_EQ(counters[0].value, value + 1);
+  EXPECT_EQ(mapped->num_maps(), 1);
+  EXPECT_EQ(mapped->num_indexes(), 1);
+
+  // Replaces the file, like a restarted JVM with the same PID.
+  const std::filesystem::path new_path = temp_dir_.path() / "hsperfdata.new";
+  ASSERT_OK(WriteFileFromString(new_path, content_));
+  std::filesystem::rename(new_path, path_);
+  ASSERT_OK_AND_ASSIGN(counters, mapped->Read());
+  ASSERT_THAT(counters, SizeIs(1));
+  EXPECT_EQ(counters[0].value, value);
+  EXPECT_EQ(mapped->num_maps(), 2);
+  EXPECT_EQ(mapped->num_indexes(), 2);
+}
+
+// Tests that a file the JVM has not written yet is reported as invalid data, and is read once it
+// is written.
+TEST_F(MappedHsperfDataTest, EmptyFile) {
+  ASSERT_OK(WriteFileFromString(path_, ""));
+  ASSERT_OK_AND_ASSIGN(auto mapped, MappedHsperfData::Open(path_, &Stats::IsExportedStat));
+  auto counters_or = mapped->Read();
+  EXPECT_TRUE(error::IsInvalidArgument(counters_or.status()));
+
+  ASSERT_OK(WriteFileFromString(path_, content_));
+  ASSERT_OK_AND_ASSIGN(std::vector<Counter> counters, mapped->Read());
+  EXPECT_THAT(counters, Not(IsEmpty()));
+}
+
+TEST_F(MappedHsperfDataTest, MissingFile) {
+  EXPECT_NOT_OK(MappedHsperfData::Open(temp_dir_.path() / "missing", &Stats::IsExportedStat));
+}
+
 }  // namespace hsperf
 }  // namespace java
 }  // namespace stirling
@@ -60,34 +60,53 @@ Status Stats::Parse() {
   return Status::OK();
 }
 
-uint64_t Stats::YoungGCTimeNanos() const { return StatForSuffix("gc.collector.0.time"); }
+namespace {
+
+constexpr std::string_view kYoungGCTimeSuffix = "gc.collector.0.time";
+constexpr std::string_view kFullGCTimeSuffix = "gc.collector.1.time";
+constexpr std::string_view kUsedHeapSizeSuffixes[] = {
+    "gc.generation.0.space.0.used",
+    "gc.generation.0.space.1.used",
+    "gc.generation.0.space.2.used",
+    "gc.generation.1.space.0.used",
+};
+constexpr std::string_view kTotalHeapSizeSuffixes[] = {
+    "gc.generation.0.space.0.capacity",
+    "gc.generation.0.space.1.capacity",
+    "gc.generation.0.space.2.capacity",
+    "gc.generation.1.space.0.capacity",
+};
+constexpr std::string_view kMaxHeapSizeSuffixes[] = {
+    "gc.generation.0.maxCapacity",
+    "gc.generation.1.maxCapacity",
+};
+
+bool EndsWithAny(std::string_view name, ArrayView<std::string_view> suffixes) {
+  for (const auto& suffix : suffixes) {
+    if (absl::EndsWith(name, suffix)) {
+      return true;
+    }
+  }
+  return false;
+}
 
-uint64_t Stats::FullGCTimeNanos() const { return StatForSuffix("gc.collector.1.time"); }
+}  // namespace
 
-uint64_t Stats::UsedHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.space.0.used",
-      "gc.generation.0.space.1.used",
-      "gc.generation.0.space.2.used",
-      "gc.generation.1.space.0.used",
-  });
+bool Stats::IsExportedStat(std::string_view name) {
+  return absl::EndsWith(name, kYoungGCTimeSuffix) || absl::EndsWith(name, kFullGCTimeSuffix) ||
+         EndsWithAny(name, kUsedHeapSizeSuffixes) || EndsWithAny(name, kTotalHeapSizeSuffixes) ||
+         EndsWithAny(name, kMaxHeapSizeSuffixes);
 }
 
-uint64_t Stats::TotalHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.space.0.capacity",
-      "gc.generation.0.space.1.capacity",
-      "gc.generation.0.space.2.capacity",
-      "gc.generation.1.space.0.capacity",
-  });
-}
+uint64_t Stats::YoungGCTimeNanos() const { return StatForSuffix(kYoungGCTimeSuffix); }
 
-uint64_t Stats::MaxHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.maxCapacity",
-      "gc.generation.1.maxCapacity",
-  });
-}
+uint64_t Stats::FullGCTimeNanos() const { return StatForSuffix(kFullGCTimeSuffix); }
+
+uint64_t Stats::UsedHeapSizeBytes() const { return SumStatsForSuffixes(kUsedHeapSizeSuffixes); }
+
+uint64_t Stats::TotalHeapSizeBytes() const { return SumStatsForSuffixes(kTotalHeapSizeSuffixes); }
+
+uint64_t Stats::MaxHeapSizeBytes() const { return SumStatsForSuffixes(kMaxHeapSizeSuffixes); }
 
 uint64_t Stats::StatForSuffix(std::string_view suffix) const {
   for (const auto& stat : stats_) {
@@ -98,7 +117,7 @@ uint64_t Stats::StatForSuffix(std::string_view suffix) const {
   return 0;
 }
 
-uint64_t Stats::SumStatsForSuffixes(const std::vector<std::string_view>& suffixes) const {
+uint64_t Stats::SumStatsForSuffixes(ArrayView<std::string_view> suffixes) const {
   uint64_t sum = 0;
   for (const auto& suffix : suffixes) {
     sum += StatForSuffix(suffix);
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "src/common/base/statusor.h"
+#include "src/common/base/types.h"
 
 namespace px {
 namespace stirling {
@@ -50,6 +51,11 @@ class Stats {
    */
   Status Parse();
 
+  /**
+   * Returns true if the stat with the given name is used by any of the exported values below.
+   */
+  static bool IsExportedStat(std::string_view name);
+
   uint64_t YoungGCTimeNanos() const;
   uint64_t FullGCTimeNanos() const;
   uint64_t UsedHeapSizeBytes() const;
@@ -58,7 +64,7 @@ class Stats {
 
  private:
   uint64_t StatForSuffix(std::string_view suffix) const;
-  uint64_t SumStatsForSuffixes(const std::vector<std::string_view>& suffixes) const;
+  uint64_t SumStatsForSuffixes(ArrayView<std::string_view> suffixes) const;
 
   std::string hsperf_data_;
   std::vector<Stat> stats_;
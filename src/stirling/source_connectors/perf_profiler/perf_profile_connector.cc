@@ -21,6 +21,7 @@
 
 #include <sys/sysinfo.h>
 
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <utility>
@@ -51,6 +52,16 @@ DEFINE_double(stirling_profiler_stack_trace_size_factor, 3.0,
 DEFINE_double(stirling_profiler_perf_buffer_size_factor, 1.2,
               "Scaling factor to apply to Profiler's eBPF perf buffer sizes");
 
+DEFINE_string(stirling_profiler_symbol_cache_dir, "",
+              "If non-empty, a directory where the profiler keeps persistent symbol caches, "
+              "so that symbols survive restarts. Empty disables persistent caching.");
+DEFINE_uint32(stirling_profiler_symbol_cache_size_mb, 64,
+              "Maximum size (in MB) of each persistent profiler symbol cache file.");
+
+DEFINE_bool(stirling_profiler_intern_stack_traces, false,
+            "If true, stack trace strings are recorded once per aging period in "
+            "stack_trace_dict.beta, instead of in every row of stack_traces.beta.");
+
 namespace px {
 namespace stirling {
 
@@ -80,6 +91,32 @@ PerfProfileConnector::PerfProfileConnector(std::string_view source_name)
   DCHECK(sampling_period_ >= stack_trace_sampling_period_);
 }
 
+namespace {
+
+// Returns nullptr if persistent caching is disabled or the cache could not be created;
+// the profiler then works as before, just without warm restarts.
+std::unique_ptr<PersistentSymbolCache> CreatePersistentSymbolCache(std::string_view name) {
+  if (FLAGS_stirling_profiler_symbol_cache_dir.empty()) {
+    return nullptr;
+  }
+  const std::filesystem::path dir = FLAGS_stirling_profiler_symbol_cache_dir;
+  const std::filesystem::path path = dir / absl::StrCat(name, ".cache");
+  const size_t max_bytes = size_t{FLAGS_stirling_profiler_symbol_cache_size_mb} * 1024 * 1024;
+
+  auto cache_or = PersistentSymbolCache::Create(path, max_bytes);
+  if (!cache_or.ok()) {
+    LOG(WARNING) << absl::Substitute("PerfProfiler: Persistent symbol cache disabled: $0",
+                                     cache_or.msg());
+    return nullptr;
+  }
+  auto cache = cache_or.ConsumeValueOrDie();
+  LOG(INFO) << absl::Substitute("PerfProfiler: Using persistent symbol cache $0 [reused=$1].",
+                                path.string(), cache->reused());
+  return cache;
+}
+
+}  // namespace
+
 Status PerfProfileConnector::InitImpl() {
   sampling_freq_mgr_.set_period(sampling_period_);
   push_freq_mgr_.set_period(push_period_);
@@ -174,8 +211,12 @@ Status PerfProfileConnector::InitImpl() {
 
   if (FLAGS_stirling_profiler_cache_symbols) {
     // Add a caching layer on top of the existing symbolizer.
-    PX_ASSIGN_OR_RETURN(u_symbolizer_, CachingSymbolizer::Create(std::move(u_symbolizer_)));
-    PX_ASSIGN_OR_RETURN(k_symbolizer_, CachingSymbolizer::Create(std::move(k_symbolizer_)));
+    PX_ASSIGN_OR_RETURN(u_symbolizer_,
+                        CachingSymbolizer::Create(std::move(u_symbolizer_),
+                                                  CreatePersistentSymbolCache("user_symbols")));
+    PX_ASSIGN_OR_RETURN(k_symbolizer_,
+                        CachingSymbolizer::Create(std::move(k_symbolizer_),
+                                                  CreatePersistentSymbolCache("kernel_symbols")));
   }
 
   return Status::OK();
@@ -304,7 +345,7 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
 }
 
 void PerfProfileConnector::CreateRecords(WrappedBCCStackTable* stack_traces, ConnectorContext* ctx,
-                                         DataTable* data_table) {
+                                         DataTable* data_table, DataTable* dict_table) {
   constexpr size_t kMaxSymbolSize = 512;
   constexpr size_t kMaxStackDepth = 64;
   constexpr size_t kMaxStackTraceSize = kMaxStackDepth * kMaxSymbolSize;
@@ -325,17 +366,31 @@ void PerfProfileConnector::CreateRecords(WrappedBCCStackTable* stack_traces, Con
   }
 
   for (const auto& [key, count] : stack_trace_histogram) {
+    const bool intern = dict_table != nullptr;
+    const bool emit_dict_entry = intern && !stack_trace_ids_.SeenThisPeriod(key);
+    const uint64_t stack_trace_id = stack_trace_ids_.Lookup(key);
+
+    if (emit_dict_entry) {
+      DataTable::RecordBuilder<&kStackTraceDictTable> r(dict_table, timestamp_ns);
+      r.Append<r.ColIndex("time_")>(timestamp_ns);
+      r.Append<r.ColIndex("upid")>(key.upid.value());
+      r.Append<r.ColIndex("stack_trace_id")>(stack_trace_id);
+      r.Append<r.ColIndex("stack_trace")>(key.stack_trace_str, kMaxStackTraceSize);
+    }
+
     DataTable::RecordBuilder<&kStackTraceTable> r(data_table, timestamp_ns);
 
     r.Append<r.ColIndex("time_")>(timestamp_ns);
     r.Append<r.ColIndex("upid")>(key.upid.value());
-    r.Append<r.ColIndex("stack_trace_id")>(stack_trace_ids_.Lookup(key));
-    r.Append<r.ColIndex("stack_trace")>(key.stack_trace_str, kMaxStackTraceSize);
+    r.Append<r.ColIndex("stack_trace_id")>(stack_trace_id);
+    r.Append<r.ColIndex("stack_trace")>(intern ? std::string() : key.stack_trace_str,
+                                        kMaxStackTraceSize);
     r.Append<r.ColIndex("count")>(count);
   }
 }
 
-void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table) {
+void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table,
+                                                 DataTable* dict_table) {
   // Choose the maps to consume.
   const bool using_map_set_a = transfer_count_ % 2 == 0;
   auto& stack_traces = using_map_set_a ? stack_traces_a_ : stack_traces_b_;
@@ -355,7 +410,7 @@ void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTabl
   LOG_IF(ERROR, !map_status.ok()) << "Error writing transfer_count_: " << map_status.msg();
 
   // Read BPF stack traces & histogram, build records, incorporate records to data table.
-  CreateRecords(stack_traces.get(), ctx, data_table);
+  CreateRecords(stack_traces.get(), ctx, data_table, dict_table);
 
   const uint64_t num_stack_traces_sampled = profiler_state_->GetValue(sample_count_idx).ValueOr(0);
   CheckProfilerState(num_stack_traces_sampled);
@@ -408,15 +463,19 @@ void PerfProfileConnector::CheckProfilerState(const uint64_t num_stack_traces) {
 }
 
 void PerfProfileConnector::TransferDataImpl(ConnectorContext* ctx) {
-  DCHECK_EQ(data_tables_.size(), 1U);
+  DCHECK_EQ(data_tables_.size(), kTables.size());
 
-  auto* data_table = data_tables_[0];
+  auto* data_table = data_tables_[kPerfProfileTableNum];
 
   if (data_table == nullptr) {
     return;
   }
 
-  ProcessBPFStackTraces(ctx, data_table);
+  // The dictionary table is only populated when interning is enabled (and the table is in use).
+  DataTable* dict_table =
+      FLAGS_stirling_profiler_intern_stack_traces ? data_tables_[kStackTraceDictTableNum] : nullptr;
+
+  ProcessBPFStackTraces(ctx, data_table, dict_table);
 
   // Cleanup the symbolizer so we don't leak memory.
   proc_tracker_.Update(ctx->GetUPIDs());
@@ -450,6 +509,16 @@ void PerfProfileConnector::PrintStats() const {
     LOG(INFO) << absl::Substitute(
         "PerfProfileConnector k_symbolizer num_symbols_cached=$0 hits=$1 accesses=$2 hit_rate=$3",
         k_num_symbols, k_hits, k_accesses, k_hit_rate);
+    for (const auto& [name, symbolizer] : {std::make_pair("u_symbolizer", u_symbolizer),
+                                           std::make_pair("k_symbolizer", k_symbolizer)}) {
+      const PersistentSymbolCache* persistent_cache = symbolizer->persistent_cache();
+      if (persistent_cache != nullptr) {
+        LOG(INFO) << absl::Substitute(
+            "PerfProfileConnector $0 persistent cache hits=$1 misses=$2 evictions=$3", name,
+            persistent_cache->stat_hits(), persistent_cache->stat_misses(),
+            persistent_cache->stat_evictions());
+      }
+    }
   }
 }
 
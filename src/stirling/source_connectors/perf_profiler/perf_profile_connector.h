@@ -52,8 +52,9 @@ static constexpr std::string_view kNotSymbolizedMessage = "<not symbolized>";
 class PerfProfileConnector : public BCCSourceConnector {
  public:
   static constexpr std::string_view kName = "perf_profiler";
-  static constexpr auto kTables = MakeArray(kStackTraceTable);
+  static constexpr auto kTables = MakeArray(kStackTraceTable, kStackTraceDictTable);
   static constexpr uint32_t kPerfProfileTableNum = TableNum(kTables, kStackTraceTable);
+  static constexpr uint32_t kStackTraceDictTableNum = TableNum(kTables, kStackTraceDictTable);
 
   static std::unique_ptr<PerfProfileConnector> Create(std::string_view name) {
     return std::unique_ptr<PerfProfileConnector>(new PerfProfileConnector(name));
@@ -94,11 +95,14 @@ class PerfProfileConnector : public BCCSourceConnector {
 
   explicit PerfProfileConnector(std::string_view source_name);
 
-  void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table);
+  void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table,
+                             DataTable* dict_table);
 
   // Read BPF data structures, build & incorporate records to the table.
+  // If dict_table is non-null, stack traces are interned: the folded string is recorded in
+  // dict_table once per stack trace ID cache aging period, and omitted from data_table.
   void CreateRecords(WrappedBCCStackTable* stack_traces, ConnectorContext* ctx,
-                     DataTable* data_table);
+                     DataTable* data_table, DataTable* dict_table);
 
   StackTraceHisto AggregateStackTraces(ConnectorContext* ctx, WrappedBCCStackTable* stack_traces);
 
@@ -49,6 +49,12 @@ class StackTraceIDCache {
   uint64_t Lookup(const profiler::SymbolicStackTrace& stack_trace);
   void AgeTick();
 
+  // Returns true if the stack trace has been looked up since the last AgeTick().
+  // Used to emit each interned stack trace into the dictionary table once per aging period.
+  bool SeenThisPeriod(const profiler::SymbolicStackTrace& stack_trace) const {
+    return stack_trace_ids_.contains(stack_trace);
+  }
+
  private:
   absl::flat_hash_map<profiler::SymbolicStackTrace, uint64_t> stack_trace_ids_;
   absl::flat_hash_map<profiler::SymbolicStackTrace, uint64_t> prev_stack_trace_ids_;
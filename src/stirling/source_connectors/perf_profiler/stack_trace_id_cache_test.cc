@@ -51,5 +51,23 @@ TEST(StackTraceIDCache, Basic) {
   EXPECT_NE(stack_trace_ids.Lookup(kStackTrace2), id2);
 }
 
+TEST(StackTraceIDCache, SeenThisPeriod) {
+  StackTraceIDCache stack_trace_ids;
+
+  const md::UPID kUPID(1, 1, 1);
+  const profiler::SymbolicStackTrace kStackTrace{kUPID, "a();b();c();"};
+
+  EXPECT_FALSE(stack_trace_ids.SeenThisPeriod(kStackTrace));
+  const uint64_t id = stack_trace_ids.Lookup(kStackTrace);
+  EXPECT_TRUE(stack_trace_ids.SeenThisPeriod(kStackTrace));
+
+  // After aging, the stack trace keeps its ID but is reported as unseen until looked up again,
+  // so that it is re-emitted into the dictionary table once per period.
+  stack_trace_ids.AgeTick();
+  EXPECT_FALSE(stack_trace_ids.SeenThisPeriod(kStackTrace));
+  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace), id);
+  EXPECT_TRUE(stack_trace_ids.SeenThisPeriod(kStackTrace));
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -38,7 +38,8 @@ static constexpr DataElement kElements[] = {
     {"stack_trace",
      "A stack trace within the sampled process, in folded format. "
      "The call stack symbols are separated by semicolons. "
-     "If symbols cannot be resolved, addresses are populated instead.",
+     "If symbols cannot be resolved, addresses are populated instead. "
+     "Empty when stack traces are interned; see `stack_trace_dict.beta`.",
      types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
     {"count",
      "Number of times the stack trace has been sampled.",
@@ -54,11 +55,36 @@ constexpr auto kStackTraceTable = DataTableSchema(
 // clang-format on
 DEFINE_PRINT_TABLE(StackTrace)
 
+// clang-format off
+static constexpr DataElement kDictElements[] = {
+    canonical_data_elements::kTime,
+    canonical_data_elements::kUPID,
+    {"stack_trace_id",
+     "The stack trace identifier, as used in the `stack_trace_id` column of `stack_traces.beta`.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"stack_trace",
+     "The stack trace in folded format. The call stack symbols are separated by semicolons.",
+     types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+};
+
+constexpr auto kStackTraceDictTable = DataTableSchema(
+        "stack_trace_dict.beta",
+        "Dictionary of interned stack traces, mapping (upid, stack_trace_id) to the folded "
+        "stack trace string. An entry is recorded the first time a stack trace is observed "
+        "in each ID cache aging period. Only populated when stack trace interning is enabled.",
+        kDictElements
+);
+// clang-format on
+DEFINE_PRINT_TABLE(StackTraceDict)
+
 constexpr int kStackTraceTimeIdx = kStackTraceTable.ColIndex("time_");
 constexpr int kStackTraceUPIDIdx = kStackTraceTable.ColIndex("upid");
 constexpr int kStackTraceStackTraceIDIdx = kStackTraceTable.ColIndex("stack_trace_id");
 constexpr int kStackTraceStackTraceStrIdx = kStackTraceTable.ColIndex("stack_trace");
 constexpr int kStackTraceCountIdx = kStackTraceTable.ColIndex("count");
 
+constexpr int kStackTraceDictStackTraceIDIdx = kStackTraceDictTable.ColIndex("stack_trace_id");
+constexpr int kStackTraceDictStackTraceStrIdx = kStackTraceDictTable.ColIndex("stack_trace");
+
 }  // namespace stirling
 }  // namespace px
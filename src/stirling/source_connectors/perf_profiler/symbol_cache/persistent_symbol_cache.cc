@@ -0,0 +1,190 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/persistent_symbol_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <absl/strings/ascii.h>
+
+#include "xxhash.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+constexpr char kMagic[8] = {'P', 'X', 'S', 'Y', 'M', 'C', 'C', 'H'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kBootIDSize = 40;
+constexpr char kBootIDPath[] = "/proc/sys/kernel/random/boot_id";
+}  // namespace
+
+struct PersistentSymbolCache::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t slot_size;
+  uint64_t num_sets;
+  char boot_id[kBootIDSize];
+  // A logical clock, used to track the recency of each slot.
+  uint64_t clock;
+};
+
+struct PersistentSymbolCache::Slot {
+  uint64_t key;
+  uint64_t addr;
+  // Zero means the slot is empty.
+  uint64_t last_use;
+  uint16_t symbol_size;
+  char symbol[kMaxSymbolSize];
+};
+
+StatusOr<std::unique_ptr<PersistentSymbolCache>> PersistentSymbolCache::Create(
+    const std::filesystem::path& path, size_t max_bytes) {
+  PX_ASSIGN_OR_RETURN(std::string boot_id, ReadFileToString(kBootIDPath));
+  return Create(path, max_bytes, absl::StripAsciiWhitespace(boot_id));
+}
+
+StatusOr<std::unique_ptr<PersistentSymbolCache>> PersistentSymbolCache::Create(
+    const std::filesystem::path& path, size_t max_bytes, std::string_view boot_id) {
+  // The header occupies the first slot.
+  const size_t num_sets = (max_bytes / kSlotSize - 1) / kWays;
+  if (num_sets == 0) {
+    return error::InvalidArgument("Persistent symbol cache size $0 is too small.", max_bytes);
+  }
+  const size_t map_size = kSlotSize * (1 + num_sets * kWays);
+
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd == -1) {
+    return error::Internal("Failed to open persistent symbol cache $0. errno=$1", path.string(),
+                           errno);
+  }
+  DEFER(close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    return error::Internal("Failed to stat persistent symbol cache $0. errno=$1", path.string(),
+                           errno);
+  }
+  const bool size_matches = static_cast<size_t>(st.st_size) == map_size;
+  if (!size_matches && ftruncate(fd, map_size) == -1) {
+    return error::Internal("Failed to size persistent symbol cache $0. errno=$1", path.string(),
+                           errno);
+  }
+
+  void* map = mmap(/*addr*/ nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                   /*offset*/ 0);
+  if (map == MAP_FAILED) {
+    return error::Internal("Failed to mmap persistent symbol cache $0. errno=$1", path.string(),
+                           errno);
+  }
+
+  auto cache =
+      std::unique_ptr<PersistentSymbolCache>(new PersistentSymbolCache(map, map_size, num_sets));
+
+  Header* header = cache->header();
+  const std::string_view stored_boot_id(header->boot_id, strnlen(header->boot_id, kBootIDSize));
+  const bool valid = size_matches && std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+                     header->version == kVersion && header->slot_size == kSlotSize &&
+                     header->num_sets == num_sets && stored_boot_id == boot_id;
+  if (valid) {
+    cache->reused_ = true;
+    return cache;
+  }
+
+  // Start from an empty cache.
+  std::memset(map, 0, map_size);
+  std::memcpy(header->magic, kMagic, sizeof(kMagic));
+  header->version = kVersion;
+  header->slot_size = kSlotSize;
+  header->num_sets = num_sets;
+  std::memcpy(header->boot_id, boot_id.data(), std::min(boot_id.size(), kBootIDSize - 1));
+  header->clock = 0;
+  return cache;
+}
+
+PersistentSymbolCache::PersistentSymbolCache(void* map, size_t map_size, size_t num_sets)
+    : map_(map), map_size_(map_size), num_sets_(num_sets) {
+  static_assert(sizeof(Slot) == kSlotSize);
+  static_assert(sizeof(Header) <= kSlotSize);
+}
+
+PersistentSymbolCache::~PersistentSymbolCache() { munmap(map_, map_size_); }
+
+PersistentSymbolCache::Header* PersistentSymbolCache::header() const {
+  return static_cast<Header*>(map_);
+}
+
+PersistentSymbolCache::Slot* PersistentSymbolCache::SetBegin(uint64_t key, uintptr_t addr) const {
+  const uint64_t hash = XXH64(&addr, sizeof(addr), key);
+  Slot* slots = reinterpret_cast<Slot*>(static_cast<char*>(map_) + kSlotSize);
+  return slots + (hash % num_sets_) * kWays;
+}
+
+std::optional<std::string_view> PersistentSymbolCache::Lookup(uint64_t key, uintptr_t addr) {
+  Slot* set = SetBegin(key, addr);
+  for (size_t i = 0; i < kWays; ++i) {
+    Slot& slot = set[i];
+    if (slot.last_use != 0 && slot.key == key && slot.addr == addr &&
+        slot.symbol_size <= kMaxSymbolSize) {
+      slot.last_use = ++header()->clock;
+      ++stat_hits_;
+      return std::string_view(slot.symbol, slot.symbol_size);
+    }
+  }
+  ++stat_misses_;
+  return std::nullopt;
+}
+
+void PersistentSymbolCache::Insert(uint64_t key, uintptr_t addr, std::string_view symbol) {
+  if (symbol.size() > kMaxSymbolSize) {
+    return;
+  }
+
+  // Pick the slot holding the same entry, or else an empty slot, or else the LRU slot.
+  Slot* set = SetBegin(key, addr);
+  Slot* victim = &set[0];
+  for (size_t i = 0; i < kWays; ++i) {
+    Slot& slot = set[i];
+    if (slot.last_use != 0 && slot.key == key && slot.addr == addr) {
+      victim = &slot;
+      break;
+    }
+    if (slot.last_use < victim->last_use) {
+      victim = &slot;
+    }
+  }
+  if (victim->last_use != 0 && (victim->key != key || victim->addr != addr)) {
+    ++stat_evictions_;
+  }
+
+  // Mark the slot empty while it is rewritten, so that a torn write is never read back.
+  victim->last_use = 0;
+  victim->key = key;
+  victim->addr = addr;
+  victim->symbol_size = symbol.size();
+  std::memcpy(victim->symbol, symbol.data(), symbol.size());
+  victim->last_use = ++header()->clock;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * PersistentSymbolCache is a fixed-size, memory-mapped, on-disk cache of symbols, so that
+ * symbolization results survive a restart of the profiler.
+ *
+ * Entries are keyed by a caller supplied 64-bit key (which should identify the process and its
+ * binary; see CachingSymbolizer) plus the address. The file is a set-associative hash table of
+ * fixed-size slots: a key maps to one set of kWays slots, and inserting into a full set evicts
+ * the least recently used slot of that set. This bounds the file size without any compaction.
+ *
+ * Symbols longer than kMaxSymbolSize are not persisted. The cache is invalidated on reboot
+ * (addresses are only meaningful within one boot), and on any format mismatch.
+ *
+ * Not thread-safe.
+ */
+class PersistentSymbolCache : public NotCopyMoveable {
+ public:
+  static constexpr size_t kSlotSize = 256;
+  static constexpr size_t kWays = 8;
+  static constexpr size_t kMaxSymbolSize = kSlotSize - 3 * sizeof(uint64_t) - sizeof(uint16_t);
+
+  /**
+   * Opens (or creates) the cache file at path, sized to at most max_bytes.
+   * An existing file is reused only if it was written during the same boot, with the same size.
+   */
+  static StatusOr<std::unique_ptr<PersistentSymbolCache>> Create(
+      const std::filesystem::path& path, size_t max_bytes);
+
+  // Same as above, but with an explicit boot ID. Exposed for testing.
+  static StatusOr<std::unique_ptr<PersistentSymbolCache>> Create(
+      const std::filesystem::path& path, size_t max_bytes, std::string_view boot_id);
+
+  ~PersistentSymbolCache();
+
+  /**
+   * Returns the cached symbol, if any. The returned view is invalidated by the next Insert().
+   */
+  std::optional<std::string_view> Lookup(uint64_t key, uintptr_t addr);
+
+  /**
+   * Inserts (or overwrites) the symbol for the key and address.
+   */
+  void Insert(uint64_t key, uintptr_t addr, std::string_view symbol);
+
+  size_t num_slots() const { return num_sets_ * kWays; }
+  bool reused() const { return reused_; }
+
+  int64_t stat_hits() const { return stat_hits_; }
+  int64_t stat_misses() const { return stat_misses_; }
+  int64_t stat_evictions() const { return stat_evictions_; }
+
+ private:
+  struct Header;
+  struct Slot;
+
+  PersistentSymbolCache(void* map, size_t map_size, size_t num_sets);
+
+  Header* header() const;
+  Slot* SetBegin(uint64_t key, uintptr_t addr) const;
+
+  void* map_;
+  size_t map_size_;
+  size_t num_sets_;
+  bool reused_ = false;
+
+  int64_t stat_hits_ = 0;
+  int64_t stat_misses_ = 0;
+  int64_t stat_evictions_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/persistent_symbol_cache.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::Optional;
+
+constexpr std::string_view kBootID = "0f9f6cd1-32c4-4d65-9b36-53b9e2a8b8a6";
+constexpr size_t kCacheSize = 64 * 1024;
+
+class PersistentSymbolCacheTest : public ::testing::Test {
+ protected:
+  std::filesystem::path cache_path() const { return temp_dir_.path() / "symbols.cache"; }
+
+  px::testing::TempDir temp_dir_;
+};
+
+TEST_F(PersistentSymbolCacheTest, LookupAndInsert) {
+  ASSERT_OK_AND_ASSIGN(auto cache,
+                       PersistentSymbolCache::Create(cache_path(), kCacheSize, kBootID));
+  EXPECT_FALSE(cache->reused());
+
+  EXPECT_EQ(cache->Lookup(1, 0x1000), std::nullopt);
+  cache->Insert(1, 0x1000, "foo()");
+  cache->Insert(2, 0x1000, "bar()");
+  EXPECT_THAT(cache->Lookup(1, 0x1000), Optional(std::string_view("foo()")));
+  EXPECT_THAT(cache->Lookup(2, 0x1000), Optional(std::string_view("bar()")));
+  EXPECT_EQ(cache->Lookup(1, 0x2000), std::nullopt);
+
+  // Overwrite an existing entry.
+  cache->Insert(1, 0x1000, "baz()");
+  EXPECT_THAT(cache->Lookup(1, 0x1000), Optional(std::string_view("baz()")));
+  EXPECT_EQ(cache->stat_evictions(), 0);
+}
+
+TEST_F(PersistentSymbolCacheTest, TooLongSymbolIsNotCached) {
+  ASSERT_OK_AND_ASSIGN(auto cache,
+                       PersistentSymbolCache::Create(cache_path(), kCacheSize, kBootID));
+
+  const std::string long_symbol(PersistentSymbolCache::kMaxSymbolSize + 1, 'x');
+  cache->Insert(1, 0x1000, long_symbol);
+  EXPECT_EQ(cache->Lookup(1, 0x1000), std::nullopt);
+}
+
+TEST_F(PersistentSymbolCacheTest, SurvivesReopen) {
+  {
+    ASSERT_OK_AND_ASSIGN(auto cache,
+                         PersistentSymbolCache::Create(cache_path(), kCacheSize, kBootID));
+    cache->Insert(1, 0x1000, "foo()");
+  }
+
+  ASSERT_OK_AND_ASSIGN(auto cache,
+                       PersistentSymbolCache::Create(cache_path(), kCacheSize, kBootID));
+  EXPECT_TRUE(cache->reused());
+  EXPECT_THAT(cache->Lookup(1, 0x1000), Optional(std::string_view("foo()")));
+}
+
+TEST_F(PersistentSymbolCacheTest, InvalidatedOnRebootOrResize) {
+  {
+    ASSERT_OK_AND_ASSIGN(auto cache,
+                         PersistentSymbolCache::Create(cache_path(), kCacheSize, kBootID));
+    cache->Insert(1, 0x1000, "foo()");
+  }
+
+  {
+    ASSERT_OK_AND_ASSIGN(auto cache,
+                         PersistentSymbolCache::Create(cache_path(), kCacheSize, "other-boot"));
+    EXPECT_FALSE(cache->reused());
+    EXPECT_EQ(cache->Lookup(1, 0x1000), std::nullopt);
+    cache->Insert(1, 0x1000, "foo()");
+  }
+
+  ASSERT_OK_AND_ASSIGN(auto cache,
+                       PersistentSymbolCache::Create(cache_path(), 2 * kCacheSize, "other-boot"));
+  EXPECT_FALSE(cache->reused());
+  EXPECT_EQ(cache->Lookup(1, 0x1000), std::nullopt);
+}
+
+TEST_F(PersistentSymbolCacheTest, BoundedWithLRUEviction) {
+  // Smallest possible cache: one set.
+  constexpr size_t kOneSetSize =
+      PersistentSymbolCache::kSlotSize * (1 + PersistentSymbolCache::kWays);
+  ASSERT_OK_AND_ASSIGN(auto cache,
+                       PersistentSymbolCache::Create(cache_path(), kOneSetSize, kBootID));
+  ASSERT_EQ(cache->num_slots(), PersistentSymbolCache::kWays);
+
+  for (uintptr_t addr = 0; addr < PersistentSymbolCache::kWays; ++addr) {
+    cache->Insert(1, addr, absl::StrCat("sym", addr));
+  }
+  // Touch address 0, making address 1 the least recently used.
+  EXPECT_THAT(cache->Lookup(1, 0), Optional(std::string_view("sym0")));
+
+  cache->Insert(1, 100, "sym100");
+  EXPECT_EQ(cache->stat_evictions(), 1);
+  EXPECT_THAT(cache->Lookup(1, 100), Optional(std::string_view("sym100")));
+  EXPECT_THAT(cache->Lookup(1, 0), Optional(std::string_view("sym0")));
+  EXPECT_EQ(cache->Lookup(1, 1), std::nullopt);
+  EXPECT_EQ(std::filesystem::file_size(cache_path()), kOneSetSize);
+}
+
+TEST_F(PersistentSymbolCacheTest, TooSmall) {
+  EXPECT_NOT_OK(PersistentSymbolCache::Create(cache_path(), PersistentSymbolCache::kSlotSize,
+                                              kBootID));
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -16,11 +16,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string>
+#include <type_traits>
 #include <utility>
 
 #include <absl/functional/bind_front.h>
+#include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
 
+#include "src/common/system/proc_pid_path.h"
+#include "src/stirling/obj_tools/binary_identity.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/caching_symbolizer.h"
+#include "xxhash.h"
 
 DEFINE_uint64(
     stirling_profiler_cache_eviction_threshold, 1000,
@@ -30,13 +37,93 @@ namespace px {
 namespace stirling {
 
 StatusOr<std::unique_ptr<Symbolizer>> CachingSymbolizer::Create(
-    std::unique_ptr<Symbolizer> inner_symbolizer) {
+    std::unique_ptr<Symbolizer> inner_symbolizer,
+    std::unique_ptr<PersistentSymbolCache> persistent_cache) {
   auto ptr = new CachingSymbolizer();
   auto uptr = std::unique_ptr<Symbolizer>(ptr);
   ptr->symbolizer_ = std::move(inner_symbolizer);
+  ptr->persistent_cache_ = std::move(persistent_cache);
   return uptr;
 }
 
+namespace {
+
+// Appends a length-prefixed integer field to out.
+template <typename T>
+void AppendField(std::string* out, T value) {
+  static_assert(std::is_integral_v<T>);
+  const uint64_t size = sizeof(value);
+  out->append(reinterpret_cast<const char*>(&size), sizeof(size));
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Computes the persistent cache key of a process. Addresses are only meaningful within a process
+// (and for the kernel, within a boot, which the persistent cache itself checks). Within a boot,
+// the UPID identifies the process, and the binary identity guards against an exec() that
+// replaced the process image.
+std::optional<uint64_t> PersistentCacheKey(const struct upid_t& upid) {
+  obj_tools::BinaryIdentity binary;
+  if (upid.pid != profiler::kKernelUPID.pid) {
+    auto binary_or = obj_tools::GetBinaryIdentity(system::ProcPidPath(upid.pid, "exe"));
+    if (!binary_or.ok()) {
+      return std::nullopt;
+    }
+    binary = binary_or.ConsumeValueOrDie();
+  }
+
+  // Each field is hashed on its own, length-prefixed, rather than hashing a struct, whose padding
+  // bytes are unspecified.
+  std::string encoded;
+  AppendField(&encoded, upid.pid);
+  AppendField(&encoded, upid.start_time_ticks);
+  AppendField(&encoded, static_cast<uint64_t>(binary.dev));
+  AppendField(&encoded, static_cast<uint64_t>(binary.inode));
+  AppendField(&encoded, binary.mtime_ns);
+  AppendField(&encoded, binary.size);
+  return XXH64(encoded.data(), encoded.size(), /*seed*/ 0);
+}
+
+// Whether the symbol is the bare address that symbolizers return when they can't resolve it, e.g.
+// "0x00007f0a1b2c3d4e". Those aren't persisted, since the symbol may resolve on a later attempt
+// (e.g. once the Java agent has attached).
+bool IsAddressPlaceholder(std::string_view symbol) {
+  if (!absl::StartsWith(symbol, "0x") || symbol.size() == 2) {
+    return false;
+  }
+  for (char c : symbol.substr(2)) {
+    if (!absl::ascii_isxdigit(c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+profiler::SymbolizerFn CachingSymbolizer::WrapWithPersistentCache(
+    const struct upid_t& upid, profiler::SymbolizerFn symbolizer_fn) {
+  const auto [iter, inserted] = persistent_cache_keys_.try_emplace(upid, std::nullopt);
+  if (inserted) {
+    iter->second = PersistentCacheKey(upid);
+  }
+  if (!iter->second.has_value()) {
+    return symbolizer_fn;
+  }
+
+  return [cache = persistent_cache_.get(), key = iter->second.value(),
+          symbolizer_fn = std::move(symbolizer_fn)](const uintptr_t addr) -> std::string_view {
+    std::optional<std::string_view> cached = cache->Lookup(key, addr);
+    if (cached.has_value()) {
+      return cached.value();
+    }
+    std::string_view symbol = symbolizer_fn(addr);
+    if (!IsAddressPlaceholder(symbol)) {
+      cache->Insert(key, addr, symbol);
+    }
+    return symbol;
+  };
+}
+
 void CachingSymbolizer::IterationPreTick() { symbolizer_->IterationPreTick(); }
 
 profiler::SymbolizerFn CachingSymbolizer::GetSymbolizerFn(const struct upid_t& upid) {
@@ -51,6 +138,9 @@ profiler::SymbolizerFn CachingSymbolizer::GetSymbolizerFn(const struct upid_t& u
   // Here, we trigger the get symbolizer logic in the underlying symbolizer to ensure that
   // we catch any Java processes that may have had their agent delayed by attach rate limiting.
   auto symbolizer_fn = symbolizer_->GetSymbolizerFn(upid);
+  if (persistent_cache_ != nullptr) {
+    symbolizer_fn = WrapWithPersistentCache(upid, std::move(symbolizer_fn));
+  }
 
   if (inserted) {
     iter->second = std::make_unique<SymbolCache>(symbolizer_fn);
@@ -67,6 +157,7 @@ profiler::SymbolizerFn CachingSymbolizer::GetSymbolizerFn(const struct upid_t& u
 void CachingSymbolizer::DeleteUPID(const struct upid_t& upid) {
   // The inner map is owned by a unique_ptr; this will free the memory.
   symbol_caches_.erase(upid);
+  persistent_cache_keys_.erase(upid);
 
   symbolizer_->DeleteUPID(upid);
 }
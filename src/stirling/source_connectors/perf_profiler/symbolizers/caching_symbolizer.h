@@ -19,7 +19,9 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/persistent_symbol_cache.h"
 #include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_cache.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
@@ -30,10 +32,15 @@ namespace stirling {
 
 /**
  * A class that takes another symbolizer and adds a cache to it.
+ *
+ * Optionally, a persistent (on-disk) cache is consulted on a miss, before the inner symbolizer,
+ * so that symbols survive restarts of the profiler.
  */
 class CachingSymbolizer : public Symbolizer {
  public:
-  static StatusOr<std::unique_ptr<Symbolizer>> Create(std::unique_ptr<Symbolizer> inner_symbolizer);
+  static StatusOr<std::unique_ptr<Symbolizer>> Create(
+      std::unique_ptr<Symbolizer> inner_symbolizer,
+      std::unique_ptr<PersistentSymbolCache> persistent_cache = nullptr);
 
   profiler::SymbolizerFn GetSymbolizerFn(const struct upid_t& upid) override;
 
@@ -44,6 +51,7 @@ class CachingSymbolizer : public Symbolizer {
   int64_t stat_accesses() const { return stat_accesses_; }
   int64_t stat_hits() const { return stat_hits_; }
   uint64_t GetNumberOfSymbolsCached() const;
+  const PersistentSymbolCache* persistent_cache() const { return persistent_cache_.get(); }
   bool Uncacheable(const struct upid_t& /*upid*/) override { return false; }
 
  private:
@@ -51,10 +59,19 @@ class CachingSymbolizer : public Symbolizer {
 
   std::string_view Symbolize(SymbolCache* symbol_cache, const uintptr_t addr);
 
+  // Wraps the inner symbolizer function so that the persistent cache is consulted first.
+  profiler::SymbolizerFn WrapWithPersistentCache(const struct upid_t& upid,
+                                                 profiler::SymbolizerFn symbolizer_fn);
+
   std::unique_ptr<Symbolizer> symbolizer_;
 
   absl::flat_hash_map<struct upid_t, std::unique_ptr<SymbolCache>> symbol_caches_;
 
+  std::unique_ptr<PersistentSymbolCache> persistent_cache_;
+
+  // Keys into the persistent cache, per UPID. std::nullopt if the UPID cannot be persisted.
+  absl::flat_hash_map<struct upid_t, std::optional<uint64_t>> persistent_cache_keys_;
+
   int64_t stat_accesses_ = 0;
   int64_t stat_hits_ = 0;
 };
@@ -16,43 +16,107 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
+#include <filesystem>
 #include <memory>
 #include <utility>
 
 #include <absl/functional/bind_front.h>
 
 #include "src/common/base/base.h"
+#include "src/common/metrics/metrics.h"
 #include "src/common/system/proc_pid_path.h"
 #include "src/stirling/obj_tools/address_converter.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbolizer.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
+using ::px::stirling::obj_tools::BinaryIdentity;
 using ::px::stirling::obj_tools::ElfReader;
 using ::px::system::ProcPidRootPath;
 
 namespace px {
 namespace stirling {
 
+ElfSymbolizer::ElfSymbolizer()
+    : binary_index_hits_counter_(
+          BuildCounter("perf_profiler_elf_symbolizer_binary_index_hits",
+                       "Count of UPIDs that reused the symbol index of an already indexed binary.")),
+      binary_index_misses_counter_(
+          BuildCounter("perf_profiler_elf_symbolizer_binary_index_misses",
+                       "Count of UPIDs that required a new symbol index to be built.")),
+      binary_index_build_time_us_counter_(
+          BuildCounter("perf_profiler_elf_symbolizer_binary_index_build_time_us",
+                       "Total time (in microseconds) spent building ELF symbol indices.")),
+      binary_index_memory_bytes_gauge_(
+          BuildGauge("perf_profiler_elf_symbolizer_binary_index_memory_bytes",
+                     "Approximate memory (in bytes) held by the ELF symbol indices.")) {}
+
 StatusOr<std::unique_ptr<Symbolizer>> ElfSymbolizer::Create() {
   ElfSymbolizer* elf_symbolizer = new ElfSymbolizer();
   auto symbolizer = std::unique_ptr<Symbolizer>(elf_symbolizer);
   return symbolizer;
 }
 
-void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) { symbolizers_.erase(upid); }
+void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) {
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end()) {
+    return;
+  }
+  const BinaryIdentity binary = iter->second->binary();
+  symbolizers_.erase(iter);
+
+  // Drop the shared symbol index once no other UPID references it.
+  auto binary_iter = binary_symbolizers_.find(binary);
+  if (binary_iter != binary_symbolizers_.end() && binary_iter->second.use_count() == 1) {
+    binary_symbolizers_bytes_ -= binary_iter->second->MemoryUsageBytes();
+    binary_symbolizers_.erase(binary_iter);
+    UpdateMemoryGauge();
+  }
+}
+
+void ElfSymbolizer::UpdateMemoryGauge() {
+  binary_index_memory_bytes_gauge_.Set(static_cast<double>(binary_symbolizers_bytes_));
+}
+
+StatusOr<std::shared_ptr<const ElfReader::Symbolizer>> ElfSymbolizer::GetOrCreateBinarySymbolizer(
+    const BinaryIdentity& binary, ElfReader* elf_reader) {
+  auto iter = binary_symbolizers_.find(binary);
+  if (iter != binary_symbolizers_.end()) {
+    binary_index_hits_counter_.Increment();
+    return iter->second;
+  }
+
+  binary_index_misses_counter_.Increment();
+  const auto start = std::chrono::steady_clock::now();
+  PX_ASSIGN_OR_RETURN(std::shared_ptr<const ElfReader::Symbolizer> symbolizer,
+                      elf_reader->GetSymbolizer());
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  binary_index_build_time_us_counter_.Increment(
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+  binary_symbolizers_bytes_ += symbolizer->MemoryUsageBytes();
+  UpdateMemoryGauge();
+  binary_symbolizers_[binary] = symbolizer;
+  return symbolizer;
+}
 
-StatusOr<std::unique_ptr<ElfSymbolizer::SymbolizerWithConverter>> CreateUPIDSymbolizer(
-    const struct upid_t& upid) {
+StatusOr<std::unique_ptr<ElfSymbolizer::SymbolizerWithConverter>>
+ElfSymbolizer::CreateUPIDSymbolizer(const struct upid_t& upid) {
   const pid_t pid = upid.pid;
   const system::ProcParser proc_parser;
   PX_ASSIGN_OR_RETURN(const auto proc_exe, proc_parser.GetExePath(pid));
-  PX_ASSIGN_OR_RETURN(auto elf_reader, ElfReader::Create(ProcPidRootPath(pid, proc_exe.string())));
+  const std::filesystem::path binary_path = ProcPidRootPath(pid, proc_exe.string());
+  PX_ASSIGN_OR_RETURN(const BinaryIdentity binary, obj_tools::GetBinaryIdentity(binary_path));
 
-  PX_ASSIGN_OR_RETURN(auto symbolizer, elf_reader->GetSymbolizer());
+  // The ELF file is opened for every UPID, even if its binary is already indexed, because the
+  // address converter needs the binary's ELF type and segment layout. Only building the symbol
+  // index is shared across UPIDs.
+  PX_ASSIGN_OR_RETURN(auto elf_reader, ElfReader::Create(binary_path));
   PX_ASSIGN_OR_RETURN(auto converter,
                       obj_tools::ElfAddressConverter::Create(elf_reader.get(), pid));
-  return std::make_unique<ElfSymbolizer::SymbolizerWithConverter>(std::move(symbolizer),
+  PX_ASSIGN_OR_RETURN(auto symbolizer, GetOrCreateBinarySymbolizer(binary, elf_reader.get()));
+  return std::make_unique<ElfSymbolizer::SymbolizerWithConverter>(binary, std::move(symbolizer),
                                                                   std::move(converter));
 }
 
@@ -70,19 +134,20 @@ profiler::SymbolizerFn ElfSymbolizer::GetSymbolizerFn(const struct upid_t& upid)
     return profiler::SymbolizerFn(&(BogusKernelSymbolizerFn));
   }
 
-  std::unique_ptr<SymbolizerWithConverter>& symbolizer_with_converter = symbolizers_[upid];
-  if (symbolizer_with_converter == nullptr) {
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end()) {
     auto upid_symbolizer_status = CreateUPIDSymbolizer(upid);
     if (!upid_symbolizer_status.ok()) {
+      // Nothing is recorded for the UPID, so that creating its symbolizer is retried next time,
+      // and symbolizers_ never holds a null entry.
       VLOG(1) << absl::Substitute("Failed to create Symbolizer function for $0 [error=$1]",
                                   upid.pid, upid_symbolizer_status.ToString());
       return profiler::SymbolizerFn(&(EmptySymbolizerFn));
     }
-    symbolizer_with_converter = upid_symbolizer_status.ConsumeValueOrDie();
+    iter = symbolizers_.emplace(upid, upid_symbolizer_status.ConsumeValueOrDie()).first;
   }
 
-  return absl::bind_front(&ElfSymbolizer::SymbolizerWithConverter::Lookup,
-                          symbolizer_with_converter.get());
+  return absl::bind_front(&ElfSymbolizer::SymbolizerWithConverter::Lookup, iter->second.get());
 }
 
 std::string_view ElfSymbolizer::SymbolizerWithConverter::Lookup(uint64_t virtual_addr) const {
@@ -18,10 +18,14 @@
 
 #pragma once
 
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+
 #include <memory>
 #include <utility>
 
 #include "src/stirling/obj_tools/address_converter.h"
+#include "src/stirling/obj_tools/binary_identity.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
 namespace px {
@@ -29,6 +33,10 @@ namespace stirling {
 
 /**
  * A Symbolizer using the ElfReader symbolization core.
+ *
+ * The symbol index of a binary is shared by all processes that run that binary (as identified by
+ * obj_tools::BinaryIdentity), so that N replicas of the same service only index its symbol table
+ * once. Only the address converter, which depends on where the binary is mapped, is kept per UPID.
  */
 class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
  public:
@@ -41,21 +49,51 @@ class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
 
   class SymbolizerWithConverter {
    public:
-    SymbolizerWithConverter(std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer,
+    SymbolizerWithConverter(obj_tools::BinaryIdentity binary,
+                            std::shared_ptr<const obj_tools::ElfReader::Symbolizer> symbolizer,
                             std::unique_ptr<obj_tools::ElfAddressConverter> converter)
-        : symbolizer_(std::move(symbolizer)), converter_(std::move(converter)) {}
+        : binary_(binary), symbolizer_(std::move(symbolizer)), converter_(std::move(converter)) {}
     std::string_view Lookup(uintptr_t addr) const;
 
+    const obj_tools::BinaryIdentity& binary() const { return binary_; }
+
    private:
-    std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer_;
+    obj_tools::BinaryIdentity binary_;
+    std::shared_ptr<const obj_tools::ElfReader::Symbolizer> symbolizer_;
     std::unique_ptr<obj_tools::ElfAddressConverter> converter_;
   };
 
+  size_t num_upids() const { return symbolizers_.size(); }
+  size_t num_binaries() const { return binary_symbolizers_.size(); }
+
  private:
-  ElfSymbolizer() = default;
+  ElfSymbolizer();
+
+  StatusOr<std::unique_ptr<SymbolizerWithConverter>> CreateUPIDSymbolizer(
+      const struct upid_t& upid);
 
-  // A symbolizer per UPID.
+  // Returns the shared symbol index for the binary, creating it with the elf_reader if needed.
+  StatusOr<std::shared_ptr<const obj_tools::ElfReader::Symbolizer>> GetOrCreateBinarySymbolizer(
+      const obj_tools::BinaryIdentity& binary, obj_tools::ElfReader* elf_reader);
+
+  void UpdateMemoryGauge();
+
+  // A symbolizer per UPID; each references a shared symbol index in binary_symbolizers_.
   absl::flat_hash_map<struct upid_t, std::unique_ptr<SymbolizerWithConverter>> symbolizers_;
+
+  // Symbol indices keyed by binary identity, shared across all UPIDs running the binary.
+  // An entry is removed when the last UPID referencing it is deleted.
+  absl::flat_hash_map<obj_tools::BinaryIdentity,
+                      std::shared_ptr<const obj_tools::ElfReader::Symbolizer>>
+      binary_symbolizers_;
+
+  // Approximate bytes held by the symbol indices in binary_symbolizers_.
+  size_t binary_symbolizers_bytes_ = 0;
+
+  prometheus::Counter& binary_index_hits_counter_;
+  prometheus::Counter& binary_index_misses_counter_;
+  prometheus::Counter& binary_index_build_time_us_counter_;
+  prometheus::Gauge& binary_index_memory_bytes_gauge_;
 };
 
 }  // namespace stirling
@@ -82,6 +82,50 @@ TYPED_TEST(SymbolizerTest, UserSymbols) {
   EXPECT_EQ(symbolize(kBarAddr), "test::bar()");
 }
 
+// Two UPIDs that run the same binary should share one symbol index, which is released only when
+// the last of the UPIDs is deleted.
+TEST_F(ElfSymbolizerTest, SharedBinaryIndex) {
+  auto* elf_symbolizer = static_cast<ElfSymbolizer*>(symbolizer_.get());
+
+  const uint32_t pid = static_cast<uint32_t>(getpid());
+  const struct upid_t upid_a = {{pid}, 0};
+  const struct upid_t upid_b = {{pid}, 1};
+
+  auto symbolize_a = symbolizer_->GetSymbolizerFn(upid_a);
+  auto symbolize_b = symbolizer_->GetSymbolizerFn(upid_b);
+  EXPECT_EQ(elf_symbolizer->num_upids(), 2);
+  EXPECT_EQ(elf_symbolizer->num_binaries(), 1);
+
+  EXPECT_EQ(symbolize_a(kFooAddr), "test::foo()");
+  EXPECT_EQ(symbolize_b(kBarAddr), "test::bar()");
+
+  symbolizer_->DeleteUPID(upid_a);
+  EXPECT_EQ(elf_symbolizer->num_upids(), 1);
+  EXPECT_EQ(elf_symbolizer->num_binaries(), 1);
+  EXPECT_EQ(symbolize_b(kFooAddr), "test::foo()");
+
+  symbolizer_->DeleteUPID(upid_b);
+  EXPECT_EQ(elf_symbolizer->num_upids(), 0);
+  EXPECT_EQ(elf_symbolizer->num_binaries(), 0);
+}
+
+// A UPID whose symbolizer could not be created (here, because the process doesn't exist) gets the
+// fallback symbolizer, and can be deleted like any other UPID.
+TEST_F(ElfSymbolizerTest, DeleteUPIDWithFailedSymbolizer) {
+  auto* elf_symbolizer = static_cast<ElfSymbolizer*>(symbolizer_.get());
+
+  // PIDs are bounded by /proc/sys/kernel/pid_max, which can't exceed 2^22.
+  const struct upid_t missing_upid = {{1 << 23}, 0};
+
+  auto symbolize = symbolizer_->GetSymbolizerFn(missing_upid);
+  EXPECT_EQ(symbolize(0x1234), "0x0000000000001234");
+  EXPECT_EQ(elf_symbolizer->num_upids(), 0);
+
+  symbolizer_->DeleteUPID(missing_upid);
+  EXPECT_EQ(elf_symbolizer->num_upids(), 0);
+  EXPECT_EQ(elf_symbolizer->num_binaries(), 0);
+}
+
 TEST_F(BCCSymbolizerTest, KernelSymbols) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<Symbolizer> symbolizer, BCCSymbolizer::Create());
 
@@ -476,6 +520,41 @@ TEST_F(BCCSymbolizerTest, Caching) {
   }
 }
 
+// Resolved symbols are persisted, and found there once the in-memory cache is gone, but addresses
+// that the symbolizer couldn't resolve are not persisted.
+TEST_F(ElfSymbolizerTest, PersistentCacheSkipsUnresolvedAddresses) {
+  px::testing::TempDir temp_dir;
+  ASSERT_OK_AND_ASSIGN(auto persistent_cache,
+                       PersistentSymbolCache::Create(temp_dir.path() / "symbols.cache",
+                                                     /*max_bytes*/ 64 * 1024));
+  ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Symbolizer> symbolizer_uptr,
+      CachingSymbolizer::Create(std::move(symbolizer_), std::move(persistent_cache)));
+  auto& symbolizer = *static_cast<CachingSymbolizer*>(symbolizer_uptr.get());
+  const PersistentSymbolCache& cache = *symbolizer.persistent_cache();
+
+  const struct upid_t this_upid = {{static_cast<uint32_t>(getpid())}, 0};
+  constexpr uintptr_t kUnknownAddr = 0x10;
+
+  {
+    auto symbolize = symbolizer.GetSymbolizerFn(this_upid);
+    EXPECT_EQ(symbolize(kFooAddr), "test::foo()");
+    EXPECT_THAT(std::string(symbolize(kUnknownAddr)), ::testing::StartsWith("0x"));
+    EXPECT_EQ(cache.stat_hits(), 0);
+    EXPECT_EQ(cache.stat_misses(), 2);
+  }
+
+  // Drop the in-memory cache of the UPID, so that the lookups go to the persistent cache.
+  symbolizer.DeleteUPID(this_upid);
+  {
+    auto symbolize = symbolizer.GetSymbolizerFn(this_upid);
+    EXPECT_EQ(symbolize(kFooAddr), "test::foo()");
+    EXPECT_THAT(std::string(symbolize(kUnknownAddr)), ::testing::StartsWith("0x"));
+    EXPECT_EQ(cache.stat_hits(), 1);
+    EXPECT_EQ(cache.stat_misses(), 3);
+  }
+}
+
 // Expect that upids for Java processes (that we attempt to symbolize) are inserted to global set.
 TEST_F(BCCSymbolizerTest, JavaProcessBeingTracked) {
   PX_SET_FOR_SCOPE(FLAGS_stirling_profiler_java_agent_libs, GetAgentLibsFlagValueForTesting());
@@ -74,6 +74,12 @@ inline bool operator==(const struct location_t& a, const struct location_t& b) {
 }
 #endif
 
+// Version of the layout of go_common_symaddrs_t, go_http2_symaddrs_t and go_tls_symaddrs_t.
+// Increment it whenever a member of these structs is added, removed, reordered or changes type.
+// Go symaddrs that the agent saved to disk (see GoSymAddrsCache) under another version are
+// discarded.
+#define GO_SYMADDRS_LAYOUT_VERSION 1
+
 // A set of symbols that are useful for various different uprobes.
 // Currently, this includes mostly connection related items,
 // which applies to any network protocol tracing (HTTP2, TLS, etc.).
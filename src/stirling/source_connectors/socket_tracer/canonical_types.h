@@ -78,6 +78,15 @@ constexpr DataElement kLatencyNS = {
     types::PatternType::METRIC_GAUGE,
 };
 
+constexpr DataElement kSamplingRatio = {
+    "sampling_ratio",
+    "The connection was traced as 1 of this many connections of its protocol, because of load "
+    "shedding. Multiply counts by this ratio to estimate the totals.",
+    types::DataType::INT64,
+    types::SemanticType::ST_NONE,
+    types::PatternType::GENERAL,
+};
+
 constexpr DataElement kPXInfo = {
     "px_info_",
     "Pixie messages regarding the record (e.g. warnings)",
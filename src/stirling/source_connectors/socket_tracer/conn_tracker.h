@@ -410,6 +410,26 @@ class ConnTracker : NotCopyMoveable {
    */
   std::string_view disable_reason() const { return disable_reason_; }
 
+  /**
+   * Records that load shedding sampled this connection, when connections of its protocol were
+   * traced at 1 in the given ratio.
+   */
+  void set_sampling_ratio(uint32_t sampling_ratio) {
+    sampling_ratio_ = sampling_ratio;
+    sampled_ = true;
+  }
+
+  /**
+   * Whether load shedding has already decided whether to trace this connection.
+   */
+  bool sampled() const { return sampled_; }
+
+  /**
+   * The sampling ratio under which this connection was traced. Counts of the records of this
+   * connection are multiplied by it to estimate the counts of all connections.
+   */
+  uint32_t sampling_ratio() const { return sampling_ratio_; }
+
   /**
    * Returns a state that determine the operations performed on the traffic traced on the
    * connection.
@@ -756,6 +776,10 @@ class ConnTracker : NotCopyMoveable {
 
   std::string disable_reason_;
 
+  // See set_sampling_ratio().
+  bool sampled_ = false;
+  uint32_t sampling_ratio_ = 1;
+
   // Iterations before the tracker can be killed.
   int32_t death_countdown_ = -1;
 
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/go_binary_analyzer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/metrics/metrics.h"
+#include "src/stirling/obj_tools/go_syms.h"
+
+DEFINE_int32(stirling_uprobe_analysis_threads,
+             gflags::Int32FromEnv("PL_STIRLING_UPROBE_ANALYSIS_THREADS", 2),
+             "Number of threads that analyze binaries for uprobe deployment in parallel. "
+             "Each thread may hold the DWARF index of a large binary in memory.");
+
+namespace px {
+namespace stirling {
+
+using ::px::stirling::obj_tools::ElfReader;
+
+namespace {
+
+// Returns the key under which the symaddrs of the binary are cached. Keyed by contents rather than
+// by path, since every container running the same image reaches the binary through a different
+// /proc/<pid>/root path. Binaries without a build-id fall back to a hash of the whole file, which
+// is still much cheaper than indexing its DWARF info.
+// Returns an empty string if the binary can't be keyed, in which case it is not cached.
+std::string ContentKey(ElfReader* elf_reader, const std::string& binary) {
+  StatusOr<std::string> build_id_status = elf_reader->BuildID();
+  if (build_id_status.ok()) {
+    return build_id_status.ConsumeValueOrDie();
+  }
+  StatusOr<std::string> md5_status = MD5onFile(binary);
+  if (md5_status.ok()) {
+    return absl::StrCat("md5:", md5_status.ValueOrDie());
+  }
+  return "";
+}
+
+}  // namespace
+
+GoBinaryAnalyzer::GoBinaryAnalyzer(GoSymAddrsCache* cache, int max_threads)
+    : cache_(cache),
+      max_threads_(std::max(max_threads, 1)),
+      queue_depth_gauge_(
+          BuildGauge("socket_tracer_uprobe_analysis_queue_depth",
+                     "Number of binaries waiting to be analyzed for uprobe deployment.")),
+      cache_hits_counter_(
+          BuildCounter("socket_tracer_go_symaddrs_cache_hits",
+                       "Count of Go binaries whose symaddrs were found in the analysis cache.")),
+      cache_misses_counter_(
+          BuildCounter("socket_tracer_go_symaddrs_cache_misses",
+                       "Count of Go binaries whose symaddrs had to be resolved from DWARF info.")),
+      analysis_time_us_counter_(
+          BuildCounter("socket_tracer_go_binary_analysis_time_us",
+                       "Total time (in microseconds) spent resolving Go symaddrs from DWARF.")) {}
+
+void GoBinaryAnalyzer::RunParallel(size_t num_tasks, const std::function<void(size_t)>& fn) {
+  queue_depth_gauge_.Increment(num_tasks);
+
+  std::atomic<size_t> next_task = 0;
+  auto worker = [&]() {
+    for (size_t i = next_task++; i < num_tasks; i = next_task++) {
+      queue_depth_gauge_.Decrement();
+      fn(i);
+    }
+  };
+
+  // The calling thread is one of the workers.
+  const size_t num_threads = std::min<size_t>(max_threads_, num_tasks);
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+std::vector<GoBinaryAnalysis> GoBinaryAnalyzer::Analyze(const std::vector<std::string>& binaries) {
+  DCHECK_LE(binaries.size(), kMaxBatchSize);
+  std::vector<GoBinaryAnalysis> results(binaries.size());
+  std::vector<std::string> keys(binaries.size());
+
+  // Pass 1: Read the ELF info of every binary.
+  RunParallel(binaries.size(), [&](size_t i) {
+    GoBinaryAnalysis& result = results[i];
+    result.binary = binaries[i];
+
+    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(result.binary);
+    if (!elf_reader_status.ok()) {
+      result.status = elf_reader_status.status();
+      return;
+    }
+    result.is_elf = true;
+    result.elf_reader = elf_reader_status.ConsumeValueOrDie();
+
+    // Avoid going past this point if not a golang program.
+    // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
+    result.is_go_binary = obj_tools::IsGoExecutable(result.elf_reader.get());
+    if (!result.is_go_binary) {
+      result.status = error::NotFound("$0 is not a Go binary.", result.binary);
+      result.elf_reader.reset();
+      return;
+    }
+    keys[i] = ContentKey(result.elf_reader.get(), result.binary);
+  });
+
+  // Serve what we can from the cache, and pick one binary to index per distinct content key.
+  std::vector<size_t> to_index;
+  absl::flat_hash_map<std::string_view, size_t> indexed_binary_by_key;
+  std::vector<std::pair<size_t, size_t>> same_as_indexed_binary;
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (!results[i].is_go_binary) {
+      continue;
+    }
+    if (keys[i].empty()) {
+      to_index.push_back(i);
+      continue;
+    }
+    const GoSymAddrs* cached_symaddrs = cache_->Find(keys[i]);
+    if (cached_symaddrs != nullptr) {
+      results[i].symaddrs = *cached_symaddrs;
+      results[i].cache_hit = true;
+      cache_hits_counter_.Increment();
+      continue;
+    }
+    auto [iter, inserted] = indexed_binary_by_key.try_emplace(keys[i], i);
+    if (inserted) {
+      to_index.push_back(i);
+    } else {
+      same_as_indexed_binary.emplace_back(i, iter->second);
+    }
+  }
+  cache_misses_counter_.Increment(to_index.size());
+
+  // Pass 2: Index the DWARF info of the binaries that weren't in the cache.
+  RunParallel(to_index.size(), [&](size_t j) {
+    GoBinaryAnalysis& result = results[to_index[j]];
+    const auto start = std::chrono::steady_clock::now();
+    StatusOr<GoSymAddrs> symaddrs_status =
+        ResolveGoSymAddrs(result.binary, result.elf_reader.get());
+    if (symaddrs_status.ok()) {
+      result.symaddrs = symaddrs_status.ConsumeValueOrDie();
+    } else {
+      result.status = symaddrs_status.status();
+      result.elf_reader.reset();
+    }
+    analysis_time_us_counter_.Increment(std::chrono::duration_cast<std::chrono::microseconds>(
+                                            std::chrono::steady_clock::now() - start)
+                                            .count());
+  });
+
+  for (size_t i : to_index) {
+    // A binary missing the symbols of a group of probes is cached as well,
+    // so that it is not re-analyzed either.
+    if (results[i].status.ok() && !keys[i].empty()) {
+      cache_->Insert(keys[i], results[i].symaddrs);
+    }
+  }
+  for (const auto& [i, indexed_i] : same_as_indexed_binary) {
+    results[i].status = results[indexed_i].status;
+    results[i].symaddrs = results[indexed_i].symaddrs;
+    results[i].cache_hit = results[i].status.ok();
+    if (results[i].cache_hit) {
+      cache_hits_counter_.Increment();
+    } else {
+      results[i].elf_reader.reset();
+    }
+  }
+
+  return results;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/obj_tools/elf_reader.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+DECLARE_int32(stirling_uprobe_analysis_threads);
+
+namespace px {
+namespace stirling {
+
+/**
+ * The outcome of analyzing one binary for Go uprobe deployment.
+ */
+struct GoBinaryAnalysis {
+  std::string binary;
+
+  // False if the binary could not be read as an ELF file; status holds the reason.
+  bool is_elf = false;
+
+  bool is_go_binary = false;
+
+  // Only kept for the Go binaries whose analysis succeeded, which the probes are attached to.
+  // Null otherwise, so that a batch of large non-Go binaries doesn't stay in memory.
+  std::unique_ptr<obj_tools::ElfReader> elf_reader;
+
+  // Error if the binary is not a Go binary, or its DWARF info could not be read.
+  Status status;
+  GoSymAddrs symaddrs;
+
+  // Whether the symaddrs were reused from an earlier analysis of a binary with the same contents.
+  bool cache_hit = false;
+};
+
+/**
+ * Analyzes binaries for Go uprobe deployment on a bounded number of threads.
+ *
+ * Reading the ELF and DWARF info of a binary is independent of any other binary, and is what
+ * dominates uprobe deployment when many new processes show up at once (e.g. on node boot).
+ * Attaching the probes is left to the caller, since BCC requires it to be serialized.
+ *
+ * Binaries are analyzed in two parallel passes: the first reads the ELF info and the content key
+ * of every binary, and the second indexes the DWARF info of each distinct binary that isn't in the
+ * cache. Binaries with the same contents (e.g. the same image in different containers) are thus
+ * only indexed once, even within a single call.
+ *
+ * The results hold the ELF reader of every Go binary, so callers should analyze many binaries in
+ * batches of at most kMaxBatchSize, and release the results of a batch before the next one.
+ */
+class GoBinaryAnalyzer {
+ public:
+  static constexpr size_t kMaxBatchSize = 32;
+
+  /**
+   * @param cache Cache of previously analyzed binaries. Must outlive the analyzer.
+   * @param max_threads Maximum number of threads analyzing binaries at once. 1 analyzes all
+   *                    binaries on the calling thread.
+   */
+  GoBinaryAnalyzer(GoSymAddrsCache* cache, int max_threads);
+
+  /**
+   * Analyzes the given binaries, and returns one result per binary, in the same order.
+   * At most kMaxBatchSize binaries may be given at once.
+   */
+  std::vector<GoBinaryAnalysis> Analyze(const std::vector<std::string>& binaries);
+
+ private:
+  // Runs fn(i) for every i in [0, num_tasks), on up to max_threads_ threads.
+  void RunParallel(size_t num_tasks, const std::function<void(size_t)>& fn);
+
+  GoSymAddrsCache* cache_;
+  const int max_threads_;
+
+  prometheus::Gauge& queue_depth_gauge_;
+  prometheus::Counter& cache_hits_counter_;
+  prometheus::Counter& cache_misses_counter_;
+  prometheus::Counter& analysis_time_us_counter_;
+};
+
+}  // namespace stirling
+}  // namespace px
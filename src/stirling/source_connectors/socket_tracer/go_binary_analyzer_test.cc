@@ -0,0 +1,158 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/go_binary_analyzer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::SizeIs;
+
+namespace {
+
+constexpr std::string_view kGoBinary = "src/stirling/obj_tools/testdata/go/test_go_1_19_binary";
+constexpr std::string_view kCCBinary = "src/stirling/obj_tools/testdata/cc/prebuilt_test_exe";
+
+// Returns all the sample binaries (and any other files) in the obj_tools testdata directories.
+std::vector<std::string> SampleBinaries() {
+  std::vector<std::string> binaries;
+  for (std::string_view dir :
+       {"src/stirling/obj_tools/testdata/go", "src/stirling/obj_tools/testdata/cc"}) {
+    for (const auto& entry :
+         std::filesystem::directory_iterator(px::testing::BazelRunfilePath(dir))) {
+      if (entry.is_regular_file()) {
+        binaries.push_back(entry.path().string());
+      }
+    }
+  }
+  std::sort(binaries.begin(), binaries.end());
+  return binaries;
+}
+
+}  // namespace
+
+class GoBinaryAnalyzerTest : public ::testing::TestWithParam<int> {};
+
+TEST_P(GoBinaryAnalyzerTest, AnalyzesSampleBinaries) {
+  const std::vector<std::string> binaries = SampleBinaries();
+  const std::string go_binary = px::testing::BazelRunfilePath(kGoBinary).string();
+  const std::string cc_binary = px::testing::BazelRunfilePath(kCCBinary).string();
+  ASSERT_THAT(binaries, ::testing::Contains(go_binary));
+  ASSERT_THAT(binaries, ::testing::Contains(cc_binary));
+
+  GoSymAddrsCache cache;
+  GoBinaryAnalyzer analyzer(&cache, GetParam());
+  std::vector<GoBinaryAnalysis> analyses = analyzer.Analyze(binaries);
+  ASSERT_THAT(analyses, SizeIs(binaries.size()));
+
+  for (size_t i = 0; i < binaries.size(); ++i) {
+    const GoBinaryAnalysis& analysis = analyses[i];
+    // Results come back in the order of the input.
+    EXPECT_EQ(analysis.binary, binaries[i]);
+    if (!analysis.is_elf) {
+      EXPECT_FALSE(analysis.is_go_binary);
+      EXPECT_NOT_OK(analysis.status);
+    }
+    // Only the ELF readers of the successfully analyzed Go binaries are kept.
+    EXPECT_EQ(analysis.elf_reader != nullptr, analysis.is_go_binary && analysis.status.ok())
+        << analysis.binary;
+    if (analysis.binary == go_binary) {
+      EXPECT_TRUE(analysis.is_go_binary);
+      EXPECT_OK(analysis.status);
+      EXPECT_FALSE(analysis.cache_hit);
+    }
+    if (analysis.binary == cc_binary) {
+      EXPECT_TRUE(analysis.is_elf);
+      EXPECT_FALSE(analysis.is_go_binary);
+    }
+  }
+}
+
+TEST_P(GoBinaryAnalyzerTest, MatchesSerialAnalysis) {
+  const std::vector<std::string> binaries = SampleBinaries();
+
+  GoSymAddrsCache serial_cache;
+  GoBinaryAnalyzer serial_analyzer(&serial_cache, 1);
+  std::vector<GoBinaryAnalysis> expected = serial_analyzer.Analyze(binaries);
+
+  GoSymAddrsCache cache;
+  GoBinaryAnalyzer analyzer(&cache, GetParam());
+  std::vector<GoBinaryAnalysis> analyses = analyzer.Analyze(binaries);
+
+  ASSERT_THAT(analyses, SizeIs(expected.size()));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(analyses[i].binary, expected[i].binary);
+    EXPECT_EQ(analyses[i].is_elf, expected[i].is_elf);
+    EXPECT_EQ(analyses[i].elf_reader == nullptr, expected[i].elf_reader == nullptr);
+    EXPECT_EQ(analyses[i].is_go_binary, expected[i].is_go_binary);
+    EXPECT_EQ(analyses[i].status.ok(), expected[i].status.ok()) << analyses[i].binary;
+    EXPECT_EQ(analyses[i].symaddrs.common.has_value(), expected[i].symaddrs.common.has_value());
+    EXPECT_EQ(analyses[i].symaddrs.tls.has_value(), expected[i].symaddrs.tls.has_value());
+    EXPECT_EQ(analyses[i].symaddrs.http2.has_value(), expected[i].symaddrs.http2.has_value());
+  }
+  EXPECT_EQ(cache.size(), serial_cache.size());
+}
+
+// Copies of the same binary under different paths, as seen through the roots of different
+// containers, are only indexed once.
+TEST_P(GoBinaryAnalyzerTest, AnalyzesSameContentsOnce) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path go_binary = px::testing::BazelRunfilePath(kGoBinary);
+  std::vector<std::string> binaries = {go_binary.string()};
+  for (std::string_view name : {"container1", "container2"}) {
+    const std::filesystem::path copy = tmp_dir.path() / name;
+    std::filesystem::copy_file(go_binary, copy);
+    binaries.push_back(copy.string());
+  }
+
+  GoSymAddrsCache cache;
+  GoBinaryAnalyzer analyzer(&cache, GetParam());
+  std::vector<GoBinaryAnalysis> analyses = analyzer.Analyze(binaries);
+  ASSERT_THAT(analyses, SizeIs(3));
+  EXPECT_EQ(cache.size(), 1);
+
+  int num_cache_hits = 0;
+  for (const auto& analysis : analyses) {
+    EXPECT_OK(analysis.status);
+    num_cache_hits += analysis.cache_hit;
+  }
+  EXPECT_EQ(num_cache_hits, 2);
+
+  // A later round finds all of them in the cache.
+  analyses = analyzer.Analyze(binaries);
+  ASSERT_THAT(analyses, SizeIs(3));
+  for (const auto& analysis : analyses) {
+    EXPECT_TRUE(analysis.cache_hit);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(NumThreads, GoBinaryAnalyzerTest, ::testing::Values(1, 4));
+
+}  // namespace stirling
+}  // namespace px
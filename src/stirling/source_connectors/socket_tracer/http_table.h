@@ -100,6 +100,7 @@ constexpr DataElement kHTTPElements[] = {
          types::SemanticType::ST_BYTES,
          types::PatternType::METRIC_GAUGE},
         canonical_data_elements::kLatencyNS,
+        canonical_data_elements::kSamplingRatio,
 #ifndef NDEBUG
         canonical_data_elements::kPXInfo,
 #endif
@@ -131,6 +132,7 @@ constexpr int kHTTPRespMessageIdx = kHTTPTable.ColIndex("resp_message");
 constexpr int kHTTPRespBodyIdx = kHTTPTable.ColIndex("resp_body");
 constexpr int kHTTPRespBodySizeIdx = kHTTPTable.ColIndex("resp_body_size");
 constexpr int kHTTPLatencyIdx = kHTTPTable.ColIndex("latency");
+constexpr int kHTTPSamplingRatioIdx = kHTTPTable.ColIndex("sampling_ratio");
 
 }  // namespace stirling
 }  // namespace px
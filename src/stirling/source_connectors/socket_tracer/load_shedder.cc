@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/load_shedder.h"
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+#include <magic_enum.hpp>
+
+namespace px {
+namespace stirling {
+
+LoadShedder::LoadShedder(Targets targets)
+    : targets_(targets), protocols_(magic_enum::enum_count<traffic_protocol_t>()) {}
+
+void LoadShedder::EndIteration(std::chrono::microseconds transfer_time, uint64_t lost_events) {
+  uint64_t buffered_bytes = 0;
+  for (const auto& protocol : protocols_) {
+    buffered_bytes += protocol.buffered_bytes;
+  }
+
+  const bool overloaded = transfer_time > targets_.transfer_time ||
+                          buffered_bytes > targets_.buffered_bytes || lost_events > 0;
+  const bool calm = transfer_time < targets_.transfer_time / 2 &&
+                    buffered_bytes < targets_.buffered_bytes / 2 && lost_events == 0;
+
+  if (holdoff_iters_ > 0) {
+    --holdoff_iters_;
+  }
+
+  if (overloaded) {
+    calm_iters_ = 0;
+    if (++overloaded_iters_ >= targets_.overload_iters && holdoff_iters_ == 0) {
+      ShedHeaviestProtocol();
+    }
+  } else {
+    overloaded_iters_ = 0;
+    if (calm && ++calm_iters_ >= targets_.recovery_iters) {
+      calm_iters_ = 0;
+      for (auto& protocol : protocols_) {
+        if (protocol.sampling_ratio > 1) {
+          protocol.sampling_ratio /= 2;
+        }
+      }
+    } else if (!calm) {
+      calm_iters_ = 0;
+    }
+  }
+
+  for (auto& protocol : protocols_) {
+    protocol.traffic_bytes = 0;
+    protocol.buffered_bytes = 0;
+  }
+}
+
+void LoadShedder::ShedHeaviestProtocol() {
+  // The protocol that costs the most is the one with the most traffic.
+  ProtocolLoad* heaviest = nullptr;
+  for (auto& protocol : protocols_) {
+    const uint64_t bytes = protocol.traffic_bytes + protocol.buffered_bytes;
+    if (bytes == 0 || protocol.sampling_ratio >= kMaxSamplingRatio) {
+      continue;
+    }
+    if (heaviest == nullptr || bytes > heaviest->traffic_bytes + heaviest->buffered_bytes) {
+      heaviest = &protocol;
+    }
+  }
+  if (heaviest == nullptr) {
+    return;
+  }
+  heaviest->sampling_ratio *= 2;
+  overloaded_iters_ = 0;
+  holdoff_iters_ = targets_.recovery_iters;
+}
+
+namespace {
+
+// The finalizer of SplitMix64, which spreads the bits of the connection ID into the low bits.
+uint64_t Mix(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+bool LoadShedder::Sample(const conn_id_t& conn_id, uint32_t sampling_ratio) {
+  if (sampling_ratio <= 1) {
+    return true;
+  }
+  uint64_t hash = Mix(conn_id.upid.pid);
+  hash = Mix(hash ^ conn_id.upid.start_time_ticks);
+  hash = Mix(hash ^ static_cast<uint32_t>(conn_id.fd));
+  hash = Mix(hash ^ conn_id.tsid);
+  return (hash & (sampling_ratio - 1)) == 0;
+}
+
+std::string LoadShedder::DebugString() const {
+  std::string out;
+  for (auto protocol : magic_enum::enum_values<traffic_protocol_t>()) {
+    const uint32_t ratio = protocols_[protocol].sampling_ratio;
+    if (ratio > 1) {
+      absl::StrAppend(&out, absl::Substitute(" $0=1/$1", magic_enum::enum_name(protocol), ratio));
+    }
+  }
+  return out.empty() ? "none" : out;
+}
+
+}  // namespace stirling
+}  // namespace px
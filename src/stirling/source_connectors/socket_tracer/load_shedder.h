@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * Sheds the load of the socket tracer by tracing only a sample of the connections of each
+ * protocol, when tracing all of them costs more than the targets allow.
+ *
+ * Without load shedding, an overloaded socket tracer loses data events in the perf buffers,
+ * which corrupts many connections partially. Instead, each new connection is traced with a
+ * probability of 1/N, where N is the sampling ratio of its protocol. Once the transfer
+ * iterations overshot a target for a few iterations in a row, the ratio of the protocol with the
+ * most traffic is doubled. The ratios are halved once the iterations stayed well below the targets
+ * for a while.
+ *
+ * A new ratio only applies to the connections inferred after it, so it takes a while to lower the
+ * load. A ratio is therefore raised at most once per recovery period, as many iterations as the
+ * ratios take to be lowered, rather than on every overloaded iteration.
+ *
+ * The ratios are powers of 2, and a connection is sampled based on a hash of its ID, so the
+ * connections sampled under a ratio are a subset of those sampled under any lower ratio.
+ */
+class LoadShedder {
+ public:
+  static constexpr uint32_t kMaxSamplingRatio = 1024;
+
+  struct Targets {
+    // The wall time of a transfer iteration, including draining the perf buffers.
+    std::chrono::microseconds transfer_time;
+    // The bytes held in the data streams of all connections after a transfer iteration.
+    uint64_t buffered_bytes;
+    // The number of consecutive iterations above a target, or with lost events, before a sampling
+    // ratio is raised.
+    int overload_iters;
+    // The number of consecutive iterations below half of the targets, and without lost events,
+    // before the sampling ratios are lowered. Also the minimum number of iterations between two
+    // raises of the sampling ratios.
+    int recovery_iters;
+  };
+
+  explicit LoadShedder(Targets targets);
+
+  /**
+   * Records bytes of traffic of the protocol received from BPF in the current iteration.
+   */
+  void AddTrafficBytes(traffic_protocol_t protocol, uint64_t bytes) {
+    protocols_[protocol].traffic_bytes += bytes;
+  }
+
+  /**
+   * Records bytes of the protocol left buffered in a connection at the end of the current
+   * iteration.
+   */
+  void AddBufferedBytes(traffic_protocol_t protocol, uint64_t bytes) {
+    protocols_[protocol].buffered_bytes += bytes;
+  }
+
+  /**
+   * Ends the current iteration, and adjusts the sampling ratios based on its load.
+   *
+   * @param transfer_time The wall time of the iteration.
+   * @param lost_events The number of data events lost in the perf buffers during the iteration.
+   */
+  void EndIteration(std::chrono::microseconds transfer_time, uint64_t lost_events);
+
+  /**
+   * Returns the current sampling ratio of the protocol: 1 in this many new connections are traced.
+   */
+  uint32_t sampling_ratio(traffic_protocol_t protocol) const {
+    return protocols_[protocol].sampling_ratio;
+  }
+
+  /**
+   * Returns true if the connection should be traced under the given sampling ratio.
+   */
+  static bool Sample(const conn_id_t& conn_id, uint32_t sampling_ratio);
+
+  std::string DebugString() const;
+
+ private:
+  // Doubles the sampling ratio of the protocol with the most traffic in the current iteration.
+  void ShedHeaviestProtocol();
+
+  struct ProtocolLoad {
+    uint32_t sampling_ratio = 1;
+    uint64_t traffic_bytes = 0;
+    uint64_t buffered_bytes = 0;
+  };
+
+  const Targets targets_;
+  std::vector<ProtocolLoad> protocols_;
+  int overloaded_iters_ = 0;
+  int calm_iters_ = 0;
+  // The number of iterations left before a sampling ratio may be raised again.
+  int holdoff_iters_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
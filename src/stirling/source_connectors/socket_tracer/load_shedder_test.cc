@@ -0,0 +1,162 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/load_shedder.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::std::chrono::microseconds;
+
+constexpr LoadShedder::Targets kTargets = {
+    .transfer_time = microseconds(1000),
+    .buffered_bytes = 1000,
+    .overload_iters = 2,
+    .recovery_iters = 3,
+};
+
+constexpr microseconds kCalmTime{100};
+constexpr microseconds kSlowTime{2000};
+
+// Tests that the protocol with the most traffic is shed while the transfers are too slow.
+TEST(LoadShedderTest, ShedsHeaviestProtocol) {
+  LoadShedder shedder(kTargets);
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), 1);
+
+  // A single slow iteration sheds nothing.
+  shedder.AddTrafficBytes(kProtocolHTTP, 100);
+  shedder.AddTrafficBytes(kProtocolMySQL, 10);
+  shedder.EndIteration(kSlowTime, 0);
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), 1);
+
+  shedder.AddTrafficBytes(kProtocolHTTP, 100);
+  shedder.AddTrafficBytes(kProtocolMySQL, 10);
+  shedder.EndIteration(kSlowTime, 0);
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), 2);
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolMySQL), 1);
+
+  // Buffered bytes over the target, and lost events, are overloads as well. The next ratio is
+  // raised once the recovery period since the last raise has passed.
+  for (int i = 0; i < kTargets.recovery_iters; ++i) {
+    EXPECT_EQ(shedder.sampling_ratio(kProtocolMySQL), 1);
+    shedder.AddBufferedBytes(kProtocolMySQL, 2000);
+    shedder.EndIteration(kCalmTime, 0);
+  }
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), 2);
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolMySQL), 2);
+
+  for (int i = 0; i < kTargets.recovery_iters; ++i) {
+    EXPECT_EQ(shedder.sampling_ratio(kProtocolMySQL), 2);
+    shedder.AddTrafficBytes(kProtocolMySQL, 10);
+    shedder.EndIteration(kCalmTime, 1);
+  }
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolMySQL), 4);
+}
+
+// Tests that the ratios ramp up slowly enough for each new ratio to take effect on the new
+// connections, and that occasional lost events don't shed any load.
+TEST(LoadShedderTest, RaisesRatioOncePerRecoveryPeriod) {
+  LoadShedder shedder(kTargets);
+  for (int i = 0; i < 10; ++i) {
+    shedder.AddTrafficBytes(kProtocolHTTP, 100);
+    shedder.EndIteration(kCalmTime, /*lost_events*/ i % 2 == 0 ? 1 : 0);
+  }
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), 1);
+
+  // Under a sustained overload, the first raise takes overload_iters iterations, and every next one
+  // recovery_iters iterations.
+  uint32_t expected_ratio = 1;
+  for (int i = 1; i <= 40; ++i) {
+    shedder.AddTrafficBytes(kProtocolHTTP, 100);
+    shedder.EndIteration(kSlowTime, 0);
+    const bool raise_due = i >= kTargets.overload_iters &&
+                           (i - kTargets.overload_iters) % kTargets.recovery_iters == 0;
+    if (raise_due && expected_ratio < LoadShedder::kMaxSamplingRatio) {
+      expected_ratio *= 2;
+    }
+    EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), expected_ratio) << "iteration " << i;
+  }
+  EXPECT_EQ(expected_ratio, LoadShedder::kMaxSamplingRatio);
+}
+
+TEST(LoadShedderTest, RatioIsCapped) {
+  LoadShedder shedder(kTargets);
+  for (int i = 0; i < 50; ++i) {
+    shedder.AddTrafficBytes(kProtocolHTTP, 100);
+    shedder.EndIteration(kSlowTime, 0);
+  }
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), LoadShedder::kMaxSamplingRatio);
+}
+
+// Tests that the ratios are lowered only after enough consecutive calm iterations.
+TEST(LoadShedderTest, RecoversWhenCalm) {
+  LoadShedder shedder(kTargets);
+  for (int i = 0; i < kTargets.overload_iters + kTargets.recovery_iters; ++i) {
+    shedder.AddTrafficBytes(kProtocolHTTP, 100);
+    shedder.EndIteration(kSlowTime, 0);
+  }
+  ASSERT_EQ(shedder.sampling_ratio(kProtocolHTTP), 4);
+
+  shedder.EndIteration(kCalmTime, 0);
+  shedder.EndIteration(kCalmTime, 0);
+  // Between half of the target and the target is neither an overload nor calm.
+  shedder.EndIteration(microseconds(800), 0);
+  shedder.EndIteration(kCalmTime, 0);
+  shedder.EndIteration(kCalmTime, 0);
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), 4);
+
+  shedder.EndIteration(kCalmTime, 0);
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), 2);
+
+  for (int i = 0; i < 3; ++i) {
+    shedder.EndIteration(kCalmTime, 0);
+  }
+  EXPECT_EQ(shedder.sampling_ratio(kProtocolHTTP), 1);
+  EXPECT_EQ(shedder.DebugString(), "none");
+}
+
+// Tests that a connection sampled under a ratio is sampled under all lower ratios, and that about
+// 1 in ratio connections are sampled.
+TEST(LoadShedderTest, SamplesNestedSubsets) {
+  constexpr int kNumConns = 10000;
+  int num_sampled_2 = 0;
+  int num_sampled_8 = 0;
+  for (int i = 0; i < kNumConns; ++i) {
+    conn_id_t conn_id = {};
+    conn_id.upid.pid = 100 + i % 7;
+    conn_id.upid.start_time_ticks = 12345;
+    conn_id.fd = i;
+    conn_id.tsid = 1000 * i;
+
+    EXPECT_TRUE(LoadShedder::Sample(conn_id, 1));
+    const bool sampled_2 = LoadShedder::Sample(conn_id, 2);
+    const bool sampled_8 = LoadShedder::Sample(conn_id, 8);
+    if (sampled_8) {
+      EXPECT_TRUE(sampled_2);
+    }
+    num_sampled_2 += sampled_2;
+    num_sampled_8 += sampled_8;
+  }
+  EXPECT_NEAR(num_sampled_2, kNumConns / 2, kNumConns / 20);
+  EXPECT_NEAR(num_sampled_8, kNumConns / 8, kNumConns / 40);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -30,6 +30,7 @@
 
 #include "src/common/base/base.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/amqp/types_gen.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_search.h"
 #include "src/stirling/utils/binary_decoder.h"
 
 namespace px {
@@ -54,15 +55,12 @@ size_t FindFrameBoundary(std::string_view buf, size_t start_pos) {
     return std::string::npos;
   }
 
-  for (; start_pos < buf.size(); ++start_pos) {
-    const AMQPFrameTypes type_marker = static_cast<AMQPFrameTypes>(buf[start_pos]);
-    if (type_marker == AMQPFrameTypes::kFrameHeader || type_marker == AMQPFrameTypes::kFrameBody ||
-        type_marker == AMQPFrameTypes::kFrameMethod ||
-        type_marker == AMQPFrameTypes::kFrameHeartbeat) {
-      return start_pos;
-    }
-  }
-  return std::string_view::npos;
+  static const MultiPatternSearcher kFrameTypes = MultiPatternSearcher::AnyByteOf(
+      std::string{static_cast<char>(AMQPFrameTypes::kFrameHeader),
+                  static_cast<char>(AMQPFrameTypes::kFrameBody),
+                  static_cast<char>(AMQPFrameTypes::kFrameMethod),
+                  static_cast<char>(AMQPFrameTypes::kFrameHeartbeat)});
+  return kFrameTypes.Find(buf, start_pos);
 }
 
 // Parse the message's type, channel
@@ -0,0 +1,402 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/chunked_data_stream_buffer_impl.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+namespace {
+
+// Get element <= key in a map.
+template <typename TMapType>
+typename TMapType::const_iterator MapLE(const TMapType& map, size_t key) {
+  auto iter = map.upper_bound(key);
+  if (iter == map.begin()) {
+    return map.cend();
+  }
+  --iter;
+
+  return iter;
+}
+
+// Released chunks are kept in a per-thread free list, so that streaming through a connection does
+// not hit the allocator for every chunk. The free list is bounded to limit idle memory.
+constexpr size_t kMaxPooledChunks = 256;
+
+thread_local std::vector<std::unique_ptr<char[]>> chunk_pool;
+
+std::unique_ptr<char[]> AcquireChunk() {
+  if (chunk_pool.empty()) {
+    return std::unique_ptr<char[]>(new char[ChunkedDataStreamBufferImpl::kChunkSize]);
+  }
+  std::unique_ptr<char[]> chunk = std::move(chunk_pool.back());
+  chunk_pool.pop_back();
+  return chunk;
+}
+
+void ReleaseChunk(std::unique_ptr<char[]> chunk) {
+  if (chunk_pool.size() < kMaxPooledChunks) {
+    chunk_pool.push_back(std::move(chunk));
+  }
+}
+
+}  // namespace
+
+ChunkedDataStreamBufferImpl::~ChunkedDataStreamBufferImpl() { ReleaseAll(); }
+
+void ChunkedDataStreamBufferImpl::Reset() {
+  ReleaseAll();
+  ranges_.clear();
+  timestamps_.clear();
+  position_ = 0;
+  size_ = 0;
+  ShrinkToFit();
+}
+
+void ChunkedDataStreamBufferImpl::ReleaseAll() {
+  for (auto& chunk : chunks_) {
+    ReleaseChunk(std::move(chunk));
+  }
+  chunks_.clear();
+  contiguous_.clear();
+}
+
+char* ChunkedDataStreamBufferImpl::ChunkData(size_t pos) const {
+  DCHECK_GE(pos, chunks_pos_);
+  size_t offset = pos - chunks_pos_;
+  DCHECK_LT(offset / kChunkSize, chunks_.size());
+  return chunks_[offset / kChunkSize].get() + offset % kChunkSize;
+}
+
+void ChunkedDataStreamBufferImpl::EnsureChunks(size_t end_pos) {
+  if (chunks_.empty()) {
+    chunks_pos_ = position_ - position_ % kChunkSize;
+  }
+  while (chunks_pos_ + chunks_.size() * kChunkSize < end_pos) {
+    chunks_.push_back(AcquireChunk());
+  }
+}
+
+void ChunkedDataStreamBufferImpl::CopyOut(size_t pos, size_t size, std::string* out) const {
+  while (size > 0) {
+    size_t n = std::min(size, kChunkSize - (pos - chunks_pos_) % kChunkSize);
+    out->append(ChunkData(pos), n);
+    pos += n;
+    size -= n;
+  }
+}
+
+bool ChunkedDataStreamBufferImpl::Overlaps(size_t pos, size_t size) const {
+  auto r_iter = ranges_.lower_bound(pos);
+  if (r_iter != ranges_.end() && pos + size > r_iter->first) {
+    return true;
+  }
+  if (r_iter != ranges_.begin()) {
+    auto l_iter = std::prev(r_iter);
+    if (pos < l_iter->first + l_iter->second) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ChunkedDataStreamBufferImpl::AddRange(size_t pos, size_t size) {
+  auto r_iter = ranges_.lower_bound(pos);
+  bool right_fuse = (r_iter != ranges_.end() && pos + size == r_iter->first);
+  if (right_fuse) {
+    size += r_iter->second;
+    r_iter = ranges_.erase(r_iter);
+  }
+
+  if (r_iter != ranges_.begin()) {
+    auto l_iter = std::prev(r_iter);
+    if (l_iter->first + l_iter->second == pos) {
+      l_iter->second += size;
+      return;
+    }
+  }
+  ranges_.emplace_hint(r_iter, pos, size);
+}
+
+size_t ChunkedDataStreamBufferImpl::EndPosition() const {
+  if (ranges_.empty()) {
+    return position_;
+  }
+  auto last = ranges_.rbegin();
+  return last->first + last->second;
+}
+
+void ChunkedDataStreamBufferImpl::Add(size_t pos, std::string_view data, uint64_t timestamp) {
+  if (data.size() > capacity_) {
+    size_t oversize_amount = data.size() - capacity_;
+    data.remove_prefix(oversize_amount);
+    pos += oversize_amount;
+  }
+
+  if (pos + data.size() <= position_) {
+    // Data being added is too far back. Just ignore it.
+    VLOG(1) << absl::Substitute(
+        "Ignoring event that has already been skipped [event pos=$0, current pos=$1].", pos,
+        position_);
+    return;
+  }
+
+  if (pos < position_) {
+    // Data being added is straddling the front-side of the buffer. Cut-off the prefix.
+    VLOG(1) << absl::Substitute(
+        "Event is partially too far in the past [event pos=$0, current pos=$1].", pos, position_);
+    data.remove_prefix(position_ - pos);
+    pos = position_;
+  }
+
+  if (pos + data.size() > position_ + size_) {
+    // Data being added extends the buffer.
+
+    // Same gap handling as AlwaysContiguousDataStreamBufferImpl: give up on the data currently in
+    // the buffer, and leave `allow_before_gap_size_` bytes of room before the new data.
+    if (pos > EndPosition() + max_gap_size_) {
+      VLOG(1) << absl::Substitute("Event leaves a large gap [event pos=$0, current pos=$1].", pos,
+                                  position_);
+      size_t new_position = pos - std::min(pos, allow_before_gap_size_);
+      RemovePrefix(std::max(new_position, position_) - position_);
+    }
+
+    size_t logical_size = pos + data.size() - position_;
+    if (logical_size > capacity_) {
+      // The movement of the buffer position will cause some bytes to "fall off",
+      // remove those now.
+      size_t remove_count = logical_size - capacity_;
+      VLOG(1) << absl::Substitute("Event bytes to be dropped [count=$0].", remove_count);
+      RemovePrefix(remove_count);
+    }
+
+    size_ = pos + data.size() - position_;
+    DCHECK_LE(size_, capacity_);
+    EnsureChunks(position_ + size_);
+  }
+
+  if (Overlaps(pos, data.size())) {
+    LOG(DFATAL) << absl::Substitute("New chunk overlaps with existing data [p=$0,s=$1]\n$2", pos,
+                                    data.size(), DebugInfo());
+    return;
+  }
+
+  // Copy the data into the chunks, splitting at chunk boundaries.
+  size_t write_pos = pos;
+  std::string_view remaining = data;
+  while (!remaining.empty()) {
+    size_t n = std::min(remaining.size(), kChunkSize - (write_pos - chunks_pos_) % kChunkSize);
+    memcpy(ChunkData(write_pos), remaining.data(), n);
+    remaining.remove_prefix(n);
+    write_pos += n;
+  }
+
+  AddRange(pos, data.size());
+  timestamps_[pos] = timestamp;
+}
+
+std::map<size_t, size_t>::const_iterator ChunkedDataStreamBufferImpl::GetRangeForPos(
+    size_t pos) const {
+  auto iter = MapLE(ranges_, pos);
+  if (iter == ranges_.cend() || pos >= iter->first + iter->second) {
+    return ranges_.cend();
+  }
+  return iter;
+}
+
+void ChunkedDataStreamBufferImpl::EnforceTimestampMonotonicity(size_t range_start,
+                                                               size_t range_end) {
+  auto it = timestamps_.upper_bound(range_start);
+  if (it == timestamps_.begin()) {
+    return;
+  }
+  --it;
+
+  prev_timestamp_ = 0;
+  for (; it != timestamps_.end() && it->first < range_end; ++it) {
+    if (prev_timestamp_ > 0 && it->second < prev_timestamp_) {
+      LOG(WARNING) << absl::Substitute(
+          "For chunk pos $0, detected non-monotonically increasing timestamp $1. Adjusting to "
+          "previous timestamp + 1: $2",
+          it->first, it->second, prev_timestamp_ + 1);
+      it->second = prev_timestamp_ + 1;
+    }
+    prev_timestamp_ = it->second;
+  }
+}
+
+std::string_view ChunkedDataStreamBufferImpl::Head() {
+  auto iter = GetRangeForPos(position_);
+  if (iter == ranges_.cend()) {
+    return {};
+  }
+
+  size_t range_end = iter->first + iter->second;
+  EnforceTimestampMonotonicity(iter->first, range_end);
+
+  size_t len = range_end - position_;
+
+  // Fast path: the head lives entirely within one chunk.
+  if ((position_ - chunks_pos_) % kChunkSize + len <= kChunkSize) {
+    return std::string_view(ChunkData(position_), len);
+  }
+
+  // Otherwise, materialize the head, reusing whatever was materialized by previous calls.
+  if (contiguous_.empty() || position_ < contiguous_pos_ ||
+      position_ > contiguous_pos_ + contiguous_.size()) {
+    contiguous_.clear();
+    contiguous_pos_ = position_;
+  } else if (position_ - contiguous_pos_ > contiguous_.size() / 2) {
+    // Drop the consumed prefix once it dominates, so the copy stays bounded by the head size.
+    contiguous_.erase(0, position_ - contiguous_pos_);
+    contiguous_pos_ = position_;
+  }
+
+  size_t materialized_end = contiguous_pos_ + contiguous_.size();
+  DCHECK_LE(materialized_end, range_end);
+  if (materialized_end < range_end) {
+    CopyOut(materialized_end, range_end - materialized_end, &contiguous_);
+  }
+  return std::string_view(contiguous_.data() + (position_ - contiguous_pos_), len);
+}
+
+std::vector<std::string_view> ChunkedDataStreamBufferImpl::HeadSegments() {
+  std::vector<std::string_view> segments;
+
+  auto iter = GetRangeForPos(position_);
+  if (iter == ranges_.cend()) {
+    return segments;
+  }
+
+  size_t range_end = iter->first + iter->second;
+  EnforceTimestampMonotonicity(iter->first, range_end);
+
+  for (size_t pos = position_; pos < range_end;) {
+    size_t n = std::min(range_end - pos, kChunkSize - (pos - chunks_pos_) % kChunkSize);
+    segments.emplace_back(ChunkData(pos), n);
+    pos += n;
+  }
+  return segments;
+}
+
+StatusOr<uint64_t> ChunkedDataStreamBufferImpl::GetTimestamp(size_t pos) const {
+  if (GetRangeForPos(pos) == ranges_.cend()) {
+    return error::Internal("Specified position not found");
+  }
+
+  auto iter = MapLE(timestamps_, pos);
+  if (iter == timestamps_.cend()) {
+    LOG(DFATAL) << absl::Substitute(
+        "Specified position should have been found, since we verified we are not in a chunk gap "
+        "[position=$0]\n$1.",
+        pos, DebugInfo());
+    return error::Internal("Specified position not found.");
+  }
+
+  return iter->second;
+}
+
+void ChunkedDataStreamBufferImpl::ReleaseConsumed() {
+  // Release chunks that are entirely before position_. No data is moved.
+  while (!chunks_.empty() && chunks_pos_ + kChunkSize <= position_) {
+    ReleaseChunk(std::move(chunks_.front()));
+    chunks_.pop_front();
+    chunks_pos_ += kChunkSize;
+  }
+  if (size_ == 0) {
+    ReleaseAll();
+  }
+
+  if (!contiguous_.empty() && position_ >= contiguous_pos_ + contiguous_.size()) {
+    contiguous_.clear();
+  }
+
+  // Trim the valid ranges to start at or after position_.
+  auto range_iter = MapLE(ranges_, position_);
+  if (range_iter != ranges_.cend()) {
+    size_t range_end = range_iter->first + range_iter->second;
+    auto next = std::next(range_iter);
+    ranges_.erase(ranges_.begin(), next);
+    if (range_end > position_) {
+      ranges_.emplace_hint(next, position_, range_end - position_);
+    }
+  }
+
+  // Keep the timestamp that covers position_; anything before it is expired.
+  auto ts_iter = MapLE(timestamps_, position_);
+  if (ts_iter != timestamps_.cend()) {
+    timestamps_.erase(timestamps_.begin(), ts_iter);
+  }
+}
+
+void ChunkedDataStreamBufferImpl::RemovePrefix(ssize_t n) {
+  // Check for positive values of n.
+  // For safety in production code, just return.
+  DCHECK_GE(n, 0);
+  if (n < 0) {
+    return;
+  }
+
+  position_ += n;
+  size_ -= std::min(static_cast<size_t>(n), size_);
+
+  ReleaseConsumed();
+}
+
+void ChunkedDataStreamBufferImpl::Trim() {
+  if (ranges_.empty()) {
+    return;
+  }
+
+  auto iter = ranges_.begin();
+  DCHECK_GE(iter->first, position_);
+  RemovePrefix(iter->first - position_);
+}
+
+std::string ChunkedDataStreamBufferImpl::DebugInfo() const {
+  std::string s;
+
+  absl::StrAppend(&s, absl::Substitute("Position: $0\n", position_));
+  absl::StrAppend(&s, absl::Substitute("Size: $0 (chunks=$1, materialized=$2)\n", size_,
+                                       chunks_.size(), contiguous_.size()));
+  absl::StrAppend(&s, "Ranges:\n");
+  for (const auto& [pos, size] : ranges_) {
+    absl::StrAppend(&s, absl::Substitute("  position:$0 size:$1\n", pos, size));
+  }
+  absl::StrAppend(&s, "Timestamps:\n");
+  for (const auto& [pos, timestamp] : timestamps_) {
+    absl::StrAppend(&s, absl::Substitute("  position:$0 timestamp:$1\n", pos, timestamp));
+  }
+
+  return s;
+}
+
+void ChunkedDataStreamBufferImpl::ShrinkToFit() {
+  // The materialized head is derived data, so it can always be dropped.
+  contiguous_.clear();
+  contiguous_.shrink_to_fit();
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
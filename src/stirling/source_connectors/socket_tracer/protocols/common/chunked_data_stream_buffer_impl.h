@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * This version of the DataStreamBuffer stores data in fixed-size chunks, which are recycled
+ * through a per-thread pool. Unlike the other implementations, RemovePrefix() never moves data:
+ * it only releases the chunks that fall entirely before the new head position.
+ *
+ * Contiguity is only materialized when Head() is called and the contiguous head crosses a chunk
+ * boundary. The materialized copy is kept across calls, so a parser that consumes the head
+ * incrementally (RemovePrefix() followed by Head()) does not copy the same bytes again.
+ * HeadSegments() provides the head as a list of chunk-local views, without any copying.
+ *
+ * Gap and capacity handling (and thus size()) follow AlwaysContiguousDataStreamBufferImpl.
+ */
+class ChunkedDataStreamBufferImpl : public DataStreamBufferImpl {
+ public:
+  static constexpr size_t kChunkSize = 16 * 1024;
+
+  ChunkedDataStreamBufferImpl(size_t max_capacity, size_t max_gap_size,
+                              size_t allow_before_gap_size)
+      : capacity_(max_capacity),
+        max_gap_size_(max_gap_size),
+        allow_before_gap_size_(allow_before_gap_size) {}
+
+  ~ChunkedDataStreamBufferImpl() override;
+
+  void Add(size_t pos, std::string_view data, uint64_t timestamp) override;
+
+  std::string_view Head() override;
+
+  std::vector<std::string_view> HeadSegments() override;
+
+  StatusOr<uint64_t> GetTimestamp(size_t pos) const override;
+
+  void RemovePrefix(ssize_t n) override;
+
+  void Trim() override;
+
+  size_t size() const override { return size_; }
+
+  size_t capacity() const override { return chunks_.size() * kChunkSize + contiguous_.capacity(); }
+
+  bool empty() const override { return size_ == 0; }
+
+  size_t position() const override { return position_; }
+
+  std::string DebugInfo() const override;
+
+  void Reset() override;
+
+  void ShrinkToFit() override;
+
+ private:
+  // Returns the valid range that contains pos, or ranges_.end().
+  std::map<size_t, size_t>::const_iterator GetRangeForPos(size_t pos) const;
+
+  // Returns true if [pos, pos+size) overlaps any valid range.
+  bool Overlaps(size_t pos, size_t size) const;
+
+  // Records [pos, pos+size) as valid, fusing it with adjacent ranges.
+  void AddRange(size_t pos, size_t size);
+
+  // Make sure chunks are allocated for all logical positions up to end_pos.
+  void EnsureChunks(size_t end_pos);
+
+  // Release chunks that are entirely before position_, and any metadata before position_.
+  void ReleaseConsumed();
+
+  // Release all chunks and the materialized head.
+  void ReleaseAll();
+
+  // Copies [pos, pos+size) out of the chunks, appending to out.
+  void CopyOut(size_t pos, size_t size, std::string* out) const;
+
+  // Returns a pointer to the byte at logical position pos.
+  char* ChunkData(size_t pos) const;
+
+  // Ensure that timestamps are monotonically increasing for a given range.
+  void EnforceTimestampMonotonicity(size_t range_start, size_t range_end);
+
+  // End of the last valid range, or position_ if there is none.
+  size_t EndPosition() const;
+
+  const size_t capacity_;
+  const size_t max_gap_size_;
+  const size_t allow_before_gap_size_;
+
+  // Logical position of the head of the buffer.
+  size_t position_ = 0;
+
+  // Logical size of the buffer, including gaps; i.e. the furthest data ends at position_ + size_.
+  size_t size_ = 0;
+
+  // Storage. chunks_[i] holds logical positions [chunks_pos_ + i * kChunkSize, +kChunkSize).
+  // chunks_pos_ is always a multiple of kChunkSize.
+  std::deque<std::unique_ptr<char[]>> chunks_;
+  size_t chunks_pos_ = 0;
+
+  // Map of valid range start positions to range sizes. Adjacent ranges are always fused.
+  std::map<size_t, size_t> ranges_;
+
+  // Map of positions to timestamps, as in AlwaysContiguousDataStreamBufferImpl.
+  std::map<size_t, uint64_t> timestamps_;
+  uint64_t prev_timestamp_ = 0;
+
+  // A materialized copy of valid data starting at contiguous_pos_; only used when the head
+  // crosses a chunk boundary.
+  std::string contiguous_;
+  size_t contiguous_pos_ = 0;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
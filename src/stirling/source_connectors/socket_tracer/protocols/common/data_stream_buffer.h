@@ -23,10 +23,12 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "src/common/base/base.h"
 
 DECLARE_bool(stirling_data_stream_buffer_always_contiguous_buffer);
+DECLARE_bool(stirling_data_stream_buffer_chunked_buffer);
 
 namespace px {
 namespace stirling {
@@ -39,6 +41,13 @@ class DataStreamBufferImpl {
   virtual ~DataStreamBufferImpl() = default;
   virtual void Add(size_t pos, std::string_view data, uint64_t timestamp) = 0;
   virtual std::string_view Head() = 0;
+  virtual std::vector<std::string_view> HeadSegments() {
+    std::string_view head = Head();
+    if (head.empty()) {
+      return {};
+    }
+    return {head};
+  }
   virtual StatusOr<uint64_t> GetTimestamp(size_t pos) const = 0;
   virtual void RemovePrefix(ssize_t n) = 0;
   virtual void Trim() = 0;
@@ -90,6 +99,14 @@ class DataStreamBuffer {
    */
   std::string_view Head() { return impl_->Head(); }
 
+  /**
+   * Get all the contiguous data at the head of the buffer, as a sequence of views into the
+   * underlying storage. Concatenated, the segments are equal to Head(), but unlike Head(),
+   * no implementation needs to copy data to produce them.
+   * @return The segments, in order. Empty if there is no data at the head.
+   */
+  std::vector<std::string_view> HeadSegments() { return impl_->HeadSegments(); }
+
   /**
    * Get timestamp recorded for the data at the specified position.
    * If less than previous timestamp, timestamp will be adjusted to be monotonically increasing.
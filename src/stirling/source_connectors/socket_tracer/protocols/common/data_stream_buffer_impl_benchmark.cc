@@ -23,6 +23,7 @@
 #include "src/common/base/base.h"
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/always_contiguous_data_stream_buffer_impl.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/chunked_data_stream_buffer_impl.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/lazy_contiguous_data_stream_buffer_impl.h"
 
 template <typename TDataStreamBufferImpl>
@@ -229,7 +230,43 @@ static void BM_RemovePrefix(benchmark::State& state) {
   }
 }
 
+// Mimics the socket tracer's usage: events keep arriving while a parser consumes frames of
+// size state.range(0) from the head, with a backlog of unconsumed data in the buffer.
+template <typename TDataStreamBufferImpl>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ParseLoop(benchmark::State& state) {
+  size_t capacity = 50 * 1024 * 1024;
+  size_t max_gap_size = 10 * 1024 * 1024;
+  size_t allow_before_gap_size = 1 * 1024 * 1024;
+
+  std::string data(16 * 1024, '0');
+  size_t frame_size = state.range(0);
+  size_t backlog = 256 * 1024;
+  size_t total_bytes = 16 * 1024 * 1024;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    TDataStreamBufferImpl stream_buffer(capacity, max_gap_size, allow_before_gap_size);
+    state.ResumeTiming();
+
+    size_t pos = 0;
+    uint64_t ts = 0;
+    while (pos < total_bytes) {
+      stream_buffer.Add(pos, data, ts);
+      pos += data.size();
+      ts += 1;
+
+      while (stream_buffer.size() >= backlog) {
+        benchmark::DoNotOptimize(stream_buffer.Head());
+        stream_buffer.RemovePrefix(frame_size);
+      }
+    }
+  }
+  state.SetBytesProcessed(static_cast<uint64_t>(state.iterations()) * total_bytes);
+}
+
 using px::stirling::protocols::AlwaysContiguousDataStreamBufferImpl;
+using px::stirling::protocols::ChunkedDataStreamBufferImpl;
 using px::stirling::protocols::LazyContiguousDataStreamBufferImpl;
 
 BENCHMARK_TEMPLATE(BM_ContiguousBytes, LazyContiguousDataStreamBufferImpl)
@@ -238,9 +275,13 @@ BENCHMARK_TEMPLATE(BM_ContiguousBytes, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_ContiguousBytes, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ContiguousBytes, ChunkedDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_SingleAdd, LazyContiguousDataStreamBufferImpl)->Range(1024, 32 * 1024);
 BENCHMARK_TEMPLATE(BM_SingleAdd, AlwaysContiguousDataStreamBufferImpl)->Range(1024, 32 * 1024);
+BENCHMARK_TEMPLATE(BM_SingleAdd, ChunkedDataStreamBufferImpl)->Range(1024, 32 * 1024);
 
 BENCHMARK_TEMPLATE(BM_OoOBytes, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -248,6 +289,9 @@ BENCHMARK_TEMPLATE(BM_OoOBytes, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_OoOBytes, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_OoOBytes, ChunkedDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_OverrunCapacity, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -255,6 +299,9 @@ BENCHMARK_TEMPLATE(BM_OverrunCapacity, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_OverrunCapacity, AlwaysContiguousDataStreamBufferImpl)
     ->Range(32 * 1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_OverrunCapacity, ChunkedDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_LargeGap, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -262,6 +309,9 @@ BENCHMARK_TEMPLATE(BM_LargeGap, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_LargeGap, AlwaysContiguousDataStreamBufferImpl)
     ->Range(32 * 1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_LargeGap, ChunkedDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_RemovePrefix, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -269,3 +319,16 @@ BENCHMARK_TEMPLATE(BM_RemovePrefix, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_RemovePrefix, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RemovePrefix, ChunkedDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ParseLoop, LazyContiguousDataStreamBufferImpl)
+    ->Range(1024, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ParseLoop, AlwaysContiguousDataStreamBufferImpl)
+    ->Range(1024, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ParseLoop, ChunkedDataStreamBufferImpl)
+    ->Range(1024, 16 * 1024)
+    ->Unit(benchmark::kMillisecond);
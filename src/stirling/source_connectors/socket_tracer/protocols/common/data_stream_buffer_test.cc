@@ -18,24 +18,44 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
 
+#include <absl/strings/str_join.h>
+
+#include <string>
+#include <vector>
+
 #include "src/common/testing/testing.h"
 
 namespace px {
 namespace stirling {
 namespace protocols {
 
-class DataStreamBufferTest : public ::testing::TestWithParam<bool> {
+enum class BufferImpl {
+  kAlwaysContiguous,
+  kLazyContiguous,
+  kChunked,
+};
+
+class DataStreamBufferTest : public ::testing::TestWithParam<BufferImpl> {
  protected:
   void SetUp() override {
-    old_flag_val_ = FLAGS_stirling_data_stream_buffer_always_contiguous_buffer;
-    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = GetParam();
+    old_always_contiguous_flag_val_ = FLAGS_stirling_data_stream_buffer_always_contiguous_buffer;
+    old_chunked_flag_val_ = FLAGS_stirling_data_stream_buffer_chunked_buffer;
+    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer =
+        GetParam() == BufferImpl::kAlwaysContiguous;
+    FLAGS_stirling_data_stream_buffer_chunked_buffer = GetParam() == BufferImpl::kChunked;
   }
   void TearDown() override {
-    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = old_flag_val_;
+    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = old_always_contiguous_flag_val_;
+    FLAGS_stirling_data_stream_buffer_chunked_buffer = old_chunked_flag_val_;
   }
 
+  // The always-contiguous and chunked implementations count gaps in size(), and give up on the
+  // buffered data when a large gap is encountered. The lazy implementation does neither.
+  bool AllocatesGaps() const { return GetParam() != BufferImpl::kLazyContiguous; }
+
  private:
-  bool old_flag_val_;
+  bool old_always_contiguous_flag_val_;
+  bool old_chunked_flag_val_;
 };
 
 TEST_P(DataStreamBufferTest, AddAndGet) {
@@ -211,7 +231,7 @@ TEST_P(DataStreamBufferTest, SizeAndGetPos) {
   // size() is different between the two current implementations (the new impl does not
   // include the gap in size, the old one does).
   // TODO(james): remove one of the two checks when we settle on an implementation.
-  if (FLAGS_stirling_data_stream_buffer_always_contiguous_buffer) {
+  if (AllocatesGaps()) {
     EXPECT_EQ(stream_buffer.size(), 10);
   } else {
     EXPECT_EQ(stream_buffer.size(), 6);
@@ -264,7 +284,7 @@ TEST_P(DataStreamBufferTest, LargeGap) {
   // These tests only apply to the old implementation, the new implementation will keep all of this
   // data in its buffer, since it doesn't allocate gaps.
   // TODO(james): remove when we settle on an implementation.
-  if (FLAGS_stirling_data_stream_buffer_always_contiguous_buffer) {
+  if (AllocatesGaps()) {
     EXPECT_EQ(stream_buffer.size(), 4 + kAllowBeforeGapSize);
 
     // Add event more than allow_before_gap_size before the last event. This event should not be
@@ -279,14 +299,58 @@ TEST_P(DataStreamBufferTest, LargeGap) {
   }
 }
 
+// Large events spanning several chunks, consumed a piece at a time, as a parser would.
+TEST_P(DataStreamBufferTest, LargeEventsConsumedIncrementally) {
+  const size_t kEventSize = 40000;
+  DataStreamBuffer stream_buffer(1024 * 1024, 1024 * 1024, 1024 * 1024);
+
+  std::string data;
+  for (size_t i = 0; i < 3 * kEventSize; ++i) {
+    data.push_back('a' + i % 26);
+  }
+  std::string_view data_view = data;
+
+  // Add the events out of order.
+  stream_buffer.Add(2 * kEventSize, data_view.substr(2 * kEventSize, kEventSize), 2);
+  stream_buffer.Add(0, data_view.substr(0, kEventSize), 0);
+  EXPECT_EQ(stream_buffer.Head(), data_view.substr(0, kEventSize));
+  stream_buffer.Add(kEventSize, data_view.substr(kEventSize, kEventSize), 1);
+  EXPECT_EQ(stream_buffer.Head(), data_view);
+
+  std::vector<std::string_view> segments = stream_buffer.HeadSegments();
+  EXPECT_EQ(absl::StrJoin(segments, ""), data_view);
+
+  // Consume the head in pieces that do not line up with the events.
+  size_t pos = 0;
+  while (pos < data.size()) {
+    size_t n = std::min<size_t>(7001, data.size() - pos);
+    ASSERT_EQ(stream_buffer.Head(), data_view.substr(pos));
+    ASSERT_OK_AND_EQ(stream_buffer.GetTimestamp(pos), pos / kEventSize);
+    stream_buffer.RemovePrefix(n);
+    pos += n;
+  }
+  EXPECT_TRUE(stream_buffer.empty());
+  EXPECT_EQ(stream_buffer.Head(), "");
+  EXPECT_TRUE(stream_buffer.HeadSegments().empty());
+
+  // The buffer is reusable after being drained.
+  stream_buffer.Add(pos, data_view.substr(0, 10), 3);
+  EXPECT_EQ(stream_buffer.Head(), data_view.substr(0, 10));
+}
+
 INSTANTIATE_TEST_SUITE_P(DataStreamBufferImplTest, DataStreamBufferTest,
-                         ::testing::Values(true, false),
+                         ::testing::Values(BufferImpl::kAlwaysContiguous,
+                                           BufferImpl::kLazyContiguous, BufferImpl::kChunked),
                          [](const ::testing::TestParamInfo<DataStreamBufferTest::ParamType>& info) {
-                           if (info.param) {
-                             return "AlwaysContiguousImpl";
-                           } else {
-                             return "LazyContiguousImpl";
+                           switch (info.param) {
+                             case BufferImpl::kAlwaysContiguous:
+                               return "AlwaysContiguousImpl";
+                             case BufferImpl::kLazyContiguous:
+                               return "LazyContiguousImpl";
+                             case BufferImpl::kChunked:
+                               return "ChunkedImpl";
                            }
+                           return "Unknown";
                          });
 
 }  // namespace protocols
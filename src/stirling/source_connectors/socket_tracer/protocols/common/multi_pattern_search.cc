@@ -0,0 +1,262 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_search.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+namespace {
+
+// Each Find*() returns the first position at or after pos that starts with one of first_bytes and
+// for which matches_at(pos) is true, or std::string_view::npos.
+// The SIMD versions check the positions in a block whose byte is in first_bytes and, unless
+// second_bytes is empty, whose next byte is in second_bytes.
+
+template <typename TMatchesAtFn>
+size_t FindScalar(std::string_view buf, size_t pos, const std::array<int8_t, 256>& first_byte_idx,
+                  const TMatchesAtFn& matches_at) {
+  for (; pos < buf.size(); ++pos) {
+    if (first_byte_idx[static_cast<uint8_t>(buf[pos])] >= 0 && matches_at(pos)) {
+      return pos;
+    }
+  }
+  return std::string_view::npos;
+}
+
+#if defined(__x86_64__)
+
+// Returns a bit mask of the bytes in block that are one of bytes, using PCMPESTRM in equal-any
+// mode, which compares 16 bytes against up to 16 set bytes at once. The explicit-length form is
+// needed because the set may include the zero byte.
+__attribute__((target("sse4.2"))) inline uint32_t AnyOfMaskSSE42(__m128i block,
+                                                                 const __m128i (&set)[2],
+                                                                 const int (&set_len)[2]) {
+  constexpr int kMode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+  uint32_t mask = _mm_cvtsi128_si32(_mm_cmpestrm(set[0], set_len[0], block, 16, kMode));
+  if (set_len[1] > 0) {
+    mask |= _mm_cvtsi128_si32(_mm_cmpestrm(set[1], set_len[1], block, 16, kMode));
+  }
+  return mask;
+}
+
+__attribute__((target("sse4.2"))) void LoadSetSSE42(std::string_view bytes, __m128i (&set)[2],
+                                                    int (&set_len)[2]) {
+  char set_bytes[32] = {};
+  bytes.copy(set_bytes, sizeof(set_bytes));
+  set[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set_bytes));
+  set[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set_bytes + 16));
+  set_len[0] = std::min<int>(bytes.size(), 16);
+  set_len[1] = static_cast<int>(bytes.size()) - set_len[0];
+}
+
+template <typename TMatchesAtFn>
+__attribute__((target("sse4.2"))) size_t FindSSE42(std::string_view buf, size_t pos,
+                                                   std::string_view first_bytes,
+                                                   std::string_view second_bytes,
+                                                   const std::array<int8_t, 256>& first_byte_idx,
+                                                   const TMatchesAtFn& matches_at) {
+  __m128i first_set[2];
+  int first_set_len[2];
+  LoadSetSSE42(first_bytes, first_set, first_set_len);
+  __m128i second_set[2];
+  int second_set_len[2];
+  LoadSetSSE42(second_bytes, second_set, second_set_len);
+
+  // Loads one byte past the block, for the second bytes.
+  for (; pos + 17 <= buf.size(); pos += 16) {
+    const char* block_ptr = buf.data() + pos;
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block_ptr));
+    uint32_t mask = AnyOfMaskSSE42(block, first_set, first_set_len);
+    if (mask != 0 && !second_bytes.empty()) {
+      const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block_ptr + 1));
+      mask &= AnyOfMaskSSE42(next, second_set, second_set_len);
+    }
+    for (; mask != 0; mask &= mask - 1) {
+      const size_t candidate = pos + __builtin_ctz(mask);
+      if (matches_at(candidate)) {
+        return candidate;
+      }
+    }
+  }
+  return FindScalar(buf, pos, first_byte_idx, matches_at);
+}
+
+// Returns a bit mask of the bytes in block that are one of the bytes broadcast in set.
+__attribute__((target("avx2"))) inline uint32_t AnyOfMaskAVX2(__m256i block, const __m256i* set,
+                                                              size_t set_len) {
+  __m256i matches = _mm256_cmpeq_epi8(block, set[0]);
+  for (size_t i = 1; i < set_len; ++i) {
+    matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, set[i]));
+  }
+  return _mm256_movemask_epi8(matches);
+}
+
+template <typename TMatchesAtFn>
+__attribute__((target("avx2"))) size_t FindAVX2(std::string_view buf, size_t pos,
+                                                std::string_view first_bytes,
+                                                std::string_view second_bytes,
+                                                const std::array<int8_t, 256>& first_byte_idx,
+                                                const TMatchesAtFn& matches_at) {
+  __m256i first_set[MultiPatternSearcher::kMaxSIMDBytes];
+  for (size_t i = 0; i < first_bytes.size(); ++i) {
+    first_set[i] = _mm256_set1_epi8(first_bytes[i]);
+  }
+  __m256i second_set[MultiPatternSearcher::kMaxSIMDBytes];
+  for (size_t i = 0; i < second_bytes.size(); ++i) {
+    second_set[i] = _mm256_set1_epi8(second_bytes[i]);
+  }
+
+  // Loads one byte past the block, for the second bytes.
+  for (; pos + 33 <= buf.size(); pos += 32) {
+    const char* block_ptr = buf.data() + pos;
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block_ptr));
+    uint32_t mask = AnyOfMaskAVX2(block, first_set, first_bytes.size());
+    if (mask != 0 && !second_bytes.empty()) {
+      const __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block_ptr + 1));
+      mask &= AnyOfMaskAVX2(next, second_set, second_bytes.size());
+    }
+    for (; mask != 0; mask &= mask - 1) {
+      const size_t candidate = pos + __builtin_ctz(mask);
+      if (matches_at(candidate)) {
+        return candidate;
+      }
+    }
+  }
+  return FindScalar(buf, pos, first_byte_idx, matches_at);
+}
+
+#endif
+
+}  // namespace
+
+SIMDLevel MaxSupportedSIMDLevel() {
+#if defined(__x86_64__)
+  static const SIMDLevel kLevel = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return SIMDLevel::kAVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return SIMDLevel::kSSE42;
+    }
+    return SIMDLevel::kScalar;
+  }();
+  return kLevel;
+#else
+  return SIMDLevel::kScalar;
+#endif
+}
+
+MultiPatternSearcher::MultiPatternSearcher(const std::vector<std::string_view>& patterns,
+                                           SIMDLevel level) {
+  first_byte_idx_.fill(-1);
+  std::array<bool, 256> is_second_byte = {};
+  bool has_single_byte_pattern = false;
+  for (std::string_view pattern : patterns) {
+    CHECK(!pattern.empty());
+    const uint8_t first_byte = pattern[0];
+    if (first_byte_idx_[first_byte] < 0) {
+      first_byte_idx_[first_byte] = first_bytes_.size();
+      first_bytes_.push_back(pattern[0]);
+      patterns_by_first_byte_.emplace_back();
+    }
+    patterns_by_first_byte_[first_byte_idx_[first_byte]].push_back(patterns_.size());
+    patterns_.emplace_back(pattern);
+
+    if (pattern.size() == 1) {
+      has_single_byte_pattern = true;
+    } else if (!is_second_byte[static_cast<uint8_t>(pattern[1])]) {
+      is_second_byte[static_cast<uint8_t>(pattern[1])] = true;
+      second_bytes_.push_back(pattern[1]);
+    }
+  }
+  CHECK(!patterns_.empty());
+  // first_byte_idx_ holds int8_t indexes, which bounds the number of distinct first bytes.
+  CHECK_LE(first_bytes_.size(), 128U);
+
+  all_single_byte_ = second_bytes_.empty();
+  if (has_single_byte_pattern || second_bytes_.size() > kMaxSIMDBytes) {
+    second_bytes_.clear();
+  }
+
+  level_ = std::min(level, MaxSupportedSIMDLevel());
+  if (first_bytes_.size() > kMaxSIMDBytes) {
+    level_ = SIMDLevel::kScalar;
+  }
+}
+
+MultiPatternSearcher MultiPatternSearcher::AnyByteOf(std::string_view bytes, SIMDLevel level) {
+  std::vector<std::string_view> patterns;
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    patterns.push_back(bytes.substr(i, 1));
+  }
+  return MultiPatternSearcher(patterns, level);
+}
+
+bool MultiPatternSearcher::MatchesAt(std::string_view buf, size_t pos) const {
+  if (all_single_byte_) {
+    return true;
+  }
+  const int8_t idx = first_byte_idx_[static_cast<uint8_t>(buf[pos])];
+  for (uint16_t pattern_idx : patterns_by_first_byte_[idx]) {
+    const std::string& pattern = patterns_[pattern_idx];
+    if (buf.size() - pos >= pattern.size() && buf.compare(pos, pattern.size(), pattern) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t MultiPatternSearcher::Find(std::string_view buf, size_t start_pos) const {
+  if (start_pos >= buf.size()) {
+    return std::string_view::npos;
+  }
+  auto matches_at = [this, buf](size_t pos) { return MatchesAt(buf, pos); };
+  switch (level_) {
+#if defined(__x86_64__)
+    case SIMDLevel::kAVX2:
+      return FindAVX2(buf, start_pos, first_bytes_, second_bytes_, first_byte_idx_, matches_at);
+    case SIMDLevel::kSSE42:
+      return FindSSE42(buf, start_pos, first_bytes_, second_bytes_, first_byte_idx_, matches_at);
+#endif
+    default:
+      return FindScalar(buf, start_pos, first_byte_idx_, matches_at);
+  }
+}
+
+size_t MultiPatternSearcher::FindLast(std::string_view buf, size_t start_pos) const {
+  size_t last_pos = std::string_view::npos;
+  for (size_t pos = Find(buf, start_pos); pos != std::string_view::npos; pos = Find(buf, pos + 1)) {
+    last_pos = pos;
+  }
+  return last_pos;
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+// The instruction sets MultiPatternSearcher can scan with, in order of preference.
+enum class SIMDLevel {
+  kScalar,
+  kSSE42,
+  kAVX2,
+};
+
+// Returns the best SIMDLevel supported by the CPU the process is running on.
+SIMDLevel MaxSupportedSIMDLevel();
+
+// Searches a buffer for the first occurrence of any of a fixed set of patterns.
+//
+// The protocol parsers use this to resync on a message boundary after data loss, where they look
+// for any of a protocol's message start markers (request methods, frame type bytes, etc.).
+// The search scans 16 or 32 bytes at a time with SSE4.2 or AVX2, as the CPU allows, for positions
+// holding the first byte of some pattern followed by the second byte of some pattern, and then
+// compares the patterns starting at those positions. SIMD scanning requires at most
+// kMaxSIMDBytes distinct first bytes; otherwise, or on non-x86 CPUs, the scan falls back to a
+// byte-at-a-time table lookup.
+class MultiPatternSearcher {
+ public:
+  static constexpr size_t kMaxSIMDBytes = 32;
+
+  // The patterns must be non-empty. They are copied into the searcher.
+  explicit MultiPatternSearcher(const std::vector<std::string_view>& patterns,
+                                SIMDLevel level = MaxSupportedSIMDLevel());
+
+  /**
+   * Returns the position of the first occurrence of any pattern that starts at or after start_pos
+   * and lies entirely within buf, or std::string_view::npos if there is none.
+   */
+  size_t Find(std::string_view buf, size_t start_pos = 0) const;
+
+  /**
+   * Returns the position of the last occurrence of any pattern that starts at or after start_pos
+   * and lies entirely within buf, or std::string_view::npos if there is none.
+   */
+  size_t FindLast(std::string_view buf, size_t start_pos = 0) const;
+
+  // Returns a searcher for any single byte of bytes.
+  static MultiPatternSearcher AnyByteOf(std::string_view bytes,
+                                        SIMDLevel level = MaxSupportedSIMDLevel());
+
+  SIMDLevel level() const { return level_; }
+
+ private:
+  bool MatchesAt(std::string_view buf, size_t pos) const;
+
+  std::vector<std::string> patterns_;
+  // Whether every pattern is one byte long, in which case any first byte found is a match.
+  bool all_single_byte_ = true;
+
+  // The distinct first bytes of the patterns.
+  std::string first_bytes_;
+  // The distinct second bytes of the patterns. Empty if any pattern is one byte long, or there are
+  // too many to scan for, in which case only the first bytes are scanned for.
+  std::string second_bytes_;
+  // Maps each byte value to its index in first_bytes_, or -1 if no pattern starts with it.
+  std::array<int8_t, 256> first_byte_idx_;
+  // The indexes into patterns_ of the patterns starting with each byte of first_bytes_.
+  std::vector<std::vector<uint16_t>> patterns_by_first_byte_;
+
+  SIMDLevel level_;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_search.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+using ::testing::TestWithParam;
+using ::testing::Values;
+
+// The reference implementation: the smallest position of any pattern.
+size_t NaiveFind(std::string_view buf, size_t start_pos,
+                 const std::vector<std::string_view>& patterns) {
+  size_t result = std::string_view::npos;
+  for (std::string_view pattern : patterns) {
+    result = std::min(result, buf.find(pattern, start_pos));
+  }
+  return result;
+}
+
+class MultiPatternSearcherTest : public TestWithParam<SIMDLevel> {
+ protected:
+  void SetUp() override {
+    if (GetParam() > MaxSupportedSIMDLevel()) {
+      GTEST_SKIP() << "SIMD level not supported by this CPU.";
+    }
+  }
+};
+
+TEST_P(MultiPatternSearcherTest, FindHTTPMethods) {
+  const std::vector<std::string_view> kPatterns = {"GET ", "HEAD ", "POST ", "PUT "};
+  MultiPatternSearcher searcher(kPatterns, GetParam());
+  EXPECT_EQ(searcher.level(), GetParam());
+
+  std::string_view buf = "xxPOSTxx PUTxxx\r\n\r\nHEAD /index.html GET / PUT";
+  EXPECT_EQ(searcher.Find(buf), 19);
+  EXPECT_EQ(searcher.Find(buf, 20), 36);
+  // The trailing "PUT" lacks the space, so it does not match.
+  EXPECT_EQ(searcher.Find(buf, 37), std::string_view::npos);
+  EXPECT_EQ(searcher.FindLast(buf), 36);
+  EXPECT_EQ(searcher.Find(buf, buf.size()), std::string_view::npos);
+  EXPECT_EQ(searcher.Find(buf, buf.size() + 1), std::string_view::npos);
+  EXPECT_EQ(searcher.Find(""), std::string_view::npos);
+  EXPECT_EQ(searcher.FindLast(""), std::string_view::npos);
+}
+
+TEST_P(MultiPatternSearcherTest, FindBytesIncludingZero) {
+  using std::literals::string_view_literals::operator""sv;
+  MultiPatternSearcher searcher({"\0"sv, "*", "$"}, GetParam());
+
+  std::string buf(100, 'a');
+  EXPECT_EQ(searcher.Find(buf), std::string_view::npos);
+  buf[70] = '$';
+  EXPECT_EQ(searcher.Find(buf), 70);
+  buf[45] = '\0';
+  EXPECT_EQ(searcher.Find(buf), 45);
+  EXPECT_EQ(searcher.Find(buf, 46), 70);
+  EXPECT_EQ(searcher.FindLast(buf), 70);
+}
+
+// Compares against the naive search over random buffers with a small alphabet, so that
+// candidates, partial matches and matches crossing the SIMD block boundaries are common.
+TEST_P(MultiPatternSearcherTest, MatchesNaiveSearch) {
+  const std::vector<std::vector<std::string_view>> kPatternSets = {
+      {"ab"},
+      // Only multi-byte patterns, so the scan also filters on the second bytes.
+      {"abc", "ba", "cca", "bb"},
+      {"abc", "b", "cca"},
+      {"aaaa", "abab", "d"},
+      // More distinct first bytes than fit in SIMD registers.
+      {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p", "q", "r",
+       "s", "t", "u", "v", "w", "x", "y", "z", "0", "1", "2", "3", "4", "5", "6"},
+  };
+
+  std::default_random_engine rng(37);
+  for (const auto& patterns : kPatternSets) {
+    MultiPatternSearcher searcher(patterns, GetParam());
+    for (int i = 0; i < 200; ++i) {
+      std::uniform_int_distribution<int> len_dist(0, 100);
+      std::uniform_int_distribution<int> char_dist(0, i % 2 == 0 ? 3 : 25);
+      std::string buf(len_dist(rng), ' ');
+      for (char& c : buf) {
+        c = 'a' + char_dist(rng);
+      }
+      for (size_t start_pos = 0; start_pos <= buf.size(); ++start_pos) {
+        ASSERT_EQ(searcher.Find(buf, start_pos), NaiveFind(buf, start_pos, patterns))
+            << buf << " " << start_pos;
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllLevels, MultiPatternSearcherTest,
+                         Values(SIMDLevel::kScalar, SIMDLevel::kSSE42, SIMDLevel::kAVX2));
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
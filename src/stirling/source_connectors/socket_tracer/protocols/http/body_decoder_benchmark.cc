@@ -23,7 +23,9 @@
 #include <benchmark/benchmark.h>
 
 #include "src/common/base/base.h"
+#include "src/common/zlib/test_utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/body_decoder.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/stitcher.h"
 
 using px::stirling::protocols::http::ParseChunked;
 
@@ -91,5 +93,52 @@ static void BM_pico_body_parser(benchmark::State& state) {
   }
 }
 
+std::string CreateGzippedJSON(size_t num_items) {
+  std::string json = "[";
+  std::default_random_engine rng(37);
+  std::uniform_int_distribution<int> uniform_dist(1, 1000000);
+  for (size_t i = 0; i < num_items; ++i) {
+    absl::StrAppend(&json, i == 0 ? "" : ",", R"({"id":)", i, R"(,"name":"item-)",
+                    uniform_dist(rng), R"(","tags":["alpha","beta"],"price":)",
+                    uniform_dist(rng), "}");
+  }
+  json += "]";
+  return px::zlib::GZip(json);
+}
+
+// About 1MB of JSON once decompressed.
+// NOLINTNEXTLINE: runtime/string
+const std::string gzipped_body = CreateGzippedJSON(15000);
+
+px::stirling::protocols::http::Message CreateGzippedJSONMessage() {
+  px::stirling::protocols::http::Message message;
+  message.type = message_type_t::kResponse;
+  message.headers.insert({px::stirling::protocols::http::kContentEncoding, "gzip"});
+  message.headers.insert({px::stirling::protocols::http::kContentType, "application/json"});
+  message.body = gzipped_body;
+  message.body_size = gzipped_body.size();
+  return message;
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_gzipped_body_full(benchmark::State& state) {
+  for (auto _ : state) {
+    px::stirling::protocols::http::Message message = CreateGzippedJSONMessage();
+    px::stirling::protocols::http::PreProcessMessage(&message);
+    benchmark::DoNotOptimize(message.body);
+  }
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_gzipped_body_bounded(benchmark::State& state) {
+  for (auto _ : state) {
+    px::stirling::protocols::http::Message message = CreateGzippedJSONMessage();
+    px::stirling::protocols::http::PreProcessMessage(&message, state.range(0));
+    benchmark::DoNotOptimize(message.body);
+  }
+}
+
 BENCHMARK(BM_custom_body_parser);
 BENCHMARK(BM_pico_body_parser);
+BENCHMARK(BM_gzipped_body_full);
+BENCHMARK(BM_gzipped_body_bounded)->Arg(512)->Arg(16384);
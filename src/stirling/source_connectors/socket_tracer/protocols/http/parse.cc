@@ -18,6 +18,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/body_decoder.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_search.h"
 
 #include <picohttpparser.h>
 
@@ -284,23 +285,18 @@ ParseState ParseFrame(message_type_t type, std::string_view* buf, Message* resul
 size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start_pos) {
   // List of all HTTP request methods. All HTTP requests start with one of these.
   // https://developer.mozilla.org/en-US/docs/Web/HTTP/Methods
-  static constexpr std::string_view kHTTPReqStartPatternArray[] = {
+  static const MultiPatternSearcher kHTTPReqStartPatterns({
       "GET ", "HEAD ", "POST ", "PUT ", "DELETE ", "CONNECT ", "OPTIONS ", "TRACE ", "PATCH ",
-  };
+  });
 
   // List of supported HTTP protocol versions. HTTP responses typically start with one of these.
   // https://developer.mozilla.org/en-US/docs/Web/HTTP/Messages
-  static constexpr std::string_view kHTTPRespStartPatternArray[] = {"HTTP/1.1 ", "HTTP/1.0 "};
-
-  static constexpr ArrayView<std::string_view> kHTTPReqStartPatterns =
-      ArrayView<std::string_view>(kHTTPReqStartPatternArray);
-  static constexpr ArrayView<std::string_view> kHTTPRespStartPatterns =
-      ArrayView<std::string_view>(kHTTPRespStartPatternArray);
+  static const MultiPatternSearcher kHTTPRespStartPatterns({"HTTP/1.1 ", "HTTP/1.0 "});
 
   static constexpr std::string_view kBoundaryMarker = "\r\n\r\n";
 
   // Choose the right set of patterns for request vs response.
-  const ArrayView<std::string_view>* start_patterns = nullptr;
+  const MultiPatternSearcher* start_patterns = nullptr;
   switch (type) {
     case message_type_t::kRequest:
       start_patterns = &kHTTPReqStartPatterns;
@@ -319,7 +315,7 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   //   headers
   //   \r\n\r\n
   //   body
-  // We first search forwards for \r\n\r\n, then we search backwards from there for HTTP/1.1.
+  // We first search forwards for \r\n\r\n, then we search for the last HTTP/1.1 before it.
   //
   // Note that we don't search forwards for HTTP/1.1 directly, because it could result in matches
   // inside the request/response body.
@@ -330,22 +326,11 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
       return std::string::npos;
     }
 
-    std::string_view buf_substr = buf.substr(start_pos, marker_pos - start_pos);
-
-    size_t substr_pos = std::string::npos;
-    for (auto& start_pattern : *start_patterns) {
-      size_t current_substr_pos = buf_substr.rfind(start_pattern);
-      if (current_substr_pos != std::string::npos) {
-        // Found a match. Check if it is closer to the marker than our previous match.
-        // We want to return the match that is closest to the marker, so we aren't
-        // matching to something in a previous message's body.
-        substr_pos = (substr_pos == std::string::npos) ? current_substr_pos
-                                                       : std::max(substr_pos, current_substr_pos);
-      }
-    }
-
-    if (substr_pos != std::string::npos) {
-      return start_pos + substr_pos;
+    // We want the match that is closest to the marker, so we aren't matching to something in a
+    // previous message's body.
+    size_t pos = start_patterns->FindLast(buf.substr(0, marker_pos), start_pos);
+    if (pos != std::string::npos) {
+      return pos;
     }
 
     // Couldn't find a start position. Move to the marker, and search for another marker.
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <benchmark/benchmark.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_search.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+// The boundary search before it used MultiPatternSearcher, which looks for each request method
+// separately. Kept as the baseline.
+size_t LegacyFindFrameBoundary(std::string_view buf, size_t start_pos) {
+  static constexpr std::string_view kHTTPReqStartPatterns[] = {
+      "GET ", "HEAD ", "POST ", "PUT ", "DELETE ", "CONNECT ", "OPTIONS ", "TRACE ", "PATCH ",
+  };
+  static constexpr std::string_view kBoundaryMarker = "\r\n\r\n";
+
+  while (true) {
+    size_t marker_pos = buf.find(kBoundaryMarker, start_pos);
+    if (marker_pos == std::string::npos) {
+      return std::string::npos;
+    }
+    std::string_view buf_substr = buf.substr(start_pos, marker_pos - start_pos);
+    size_t substr_pos = std::string::npos;
+    for (auto& start_pattern : kHTTPReqStartPatterns) {
+      size_t current_substr_pos = buf_substr.rfind(start_pattern);
+      if (current_substr_pos != std::string::npos) {
+        substr_pos = (substr_pos == std::string::npos) ? current_substr_pos
+                                                       : std::max(substr_pos, current_substr_pos);
+      }
+    }
+    if (substr_pos != std::string::npos) {
+      return start_pos + substr_pos;
+    }
+    start_pos = marker_pos + kBoundaryMarker.size();
+  }
+}
+
+// A stream of HTTP requests where every kGapInterval-th request was partially lost, which
+// resembles the data of a lossy connection. The parser resyncs at each gap.
+struct LossyStream {
+  std::string data;
+  std::vector<size_t> gap_positions;
+};
+
+LossyStream CreateLossyStream(int num_requests, int body_size) {
+  constexpr int kGapInterval = 4;
+  constexpr std::string_view kRequestTmpl =
+      "$0 /api/v1/items/$1 HTTP/1.1\r\n"
+      "Host: service.namespace.svc.cluster.local\r\n"
+      "User-Agent: Go-http-client/1.1\r\n"
+      "Content-Type: application/json\r\n"
+      "Content-Length: $2\r\n"
+      "\r\n";
+  constexpr std::string_view kMethods[] = {"GET", "POST", "PUT", "DELETE"};
+
+  std::default_random_engine rng(37);
+  std::uniform_int_distribution<int> char_dist(0, 63);
+  constexpr std::string_view kBodyChars =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789{}";
+
+  LossyStream stream;
+  for (int i = 0; i < num_requests; ++i) {
+    std::string request =
+        absl::Substitute(kRequestTmpl, kMethods[i % std::size(kMethods)], i, body_size);
+    for (int j = 0; j < body_size; ++j) {
+      request.push_back(kBodyChars[char_dist(rng)]);
+    }
+    if (i % kGapInterval == 0) {
+      // Drop a prefix of the request, as if the preceding events were lost.
+      std::uniform_int_distribution<size_t> gap_dist(1, request.size() - 1);
+      stream.gap_positions.push_back(stream.data.size());
+      request.erase(0, gap_dist(rng));
+    }
+    stream.data.append(request);
+  }
+  return stream;
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_Resync(benchmark::State& state) {
+  const LossyStream stream = CreateLossyStream(1000, state.range(0));
+  StateWrapper state_wrapper{};
+  for (auto _ : state) {
+    for (size_t pos : stream.gap_positions) {
+      benchmark::DoNotOptimize(FindFrameBoundary<http::Message>(
+          message_type_t::kRequest, stream.data, pos, &state_wrapper));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * stream.data.size());
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_ResyncLegacy(benchmark::State& state) {
+  const LossyStream stream = CreateLossyStream(1000, state.range(0));
+  for (auto _ : state) {
+    for (size_t pos : stream.gap_positions) {
+      benchmark::DoNotOptimize(LegacyFindFrameBoundary(stream.data, pos));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * stream.data.size());
+}
+
+// Scans the whole stream for request methods with each instruction set.
+// NOLINTNEXTLINE(runtime/references)
+static void BM_MultiPatternSearch(benchmark::State& state) {
+  const auto level = static_cast<SIMDLevel>(state.range(0));
+  if (level > MaxSupportedSIMDLevel()) {
+    state.SkipWithError("SIMD level not supported by this CPU.");
+    return;
+  }
+  const LossyStream stream = CreateLossyStream(1000, 1024);
+  const MultiPatternSearcher searcher(
+      {"GET ", "HEAD ", "POST ", "PUT ", "DELETE ", "CONNECT ", "OPTIONS ", "TRACE ", "PATCH "},
+      level);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(searcher.FindLast(stream.data));
+  }
+  state.SetBytesProcessed(state.iterations() * stream.data.size());
+}
+
+BENCHMARK(BM_Resync)->Arg(0)->Arg(256)->Arg(4096);
+BENCHMARK(BM_ResyncLegacy)->Arg(0)->Arg(256)->Arg(4096);
+BENCHMARK(BM_MultiPatternSearch)
+    ->Arg(static_cast<int>(SIMDLevel::kScalar))
+    ->Arg(static_cast<int>(SIMDLevel::kSSE42))
+    ->Arg(static_cast<int>(SIMDLevel::kAVX2));
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -43,7 +43,7 @@ namespace stirling {
 namespace protocols {
 namespace http {
 
-void PreProcessMessage(Message* message) {
+void PreProcessMessage(Message* message, std::optional<size_t> max_body_bytes) {
   // Parse the flags on the first time only.
   static const HTTPHeaderFilter kHTTPResponseHeaderFilter =
       ParseHTTPHeaderFilters(FLAGS_http_response_header_filters);
@@ -71,7 +71,11 @@ void PreProcessMessage(Message* message) {
   auto content_encoding_iter = message->headers.find(kContentEncoding);
   // Replace body with decompressed version, if required.
   if (content_encoding_iter != message->headers.end() && content_encoding_iter->second == "gzip") {
-    message->body = px::zlib::Inflate(message->body).ConsumeValueOr("<Failed to gunzip body>");
+    // One byte past the budget is kept, so that the body is still recognized as truncated.
+    StatusOr<std::string> body_or =
+        max_body_bytes.has_value() ? px::zlib::InflatePrefix(message->body, *max_body_bytes + 1)
+                                   : px::zlib::Inflate(message->body);
+    message->body = body_or.ConsumeValueOr("<Failed to gunzip body>");
   }
 }
 
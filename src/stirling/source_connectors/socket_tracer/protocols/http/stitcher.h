@@ -20,6 +20,7 @@
 
 #include <deque>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -45,7 +46,14 @@ namespace http {
 RecordsWithErrorCount<Record> ProcessMessages(std::deque<Message>* req_messages,
                                               std::deque<Message>* resp_messages);
 
-void PreProcessMessage(Message* message);
+/**
+ * Rewrites the body of the message according to its headers, e.g. removes filtered content and
+ * decompresses gzip content.
+ *
+ * @param max_body_bytes: if set, only decompresses the body up to slightly more than this many
+ *                        bytes. The rest would be truncated by the caller anyway.
+ */
+void PreProcessMessage(Message* message, std::optional<size_t> max_body_bytes = std::nullopt);
 
 }  // namespace http
 
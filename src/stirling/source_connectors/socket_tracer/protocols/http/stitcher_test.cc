@@ -45,6 +45,21 @@ TEST(PreProcessRecordTest, GzipCompressedContentIsDecompressed) {
   EXPECT_EQ("This is a test\n", message.body);
 }
 
+TEST(PreProcessRecordTest, GzipCompressedContentIsDecompressedUpToMaxBodyBytes) {
+  Message message;
+  message.type = message_type_t::kResponse;
+  message.headers.insert({kContentEncoding, "gzip"});
+  message.headers.insert({kContentType, "json"});
+  const uint8_t compressed_bytes[] = {0x1f, 0x8b, 0x08, 0x00, 0x37, 0xf0, 0xbf, 0x5c, 0x00,
+                                      0x03, 0x0b, 0xc9, 0xc8, 0x2c, 0x56, 0x00, 0xa2, 0x44,
+                                      0x85, 0x92, 0xd4, 0xe2, 0x12, 0x2e, 0x00, 0x8c, 0x2d,
+                                      0xc0, 0xfa, 0x0f, 0x00, 0x00, 0x00};
+  message.body.assign(reinterpret_cast<const char*>(compressed_bytes), sizeof(compressed_bytes));
+  PreProcessMessage(&message, /*max_body_bytes*/ 4);
+  // The extra byte lets the caller tell that the body was truncated.
+  EXPECT_EQ("This ", message.body);
+}
+
 TEST(PreProcessRecordTest, ContentHeaderIsNotAdded) {
   Message message;
   message.type = message_type_t::kResponse;
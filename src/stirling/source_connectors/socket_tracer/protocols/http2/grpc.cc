@@ -18,13 +18,12 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/grpc.h"
 
+#include <algorithm>
 #include <utility>
 
-#include <google/protobuf/empty.pb.h>
-#include <google/protobuf/text_format.h>
-
 #include "src/common/base/base.h"
 #include "src/common/zlib/zlib_wrapper.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/pb_text_printer.h"
 #include "src/stirling/utils/binary_decoder.h"
 
 DEFINE_bool(socket_tracer_enable_http2_gzip, false,
@@ -34,36 +33,23 @@ namespace px {
 namespace stirling {
 namespace grpc {
 
-using ::google::protobuf::Empty;
-using ::google::protobuf::Message;
-using ::google::protobuf::TextFormat;
 using ::px::stirling::protocols::http2::HalfStream;
 using ::px::stirling::protocols::http2::Stream;
 
 namespace {
 
-// Text format protobuf are not valid JSON. One obvious issue is that TextFormat uses unquoted
-// field numbers as key: {1: "some string"}, which is not allowed in JSON.
-Status PBWireToText(std::string_view message, TextFormat::Printer* pb_printer, std::string* text) {
-  Empty empty_pb;
-  const bool parse_succeeded = empty_pb.ParsePartialFromArray(message.data(), message.size());
-  // Proceed to print text format protobuf even if the parse failed. This allows producing partial
-  // message.
-  const bool print_succeeded = pb_printer->PrintToString(empty_pb, text);
-  if (!parse_succeeded) {
-    return error::InvalidArgument("Failed to parse the serialized protobuf message");
-  }
-  if (!print_succeeded) {
-    return error::InvalidArgument("Failed to print protobuf message to text format");
-  }
-  return Status::OK();
-}
+// The most gzip-compressed payload inflated per message when the text length is bounded.
+constexpr size_t kMaxGunzipBytesWithTextLimit = 64 * 1024;
 
 // Parses the gRPC payload into text format protobuf. In addition to parsing protobuf messages, this
 // function extracts compression and length field, and also handles multiple concatenated payloads
 // as well.
+//
+// Text format protobuf are not valid JSON. One obvious issue is that TextFormat uses unquoted
+// field numbers as key: {1: "some string"}, which is not allowed in JSON.
 Status GRPCPBWireToText(std::string_view message, bool is_gzipped, std::string* text,
-                        std::optional<int> str_field_truncation_len) {
+                        std::optional<int> str_field_truncation_len,
+                        std::optional<int> max_text_len, bool* text_truncated) {
   // 1 byte compression flag, and 4 bytes length field.
   constexpr size_t kGRPCMessageHeaderSizeBytes = 1 + sizeof(int32_t);
   if (message.size() < kGRPCMessageHeaderSizeBytes) {
@@ -75,12 +61,14 @@ Status GRPCPBWireToText(std::string_view message, bool is_gzipped, std::string*
 
   BinaryDecoder decoder(message);
 
-  TextFormat::Printer pb_printer;
+  PBTextPrinter pb_printer;
   pb_printer.SetTruncateStringFieldLongerThan(str_field_truncation_len.value_or(0));
+  pb_printer.SetMaxTextLength(max_text_len.value_or(0));
 
   Status status;
+  bool gunzip_truncated = false;
 
-  while (!decoder.eof()) {
+  while (!decoder.eof() && !pb_printer.text_truncated()) {
     PX_ASSIGN_OR_RETURN(uint8_t compressed_flag, decoder.ExtractBEInt<uint8_t>());
     // gRPC spec states that it's OK to *not* compress even if grpc-encoding header has specified
     // compression algorithm, which is indicated by is_gzipped.
@@ -103,7 +91,14 @@ Status GRPCPBWireToText(std::string_view message, bool is_gzipped, std::string*
 
     std::string gunzipped_data;
     if (is_compressed && is_gzipped) {
-      auto data_or = px::zlib::Inflate(data);
+      // The text is cut at max_text_len, so most of a large message would be inflated only to be
+      // dropped. Long string fields print shorter than their wire size, hence the extra slack.
+      auto data_or = max_text_len.has_value()
+                         ? px::zlib::InflatePrefix(data,
+                                                   std::max(static_cast<size_t>(*max_text_len),
+                                                            kMaxGunzipBytesWithTextLimit),
+                                                   &gunzip_truncated)
+                         : px::zlib::Inflate(data);
       if (data_or.ok()) {
         gunzipped_data = data_or.ConsumeValueOrDie();
       } else {
@@ -111,11 +106,14 @@ Status GRPCPBWireToText(std::string_view message, bool is_gzipped, std::string*
         continue;
       }
     }
-    std::string pb_str;
     // Include the most recent status.
-    status = PBWireToText(is_compressed ? gunzipped_data : data, &pb_printer, &pb_str);
-
-    text->append(pb_str);
+    status = pb_printer.Print(is_compressed ? gunzipped_data : data, text);
+    if (gunzip_truncated) {
+      break;
+    }
+  }
+  if (text_truncated != nullptr) {
+    *text_truncated = pb_printer.text_truncated() || gunzip_truncated;
   }
   return status;
 }
@@ -125,9 +123,11 @@ Status GRPCPBWireToText(std::string_view message, bool is_gzipped, std::string*
 // TODO(yzhao): Support reflection to get message types instead of empty message.
 // TODO(yzhao): This wrapper is too thin, remove.
 std::string ParsePB(std::string_view str, bool is_gzipped,
-                    std::optional<int> str_field_truncation_len) {
+                    std::optional<int> str_field_truncation_len, std::optional<int> max_text_len,
+                    bool* text_truncated) {
   std::string text;
-  Status s = GRPCPBWireToText(str, is_gzipped, &text, str_field_truncation_len);
+  Status s = GRPCPBWireToText(str, is_gzipped, &text, str_field_truncation_len, max_text_len,
+                              text_truncated);
   absl::StripTrailingAsciiWhitespace(&text);
   if (!s.ok() && text.empty()) {
     return "<Failed to parse protobuf>";
@@ -137,23 +137,28 @@ std::string ParsePB(std::string_view str, bool is_gzipped,
 
 void ParseReqRespBody(px::stirling::protocols::http2::Stream* http2_stream,
                       std::string_view truncation_suffix,
-                      std::optional<int> str_field_truncation_len) {
+                      std::optional<int> str_field_truncation_len,
+                      std::optional<int> max_body_text_len) {
   bool has_grpc_encoding = http2_stream->HasGRPCEncodingHeader();
   bool is_gzipped = http2_stream->HasGZipGRPCEncoding();
   if (has_grpc_encoding && !is_gzipped) {
     // Don't do anything if the compression is done with an unsupported algorithm.
     return;
   }
+  bool send_text_truncated = false;
+  bool recv_text_truncated = false;
   if (http2_stream->HasGRPCContentType()) {
     *http2_stream->send.mutable_data() =
-        ParsePB(http2_stream->send.data(), is_gzipped, str_field_truncation_len);
+        ParsePB(http2_stream->send.data(), is_gzipped, str_field_truncation_len,
+                max_body_text_len, &send_text_truncated);
     *http2_stream->recv.mutable_data() =
-        ParsePB(http2_stream->recv.data(), is_gzipped, str_field_truncation_len);
+        ParsePB(http2_stream->recv.data(), is_gzipped, str_field_truncation_len,
+                max_body_text_len, &recv_text_truncated);
   }
-  if (http2_stream->send.data_truncated()) {
+  if (http2_stream->send.data_truncated() || send_text_truncated) {
     http2_stream->send.mutable_data()->append(truncation_suffix);
   }
-  if (http2_stream->recv.data_truncated()) {
+  if (http2_stream->recv.data_truncated() || recv_text_truncated) {
     http2_stream->recv.mutable_data()->append(truncation_suffix);
   }
 }
@@ -35,9 +35,14 @@ namespace grpc {
 /**
  * Parses protobuf body of a HTTP2 message.
  * Exported for testing.
+ *
+ * @param max_text_len If specified, stops parsing once the text reaches this length, and sets
+ *        text_truncated if it is not null.
  */
 std::string ParsePB(std::string_view str, bool is_gzipped = false,
-                    std::optional<int> str_field_truncation_len = std::nullopt);
+                    std::optional<int> str_field_truncation_len = std::nullopt,
+                    std::optional<int> max_text_len = std::nullopt,
+                    bool* text_truncated = nullptr);
 
 /**
  * Parses the request & response body of the input HTTP2 Stream object.
@@ -48,10 +53,13 @@ std::string ParsePB(std::string_view str, bool is_gzipped = false,
  * @param truncation_suffix The string suffix appended to any truncated string/bytes fields.
  * @param str_field_truncation_len The string length of any string/bytes fields beyond which
  *        truncation applies, if specified.
+ * @param max_body_text_len The length of the text format bodies beyond which parsing stops and
+ *        the truncation suffix is appended, if specified.
  */
 void ParseReqRespBody(px::stirling::protocols::http2::Stream* http2_stream,
                       std::string_view truncation_suffix = {},
-                      std::optional<int> str_truncation_len = std::nullopt);
+                      std::optional<int> str_truncation_len = std::nullopt,
+                      std::optional<int> max_body_text_len = std::nullopt);
 
 }  // namespace grpc
 }  // namespace stirling
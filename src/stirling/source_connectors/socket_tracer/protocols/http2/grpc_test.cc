@@ -22,6 +22,7 @@
 
 #include "src/common/base/base.h"
 #include "src/common/testing/testing.h"
+#include "src/common/zlib/test_utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/testing/proto/greet.pb.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/testing/proto/multi_fields.pb.h"
 
@@ -137,6 +138,40 @@ TEST(ParsePbTest, ParsingInvalidGZippedData) {
   FLAGS_socket_tracer_enable_http2_gzip = false;
 }
 
+std::string PackGZippedGRPCMsg(std::string_view serialized_pb) {
+  std::string s = PackGRPCMsg(px::zlib::GZip(serialized_pb));
+  // Compressed.
+  s[0] = '\x01';
+  return s;
+}
+
+// Tests that a large gzipped message is only partially inflated when the text length is bounded,
+// and that the text is then reported as truncated.
+TEST(ParsePbTest, GZippedDataInflatedUpToMaxTextLen) {
+  MultiFieldsMessage message;
+  message.set_i32(100);
+  // 'g' is not a valid tag, so the bytes are not printed as a nested message.
+  message.set_bs(std::string(1024 * 1024, 'g'));
+  message.set_str("end");
+  std::string data = PackGZippedGRPCMsg(message.SerializeAsString());
+
+  PX_SET_FOR_SCOPE(FLAGS_socket_tracer_enable_http2_gzip, true);
+  bool text_truncated = true;
+  EXPECT_THAT(ParsePB(data, /*is_gzipped*/ true, /*str_field_truncation_len*/ 4,
+                      /*max_text_len*/ std::nullopt, &text_truncated),
+              StrEq("2: 100\n"
+                    "5: \"gggg...<truncated>...\"\n"
+                    "6: \"end\""));
+  EXPECT_FALSE(text_truncated);
+
+  // The bytes field is cut off by the inflate budget, so the last field is not printed.
+  EXPECT_THAT(ParsePB(data, /*is_gzipped*/ true, /*str_field_truncation_len*/ 4,
+                      /*max_text_len*/ 100, &text_truncated),
+              StrEq("2: 100\n"
+                    "5: \"gggg...<truncated>...\""));
+  EXPECT_TRUE(text_truncated);
+}
+
 // Tests that request & response bodies are unchanged if the grpc-encoding has a value that is not
 // gzip.
 TEST(ParseReqRespBodyTest, BodyUnchangedForUnsupportedCompressionAlgo) {
@@ -149,6 +184,22 @@ TEST(ParseReqRespBodyTest, BodyUnchangedForUnsupportedCompressionAlgo) {
   EXPECT_THAT(http2_stream.recv.data(), StrEq("recv message"));
 }
 
+// Tests that parsing stops at the max body text length, and the truncation suffix is appended.
+TEST(ParseReqRespBodyTest, StopsAtMaxBodyTextLen) {
+  std::string serialized_pb;
+  for (int i = 0; i < 100; ++i) {
+    serialized_pb.append("\x08\x01");
+  }
+  protocols::http2::Stream http2_stream;
+  http2_stream.send.mutable_headers()->insert(std::make_pair("content-type", "application/grpc"));
+  http2_stream.send.mutable_data()->assign(PackGRPCMsg(serialized_pb));
+  http2_stream.recv.mutable_data()->assign(PackGRPCMsg("\x08\x01"));
+  ParseReqRespBody(&http2_stream, "<truncated>", /*str_truncation_len*/ std::nullopt,
+                   /*max_body_text_len*/ 10);
+  EXPECT_THAT(http2_stream.send.data(), StrEq("1: 1\n1: 1<truncated>"));
+  EXPECT_THAT(http2_stream.recv.data(), StrEq("1: 1"));
+}
+
 }  // namespace grpc
 }  // namespace stirling
 }  // namespace px
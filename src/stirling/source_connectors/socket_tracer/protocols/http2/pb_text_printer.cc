@@ -0,0 +1,439 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/pb_text_printer.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <iterator>
+
+namespace px {
+namespace stirling {
+namespace grpc {
+
+namespace {
+
+// How deep TextFormat::Printer tries to print length-delimited fields as nested messages.
+constexpr int kRecursionBudget = 10;
+// The default recursion limit of the protobuf parser, which limits the nesting of groups.
+constexpr int kMaxGroupDepth = 100;
+// The top-level parser reads tags of at most 5 bytes, the parser used to detect nested messages
+// reads tags of at most 10 bytes.
+constexpr int kMaxTopLevelTagBytes = 5;
+constexpr int kMaxVarintBytes = 10;
+
+constexpr std::string_view kTruncatedStrSuffix = "...<truncated>...";
+
+constexpr size_t kMaxDecimalLen = 20;
+constexpr size_t kMaxHexLen = 18;
+
+// The length of each byte after CEscape(), which uses C escapes for common control characters and
+// quotes, and octal escapes for all other non-printable bytes.
+constexpr std::array<uint8_t, 256> kCEscapedLen = [] {
+  std::array<uint8_t, 256> len = {};
+  for (int c = 0; c < 256; ++c) {
+    if (c == '\n' || c == '\r' || c == '\t' || c == '"' || c == '\'' || c == '\\') {
+      len[c] = 2;
+    } else if (c < 0x20 || c >= 0x7f) {
+      len[c] = 4;
+    } else {
+      len[c] = 1;
+    }
+  }
+  return len;
+}();
+
+enum WireType : uint32_t {
+  kVarint = 0,
+  kFixed64 = 1,
+  kLengthDelimited = 2,
+  kStartGroup = 3,
+  kEndGroup = 4,
+  kFixed32 = 5,
+};
+
+enum class ReadResult {
+  kComplete,
+  // The data ended before the value; the missing bytes are read as zeros.
+  kTruncated,
+  kMalformed,
+};
+
+ReadResult ReadVarint(const char** p, const char* end, int max_bytes, uint64_t* value) {
+  uint64_t v = 0;
+  for (int i = 0; i < max_bytes; ++i) {
+    if (*p == end) {
+      *value = v;
+      return ReadResult::kTruncated;
+    }
+    const auto byte = static_cast<uint8_t>(**p);
+    ++*p;
+    v |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+    if (byte < 0x80) {
+      *value = v;
+      return ReadResult::kComplete;
+    }
+  }
+  return ReadResult::kMalformed;
+}
+
+template <typename TIntType>
+ReadResult ReadFixed(const char** p, const char* end, TIntType* value) {
+  const size_t n = std::min(sizeof(TIntType), static_cast<size_t>(end - *p));
+  TIntType v = 0;
+  for (size_t i = 0; i < n; ++i) {
+    v |= static_cast<TIntType>(static_cast<uint8_t>((*p)[i])) << (8 * i);
+  }
+  *p += n;
+  *value = v;
+  return n == sizeof(TIntType) ? ReadResult::kComplete : ReadResult::kTruncated;
+}
+
+// Skips the fields of a message, or a group if end_group_tag is not 0. Returns false if they are
+// not well-formed by the rules of UnknownFieldSet::ParseFromCodedStream(), which TextFormat uses to
+// decide between printing a length-delimited field as a nested message or as a string.
+// WireTextPrinter::PrintFields() applies the same rules to nested messages while printing them, and
+// uses this to check the rest of a nested message after it stops at the max text length.
+bool SkipFields(const char** p, const char* end, uint32_t end_group_tag, int group_depth_budget) {
+  while (*p != end) {
+    uint64_t tag64;
+    if (ReadVarint(p, end, kMaxVarintBytes, &tag64) != ReadResult::kComplete) {
+      return false;
+    }
+    const auto tag = static_cast<uint32_t>(tag64);
+    if ((tag & 0x7) == kEndGroup) {
+      return end_group_tag != 0 && tag == end_group_tag;
+    }
+    if ((tag >> 3) == 0) {
+      return false;
+    }
+    uint64_t u64;
+    switch (tag & 0x7) {
+      case kVarint:
+        if (ReadVarint(p, end, kMaxVarintBytes, &u64) != ReadResult::kComplete) {
+          return false;
+        }
+        break;
+      case kFixed64:
+        if (end - *p < 8) {
+          return false;
+        }
+        *p += 8;
+        break;
+      case kFixed32:
+        if (end - *p < 4) {
+          return false;
+        }
+        *p += 4;
+        break;
+      case kLengthDelimited:
+        // Lengths beyond 2GiB are rejected.
+        if (ReadVarint(p, end, kMaxVarintBytes, &u64) != ReadResult::kComplete || u64 > INT_MAX ||
+            u64 > static_cast<uint64_t>(end - *p)) {
+          return false;
+        }
+        *p += u64;
+        break;
+      case kStartGroup:
+        if (group_depth_budget == 0 || !SkipFields(p, end, tag + 1, group_depth_budget - 1)) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  // Reaching the end inside a group means the end-group tag is missing.
+  return end_group_tag == 0;
+}
+
+class WireTextPrinter {
+ public:
+  enum class Result {
+    kOK,
+    kMalformed,
+    kMaxTextLength,
+  };
+
+  WireTextPrinter(size_t str_field_truncation_len, size_t max_text_len, std::string* text)
+      : str_field_truncation_len_(str_field_truncation_len),
+        max_text_len_(max_text_len),
+        text_(text) {}
+
+  // Prints fields until the end of the data, or until end_group_tag if it is not 0. Values cut off
+  // by the end of the data are printed before returning kMalformed.
+  //
+  // Nested messages are printed before knowing whether they are well-formed, so that their data is
+  // only decoded once; the caller rolls back the text if kMalformed is returned for them.
+  Result PrintFields(const char** p, const char* end, uint32_t end_group_tag, int indent,
+                     int recursion_budget, int group_depth_budget, bool nested) {
+    while (*p != end) {
+      if (max_text_len_ > 0 && text_->size() >= max_text_len_) {
+        return StopAtMaxTextLength(p, end, end_group_tag, group_depth_budget, nested);
+      }
+      uint64_t tag64;
+      // A cut-off tag is still used, its field then has no data at all.
+      const ReadResult tag_read_result =
+          ReadVarint(p, end, nested ? kMaxVarintBytes : kMaxTopLevelTagBytes, &tag64);
+      if (tag_read_result == ReadResult::kMalformed) {
+        return Result::kMalformed;
+      }
+      const auto tag = static_cast<uint32_t>(tag64);
+      if (end_group_tag != 0 && tag == end_group_tag) {
+        return tag_read_result == ReadResult::kComplete ? Result::kOK : Result::kMalformed;
+      }
+      const uint32_t number = tag >> 3;
+      if (number == 0) {
+        return Result::kMalformed;
+      }
+      ReadResult read_result;
+      switch (tag & 0x7) {
+        case kVarint: {
+          uint64_t v;
+          read_result = ReadVarint(p, end, kMaxVarintBytes, &v);
+          if (read_result == ReadResult::kMalformed) {
+            return Result::kMalformed;
+          }
+          AppendField(indent, number, ": ", kMaxDecimalLen,
+                      [v](char* out) { return WriteDecimal(v, out); });
+          break;
+        }
+        case kFixed64: {
+          uint64_t v;
+          read_result = ReadFixed(p, end, &v);
+          AppendField(indent, number, ": ", kMaxHexLen,
+                      [v](char* out) { return WriteHex(v, out); });
+          break;
+        }
+        case kFixed32: {
+          uint32_t v;
+          read_result = ReadFixed(p, end, &v);
+          AppendField(indent, number, ": ", kMaxHexLen,
+                      [v](char* out) { return WriteHex(v, out); });
+          break;
+        }
+        case kLengthDelimited: {
+          uint64_t len;
+          read_result = ReadVarint(p, end, kMaxVarintBytes, &len);
+          if (read_result == ReadResult::kMalformed || len > INT_MAX) {
+            AppendString(indent, number, {});
+            return Result::kMalformed;
+          }
+          const size_t available = end - *p;
+          std::string_view value(*p, std::min<size_t>(len, available));
+          *p += value.size();
+          if (read_result == ReadResult::kTruncated || value.size() < len) {
+            // Do not guess the type of a cut-off value; print what is available as a string.
+            AppendString(indent, number, value);
+            return Result::kMalformed;
+          }
+          Result result = PrintLengthDelimited(indent, number, value, recursion_budget);
+          if (result == Result::kMaxTextLength) {
+            return StopAtMaxTextLength(p, end, end_group_tag, group_depth_budget, nested);
+          }
+          break;
+        }
+        case kStartGroup: {
+          if (group_depth_budget == 0) {
+            return Result::kMalformed;
+          }
+          AppendField(indent, number, " {", 0, [](char* out) { return out; });
+          Result result = PrintFields(p, end, tag + 1, indent + 1, recursion_budget - 1,
+                                      group_depth_budget - 1, nested);
+          if (result == Result::kMaxTextLength) {
+            return StopAtMaxTextLength(p, end, end_group_tag, group_depth_budget, nested);
+          }
+          AppendClosingBrace(indent);
+          if (result != Result::kOK) {
+            return result;
+          }
+          read_result = ReadResult::kComplete;
+          break;
+        }
+        default:
+          // Includes unmatched end-group tags.
+          return Result::kMalformed;
+      }
+      if (read_result != ReadResult::kComplete) {
+        return Result::kMalformed;
+      }
+    }
+    return end_group_tag == 0 ? Result::kOK : Result::kMalformed;
+  }
+
+ private:
+  // Returns kOK or kMaxTextLength.
+  Result PrintLengthDelimited(int indent, uint32_t number, std::string_view value,
+                              int recursion_budget) {
+    if (value.empty() || recursion_budget <= 0) {
+      AppendString(indent, number, value);
+      return Result::kOK;
+    }
+    const size_t text_size = text_->size();
+    AppendField(indent, number, " {", 0, [](char* out) { return out; });
+    const char* p = value.data();
+    Result result = PrintFields(&p, value.data() + value.size(), /*end_group_tag*/ 0, indent + 1,
+                                recursion_budget - 1, recursion_budget, /*nested*/ true);
+    if (result == Result::kMalformed) {
+      text_->resize(text_size);
+      AppendString(indent, number, value);
+      return Result::kOK;
+    }
+    if (result == Result::kMaxTextLength) {
+      return result;
+    }
+    AppendClosingBrace(indent);
+    return Result::kOK;
+  }
+
+  // Printing a nested message stops at the max text length before knowing whether the message is
+  // well-formed, so check the rest of it; if it turns out to be malformed, it is printed as a
+  // string after all.
+  static Result StopAtMaxTextLength(const char** p, const char* end, uint32_t end_group_tag,
+                                    int group_depth_budget, bool nested) {
+    if (nested && !SkipFields(p, end, end_group_tag, group_depth_budget)) {
+      return Result::kMalformed;
+    }
+    return Result::kMaxTextLength;
+  }
+
+  // The output is written through raw pointers into space reserved in the text, which avoids the
+  // overhead of appending the many short pieces of each line one by one.
+  char* Extend(size_t len) {
+    const size_t size = text_->size();
+    text_->resize(size + len);
+    return text_->data() + size;
+  }
+
+  // Drops the part of the space reserved by Extend() after end, which was not written.
+  void ShrinkTo(const char* end) { text_->resize(end - text_->data()); }
+
+  // Appends a line of "<indent><number><separator><value>", where the value is written by
+  // write_value, which returns the end of the value.
+  template <typename TValueWriter>
+  void AppendField(int indent, uint32_t number, std::string_view separator, size_t max_value_len,
+                   const TValueWriter& write_value) {
+    char* out = Extend(2 * indent + kMaxDecimalLen + separator.size() + max_value_len + 1);
+    out = std::fill_n(out, 2 * indent, ' ');
+    out = WriteDecimal(number, out);
+    out = std::copy(separator.begin(), separator.end(), out);
+    out = write_value(out);
+    *out++ = '\n';
+    ShrinkTo(out);
+  }
+
+  void AppendClosingBrace(int indent) {
+    char* out = Extend(2 * indent + 2);
+    out = std::fill_n(out, 2 * indent, ' ');
+    out[0] = '}';
+    out[1] = '\n';
+  }
+
+  void AppendString(int indent, uint32_t number, std::string_view value) {
+    const bool truncate = str_field_truncation_len_ > 0 && value.size() > str_field_truncation_len_;
+    if (truncate) {
+      value = value.substr(0, str_field_truncation_len_);
+    }
+    size_t escaped_len = 0;
+    for (char c : value) {
+      escaped_len += kCEscapedLen[static_cast<uint8_t>(c)];
+    }
+    const size_t value_len = escaped_len + (truncate ? kTruncatedStrSuffix.size() : 0) + 2;
+    AppendField(indent, number, ": ", value_len, [value, truncate](char* out) {
+      *out++ = '"';
+      out = WriteCEscaped(value, out);
+      if (truncate) {
+        out = std::copy(kTruncatedStrSuffix.begin(), kTruncatedStrSuffix.end(), out);
+      }
+      *out++ = '"';
+      return out;
+    });
+  }
+
+  static char* WriteDecimal(uint64_t v, char* out) {
+    char digits[kMaxDecimalLen];
+    char* begin = std::end(digits);
+    do {
+      *--begin = static_cast<char>('0' + v % 10);
+      v /= 10;
+    } while (v != 0);
+    return std::copy(begin, std::end(digits), out);
+  }
+
+  // Writes zero-padded lowercase hex with the 0x prefix, same as TextFormat for fixed fields.
+  template <typename TIntType>
+  static char* WriteHex(TIntType v, char* out) {
+    constexpr char kHexDigits[] = "0123456789abcdef";
+    *out++ = '0';
+    *out++ = 'x';
+    for (int shift = 8 * sizeof(TIntType) - 4; shift >= 0; shift -= 4) {
+      *out++ = kHexDigits[(v >> shift) & 0xf];
+    }
+    return out;
+  }
+
+  static char* WriteCEscaped(std::string_view value, char* out) {
+    for (char ch : value) {
+      const auto c = static_cast<uint8_t>(ch);
+      switch (kCEscapedLen[c]) {
+        case 1:
+          *out++ = ch;
+          break;
+        case 2:
+          *out++ = '\\';
+          *out++ = c == '\n' ? 'n' : c == '\r' ? 'r' : c == '\t' ? 't' : ch;
+          break;
+        default:
+          *out++ = '\\';
+          *out++ = static_cast<char>('0' + (c >> 6));
+          *out++ = static_cast<char>('0' + ((c >> 3) & 0x7));
+          *out++ = static_cast<char>('0' + (c & 0x7));
+          break;
+      }
+    }
+    return out;
+  }
+
+  const size_t str_field_truncation_len_;
+  const size_t max_text_len_;
+  std::string* text_;
+};
+
+}  // namespace
+
+Status PBTextPrinter::Print(std::string_view serialized, std::string* text) {
+  WireTextPrinter printer(str_field_truncation_len_, max_text_len_, text);
+  const char* p = serialized.data();
+  switch (printer.PrintFields(&p, serialized.data() + serialized.size(), /*end_group_tag*/ 0,
+                              /*indent*/ 0, kRecursionBudget, kMaxGroupDepth,
+                              /*nested*/ false)) {
+    case WireTextPrinter::Result::kOK:
+      return Status::OK();
+    case WireTextPrinter::Result::kMaxTextLength:
+      text_truncated_ = true;
+      return Status::OK();
+    case WireTextPrinter::Result::kMalformed:
+      break;
+  }
+  return error::InvalidArgument("Failed to parse the serialized protobuf message");
+}
+
+}  // namespace grpc
+}  // namespace stirling
+}  // namespace px
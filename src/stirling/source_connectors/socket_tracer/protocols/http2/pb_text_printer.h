@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace grpc {
+
+/**
+ * Prints serialized protobuf messages in the protobuf text format without a schema, i.e., every
+ * field is printed as an unknown field.
+ *
+ * For well-formed messages, the output is identical to parsing the message into
+ * google::protobuf::Empty and printing it with TextFormat::Printer. But the wire format is decoded
+ * in one pass and written directly to the output, without building the intermediate
+ * UnknownFieldSet tree; and printing stops once the output reaches the max text length.
+ */
+class PBTextPrinter {
+ public:
+  /**
+   * String and bytes fields longer than this are truncated, same as
+   * TextFormat::Printer::SetTruncateStringFieldLongerThan(). 0 disables truncation.
+   */
+  void SetTruncateStringFieldLongerThan(size_t len) { str_field_truncation_len_ = len; }
+
+  /**
+   * Stops printing at the first field encountered after the output reached this size, which can be
+   * inside a nested message. 0 disables the limit.
+   */
+  void SetMaxTextLength(size_t len) { max_text_len_ = len; }
+
+  /**
+   * Appends the text format of the serialized message to text.
+   *
+   * Returns an error if the message is malformed or incomplete; the fields before the error are
+   * still printed, so truncated messages produce partial text. Scalar fields cut off at the end are
+   * printed with the missing bytes as zeros, string fields with the available bytes.
+   */
+  Status Print(std::string_view serialized, std::string* text);
+
+  /**
+   * Returns true if the text was cut off by the max text length in any of the Print() calls.
+   */
+  bool text_truncated() const { return text_truncated_; }
+
+ private:
+  size_t str_field_truncation_len_ = 0;
+  size_t max_text_len_ = 0;
+  bool text_truncated_ = false;
+};
+
+}  // namespace grpc
+}  // namespace stirling
+}  // namespace px
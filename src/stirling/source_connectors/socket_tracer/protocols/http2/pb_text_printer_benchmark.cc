@@ -0,0 +1,188 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <google/protobuf/empty.pb.h>
+#include <google/protobuf/text_format.h>
+
+#include <string>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/pb_text_printer.h"
+
+using ::google::protobuf::Empty;
+using ::google::protobuf::TextFormat;
+using ::px::stirling::grpc::PBTextPrinter;
+
+// The string field truncation used by the socket tracer, see kMaxPBStringLen.
+constexpr int kStrFieldTruncationLen = 64;
+
+void AppendVarint(uint64_t v, std::string* s) {
+  while (v >= 0x80) {
+    s->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  s->push_back(static_cast<char>(v));
+}
+
+void AppendVarintField(uint32_t number, uint64_t v, std::string* s) {
+  AppendVarint(number << 3, s);
+  AppendVarint(v, s);
+}
+
+void AppendFixed64Field(uint32_t number, uint64_t v, std::string* s) {
+  AppendVarint((number << 3) | 1, s);
+  for (int i = 0; i < 8; ++i) {
+    s->push_back(static_cast<char>(v >> (8 * i)));
+  }
+}
+
+void AppendLengthDelimitedField(uint32_t number, std::string_view v, std::string* s) {
+  AppendVarint((number << 3) | 2, s);
+  AppendVarint(v.size(), s);
+  s->append(v);
+}
+
+// A greeter request, same as the one used by the gRPC tracing tests.
+std::string HelloRequest() {
+  std::string s;
+  AppendLengthDelimitedField(1, "pixielabs", &s);
+  AppendVarintField(2, 3, &s);
+  return s;
+}
+
+// Same shape as an OpenTelemetry trace export request, which makes up much of the gRPC traffic in
+// service meshes: resource attributes, then spans with ids, timestamps and attributes.
+std::string TraceExportRequest(int num_spans) {
+  auto key_value = [](std::string_view key, std::string_view value) {
+    std::string any_value;
+    AppendLengthDelimitedField(1, value, &any_value);
+    std::string kv;
+    AppendLengthDelimitedField(1, key, &kv);
+    AppendLengthDelimitedField(2, any_value, &kv);
+    return kv;
+  };
+
+  std::string resource;
+  AppendLengthDelimitedField(1, key_value("service.name", "checkoutservice"), &resource);
+  AppendLengthDelimitedField(1, key_value("k8s.pod.name", "checkoutservice-7b5c9d4f6-x2k8p"),
+                             &resource);
+  AppendLengthDelimitedField(1, key_value("k8s.namespace.name", "online-boutique"), &resource);
+
+  std::string scope_spans;
+  for (int i = 0; i < num_spans; ++i) {
+    std::string span;
+    AppendLengthDelimitedField(1, std::string(16, static_cast<char>(0xa0 + i)), &span);
+    AppendLengthDelimitedField(2, std::string(8, static_cast<char>(0x10 + i)), &span);
+    AppendLengthDelimitedField(5, "hipstershop.PaymentService/Charge", &span);
+    AppendVarintField(6, 3, &span);
+    AppendFixed64Field(7, 1667000000000000000 + i, &span);
+    AppendFixed64Field(8, 1667000000012345678 + i, &span);
+    AppendLengthDelimitedField(9, key_value("rpc.system", "grpc"), &span);
+    AppendLengthDelimitedField(9, key_value("rpc.method", "Charge"), &span);
+    AppendLengthDelimitedField(9, key_value("net.peer.name", "paymentservice.svc.cluster.local"),
+                               &span);
+    AppendLengthDelimitedField(2, span, &scope_spans);
+  }
+
+  std::string resource_spans;
+  AppendLengthDelimitedField(1, resource, &resource_spans);
+  AppendLengthDelimitedField(2, scope_spans, &resource_spans);
+
+  std::string request;
+  AppendLengthDelimitedField(1, resource_spans, &request);
+  return request;
+}
+
+void TextFormatPrint(std::string_view serialized, std::string* text) {
+  Empty empty_pb;
+  empty_pb.ParsePartialFromArray(serialized.data(), serialized.size());
+  TextFormat::Printer printer;
+  printer.SetTruncateStringFieldLongerThan(kStrFieldTruncationLen);
+  printer.PrintToString(empty_pb, text);
+}
+
+void PBTextPrint(std::string_view serialized, size_t max_text_len, std::string* text) {
+  PBTextPrinter printer;
+  printer.SetTruncateStringFieldLongerThan(kStrFieldTruncationLen);
+  printer.SetMaxTextLength(max_text_len);
+  PX_UNUSED(printer.Print(serialized, text));
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_text_format_hello_request(benchmark::State& state) {
+  const std::string serialized = HelloRequest();
+  for (auto _ : state) {
+    std::string text;
+    TextFormatPrint(serialized, &text);
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_pb_text_printer_hello_request(benchmark::State& state) {
+  const std::string serialized = HelloRequest();
+  for (auto _ : state) {
+    std::string text;
+    PBTextPrint(serialized, /*max_text_len*/ 0, &text);
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_text_format_trace_export(benchmark::State& state) {
+  const std::string serialized = TraceExportRequest(state.range(0));
+  for (auto _ : state) {
+    std::string text;
+    TextFormatPrint(serialized, &text);
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_pb_text_printer_trace_export(benchmark::State& state) {
+  const std::string serialized = TraceExportRequest(state.range(0));
+  for (auto _ : state) {
+    std::string text;
+    PBTextPrint(serialized, /*max_text_len*/ 0, &text);
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
+// Stops at the socket tracer's default max_body_bytes.
+// NOLINTNEXTLINE(runtime/references)
+static void BM_pb_text_printer_trace_export_max_text_len(benchmark::State& state) {
+  const std::string serialized = TraceExportRequest(state.range(0));
+  for (auto _ : state) {
+    std::string text;
+    PBTextPrint(serialized, /*max_text_len*/ 512, &text);
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+
+BENCHMARK(BM_text_format_hello_request);
+BENCHMARK(BM_pb_text_printer_hello_request);
+BENCHMARK(BM_text_format_trace_export)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK(BM_pb_text_printer_trace_export)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK(BM_pb_text_printer_trace_export_max_text_len)->Arg(1)->Arg(10)->Arg(100);
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/pb_text_printer.h"
+
+#include <google/protobuf/empty.pb.h>
+#include <google/protobuf/text_format.h>
+
+#include <random>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http2/testing/proto/multi_fields.pb.h"
+
+namespace px {
+namespace stirling {
+namespace grpc {
+
+using ::google::protobuf::Empty;
+using ::google::protobuf::TextFormat;
+using ::px::stirling::protocols::http2::testing::MultiFieldsMessage;
+using ::testing::StrEq;
+
+namespace {
+
+std::string TextFormatPrint(std::string_view serialized) {
+  Empty empty_pb;
+  empty_pb.ParsePartialFromArray(serialized.data(), serialized.size());
+  std::string text;
+  TextFormat::Printer().PrintToString(empty_pb, &text);
+  return text;
+}
+
+std::string PBTextPrint(std::string_view serialized) {
+  PBTextPrinter printer;
+  std::string text;
+  PX_UNUSED(printer.Print(serialized, &text));
+  return text;
+}
+
+void AppendVarint(uint64_t v, std::string* s) {
+  while (v >= 0x80) {
+    s->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  s->push_back(static_cast<char>(v));
+}
+
+// Generates random well-formed messages, with length-delimited fields that are nested messages,
+// cut-off nested messages, and strings with characters that need escaping.
+class RandomMessageGenerator {
+ public:
+  std::string Generate(int depth = 0) {
+    std::string s;
+    const int num_fields = Uniform(depth == 0 ? 8 : 4);
+    for (int i = 0; i < num_fields; ++i) {
+      AppendField(depth, &s);
+    }
+    return s;
+  }
+
+ private:
+  uint64_t Uniform(uint64_t n) { return rng_() % n; }
+
+  void AppendField(int depth, std::string* s) {
+    const uint32_t number = 1 + (Uniform(4) == 0 ? Uniform((1 << 29) - 1) : Uniform(20));
+    // Wire types 0-5 except end-group.
+    uint32_t wire_type = Uniform(5);
+    if (wire_type == 4) {
+      wire_type = 5;
+    }
+    if (wire_type == 3 && depth > 6) {
+      wire_type = 0;
+    }
+    AppendVarint((number << 3) | wire_type, s);
+    switch (wire_type) {
+      case 0:
+        AppendVarint(Uniform(3) == 0 ? rng_() : Uniform(300), s);
+        break;
+      case 1:
+        AppendBytes(8, s);
+        break;
+      case 5:
+        AppendBytes(4, s);
+        break;
+      case 2: {
+        std::string value;
+        switch (Uniform(4)) {
+          case 0:
+            value = Generate(depth + 1);
+            break;
+          case 1:
+            value = Generate(depth + 1);
+            value.resize(value.empty() ? 0 : Uniform(value.size()));
+            break;
+          case 2:
+            AppendBytes(Uniform(12), &value);
+            break;
+          default:
+            for (int i = Uniform(40); i > 0; --i) {
+              value.push_back(static_cast<char>(' ' + Uniform(95)));
+            }
+            break;
+        }
+        AppendVarint(value.size(), s);
+        s->append(value);
+        break;
+      }
+      case 3:
+        for (int i = Uniform(4); i > 0; --i) {
+          AppendField(depth + 1, s);
+        }
+        AppendVarint((number << 3) | 4, s);
+        break;
+    }
+  }
+
+  void AppendBytes(int n, std::string* s) {
+    for (int i = 0; i < n; ++i) {
+      s->push_back(static_cast<char>(Uniform(256)));
+    }
+  }
+
+  std::mt19937_64 rng_{37};
+};
+
+}  // namespace
+
+TEST(PBTextPrinterTest, SameAsTextFormatForTypedMessage) {
+  MultiFieldsMessage msg;
+  ASSERT_TRUE(TextFormat::ParseFromString(R"proto(
+                                          b: true
+                                          i32: -100
+                                          i64: 200
+                                          f: 1.2345
+                                          bs: "\x00\x01\xff\"'\\\n"
+                                          str: "\n\x0A\x06nested"
+                                          )proto",
+                                          &msg));
+  std::string serialized = msg.SerializeAsString();
+  EXPECT_THAT(PBTextPrint(serialized), StrEq(TextFormatPrint(serialized)));
+}
+
+TEST(PBTextPrinterTest, SameAsTextFormatForRandomMessages) {
+  RandomMessageGenerator generator;
+  for (int i = 0; i < 2000; ++i) {
+    std::string serialized = generator.Generate();
+    ASSERT_THAT(PBTextPrint(serialized), StrEq(TextFormatPrint(serialized)))
+        << absl::BytesToHexString(serialized);
+  }
+}
+
+TEST(PBTextPrinterTest, NestingBeyondRecursionBudgetPrintedAsString) {
+  std::string serialized = "\x08\x01";
+  for (int i = 0; i < 12; ++i) {
+    std::string outer = "\x0A";
+    AppendVarint(serialized.size(), &outer);
+    serialized = outer + serialized;
+  }
+  EXPECT_THAT(PBTextPrint(serialized), StrEq(TextFormatPrint(serialized)));
+}
+
+TEST(PBTextPrinterTest, TruncateStringFields) {
+  std::string serialized = "\x0A\x0A" "0123456789" "\x12\x05" "01234";
+  PBTextPrinter printer;
+  printer.SetTruncateStringFieldLongerThan(5);
+  std::string text;
+  ASSERT_OK(printer.Print(serialized, &text));
+  EXPECT_THAT(text, StrEq("1: \"01234...<truncated>...\"\n2: \"01234\"\n"));
+}
+
+TEST(PBTextPrinterTest, StopsAtMaxTextLength) {
+  std::string serialized;
+  for (int i = 0; i < 100; ++i) {
+    serialized.append("\x08\x01");
+  }
+  PBTextPrinter printer;
+  printer.SetMaxTextLength(10);
+  std::string text;
+  ASSERT_OK(printer.Print(serialized, &text));
+  EXPECT_THAT(text, StrEq("1: 1\n1: 1\n"));
+  EXPECT_TRUE(printer.text_truncated());
+
+  // The limit applies to the whole text, so later messages print nothing.
+  text.clear();
+  text.append(20, ' ');
+  ASSERT_OK(printer.Print(serialized, &text));
+  EXPECT_EQ(text.size(), 20);
+}
+
+TEST(PBTextPrinterTest, PartialMessage) {
+  // A 2-byte string field cut off after 1 byte, after a complete varint field.
+  std::string serialized = "\x08\x96\x01\x12\x02" "a";
+  PBTextPrinter printer;
+  std::string text;
+  EXPECT_NOT_OK(printer.Print(serialized, &text));
+  EXPECT_THAT(text, StrEq("1: 150\n2: \"a\"\n"));
+
+  // A cut-off group is closed.
+  serialized = "\x0B\x10\x01";
+  text.clear();
+  EXPECT_NOT_OK(printer.Print(serialized, &text));
+  EXPECT_THAT(text, StrEq(TextFormatPrint(serialized)));
+  EXPECT_THAT(text, StrEq("1 {\n  2: 1\n}\n"));
+}
+
+TEST(PBTextPrinterTest, MalformedMessages) {
+  for (std::string_view serialized :
+       {std::string_view("\x00", 1), std::string_view("\x0C"), std::string_view("\x0E"),
+        std::string_view("\x08\x01\x07"), std::string_view("\x0B\x14")}) {
+    PBTextPrinter printer;
+    std::string text;
+    EXPECT_NOT_OK(printer.Print(serialized, &text));
+    EXPECT_THAT(text, StrEq(TextFormatPrint(serialized)));
+  }
+}
+
+}  // namespace grpc
+}  // namespace stirling
+}  // namespace px
@@ -24,6 +24,7 @@
 #include <utility>
 
 #include "src/common/base/byte_utils.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_search.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/mysql/types.h"
 #include "src/stirling/utils/parse_state.h"
 
@@ -85,18 +86,21 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
     return std::string::npos;
   }
 
-  // Need at least kPacketHeaderLength bytes + 1 command byte in buf.
-  for (size_t i = start_pos; i < buf.size() - mysql::kPacketHeaderLength; ++i) {
+  // Requests must have sequence id of 0, so only positions whose sequence id byte is 0 are
+  // checked. The sequence id follows the payload length.
+  static const MultiPatternSearcher kZeroSequenceID =
+      MultiPatternSearcher::AnyByteOf(std::string(1, '\0'));
+
+  // Need at least kPacketHeaderLength bytes + 1 command byte in buf, so the sequence id can be at
+  // most at the second to last byte.
+  std::string_view sequence_ids = buf.substr(0, buf.size() - 1);
+  for (size_t pos = kZeroSequenceID.Find(sequence_ids, start_pos + mysql::kPayloadLengthLength);
+       pos != std::string::npos; pos = kZeroSequenceID.Find(sequence_ids, pos + 1)) {
+    size_t i = pos - mysql::kPayloadLengthLength;
     std::string_view cur_buf = buf.substr(i);
     int packet_length = utils::LEndianBytesToInt<int, mysql::kPayloadLengthLength>(cur_buf);
-    uint8_t sequence_id = static_cast<uint8_t>(cur_buf[3]);
     auto command_byte = magic_enum::enum_cast<mysql::Command>(cur_buf[mysql::kPacketHeaderLength]);
 
-    // Requests must have sequence id of 0.
-    if (sequence_id != 0) {
-      continue;
-    }
-
     // If the command byte doesn't decode to a valid command, then this can't a message boundary.
     if (!command_byte.has_value()) {
       continue;
@@ -45,6 +45,10 @@ TEST(FindMessageBoundaryTest, ResultsAreAsExpected) {
   EXPECT_EQ(FindFrameBoundary<nats::Message>(message_type_t::kUnknown, " -ERR 'test'\r\n", 0), 1);
   EXPECT_EQ(FindFrameBoundary<nats::Message>(message_type_t::kUnknown, " {} \r\n", 0),
             std::string_view::npos);
+  EXPECT_EQ(FindFrameBoundary<nats::Message>(message_type_t::kUnknown, "PING\r\nPONG\r\n", 1), 6);
+  // A message type at the very end of the buffer is not a complete message.
+  EXPECT_EQ(FindFrameBoundary<nats::Message>(message_type_t::kUnknown, " +OK", 0),
+            std::string_view::npos);
 }
 
 struct TestParam {
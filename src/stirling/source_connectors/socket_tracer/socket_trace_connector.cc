@@ -151,6 +151,21 @@ DEFINE_double(stirling_socket_tracer_max_total_bw_overprovision_factor, 1,
               "Factor to overprovision maximum total bandwidth, to account for the fact that "
               "traffic won't be exactly evenly distributed over all cpus.");
 
+DEFINE_bool(stirling_socket_tracer_load_shedding,
+            gflags::BoolFromEnv("PL_STIRLING_SOCKET_TRACER_LOAD_SHEDDING", false),
+            "If true, when a transfer iteration overshoots the targets below, only a sample of "
+            "the new connections of the protocols with the most traffic are traced, instead of "
+            "losing data of all connections. The sampling ratio is recorded in the "
+            "sampling_ratio column of the protocol tables.");
+DEFINE_uint32(stirling_socket_tracer_target_transfer_time_ms,
+              gflags::Uint32FromEnv("PL_STIRLING_SOCKET_TRACER_TARGET_TRANSFER_TIME_MS", 100),
+              "The target wall time of a socket tracer transfer iteration, used by load shedding.");
+DEFINE_uint64(stirling_socket_tracer_target_buffered_bytes,
+              gflags::Uint64FromEnv("PL_STIRLING_SOCKET_TRACER_TARGET_BUFFERED_BYTES",
+                                    256 * 1024 * 1024),
+              "The target number of bytes held in the data streams of all connections after a "
+              "socket tracer transfer iteration, used by load shedding.");
+
 DEFINE_uint32(messages_expiry_duration_secs, 1 * 60,
               "The duration after which a parsed message is erased.");
 DEFINE_uint32(messages_size_limit_bytes, 1024 * 1024,
@@ -217,7 +232,14 @@ SocketTraceConnector::SocketTraceConnector(std::string_view source_name)
           BuildCounterFamily(openssl_mismatched_fds_metric, openssl_mismatched_fds_help)),
       openssl_trace_tls_source_counter_family_(
           BuildCounterFamily(openssl_tls_source_metric, openssl_tls_source_help)),
-      uprobe_mgr_(&this->BCC()) {
+      uprobe_mgr_(&this->BCC()),
+      load_shedder_({
+          .transfer_time = std::chrono::milliseconds(
+              FLAGS_stirling_socket_tracer_target_transfer_time_ms),
+          .buffered_bytes = FLAGS_stirling_socket_tracer_target_buffered_bytes,
+          .overload_iters = kLoadSheddingOverloadPeriod / kSamplingPeriod,
+          .recovery_iters = kLoadSheddingRecoveryPeriod / kSamplingPeriod,
+      }) {
   proc_parser_ = std::make_unique<system::ProcParser>();
   InitProtocolTransferSpecs();
 }
@@ -682,6 +704,29 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   }
 }
 
+void SocketTraceConnector::SampleConnTracker(ConnTracker* tracker) {
+  if (tracker->sampled() || tracker->protocol() == kProtocolUnknown ||
+      tracker->state() == ConnTracker::State::kDisabled) {
+    return;
+  }
+
+  const uint32_t sampling_ratio = load_shedder_.sampling_ratio(tracker->protocol());
+  tracker->set_sampling_ratio(sampling_ratio);
+  if (!LoadShedder::Sample(tracker->conn_id(), sampling_ratio)) {
+    stats_.Increment(StatKey::kLoadSheddingDisabledConns);
+    // Also tells BPF to stop sending the data of this connection.
+    tracker->Disable(absl::Substitute("Not sampled by load shedding at 1/$0", sampling_ratio));
+  }
+}
+
+void SocketTraceConnector::UpdateLoadShedding() {
+  const int64_t lost_data_events = stats_.Get(StatKey::kLossSocketDataEvent);
+  const auto transfer_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(now_fn_() - iteration_time_);
+  load_shedder_.EndIteration(transfer_time, lost_data_events - last_lost_data_events_);
+  last_lost_data_events_ = lost_data_events;
+}
+
 void SocketTraceConnector::UpdateTrackerTraceLevel(ConnTracker* tracker) {
   if (pids_to_trace_.contains(tracker->conn_id().upid.pid)) {
     tracker->SetDebugTrace(2);
@@ -765,6 +810,9 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
     conn_trackers_mgr_.ComputeProtocolStats();
     LOG(INFO) << "ConnTracker statistics: " << conn_trackers_mgr_.StatsString();
     LOG(INFO) << "SocketTracer statistics: " << stats_.Print();
+    if (FLAGS_stirling_socket_tracer_load_shedding) {
+      LOG(INFO) << "SocketTracer load shedding sampling ratios: " << load_shedder_.DebugString();
+    }
   }
 
   constexpr auto kDebugDumpPeriod = std::chrono::minutes(1);
@@ -807,6 +855,10 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
       }
     }
 
+    if (FLAGS_stirling_socket_tracer_load_shedding) {
+      SampleConnTracker(conn_tracker);
+    }
+
     conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
                                    socket_info_mgr_.get());
 
@@ -821,6 +873,16 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
     }
 
     conn_tracker->IterationPostTick();
+
+    if (FLAGS_stirling_socket_tracer_load_shedding) {
+      load_shedder_.AddBufferedBytes(conn_tracker->protocol(),
+                                     conn_tracker->send_data().data_buffer().size() +
+                                         conn_tracker->recv_data().data_buffer().size());
+    }
+  }
+
+  if (FLAGS_stirling_socket_tracer_load_shedding) {
+    UpdateLoadShedding();
   }
 
   CheckTracerState();
@@ -1051,6 +1113,9 @@ void SocketTraceConnector::AcceptDataEvent(std::unique_ptr<SocketDataEvent> even
   stats_.Increment(StatKey::kPollSocketDataEventCount);
   stats_.Increment(StatKey::kPollSocketDataEventAttrSize, sizeof(event->attr));
   stats_.Increment(StatKey::kPollSocketDataEventDataSize, event->msg.size());
+  if (FLAGS_stirling_socket_tracer_load_shedding) {
+    load_shedder_.AddTrafficBytes(event->attr.protocol, event->msg.size());
+  }
 
   ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
   tracker.AddDataEvent(std::move(event));
@@ -1254,7 +1319,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
 
   // Currently decompresses gzip content, but could handle other transformations too.
   // Note that we do this after filtering to avoid burning CPU cycles unnecessarily.
-  protocols::http::PreProcessMessage(&resp_message);
+  protocols::http::PreProcessMessage(&resp_message, FLAGS_max_body_bytes);
 
   md::UPID upid(ctx->GetASID(), conn_tracker.conn_id().upid.pid,
                 conn_tracker.conn_id().upid.start_time_ticks);
@@ -1289,6 +1354,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(resp_message.body), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(req_message.timestamp_ns, resp_message.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1328,7 +1394,8 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
     content_type = HTTPContentType::kGRPC;
   }
 
-  ParseReqRespBody(&record, DataTable::kTruncatedMsg, kMaxPBStringLen);
+  ParseReqRespBody(&record, DataTable::kTruncatedMsg, kMaxPBStringLen,
+                   static_cast<int>(FLAGS_max_body_bytes));
 
   DataTable::RecordBuilder<&kHTTPTable> r(data_table, resp_stream->timestamp_ns);
   r.Append<r.ColIndex("time_")>(resp_stream->timestamp_ns);
@@ -1351,9 +1418,8 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   // TODO(yzhao): Populate the following field from headers.
   r.Append<r.ColIndex("resp_message")>("OK");
   r.Append<r.ColIndex("req_body_size")>(req_stream->original_data_size());
-  // Do not apply truncation at this point, as the truncation was already done on serialized
-  // protobuf message. This might result into longer text format data here, but the increase is
-  // minimal.
+  // Do not apply truncation at this point, as ParseReqRespBody() already stopped printing the text
+  // format at max_body_bytes and appended the truncation message.
   r.Append<r.ColIndex("req_body")>(req_stream->ConsumeData());
   r.Append<r.ColIndex("resp_body_size")>(resp_stream->original_data_size());
   r.Append<r.ColIndex("resp_body")>(resp_stream->ConsumeData());
@@ -1362,6 +1428,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   // TODO(yzhao): Remove once http2::Record::bpf_timestamp_ns is removed.
   LOG_IF_EVERY_N(WARNING, latency_ns < 0, 100)
       << absl::Substitute("Negative latency found in HTTP2 records, record=$0", record.ToString());
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1387,6 +1454,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(entry.resp.msg), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1412,6 +1480,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(entry.resp.msg), FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1437,6 +1506,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(entry.resp.msg);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1461,6 +1531,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
   r.Append<r.ColIndex("req_cmd")>(ToString(entry.req.tag, /* is_req */ true));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1483,6 +1554,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("req_type")>(entry.req.type);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1518,6 +1590,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("latency")>(
       AMQPCalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns, entry.req.synchronous,
                            entry.resp.synchronous));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 }
 
 namespace {
@@ -1561,6 +1634,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp")>(std::string(entry.resp.payload));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, entry));
 #endif
@@ -1584,6 +1658,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("cmd")>(record.req.command);
   r.Append<r.ColIndex("body")>(record.req.options);
   r.Append<r.ColIndex("resp")>(record.resp.command);
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1612,6 +1687,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp")>(std::move(record.resp.msg), kMaxKafkaBodyBytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(record.req.timestamp_ns, record.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -1638,6 +1714,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(record.resp.frame_body));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(record.req.timestamp_ns, record.resp.timestamp_ns));
+  r.Append<r.ColIndex("sampling_ratio")>(conn_tracker.sampling_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(PXInfoString(conn_tracker, record));
 #endif
@@ -44,6 +44,7 @@
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+#include "src/stirling/source_connectors/socket_tracer/load_shedder.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
@@ -72,6 +73,10 @@ DECLARE_string(stirling_role_to_trace);
 DECLARE_uint32(stirling_socket_tracer_target_data_bw_percpu);
 DECLARE_uint32(stirling_socket_tracer_target_control_bw_percpu);
 
+DECLARE_bool(stirling_socket_tracer_load_shedding);
+DECLARE_uint32(stirling_socket_tracer_target_transfer_time_ms);
+DECLARE_uint64(stirling_socket_tracer_target_buffered_bytes);
+
 DECLARE_uint32(messages_expiry_duration_secs);
 DECLARE_uint32(messages_size_limit_bytes);
 DECLARE_uint32(datastream_buffer_expiry_duration_secs);
@@ -114,6 +119,13 @@ class SocketTraceConnector : public BCCSourceConnector {
   static constexpr auto kSamplingPeriod = std::chrono::milliseconds{200};
   // TODO(yzhao): This is not used right now. Eventually use this to control data push frequency.
   static constexpr auto kPushPeriod = std::chrono::milliseconds{1000};
+  // How long the load must stay above the load shedding targets before a sampling ratio is
+  // raised, so that a single slow iteration or lost event doesn't shed any load.
+  static constexpr auto kLoadSheddingOverloadPeriod = std::chrono::seconds{1};
+  // How long the load must stay well below the load shedding targets before the sampling ratios
+  // are lowered. A sampling ratio is also raised at most once per period, since it only applies to
+  // new connections and takes a while to show in the load.
+  static constexpr auto kLoadSheddingRecoveryPeriod = std::chrono::seconds{10};
 
   static std::unique_ptr<SocketTraceConnector> Create(std::string_view name) {
     return std::unique_ptr<SocketTraceConnector>(new SocketTraceConnector(name));
@@ -221,6 +233,13 @@ class SocketTraceConnector : public BCCSourceConnector {
 
   void UpdateTrackerTraceLevel(ConnTracker* tracker);
 
+  // Decides whether to trace a connection whose protocol was just inferred, based on the current
+  // sampling ratio of the protocol. Connections that are not sampled are disabled.
+  void SampleConnTracker(ConnTracker* tracker);
+
+  // Adjusts the sampling ratios of load shedding, based on the load of the current iteration.
+  void UpdateLoadShedding();
+
   template <typename TRecordType>
   static void AppendMessage(ConnectorContext* ctx, const ConnTracker& conn_tracker,
                             TRecordType record, DataTable* data_table);
@@ -307,6 +326,9 @@ class SocketTraceConnector : public BCCSourceConnector {
     kLossGrpcCHeaderEvent,
     kLossGrpcCCloseEvent,
 
+    // The number of connections that were not traced because of load shedding.
+    kLoadSheddingDisabledConns,
+
     kPollSocketDataEventCount,
     kPollSocketDataEventAttrSize,
     kPollSocketDataEventDataSize,
@@ -315,6 +337,11 @@ class SocketTraceConnector : public BCCSourceConnector {
 
   utils::StatCounter<StatKey> stats_;
 
+  // Used to compute the data events lost during each iteration.
+  int64_t last_lost_data_events_ = 0;
+
+  LoadShedder load_shedder_;
+
   friend class SocketTraceConnectorFriend;
   friend class SocketTraceBPFTest;
 };
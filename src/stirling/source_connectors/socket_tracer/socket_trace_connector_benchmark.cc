@@ -71,6 +71,20 @@ enum class DisplayStatCategory {
 void CountOutput(px::stirling::DataTables* tables, uint64_t* output_records,
                  uint64_t* output_bytes) {
   for (auto tbl : tables->tables()) {
+    if (tbl->arrow_builders_enabled()) {
+      for (const auto& tagged_record : tbl->ConsumeArrowRecords()) {
+        if (!tagged_record.records.empty()) {
+          *output_records += tagged_record.records[0]->length();
+        }
+        for (const auto& arr : tagged_record.records) {
+          for (const auto& buffer : arr->data()->buffers) {
+            *output_bytes += buffer == nullptr ? 0 : buffer->size();
+          }
+        }
+      }
+      continue;
+    }
+
     auto tagged_records = tbl->ConsumeRecords();
     for (auto tagged_record : tagged_records) {
       if (tagged_record.records.size() > 0) {
@@ -106,6 +120,7 @@ px::StatusOr<absl::flat_hash_set<DisplayStatCategory>> GetDisplayStatCategories(
 // Benchmark that simulates events coming from BPF and getting pushed to the SocketTraceConnector.
 // Only benchmarks the path from receiving events from BPF to transferring those events to
 // DataTables, doesn't benchmark the pushing to table store part of the pipeline.
+// Run with --stirling_data_table_arrow_builders to build arrow arrays in the DataTables.
 
 // NOLINTNEXTLINE: runtime/references.
 static void BM_SocketTraceConnector(benchmark::State& state, BenchmarkDataGenerationSpec spec) {
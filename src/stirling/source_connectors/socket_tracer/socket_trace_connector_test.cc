@@ -40,6 +40,7 @@ namespace stirling {
 
 namespace http = protocols::http;
 
+using ::testing::Each;
 using ::testing::ElementsAre;
 
 using ::px::stirling::testing::RecordBatchSizeIs;
@@ -259,6 +260,38 @@ TEST_F(SocketTraceConnectorTest, HTTPDelayedRespBody) {
   EXPECT_THAT(ToStringVector(records[kHTTPRespBodyIdx]), ElementsAre("hello world"));
 }
 
+// Tests that under load shedding, only a sample of the new connections is traced, and their
+// records carry the sampling ratio.
+TEST_F(SocketTraceConnectorTest, LoadSheddingSamplesConnections) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_socket_tracer_load_shedding, true);
+
+  // Overloads the socket tracer with HTTP traffic, until 1 in 4 HTTP connections are traced.
+  LoadShedder& load_shedder = source_->load_shedder();
+  for (int i = 0; i < 2; ++i) {
+    load_shedder.AddTrafficBytes(kProtocolHTTP, kReq0.size());
+    load_shedder.EndIteration(std::chrono::seconds(1), 0);
+  }
+  ASSERT_EQ(load_shedder.sampling_ratio(kProtocolHTTP), 4);
+
+  constexpr size_t kNumConns = 100;
+  for (size_t i = 0; i < kNumConns; ++i) {
+    source_->AcceptControlEvent(event_gen_.InitConn());
+    source_->AcceptDataEvent(event_gen_.InitSendEvent<kProtocolHTTP>(kReq0));
+    source_->AcceptDataEvent(event_gen_.InitRecvEvent<kProtocolHTTP>(kResp0));
+    source_->AcceptControlEvent(event_gen_.InitClose());
+  }
+  connector_->TransferData(ctx_.get());
+
+  std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+
+  const std::vector<int64_t> sampling_ratios =
+      ToIntVector<types::Int64Value>(records[kHTTPSamplingRatioIdx]);
+  EXPECT_GT(sampling_ratios.size(), kNumConns / 10);
+  EXPECT_LT(sampling_ratios.size(), kNumConns / 2);
+  EXPECT_THAT(sampling_ratios, Each(4));
+}
+
 TEST_F(SocketTraceConnectorTest, HTTPContentType) {
   struct socket_control_event_t conn = event_gen_.InitConn();
   std::unique_ptr<SocketDataEvent> event0_req = event_gen_.InitSendEvent<kProtocolHTTP>(kReq0);
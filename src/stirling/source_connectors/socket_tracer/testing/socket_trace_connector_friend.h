@@ -69,6 +69,8 @@ class SocketTraceConnectorFriend : public SocketTraceConnector {
   void HandleHTTP2Data(go_grpc_data_event_t* data, int data_size) {
     SocketTraceConnector::HandleHTTP2Event(this, data, data_size);
   }
+
+  LoadShedder& load_shedder() { return load_shedder_; }
 };
 
 }  // namespace stirling
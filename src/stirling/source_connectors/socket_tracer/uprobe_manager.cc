@@ -18,14 +18,11 @@
 
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
 
-#include <fcntl.h>
-#include <openssl/md5.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <map>
 #include <tuple>
@@ -34,10 +31,9 @@
 #include "src/common/base/utils.h"
 #include "src/common/exec/subprocess.h"
 #include "src/common/fs/fs_wrapper.h"
+#include "src/common/metrics/metrics.h"
 #include "src/common/system/proc_pid_path.h"
 #include "src/stirling/bpf_tools/macros.h"
-#include "src/stirling/obj_tools/dwarf_reader.h"
-#include "src/stirling/obj_tools/go_syms.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
 #include "src/stirling/utils/linux_headers.h"
 #include "src/stirling/utils/proc_path_tools.h"
@@ -51,18 +47,30 @@ DEFINE_bool(stirling_enable_grpc_c_tracing,
 DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
+DEFINE_string(stirling_go_symaddrs_cache_file,
+              gflags::StringFromEnv("PL_STIRLING_GO_SYMADDRS_CACHE_FILE", ""),
+              "If set, the symbol addresses of analyzed Go binaries are saved to this file, and "
+              "reloaded from it on startup, so that binaries aren't re-analyzed across restarts");
 
 namespace px {
 namespace stirling {
 
-using ::px::stirling::obj_tools::DwarfReader;
 using ::px::stirling::obj_tools::ElfReader;
 using ::px::system::GetKernelVersion;
 using ::px::system::KernelVersion;
 using ::px::system::KernelVersionOrder;
 using ::px::system::ProcPidRootPath;
 
-UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc) : bcc_(bcc) {
+UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc)
+    : bcc_(bcc),
+      go_binary_analyzer_(&go_symaddrs_cache_, FLAGS_stirling_uprobe_analysis_threads),
+      time_to_first_probe_us_gauge_(BuildGauge(
+          "socket_tracer_uprobe_time_to_first_probe_us",
+          "Time (in microseconds) from the start of the last uprobe deployment round that attached "
+          "any probes, to its first attached probe.")),
+      go_uprobe_deploy_time_us_counter_(
+          BuildCounter("socket_tracer_go_uprobe_deploy_time_us",
+                       "Total time (in microseconds) spent deploying uprobes on Go binaries.")) {
   proc_parser_ = std::make_unique<system::ProcParser>();
 }
 
@@ -81,6 +89,18 @@ void UProbeManager::Init(bool disable_go_tls_tracing, bool enable_http2_tracing,
   node_tlswrap_symaddrs_map_ =
       MapT<struct node_tlswrap_symaddrs_t>::Create(bcc_, "node_tlswrap_symaddrs_map");
   grpc_c_versions_map_ = MapT<uint64_t>::Create(bcc_, "grpc_c_versions");
+
+  const std::filesystem::path cache_file = FLAGS_stirling_go_symaddrs_cache_file;
+  if (!cache_file.empty() && fs::Exists(cache_file)) {
+    Status s = go_symaddrs_cache_.Load(cache_file);
+    if (!s.ok()) {
+      LOG(WARNING) << absl::Substitute("Ignoring Go symaddrs cache file $0: $1",
+                                       cache_file.string(), s.msg());
+    } else {
+      LOG(INFO) << absl::Substitute("Loaded symaddrs of $0 Go binaries from $1",
+                                    go_symaddrs_cache_.size(), cache_file.string());
+    }
+  }
 }
 
 void UProbeManager::NotifyMMapEvent(upid_t upid) {
@@ -93,6 +113,11 @@ Status UProbeManager::LogAndAttachUProbe(const bpf_tools::UProbeSpec& spec) {
   auto s = bcc_->AttachUProbe(spec);
   if (!s.ok()) {
     monitor_.AppendProbeStatusRecord("socket_tracer", spec.probe_fn, s, spec.ToJSON());
+  } else if (deploy_round_start_.has_value()) {
+    time_to_first_probe_us_gauge_.Set(std::chrono::duration_cast<std::chrono::microseconds>(
+                                          std::chrono::steady_clock::now() - *deploy_round_start_)
+                                          .count());
+    deploy_round_start_.reset();
   }
   return s;
 }
@@ -164,11 +189,8 @@ Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_mana
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
+Status UProbeManager::UpdateGoCommonSymAddrs(const struct go_common_symaddrs_t& symaddrs,
                                              const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
-
   for (auto& pid : pids) {
     PX_RETURN_IF_ERROR(go_common_symaddrs_map_->SetValue(pid, symaddrs));
   }
@@ -176,11 +198,8 @@ Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader*
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
+Status UProbeManager::UpdateGoHTTP2SymAddrs(const struct go_http2_symaddrs_t& symaddrs,
                                             const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
-
   for (auto& pid : pids) {
     PX_RETURN_IF_ERROR(go_http2_symaddrs_map_->SetValue(pid, symaddrs));
   }
@@ -188,10 +207,8 @@ Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader*
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
+Status UProbeManager::UpdateGoTLSSymAddrs(const struct go_tls_symaddrs_t& symaddrs,
                                           const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
-
   for (auto& pid : pids) {
     PX_RETURN_IF_ERROR(go_tls_symaddrs_map_->SetValue(pid, symaddrs));
   }
@@ -506,19 +523,19 @@ StatusOr<int> UProbeManager::AttachNodeJsOpenSSLUprobes(const uint32_t pid) {
   return kOpenSSLUProbes.size() + count;
 }
 
-StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
-                                                obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
-                                                const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+StatusOr<int> UProbeManager::AttachGoTLSUProbes(
+    const std::string& binary, obj_tools::ElfReader* elf_reader,
+    const std::optional<struct go_tls_symaddrs_t>& symaddrs, const std::vector<int32_t>& pids) {
+  if (!symaddrs.has_value()) {
     // Doesn't appear to be a binary with the mandatory symbols.
     // Might not even be a golang binary.
     // Either way, not of interest to probe.
     return 0;
   }
 
+  // Step 1: Update BPF symbols_map on all new PIDs.
+  PX_RETURN_IF_ERROR(UpdateGoTLSSymAddrs(symaddrs.value(), pids));
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_tls_probed_binaries_.insert(binary);
   if (!result.second) {
@@ -528,16 +545,16 @@ StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
   return AttachUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader);
 }
 
-StatusOr<int> UProbeManager::AttachGoHTTP2UProbes(const std::string& binary,
-                                                  obj_tools::ElfReader* elf_reader,
-                                                  obj_tools::DwarfReader* dwarf_reader,
-                                                  const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+StatusOr<int> UProbeManager::AttachGoHTTP2UProbes(
+    const std::string& binary, obj_tools::ElfReader* elf_reader,
+    const std::optional<struct go_http2_symaddrs_t>& symaddrs, const std::vector<int32_t>& pids) {
+  if (!symaddrs.has_value()) {
     return 0;
   }
 
+  // Step 1: Update BPF symaddrs for this binary.
+  PX_RETURN_IF_ERROR(UpdateGoHTTP2SymAddrs(symaddrs.value(), pids));
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_http2_probed_binaries_.insert(binary);
   if (!result.second) {
@@ -664,50 +681,6 @@ int UProbeManager::DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pid
   return uprobe_count;
 }
 
-StatusOr<std::string> UProbeManager::MD5onFile(const std::string& file) {
-  // Implementation based on
-  // https://stackoverflow.com/questions/1220046/how-to-get-the-md5-hash-of-a-file-in-c
-  unsigned char md5_hash[MD5_DIGEST_LENGTH] = {0};
-  int file_descript = open(file.c_str(), O_RDONLY);
-  if (-1 == file_descript) {
-    return error::Internal(absl::Substitute(
-        "Failed to get the MD5 hash of file $0 because of open failure. errno $1.", file, errno));
-  }
-
-  struct stat statbuf;
-  if (-1 == fstat(file_descript, &statbuf)) {
-    close(file_descript);  // Ignore if close fails, we already exit the function with an error on
-                           // the file.
-    return error::Internal(absl::Substitute(
-        "Failed to get the MD5 hash of file $0 because of stat failure. errno $1.", file, errno));
-  }
-  uint64_t file_size = statbuf.st_size;
-
-  void* mapped_file_buffer =
-      mmap(/*addr*/ 0, file_size, PROT_READ, MAP_SHARED, file_descript, /*offset*/ 0);
-  if (MAP_FAILED == mapped_file_buffer) {
-    return error::Internal(absl::Substitute(
-        "Failed to map area to store file $0 that needs hashing. errno $1.", file, errno));
-  }
-  if (-1 == close(file_descript)) {
-    return error::Internal(
-        absl::Substitute("Failed to close file $0 that needs hashing. errno $1.", file, errno));
-  }
-  // This can't fail, it always returns the pointer to the hash value (3rd argument).
-  MD5((unsigned char*)mapped_file_buffer, file_size, md5_hash);
-  if (0 != munmap(mapped_file_buffer, file_size)) {
-    return error::Internal(
-        absl::Substitute("Failed to unmap file $0 that needs hashing. errno $1.", file, errno));
-  }
-
-  std::basic_string_view<char> md5_hash_str_view{reinterpret_cast<char*>(md5_hash),
-                                                 MD5_DIGEST_LENGTH};
-  std::string hash_str =
-      absl::AsciiStrToLower(BytesToString<bytes_format::HexCompact>(md5_hash_str_view));
-
-  return hash_str;
-}
-
 StatusOr<int> UProbeManager::AttachGrpcCUProbesOnDynamicPythonLib(uint32_t pid) {
   // grpc-c libraries that are used by python normally have this prefix,
   // I have not seen a case where it's not used.
@@ -816,7 +789,10 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
 
   static int32_t kPID = getpid();
 
-  for (const auto& [binary, pid_vec] : ConvertPIDsListToMap(pids)) {
+  const auto start = std::chrono::steady_clock::now();
+
+  std::map<std::string, std::vector<int32_t>> new_binaries;
+  for (auto& [binary, pid_vec] : ConvertPIDsListToMap(pids)) {
     // Don't bother rescanning binaries that have been scanned before to avoid unnecessary work.
     if (!scanned_binaries_.insert(binary).second) {
       continue;
@@ -830,68 +806,110 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
       }
     }
 
-    // Read binary's symbols.
-    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
-    if (!elf_reader_status.ok()) {
-      LOG(WARNING) << absl::Substitute(
-          "Cannot analyze binary $0 for uprobe deployment. "
-          "If file is under /var/lib, container may have terminated. "
-          "Message = $1",
-          binary, elf_reader_status.msg());
-      continue;
-    }
-    std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+    new_binaries.emplace(binary, std::move(pid_vec));
+  }
 
-    // Avoid going past this point if not a golang program.
-    // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
-    if (!IsGoExecutable(elf_reader.get())) {
-      continue;
-    }
+  std::vector<std::string> binaries;
+  binaries.reserve(new_binaries.size());
+  for (const auto& [binary, pid_vec] : new_binaries) {
+    binaries.push_back(binary);
+  }
 
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
-        DwarfReader::CreateIndexingAll(binary);
-    if (!dwarf_reader_status.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
-          "Message = $1",
-          binary, dwarf_reader_status.msg());
-      continue;
-    }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
-    if (!s.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
-      continue;
-    }
+  // Analyze the binaries in parallel, a bounded batch at a time, since the analyses hold the ELF
+  // readers of the Go binaries until their probes are attached. Attaching the probes below stays on
+  // this thread.
+  for (size_t batch_start = 0; batch_start < binaries.size();
+       batch_start += GoBinaryAnalyzer::kMaxBatchSize) {
+    const size_t batch_end =
+        std::min(batch_start + GoBinaryAnalyzer::kMaxBatchSize, binaries.size());
+    std::vector<GoBinaryAnalysis> analyses = go_binary_analyzer_.Analyze(
+        std::vector<std::string>(binaries.begin() + batch_start, binaries.begin() + batch_end));
 
-    // GoTLS Probes.
-    if (!cfg_disable_go_tls_tracing_) {
-      VLOG(1) << absl::Substitute("Attempting to attach Go TLS uprobes to binary $0", binary);
-      StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
-      if (!attach_status.ok()) {
-        monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
-                                          "AttachGoTLSUProbes");
-        LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach GoTLS Uprobes to $0: $1",
-                                                     binary, attach_status.ToString());
-      } else {
-        uprobe_count += attach_status.ValueOrDie();
+    for (GoBinaryAnalysis& analysis : analyses) {
+      const std::string& binary = analysis.binary;
+      const std::vector<int32_t>& pid_vec = new_binaries[binary];
+
+      if (!analysis.is_elf) {
+        LOG(WARNING) << absl::Substitute(
+            "Cannot analyze binary $0 for uprobe deployment. "
+            "If file is under /var/lib, container may have terminated. "
+            "Message = $1",
+            binary, analysis.status.msg());
+        continue;
+      }
+      if (!analysis.is_go_binary) {
+        continue;
+      }
+      if (!analysis.status.ok()) {
+        VLOG(1) << absl::Substitute(
+            "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
+            "Message = $1",
+            binary, analysis.status.msg());
+        continue;
+      }
+      const GoSymAddrs& symaddrs = analysis.symaddrs;
+      if (!symaddrs.common.has_value()) {
+        VLOG(1) << absl::Substitute(
+            "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+        continue;
+      }
+      Status s = UpdateGoCommonSymAddrs(symaddrs.common.value(), pid_vec);
+      if (!s.ok()) {
+        VLOG(1) << absl::Substitute("Failed to update Go common symaddrs of binary $0: $1", binary,
+                                    s.msg());
+        continue;
       }
-    }
 
-    // Go HTTP2 Probes.
-    if (!cfg_disable_go_tls_tracing_ && cfg_enable_http2_tracing_) {
-      StatusOr<int> attach_status =
-          AttachGoHTTP2UProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
-      if (!attach_status.ok()) {
-        monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
-                                          "AttachGoHTTP2UProbes");
-        LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach HTTP2 Uprobes to $0: $1",
-                                                     binary, attach_status.ToString());
-      } else {
-        uprobe_count += attach_status.ValueOrDie();
+      ElfReader* elf_reader = analysis.elf_reader.get();
+
+      // GoTLS Probes.
+      if (!cfg_disable_go_tls_tracing_) {
+        VLOG(1) << absl::Substitute("Attempting to attach Go TLS uprobes to binary $0", binary);
+        StatusOr<int> attach_status = AttachGoTLSUProbes(binary, elf_reader, symaddrs.tls, pid_vec);
+        if (!attach_status.ok()) {
+          monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
+                                            "AttachGoTLSUProbes");
+          LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach GoTLS Uprobes to $0: $1",
+                                                       binary, attach_status.ToString());
+        } else {
+          uprobe_count += attach_status.ValueOrDie();
+        }
+      }
+
+      // Go HTTP2 Probes.
+      if (!cfg_disable_go_tls_tracing_ && cfg_enable_http2_tracing_) {
+        StatusOr<int> attach_status =
+            AttachGoHTTP2UProbes(binary, elf_reader, symaddrs.http2, pid_vec);
+        if (!attach_status.ok()) {
+          monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
+                                            "AttachGoHTTP2UProbes");
+          LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach HTTP2 Uprobes to $0: $1",
+                                                       binary, attach_status.ToString());
+        } else {
+          uprobe_count += attach_status.ValueOrDie();
+        }
       }
+
+      VLOG(1) << absl::Substitute(
+          "Deployed Go uprobes on binary $0 after $1 us (symaddrs cache $2)", binary,
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                start)
+              .count(),
+          analysis.cache_hit ? "hit" : "miss");
+    }
+  }
+
+  go_uprobe_deploy_time_us_counter_.Increment(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                            start)
+          .count());
+
+  const std::filesystem::path cache_file = FLAGS_stirling_go_symaddrs_cache_file;
+  if (!cache_file.empty() && go_symaddrs_cache_.dirty()) {
+    Status s = go_symaddrs_cache_.Save(cache_file);
+    if (!s.ok()) {
+      LOG_FIRST_N(WARNING, 1) << absl::Substitute("Failed to save Go symaddrs cache to $0: $1",
+                                                  cache_file.string(), s.msg());
     }
   }
 
@@ -958,6 +976,8 @@ bool KernelVersionAllowsGRPCCTracing() {
 void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
   const std::lock_guard<std::mutex> lock(deploy_uprobes_mutex_);
 
+  deploy_round_start_ = std::chrono::steady_clock::now();
+
   proc_tracker_.Update(pids);
 
   // Before deploying new probes, clean-up map entries for old processes that are now dead.
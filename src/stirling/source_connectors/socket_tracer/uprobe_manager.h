@@ -18,17 +18,20 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <absl/synchronization/mutex.h>
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
 
 #include "src/common/system/proc_parser.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
-#include "src/stirling/obj_tools/dwarf_reader.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 #include "src/stirling/obj_tools/raw_fptr_manager.h"
 
@@ -36,7 +39,9 @@
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
 
+#include "src/stirling/source_connectors/socket_tracer/go_binary_analyzer.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
 #include "src/stirling/utils/detect_application.h"
 #include "src/stirling/utils/monitor.h"
 #include "src/stirling/utils/proc_path_tools.h"
@@ -46,6 +51,7 @@ DECLARE_bool(stirling_rescan_for_dlopen);
 DECLARE_bool(stirling_enable_grpc_c_tracing);
 DECLARE_double(stirling_rescan_exp_backoff_factor);
 DECLARE_bool(stirling_trace_static_tls_binaries);
+DECLARE_string(stirling_go_symaddrs_cache_file);
 
 namespace px {
 namespace stirling {
@@ -385,9 +391,6 @@ class UProbeManager {
   });
 
   int DeployGrpcCUProbes(const absl::flat_hash_set<md::UPID>& pids);
-  // We hash grpc-c libraries to know its version.
-  // For further explanation see the definition of kGrpcCMD5HashToVersion.
-  StatusOr<std::string> MD5onFile(const std::string& file);
   StatusOr<int> AttachGrpcCUProbesOnDynamicPythonLib(uint32_t pid);
 
   static StatusOr<std::array<UProbeTmpl, 6>> GetNodeOpensslUProbeTmpls(const SemVer& ver);
@@ -493,7 +496,7 @@ class UProbeManager {
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
    * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param symaddrs The Go HTTP2 symaddrs of the binary, if it has them.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not considered an error if the binary
@@ -501,7 +504,7 @@ class UProbeManager {
    *         zero.
    */
   StatusOr<int> AttachGoHTTP2UProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                     obj_tools::DwarfReader* dwarf_reader,
+                                     const std::optional<struct go_http2_symaddrs_t>& symaddrs,
                                      const std::vector<int32_t>& pids);
 
   /**
@@ -510,14 +513,14 @@ class UProbeManager {
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
    * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param symaddrs The Go TLS symaddrs of the binary, if it has them.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not an error if the binary
    *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
    */
   StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
+                                   const std::optional<struct go_tls_symaddrs_t>& symaddrs,
                                    const std::vector<int32_t>& new_pids);
 
   /**
@@ -578,13 +581,11 @@ class UProbeManager {
 
   Status UpdateOpenSSLSymAddrs(px::stirling::obj_tools::RawFptrManager* fptrManager,
                                std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoCommonSymAddrs(const struct go_common_symaddrs_t& symaddrs,
                                 const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoHTTP2SymAddrs(const struct go_http2_symaddrs_t& symaddrs,
                                const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
+  Status UpdateGoTLSSymAddrs(const struct go_tls_symaddrs_t& symaddrs,
                              const std::vector<int32_t>& pids);
   Status UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
                                    const SemVer& ver);
@@ -634,6 +635,19 @@ class UProbeManager {
   absl::flat_hash_set<std::string> nodejs_binaries_;
   absl::flat_hash_set<std::string> grpc_c_probed_binaries_;
 
+  // Symaddrs of analyzed Go binaries, keyed by build-id (or content hash), so that instances of
+  // the same binary reached through different paths (e.g. in different containers) are only
+  // analyzed once. Optionally persisted to FLAGS_stirling_go_symaddrs_cache_file.
+  GoSymAddrsCache go_symaddrs_cache_;
+
+  // Analyzes new Go binaries in parallel, before their uprobes are attached.
+  GoBinaryAnalyzer go_binary_analyzer_;
+
+  // Start time of the current DeployUProbes() round, until its first probe gets attached.
+  std::optional<std::chrono::steady_clock::time_point> deploy_round_start_;
+  prometheus::Gauge& time_to_first_probe_us_gauge_;
+  prometheus::Counter& go_uprobe_deploy_time_us_counter_;
+
   // BPF maps through which the addresses of symbols for a given pid are communicated to uprobes.
   std::unique_ptr<MapT<ssl_source_t>> openssl_source_map_;
   std::unique_ptr<MapT<struct openssl_symaddrs_t>> openssl_symaddrs_map_;
@@ -18,6 +18,11 @@
 
 #include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <openssl/md5.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <map>
@@ -26,6 +31,7 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/common/base/utils.h"
 #include "src/common/fs/fs_wrapper.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
 #include "src/stirling/obj_tools/elf_reader.h"
@@ -47,6 +53,11 @@ DEFINE_bool(openssl_raw_fptrs_enabled, false,
             "If true, allows the openssl tracing implementation to fall back to function pointers "
             "if dlopen/dlsym is unable to find symbols");
 
+DEFINE_int32(stirling_go_dwarf_index_threads,
+             gflags::Int32FromEnv("PL_STIRLING_GO_DWARF_INDEX_THREADS", 2),
+             "Number of threads used to scan the DWARF info of a Go binary for the symbols needed "
+             "by its uprobes.");
+
 namespace px {
 namespace stirling {
 
@@ -914,5 +925,75 @@ StatusOr<struct node_tlswrap_symaddrs_t> NodeTLSWrapSymAddrs(const std::filesyst
   return error::NotFound("Nodejs version cannot be older than 12.3.1, got '$0'", ver.ToString());
 }
 
+StatusOr<GoSymAddrs> ResolveGoSymAddrs(const std::string& binary, ElfReader* elf_reader) {
+  // Only a few dozen structs and functions are looked up, so index lazily rather than building
+  // the full index, which is expensive on binaries with a lot of debug info.
+  PX_ASSIGN_OR_RETURN(
+      std::unique_ptr<DwarfReader> dwarf_reader,
+      DwarfReader::CreateWithLazyIndexing(binary, FLAGS_stirling_go_dwarf_index_threads));
+
+  GoSymAddrs symaddrs;
+  StatusOr<struct go_common_symaddrs_t> common_or =
+      GoCommonSymAddrs(elf_reader, dwarf_reader.get());
+  if (!common_or.ok()) {
+    return symaddrs;
+  }
+  symaddrs.common = common_or.ConsumeValueOrDie();
+
+  StatusOr<struct go_tls_symaddrs_t> tls_or = GoTLSSymAddrs(elf_reader, dwarf_reader.get());
+  if (tls_or.ok()) {
+    symaddrs.tls = tls_or.ConsumeValueOrDie();
+  }
+  StatusOr<struct go_http2_symaddrs_t> http2_or = GoHTTP2SymAddrs(elf_reader, dwarf_reader.get());
+  if (http2_or.ok()) {
+    symaddrs.http2 = http2_or.ConsumeValueOrDie();
+  }
+  return symaddrs;
+}
+
+StatusOr<std::string> MD5onFile(const std::string& file) {
+  // Implementation based on
+  // https://stackoverflow.com/questions/1220046/how-to-get-the-md5-hash-of-a-file-in-c
+  unsigned char md5_hash[MD5_DIGEST_LENGTH] = {0};
+  int file_descript = open(file.c_str(), O_RDONLY);
+  if (-1 == file_descript) {
+    return error::Internal(absl::Substitute(
+        "Failed to get the MD5 hash of file $0 because of open failure. errno $1.", file, errno));
+  }
+
+  struct stat statbuf;
+  if (-1 == fstat(file_descript, &statbuf)) {
+    close(file_descript);  // Ignore if close fails, we already exit the function with an error on
+                           // the file.
+    return error::Internal(absl::Substitute(
+        "Failed to get the MD5 hash of file $0 because of stat failure. errno $1.", file, errno));
+  }
+  uint64_t file_size = statbuf.st_size;
+
+  void* mapped_file_buffer =
+      mmap(/*addr*/ 0, file_size, PROT_READ, MAP_SHARED, file_descript, /*offset*/ 0);
+  if (MAP_FAILED == mapped_file_buffer) {
+    return error::Internal(absl::Substitute(
+        "Failed to map area to store file $0 that needs hashing. errno $1.", file, errno));
+  }
+  if (-1 == close(file_descript)) {
+    return error::Internal(
+        absl::Substitute("Failed to close file $0 that needs hashing. errno $1.", file, errno));
+  }
+  // This can't fail, it always returns the pointer to the hash value (3rd argument).
+  MD5((unsigned char*)mapped_file_buffer, file_size, md5_hash);
+  if (0 != munmap(mapped_file_buffer, file_size)) {
+    return error::Internal(
+        absl::Substitute("Failed to unmap file $0 that needs hashing. errno $1.", file, errno));
+  }
+
+  std::basic_string_view<char> md5_hash_str_view{reinterpret_cast<char*>(md5_hash),
+                                                 MD5_DIGEST_LENGTH};
+  std::string hash_str =
+      absl::AsciiStrToLower(BytesToString<bytes_format::HexCompact>(md5_hash_str_view));
+
+  return hash_str;
+}
+
 }  // namespace stirling
 }  // namespace px
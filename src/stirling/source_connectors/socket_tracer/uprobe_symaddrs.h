@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 
 #include "src/common/base/base.h"
@@ -57,6 +58,25 @@ StatusOr<struct go_http2_symaddrs_t> GoHTTP2SymAddrs(obj_tools::ElfReader* elf_r
 StatusOr<struct go_tls_symaddrs_t> GoTLSSymAddrs(obj_tools::ElfReader* elf_reader,
                                                  obj_tools::DwarfReader* dwarf_reader);
 
+/**
+ * The symbol addresses resolved for one Go binary.
+ * A field is empty when the binary lacks the symbols for that group of probes
+ * (e.g. a Go binary that doesn't link crypto/tls has no TLS symaddrs).
+ */
+struct GoSymAddrs {
+  std::optional<struct go_common_symaddrs_t> common;
+  std::optional<struct go_tls_symaddrs_t> tls;
+  std::optional<struct go_http2_symaddrs_t> http2;
+};
+
+/**
+ * Indexes the DWARF info of a Go binary and resolves all of its Go symaddrs.
+ * The TLS and HTTP2 symaddrs are only resolved if the binary has the common ones.
+ * Returns an error only if the DWARF info could not be read.
+ */
+StatusOr<GoSymAddrs> ResolveGoSymAddrs(const std::string& binary,
+                                       obj_tools::ElfReader* elf_reader);
+
 /**
  * Detects the version of OpenSSL to return the locations of all relevant symbols for OpenSSL uprobe
  * deployment.
@@ -73,5 +93,8 @@ StatusOr<struct openssl_symaddrs_t> OpenSSLSymAddrs(obj_tools::RawFptrManager* f
 StatusOr<struct node_tlswrap_symaddrs_t> NodeTLSWrapSymAddrs(const std::filesystem::path& node_exe,
                                                              const SemVer& ver);
 
+// Returns the lowercase hex MD5 hash of the contents of the file.
+StatusOr<std::string> MD5onFile(const std::string& file);
+
 }  // namespace stirling
 }  // namespace px
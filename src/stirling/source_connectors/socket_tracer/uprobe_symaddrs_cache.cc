@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/escaping.h>
+#include <absl/strings/str_split.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/file.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+// Header of the saved cache file. A change of the layout version or of the struct sizes
+// invalidates all the saved entries. The sizes catch layout changes that the version was not
+// bumped for, as long as they add or remove members.
+std::string FileHeader() {
+  return absl::Substitute("# go_symaddrs_cache v$0 $1 $2 $3", GO_SYMADDRS_LAYOUT_VERSION,
+                          sizeof(struct go_common_symaddrs_t), sizeof(struct go_tls_symaddrs_t),
+                          sizeof(struct go_http2_symaddrs_t));
+}
+
+constexpr std::string_view kAbsent = "-";
+
+template <typename TSymAddrs>
+std::string Encode(const std::optional<TSymAddrs>& symaddrs) {
+  if (!symaddrs.has_value()) {
+    return std::string(kAbsent);
+  }
+  return absl::BytesToHexString(
+      std::string_view(reinterpret_cast<const char*>(&symaddrs.value()), sizeof(TSymAddrs)));
+}
+
+template <typename TSymAddrs>
+StatusOr<std::optional<TSymAddrs>> Decode(std::string_view hex) {
+  if (hex == kAbsent) {
+    return std::optional<TSymAddrs>();
+  }
+  if (hex.size() != 2 * sizeof(TSymAddrs) ||
+      !std::all_of(hex.begin(), hex.end(), [](char c) { return absl::ascii_isxdigit(c); })) {
+    return error::InvalidArgument("Malformed symaddrs: $0", hex);
+  }
+  const std::string bytes = absl::HexStringToBytes(hex);
+  TSymAddrs symaddrs;
+  std::memcpy(&symaddrs, bytes.data(), sizeof(TSymAddrs));
+  return std::optional<TSymAddrs>(symaddrs);
+}
+
+}  // namespace
+
+const GoSymAddrs* GoSymAddrsCache::Find(const std::string& key) const {
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    return nullptr;
+  }
+  return &iter->second;
+}
+
+void GoSymAddrsCache::Insert(const std::string& key, const GoSymAddrs& symaddrs) {
+  auto [iter, inserted] = entries_.insert_or_assign(key, symaddrs);
+  PX_UNUSED(iter);
+  dirty_ = true;
+  if (!inserted) {
+    return;
+  }
+
+  insertion_order_.push_back(key);
+  while (entries_.size() > max_entries_) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+Status GoSymAddrsCache::Load(const std::filesystem::path& path) {
+  PX_ASSIGN_OR_RETURN(std::string contents, ReadFileToString(path.string()));
+
+  std::vector<std::string_view> lines = absl::StrSplit(contents, '\n', absl::SkipEmpty());
+  if (lines.empty() || lines.front() != FileHeader()) {
+    return error::FailedPrecondition(
+        "Go symaddrs cache file $0 was written by an incompatible version.", path.string());
+  }
+
+  // Parse the whole file before touching the cache, so that a malformed line leaves the cache as
+  // it was, instead of half-loaded.
+  std::vector<std::pair<std::string, GoSymAddrs>> loaded_entries;
+  loaded_entries.reserve(lines.size() - 1);
+  for (size_t i = 1; i < lines.size(); ++i) {
+    std::vector<std::string_view> fields = absl::StrSplit(lines[i], ' ');
+    if (fields.size() != 4) {
+      return error::InvalidArgument("Malformed line $0 in Go symaddrs cache file $1.", i,
+                                    path.string());
+    }
+    GoSymAddrs symaddrs;
+    PX_ASSIGN_OR_RETURN(symaddrs.common, Decode<struct go_common_symaddrs_t>(fields[1]));
+    PX_ASSIGN_OR_RETURN(symaddrs.tls, Decode<struct go_tls_symaddrs_t>(fields[2]));
+    PX_ASSIGN_OR_RETURN(symaddrs.http2, Decode<struct go_http2_symaddrs_t>(fields[3]));
+    loaded_entries.emplace_back(std::string(fields[0]), symaddrs);
+  }
+
+  for (const auto& [key, symaddrs] : loaded_entries) {
+    Insert(key, symaddrs);
+  }
+
+  dirty_ = false;
+  return Status::OK();
+}
+
+Status GoSymAddrsCache::Save(const std::filesystem::path& path) {
+  std::string contents = FileHeader();
+  contents.push_back('\n');
+  for (const std::string& key : insertion_order_) {
+    const GoSymAddrs& symaddrs = entries_.at(key);
+    absl::StrAppend(&contents, key, " ", Encode(symaddrs.common), " ", Encode(symaddrs.tls), " ",
+                    Encode(symaddrs.http2), "\n");
+  }
+
+  // Write to a temporary file first, so a crash never leaves a truncated cache behind.
+  const std::filesystem::path tmp_path = absl::StrCat(path.string(), ".tmp");
+  PX_RETURN_IF_ERROR(WriteFileFromString(tmp_path.string(), contents));
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::Internal("Could not rename $0 to $1: $2", tmp_path.string(), path.string(),
+                           ec.message());
+  }
+
+  dirty_ = false;
+  return Status::OK();
+}
+
+}  // namespace stirling
+}  // namespace px
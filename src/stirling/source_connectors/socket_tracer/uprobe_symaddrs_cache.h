@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <filesystem>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * Caches the symaddrs of Go binaries by content key (build-id, or a content hash when the binary
+ * has none), so that replicas of the same image reached through different container paths are
+ * only analyzed with DWARF once.
+ *
+ * The cache can be saved to and loaded from a local file so that the analysis also survives
+ * restarts of the agent. The file records the layout version (GO_SYMADDRS_LAYOUT_VERSION) and the
+ * sizes of the symaddrs structs, and is ignored if they don't match the ones of the running binary.
+ *
+ * Not thread-safe; UProbeManager only uses it from the (serialized) uprobe deployment thread.
+ */
+class GoSymAddrsCache {
+ public:
+  static constexpr size_t kDefaultMaxEntries = 4096;
+
+  explicit GoSymAddrsCache(size_t max_entries = kDefaultMaxEntries) : max_entries_(max_entries) {}
+
+  /**
+   * Returns the cached symaddrs for the given content key, or nullptr if there are none.
+   * The returned pointer is invalidated by the next call to Insert() or Load().
+   */
+  const GoSymAddrs* Find(const std::string& key) const;
+
+  /**
+   * Records the symaddrs of a binary. Once the cache is full, the oldest entry is evicted.
+   */
+  void Insert(const std::string& key, const GoSymAddrs& symaddrs);
+
+  /**
+   * Adds the entries saved in the given file to the cache. If the file can't be parsed, no entry
+   * is added.
+   */
+  Status Load(const std::filesystem::path& path);
+
+  /**
+   * Saves all entries to the given file, replacing it atomically.
+   */
+  Status Save(const std::filesystem::path& path);
+
+  // Whether entries were inserted since the last Load() or Save().
+  bool dirty() const { return dirty_; }
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  const size_t max_entries_;
+  absl::flat_hash_map<std::string, GoSymAddrs> entries_;
+  // Keys in insertion order, for eviction.
+  std::deque<std::string> insertion_order_;
+  bool dirty_ = false;
+};
+
+}  // namespace stirling
+}  // namespace px
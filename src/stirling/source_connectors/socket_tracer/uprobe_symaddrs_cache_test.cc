@@ -0,0 +1,151 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/common/base/file.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+GoSymAddrs TestSymAddrs(int32_t seed) {
+  GoSymAddrs symaddrs;
+  struct go_common_symaddrs_t common = {};
+  common.FD_Sysfd_offset = seed;
+  common.g_goid_offset = seed + 1;
+  symaddrs.common = common;
+
+  struct go_tls_symaddrs_t tls = {};
+  tls.Write_b_loc = location_t{.type = kLocationTypeRegisters, .offset = seed};
+  symaddrs.tls = tls;
+
+  // Leave http2 absent, as for a binary that doesn't use the golang.org/x/net/http2 library.
+  return symaddrs;
+}
+
+}  // namespace
+
+TEST(GoSymAddrsCacheTest, FindAfterInsert) {
+  GoSymAddrsCache cache;
+  EXPECT_EQ(cache.Find("gnu:abcd"), nullptr);
+
+  cache.Insert("gnu:abcd", TestSymAddrs(16));
+  const GoSymAddrs* symaddrs = cache.Find("gnu:abcd");
+  ASSERT_NE(symaddrs, nullptr);
+  ASSERT_TRUE(symaddrs->common.has_value());
+  EXPECT_EQ(symaddrs->common->FD_Sysfd_offset, 16);
+  EXPECT_EQ(symaddrs->common->g_goid_offset, 17);
+  EXPECT_FALSE(symaddrs->http2.has_value());
+  EXPECT_TRUE(cache.dirty());
+}
+
+TEST(GoSymAddrsCacheTest, EvictsOldestEntry) {
+  GoSymAddrsCache cache(/*max_entries*/ 2);
+  cache.Insert("a", TestSymAddrs(1));
+  cache.Insert("b", TestSymAddrs(2));
+  cache.Insert("c", TestSymAddrs(3));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Find("a"), nullptr);
+  EXPECT_NE(cache.Find("b"), nullptr);
+  EXPECT_NE(cache.Find("c"), nullptr);
+}
+
+TEST(GoSymAddrsCacheTest, SaveAndLoad) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "go_symaddrs_cache";
+
+  GoSymAddrsCache cache;
+  cache.Insert("gnu:abcd", TestSymAddrs(16));
+  // A binary that was analyzed but has none of the symbols is cached too.
+  cache.Insert("go:not/a/tls/binary", GoSymAddrs{});
+  ASSERT_OK(cache.Save(path));
+  EXPECT_FALSE(cache.dirty());
+
+  GoSymAddrsCache loaded_cache;
+  ASSERT_OK(loaded_cache.Load(path));
+  EXPECT_EQ(loaded_cache.size(), 2);
+  EXPECT_FALSE(loaded_cache.dirty());
+
+  const GoSymAddrs* symaddrs = loaded_cache.Find("gnu:abcd");
+  ASSERT_NE(symaddrs, nullptr);
+  ASSERT_TRUE(symaddrs->common.has_value());
+  EXPECT_EQ(symaddrs->common->FD_Sysfd_offset, 16);
+  ASSERT_TRUE(symaddrs->tls.has_value());
+  EXPECT_EQ(symaddrs->tls->Write_b_loc, (location_t{.type = kLocationTypeRegisters, .offset = 16}));
+  EXPECT_FALSE(symaddrs->http2.has_value());
+
+  symaddrs = loaded_cache.Find("go:not/a/tls/binary");
+  ASSERT_NE(symaddrs, nullptr);
+  EXPECT_FALSE(symaddrs->common.has_value());
+}
+
+TEST(GoSymAddrsCacheTest, LoadRejectsIncompatibleFile) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "go_symaddrs_cache";
+  ASSERT_OK(WriteFileFromString(path.string(), "# go_symaddrs_cache v0 1 2 3\nkey - - -\n"));
+
+  GoSymAddrsCache cache;
+  EXPECT_NOT_OK(cache.Load(path));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(GoSymAddrsCacheTest, LoadRejectsOtherLayoutVersion) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "go_symaddrs_cache";
+  // Same struct sizes, but written under another layout of the structs.
+  const std::string header = absl::Substitute(
+      "# go_symaddrs_cache v$0 $1 $2 $3", GO_SYMADDRS_LAYOUT_VERSION + 1,
+      sizeof(struct go_common_symaddrs_t), sizeof(struct go_tls_symaddrs_t),
+      sizeof(struct go_http2_symaddrs_t));
+  ASSERT_OK(WriteFileFromString(path.string(), absl::StrCat(header, "\nkey - - -\n")));
+
+  GoSymAddrsCache cache;
+  EXPECT_NOT_OK(cache.Load(path));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(GoSymAddrsCacheTest, LoadRejectsMalformedEntry) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "go_symaddrs_cache";
+
+  GoSymAddrsCache cache;
+  cache.Insert("gnu:abcd", TestSymAddrs(16));
+  ASSERT_OK(cache.Save(path));
+  ASSERT_OK_AND_ASSIGN(std::string contents, ReadFileToString(path.string()));
+  ASSERT_OK(WriteFileFromString(path.string(), absl::StrCat(contents, "gnu:1234 00 - -\n")));
+
+  // The well-formed entry before the malformed one is not loaded either.
+  GoSymAddrsCache loaded_cache;
+  EXPECT_NOT_OK(loaded_cache.Load(path));
+  EXPECT_EQ(loaded_cache.size(), 0);
+  EXPECT_EQ(loaded_cache.Find("gnu:abcd"), nullptr);
+  EXPECT_FALSE(loaded_cache.dirty());
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -66,6 +66,11 @@ DEFINE_string(stirling_sources, gflags::StringFromEnv("PL_STIRLING_SOURCES", "kP
               "comma separated list of "
               "sources (find them the header files of source connector classes).");
 
+DEFINE_bool(stirling_adaptive_push, gflags::BoolFromEnv("PL_STIRLING_ADAPTIVE_PUSH", true),
+            "If true, push a source's data tables ahead of a full batch when the next transfer is "
+            "expected to overshoot the batch size. Otherwise, push only on full batches and on "
+            "the push period.");
+
 namespace px {
 namespace stirling {
 
@@ -204,6 +209,9 @@ class StirlingImpl final : public Stirling {
   Status RemoveTracepoint(sole::uuid trace_id) override;
   void GetPublishProto(stirlingpb::Publish* publish_pb) override;
   void RegisterDataPushCallback(DataPushCallback f) override { data_push_callback_ = f; }
+  void RegisterArrowDataPushCallback(ArrowDataPushCallback f) override {
+    arrow_data_push_callback_ = f;
+  }
   void RegisterAgentMetadataCallback(AgentMetadataCallback f) override {
     DCHECK(f != nullptr);
     agent_metadata_callback_ = f;
@@ -270,6 +278,9 @@ class StirlingImpl final : public Stirling {
    */
   DataPushCallback data_push_callback_ = nullptr;
 
+  // Optional. Used to push data from data tables that build arrow arrays.
+  ArrowDataPushCallback arrow_data_push_callback_ = nullptr;
+
   AgentMetadataCallback agent_metadata_callback_ = nullptr;
   AgentMetadataType agent_metadata_;
 
@@ -443,6 +454,7 @@ Status StirlingImpl::AddSource(std::unique_ptr<SourceConnector> source) {
   }
 
   source->set_data_tables(std::move(data_tables));
+  source->push_scheduler().set_predictive(FLAGS_stirling_adaptive_push);
   sources_.push_back(std::move(source));
 
   return Status::OK();
@@ -749,29 +761,6 @@ std::chrono::milliseconds StirlingImpl::TimeUntilNextTick(const time_point now)
   return std::chrono::duration_cast<std::chrono::milliseconds>(wakeup_time - now);
 }
 
-namespace {
-
-// Returns true if any of the input tables are beyond the threshold.
-bool DataExceedsThreshold(const std::vector<DataTable*>& data_tables) {
-  // Data push threshold, based on percentage of buffer that is filled.
-  constexpr uint32_t kDefaultOccupancyPctThreshold = 100;
-
-  // Data push threshold, based number of records after which a push.
-  constexpr uint32_t kDefaultOccupancyThreshold = 1024;
-
-  for (const auto* data_table : data_tables) {
-    if (static_cast<uint32_t>(100 * data_table->OccupancyPct()) > kDefaultOccupancyPctThreshold) {
-      return true;
-    }
-    if (data_table->Occupancy() > kDefaultOccupancyThreshold) {
-      return true;
-    }
-  }
-  return false;
-}
-
-}  // namespace
-
 // Main Data Collector loop.
 // Poll on Data Source Through connectors, when appropriate, then go to sleep.
 // Must run as a thread, so only call from Run() as a thread.
@@ -834,17 +823,23 @@ void StirlingImpl::RunCore() {
           // TransferData() is normally a significant amount of work: update "time now".
           now = std::chrono::steady_clock::now();
           source->sampling_freq_mgr().Reset(now);
+          source->push_scheduler().ObserveTransfer(source->TableOccupancies());
           run_core_stats_.IncrementTransferDataCount();
         }
-        // Phase 2: Push Data upstream.
-        if (source->push_freq_mgr().Expired(now_plus_run_window) ||
-            DataExceedsThreshold(source->data_tables())) {
-          source->PushData(data_push_callback_);
+        // Phase 2: Push Data upstream, when a table holds about a full batch, or when the push
+        // period (the bound on how long records wait in the tables) expires.
+        const PushReason push_reason =
+            source->push_scheduler().Decide(source->push_freq_mgr().Expired(now_plus_run_window));
+        if (push_reason != PushReason::kNone) {
+          std::vector<size_t> batch_records = source->TableOccupancies();
+          source->PushData(data_push_callback_, arrow_data_push_callback_);
 
           // PushData() is normally a significant amount of work: update "time now".
           now = std::chrono::steady_clock::now();
           source->push_freq_mgr().Reset(now);
+          source->push_scheduler().ObservePush(source->TableOccupancies());
           run_core_stats_.IncrementPushDataCount();
+          run_core_stats_.RecordPush(push_reason, batch_records);
         }
       }
 
@@ -147,6 +147,13 @@ class Stirling : public NotCopyable {
    */
   virtual void RegisterDataPushCallback(DataPushCallback f) = 0;
 
+  /**
+   * Register a call-back from the Agent that receives data as arrow arrays.
+   * Optional: if registered, it is used instead of the DataPushCallback for data tables that build
+   * arrow arrays directly (see --stirling_data_table_arrow_builders).
+   */
+  virtual void RegisterArrowDataPushCallback(ArrowDataPushCallback f) = 0;
+
   /**
    * Register a callback from the agent to fetch the latest metadata state.
    * This state is returned is constant and valid for the duration of the shared_ptr
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/push_scheduler.h"
+
+#include <algorithm>
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+// Weight of the latest transfer in the moving average of records per transfer.
+constexpr double kIngestSmoothing = 0.25;
+
+}  // namespace
+
+void PushScheduler::Resize(size_t num_tables) {
+  if (occupancies_.size() != num_tables) {
+    occupancies_.resize(num_tables, 0);
+    records_per_transfer_.resize(num_tables, 0);
+  }
+}
+
+void PushScheduler::ObserveTransfer(const std::vector<size_t>& occupancies) {
+  Resize(occupancies.size());
+  for (size_t i = 0; i < occupancies.size(); ++i) {
+    // Records only leave a table on a push, but a table could also have been cleared elsewhere.
+    size_t added = occupancies[i] > occupancies_[i] ? occupancies[i] - occupancies_[i] : 0;
+    records_per_transfer_[i] =
+        kIngestSmoothing * added + (1 - kIngestSmoothing) * records_per_transfer_[i];
+    occupancies_[i] = occupancies[i];
+  }
+}
+
+void PushScheduler::ObservePush(const std::vector<size_t>& occupancies) {
+  Resize(occupancies.size());
+  std::copy(occupancies.begin(), occupancies.end(), occupancies_.begin());
+}
+
+PushReason PushScheduler::Decide(bool push_period_expired) const {
+  PushReason reason = PushReason::kNone;
+  for (size_t i = 0; i < occupancies_.size(); ++i) {
+    const double occupancy = occupancies_[i];
+    if (occupancy >= target_batch_records_) {
+      return PushReason::kBatchFull;
+    }
+    // Pushing now undershoots the target by (target - occupancy); waiting for the next transfer
+    // overshoots it by (occupancy + expected - target). Push now when that is the smaller miss.
+    if (predictive_ && occupancy > 0 &&
+        2 * occupancy + records_per_transfer_[i] > 2.0 * target_batch_records_) {
+      reason = PushReason::kBatchAhead;
+    }
+  }
+  if (reason == PushReason::kNone && push_period_expired) {
+    reason = PushReason::kLatency;
+  }
+  return reason;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+namespace px {
+namespace stirling {
+
+// Why the data of a source connector was pushed.
+enum class PushReason {
+  // No push is needed yet.
+  kNone,
+  // A table has buffered a full batch.
+  kBatchFull,
+  // A table is close enough to a full batch that waiting for the next transfer would overshoot
+  // it by more than pushing now undershoots it.
+  kBatchAhead,
+  // The push period, which bounds how long records wait in the tables, has expired.
+  kLatency,
+};
+
+/**
+ * Picks when to push the data tables of a source connector, so that the batches handed to the
+ * table store are close to a target size, without holding records longer than the push period.
+ *
+ * The scheduler observes the occupancy of each table after every transfer, and keeps a moving
+ * average of how many records each transfer adds. A table is pushed early when pushing now gets
+ * its batch closer to the target than waiting for one more transfer would.
+ */
+class PushScheduler {
+  using time_point = std::chrono::steady_clock::time_point;
+
+ public:
+  explicit PushScheduler(size_t target_batch_records = kDefaultTargetBatchRecords)
+      : target_batch_records_(target_batch_records) {}
+
+  /**
+   * Records the occupancy of each table after a transfer.
+   */
+  void ObserveTransfer(const std::vector<size_t>& occupancies);
+
+  /**
+   * Records the occupancy of each table right after a push. Normally the tables are empty, but
+   * records past a table's cutoff time stay buffered.
+   */
+  void ObservePush(const std::vector<size_t>& occupancies);
+
+  /**
+   * Returns why the tables should be pushed now, or PushReason::kNone.
+   *
+   * @param push_period_expired Whether the latency bound on the buffered records has expired.
+   */
+  PushReason Decide(bool push_period_expired) const;
+
+  // Setting this to false pushes only on full batches and on the push period, as before the
+  // scheduler existed.
+  void set_predictive(bool predictive) { predictive_ = predictive; }
+
+  size_t target_batch_records() const { return target_batch_records_; }
+  const std::vector<double>& records_per_transfer() const { return records_per_transfer_; }
+
+  static constexpr size_t kDefaultTargetBatchRecords = 1024;
+
+ private:
+  void Resize(size_t num_tables);
+
+  const size_t target_batch_records_;
+  bool predictive_ = true;
+
+  // The occupancy of each table, as of the last transfer or push.
+  std::vector<size_t> occupancies_;
+
+  // Exponential moving average of the records added to each table per transfer.
+  std::vector<double> records_per_transfer_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/push_scheduler.h"
+
+#include <gtest/gtest.h>
+
+namespace px {
+namespace stirling {
+
+TEST(PushSchedulerTest, PushesOnFullBatch) {
+  PushScheduler scheduler(100);
+  EXPECT_EQ(scheduler.Decide(/*push_period_expired*/ false), PushReason::kNone);
+
+  scheduler.ObserveTransfer({10, 0});
+  EXPECT_EQ(scheduler.Decide(false), PushReason::kNone);
+  EXPECT_EQ(scheduler.Decide(true), PushReason::kLatency);
+
+  scheduler.ObserveTransfer({10, 100});
+  EXPECT_EQ(scheduler.Decide(false), PushReason::kBatchFull);
+  EXPECT_EQ(scheduler.Decide(true), PushReason::kBatchFull);
+
+  scheduler.ObservePush({0, 0});
+  EXPECT_EQ(scheduler.Decide(false), PushReason::kNone);
+}
+
+// Tests that a table is pushed ahead of a full batch, when the next transfer is expected to
+// overshoot the target by more than the table currently falls short of it.
+TEST(PushSchedulerTest, PushesAheadOfIngest) {
+  PushScheduler scheduler(100);
+  // Each transfer adds 40 records. The moving average converges to that.
+  size_t occupancy = 0;
+  for (int i = 0; i < 20; ++i) {
+    occupancy += 40;
+    scheduler.ObserveTransfer({occupancy});
+    scheduler.ObservePush({0});
+    occupancy = 0;
+  }
+  EXPECT_NEAR(scheduler.records_per_transfer()[0], 40, 1);
+
+  // At 70 records, the next transfer is expected to bring the table to 110 records: waiting
+  // overshoots by 10, pushing now undershoots by 30.
+  scheduler.ObserveTransfer({70});
+  EXPECT_EQ(scheduler.Decide(false), PushReason::kNone);
+
+  // At 90 records, the next transfer overshoots by 30, pushing now undershoots by 10.
+  scheduler.ObservePush({50});
+  scheduler.ObserveTransfer({90});
+  EXPECT_EQ(scheduler.Decide(false), PushReason::kBatchAhead);
+
+  scheduler.set_predictive(false);
+  EXPECT_EQ(scheduler.Decide(false), PushReason::kNone);
+  EXPECT_EQ(scheduler.Decide(true), PushReason::kLatency);
+}
+
+}  // namespace stirling
+}  // namespace px
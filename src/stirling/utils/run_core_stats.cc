@@ -18,6 +18,11 @@
 
 #include "src/stirling/utils/run_core_stats.h"
 
+#include <array>
+#include <limits>
+
+#include <magic_enum.hpp>
+
 namespace px {
 namespace stirling {
 
@@ -48,6 +53,11 @@ static constexpr std::array<std::chrono::nanoseconds, 23> kSleepBuckets = {
     std::chrono::nanoseconds{1000000000},
     std::chrono::nanoseconds{10000000000000}};
 
+// Upper bounds of the batch size histogram buckets, in records. Centered around the default
+// target batch size of the push scheduler.
+static constexpr std::array<size_t, 10> kBatchRecordsBuckets = {
+    16, 64, 256, 512, 1024, 2048, 4096, 16384, 65536, std::numeric_limits<size_t>::max()};
+
 std::string CreateHeaderString() {
   std::stringstream s;
 
@@ -60,6 +70,14 @@ std::string CreateHeaderString() {
   for (const auto bucket : kSleepBuckets) {
     s << absl::StrFormat(",no_work_%.2f_ms", static_cast<double>(bucket.count()) / 1e6);
   }
+  for (const auto reason : magic_enum::enum_values<PushReason>()) {
+    if (reason != PushReason::kNone) {
+      s << absl::StrCat(",push_", magic_enum::enum_name(reason));
+    }
+  }
+  for (const auto bucket : kBatchRecordsBuckets) {
+    s << absl::StrCat(",batch_le_", bucket);
+  }
   // header_string_ = s.str();
   return s.str();
 }
@@ -69,7 +87,9 @@ std::string CreateHeaderString() {
 RunCoreStats::RunCoreStats()
     : header_string_(CreateHeaderString()),
       sleep_histo_(kSleepBuckets.size(), 0),
-      no_work_histo_(kSleepBuckets.size(), 0) {}
+      no_work_histo_(kSleepBuckets.size(), 0),
+      push_reason_counts_(magic_enum::enum_count<PushReason>(), 0),
+      batch_records_histo_(kBatchRecordsBuckets.size(), 0) {}
 
 void RunCoreStats::IncrementTransferDataCount() {
   ++num_transfer_data_;
@@ -81,9 +101,29 @@ void RunCoreStats::IncrementPushDataCount() {
   ++push_or_transfer_this_iter_;
 }
 
+void RunCoreStats::RecordPush(const PushReason reason, const std::vector<size_t>& batch_records) {
+  ++push_reason_counts_[static_cast<size_t>(reason)];
+  for (const size_t num_records : batch_records) {
+    if (num_records == 0) {
+      continue;
+    }
+    // The last bucket catches everything, so there is no fall through case.
+    for (size_t i = 0; i < kBatchRecordsBuckets.size(); ++i) {
+      if (num_records <= kBatchRecordsBuckets[i]) {
+        ++batch_records_histo_[i];
+        break;
+      }
+    }
+  }
+}
+
 void RunCoreStats::LogStats() const {
   std::string s = absl::StrJoin(sleep_histo_, ",");
   absl::StrAppend(&s, ",", absl::StrJoin(no_work_histo_, ","));
+  // Skip the count for PushReason::kNone, which is never recorded.
+  absl::StrAppend(&s, ",",
+                  absl::StrJoin(push_reason_counts_.begin() + 1, push_reason_counts_.end(), ","));
+  absl::StrAppend(&s, ",", absl::StrJoin(batch_records_histo_, ","));
 
   LOG(INFO) << absl::Substitute("|$0,$1,$2,$3,$4,$5,$6,$7,$8", num_main_loop_iters_,
                                 num_no_work_iters_, (num_main_loop_iters_ - num_no_work_iters_),
@@ -137,6 +177,15 @@ uint64_t RunCoreStats::NoWorkCountForDuration(const std::chrono::nanoseconds d)
   return 0;
 }
 
+uint64_t RunCoreStats::BatchCountForRecords(const size_t num_records) const {
+  for (size_t i = 0; i < kBatchRecordsBuckets.size(); ++i) {
+    if (num_records <= kBatchRecordsBuckets[i]) {
+      return batch_records_histo_[i];
+    }
+  }
+  return 0;
+}
+
 void RunCoreStats::UpdateSleepDurationHisto(const std::chrono::milliseconds d,
                                             std::vector<uint64_t>* h) {
   // "d" is the sleep duration and "h" is the histogram that we will upate.
@@ -27,13 +27,15 @@
 #include <absl/strings/str_join.h>
 
 #include "src/common/base/base.h"
+#include "src/stirling/utils/push_scheduler.h"
 
 namespace px {
 namespace stirling {
 
 // RunCoreStats tracks the work done in each iteration of StirlingImpl::RunCore.
-// It counts the number of PushData() and TransferData() calls.
-// It also keeps a histogram of sleep durations: total, and those sleeps where no work is done.
+// It counts the number of PushData() and TransferData() calls, and why data was pushed.
+// It also keeps a histogram of sleep durations: total, and those sleeps where no work is done,
+// and a histogram of the number of records in each pushed table.
 class RunCoreStats {
  public:
   RunCoreStats();
@@ -42,6 +44,9 @@ class RunCoreStats {
   void IncrementTransferDataCount();
   void IncrementPushDataCount();
 
+  // Records the reason for a push, and the number of records pushed from each table.
+  void RecordPush(PushReason reason, const std::vector<size_t>& batch_records);
+
   // Logs the stats.
   void LogStats() const;
 
@@ -61,6 +66,11 @@ class RunCoreStats {
   // For now, they are useful only for the test case in run_core_stats_test.cc.
   uint64_t SleepCountForDuration(std::chrono::nanoseconds d) const;
   uint64_t NoWorkCountForDuration(std::chrono::nanoseconds d) const;
+  uint64_t BatchCountForRecords(size_t num_records) const;
+
+  uint64_t num_push_for_reason(PushReason reason) const {
+    return push_reason_counts_[static_cast<size_t>(reason)];
+  }
 
  private:
   // Update a particular sleep histogram (passed in as *h). Called by EndIter().
@@ -78,6 +88,8 @@ class RunCoreStats {
   uint64_t push_or_transfer_this_iter_ = 0;
   std::vector<uint64_t> sleep_histo_;
   std::vector<uint64_t> no_work_histo_;
+  std::vector<uint64_t> push_reason_counts_;
+  std::vector<uint64_t> batch_records_histo_;
 };
 
 }  // namespace stirling
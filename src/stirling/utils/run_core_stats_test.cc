@@ -63,6 +63,18 @@ TEST(RunCoreStatsTest, RunCoreStatsTest) {
   EXPECT_EQ(0, stats.SleepCountForDuration(std::chrono::milliseconds{1}));
   EXPECT_EQ(0, stats.NoWorkCountForDuration(std::chrono::milliseconds{2}));
 
+  // Pushes record why they happened, and how many records each table pushed.
+  stats.RecordPush(PushReason::kBatchFull, {1100, 0});
+  stats.RecordPush(PushReason::kLatency, {3, 900});
+  stats.RecordPush(PushReason::kBatchAhead, {1000});
+  EXPECT_EQ(1, stats.num_push_for_reason(PushReason::kBatchFull));
+  EXPECT_EQ(1, stats.num_push_for_reason(PushReason::kBatchAhead));
+  EXPECT_EQ(1, stats.num_push_for_reason(PushReason::kLatency));
+  EXPECT_EQ(1, stats.BatchCountForRecords(3));
+  EXPECT_EQ(2, stats.BatchCountForRecords(1000));
+  EXPECT_EQ(1, stats.BatchCountForRecords(2000));
+  EXPECT_EQ(0, stats.BatchCountForRecords(100000));
+
   // Now we can admire the printout.
   stats.LogStats();
 }
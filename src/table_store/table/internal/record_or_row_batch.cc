@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <memory>
 #include <vector>
 
 #include "src/common/base/utils.h"
@@ -103,6 +104,24 @@ Time RecordOrRowBatch::GetTimeValue(int64_t time_col_idx, int64_t row_idx) const
                     batch_);
 }
 
+RecordOrRowBatch RecordOrRowBatch::ShallowCopy() const {
+  auto copy = std::visit(
+      overloaded{
+          [](const RecordBatchWithCache& record_batch_w_cache) {
+            const auto& record_batch = *record_batch_w_cache.record_batch;
+            return RecordOrRowBatch(RecordBatchWithCache{
+                std::make_unique<types::ColumnWrapperRecordBatch>(record_batch),
+                std::vector<ArrowArrayPtr>(record_batch.size()),
+                std::vector<bool>(record_batch.size(), false),
+            });
+          },
+          [](const schema::RowBatch& row_batch) { return RecordOrRowBatch(row_batch); },
+      },
+      batch_);
+  copy.row_offset_ = row_offset_;
+  return copy;
+}
+
 void RecordOrRowBatch::RemovePrefix(size_t num_rows) { row_offset_ += num_rows; }
 
 Status RecordOrRowBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_size,
@@ -48,6 +48,15 @@ class RecordOrRowBatch {
 
   RecordOrRowBatch(RecordOrRowBatch&&) = default;
 
+  /**
+   * ShallowCopy returns a RecordOrRowBatch that shares the underlying column data with this batch,
+   * and has the same row offset. The column data is never mutated once it's in the table, so the
+   * copy can be read without holding the lock that protects this batch. The copy starts with an
+   * empty arrow cache.
+   * @return the shallow copy.
+   */
+  RecordOrRowBatch ShallowCopy() const;
+
   /**
    * Length returns the number of rows in this record or row batch.
    * @return number of rows.
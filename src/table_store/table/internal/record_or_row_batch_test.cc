@@ -111,6 +111,22 @@ TEST_P(RecordOrRowBatchTest, RemovePrefix_GetTimeValue) {
   EXPECT_EQ(25, rb_->GetTimeValue(time_col_idx_, 1));
 }
 
+TEST_P(RecordOrRowBatchTest, ShallowCopy) {
+  rb_->RemovePrefix(1);
+  auto copy = rb_->ShallowCopy();
+  EXPECT_EQ(3, copy.Length());
+  EXPECT_EQ(10, copy.GetTimeValue(time_col_idx_, 0));
+
+  // Removing a prefix from the original should not affect the copy.
+  rb_->RemovePrefix(2);
+  EXPECT_EQ(3, copy.Length());
+  EXPECT_EQ(10, copy.GetTimeValue(time_col_idx_, 0));
+
+  // The copy should still be valid after the original is destroyed.
+  rb_.reset();
+  EXPECT_EQ(25, copy.GetTimeValue(time_col_idx_, 2));
+}
+
 TEST_P(RecordOrRowBatchTest, AddBatchSliceToRowBatch) {
   schema::RowBatch rb0(schema::RowDescriptor(rel_->col_types()), 2);
   EXPECT_OK(rb_->AddBatchSliceToRowBatch(0, 2, {0, 1, 2}, &rb0));
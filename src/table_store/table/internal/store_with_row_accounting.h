@@ -154,6 +154,16 @@ class StoreWithRowTimeAccounting {
     return batches_.front();
   }
 
+  /**
+   * at returns the batch at the given index, counting from the first batch in the store.
+   * @param idx, index of the batch relative to the front of the store.
+   * @return lvalue reference to the batch.
+   */
+  const TBatch& at(size_t idx) const {
+    DCHECK_LT(idx, batches_.size());
+    return batches_[idx];
+  }
+
   /**
    * PopFront removes the first batch in the store, and returns an rvalue reference to it.
    * @return rvalue reference to the removed batch.
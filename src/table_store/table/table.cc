@@ -17,8 +17,10 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <deque>
 #include <iterator>
 #include <memory>
 #include <optional>
@@ -57,6 +59,7 @@ Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop)
 void Table::Cursor::AdvanceToStart(const StartSpec& start) {
   switch (start.type) {
     case StartSpec::StartType::StartAtTime: {
+      table_->RecordQueriedTime(start.start_time);
       last_read_row_id_ = table_->FindRowIDFromTimeFirstGreaterThanOrEqual(start.start_time) - 1;
       break;
     }
@@ -240,8 +243,9 @@ StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
 Status Table::ExpireRowBatches(int64_t row_batch_size) {
   if (row_batch_size > max_table_size_) {
     return error::InvalidArgument("RowBatch size ($0) is bigger than maximum table size ($1).",
-                                  row_batch_size, max_table_size_);
+                                  row_batch_size, max_table_size_.load());
   }
+  absl::MutexLock expiry_lock(&expiry_lock_);
   int64_t bytes;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
@@ -292,6 +296,46 @@ Status Table::TransferRecordBatch(
   return Status::OK();
 }
 
+Status Table::TransferArrowRecordBatch(
+    std::unique_ptr<px::types::ArrowArrayRecordBatch> record_batch) {
+  // Don't transfer over empty row batches.
+  if (record_batch->empty() || record_batch->at(0)->length() == 0) {
+    return Status::OK();
+  }
+  PX_RETURN_IF_ERROR(ValidateArrowRecordBatch(rel_, *record_batch));
+
+  schema::RowBatch rb(schema::RowDescriptor(rel_.col_types()), record_batch->at(0)->length());
+  for (auto& col : *record_batch) {
+    PX_RETURN_IF_ERROR(rb.AddColumn(std::move(col)));
+  }
+  internal::RecordOrRowBatch record_or_row_batch(rb);
+
+  PX_RETURN_IF_ERROR(WriteHot(std::move(record_or_row_batch)));
+  return Status::OK();
+}
+
+Status Table::ValidateArrowRecordBatch(const schema::Relation& rel,
+                                       const px::types::ArrowArrayRecordBatch& record_batch) {
+  if (record_batch.size() != rel.NumColumns()) {
+    return error::InvalidArgument("Expected $0 columns, got $1", rel.NumColumns(),
+                                  record_batch.size());
+  }
+  for (size_t i = 0; i < record_batch.size(); ++i) {
+    const auto& col = record_batch[i];
+    if (col->type_id() != types::ToArrowType(rel.GetColumnType(i))) {
+      return error::InvalidArgument("Column $0 ($1) has arrow type $2, expected $3", i,
+                                    rel.GetColumnName(i), col->type()->ToString(),
+                                    types::ToString(rel.GetColumnType(i)));
+    }
+    if (col->length() != record_batch[0]->length()) {
+      return error::InvalidArgument("Column $0 ($1) has $2 rows, expected $3", i,
+                                    rel.GetColumnName(i), col->length(),
+                                    record_batch[0]->length());
+    }
+  }
+  return Status::OK();
+}
+
 Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
   // See BatchSizeAccountantNonMutableState for an explanation of the thread safety and necessity of
   // NonMutableState.
@@ -300,13 +344,17 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
 
   PX_RETURN_IF_ERROR(ExpireRowBatches(batch_stats.bytes));
 
+  std::chrono::nanoseconds stall_time;
   {
+    auto lock_start = std::chrono::steady_clock::now();
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    stall_time = std::chrono::steady_clock::now() - lock_start;
     auto batch_length = record_or_row_batch.Length();
     batch_size_accountant_->NewHotBatch(std::move(batch_stats));
     hot_store_->EmplaceBack(next_row_id_, std::move(record_or_row_batch));
     next_row_id_ += batch_length;
   }
+  metrics_.writer_stall_ns_counter.Increment(stall_time.count());
 
   {
     absl::base_internal::SpinLockHolder lock(&stats_lock_);
@@ -417,35 +465,96 @@ TableStats Table::GetTableStats() const {
   info.compacted_batches = compacted_batches_;
   info.max_table_size = max_table_size_;
   info.min_time = min_time;
+  auto oldest_queried_time = oldest_queried_time_.load();
+  info.oldest_queried_time = oldest_queried_time == kNotQueried ? -1 : oldest_queried_time;
 
   return info;
 }
 
-Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
-  const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
+Status Table::SetMaxTableSize(int64_t max_table_size) {
+  max_table_size_ = max_table_size;
+  metrics_.max_table_size_gauge.Set(max_table_size);
+  // Expiring to fit a zero byte batch, expires until the table is within the new limit.
+  return ExpireRowBatches(0);
+}
+
+void Table::RecordQueriedTime(Time time) const {
+  auto oldest = oldest_queried_time_.load();
+  while (time < oldest && !oldest_queried_time_.compare_exchange_weak(oldest, time)) {
+  }
+}
 
-  PX_RETURN_IF_ERROR(
-      compactor_.Reserve(compaction_spec.num_rows, compaction_spec.variable_col_bytes));
+std::optional<Table::Time> Table::TakeOldestQueriedTime() {
+  auto oldest = oldest_queried_time_.exchange(kNotQueried);
+  if (oldest == kNotQueried) {
+    return std::nullopt;
+  }
+  return oldest;
+}
 
-  RowID first_row_id = -1;
-  for (auto hot_slice : compaction_spec.hot_slices) {
-    if (first_row_id == -1) {
-      first_row_id = hot_store_->FirstRowID() + hot_slice.start_row;
+StatusOr<bool> Table::CompactSingleBatch(arrow::MemoryPool*) {
+  size_t num_rows = 0;
+  std::vector<uint64_t> variable_col_bytes;
+  std::deque<internal::BatchSizeAccountant::CompactedBatchSpec::HotSlice> hot_slices;
+  std::vector<internal::RecordOrRowBatch> hot_batches;
+  RowID hot_first_row_id = -1;
+  {
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    if (!batch_size_accountant_->CompactedBatchReady()) {
+      return false;
+    }
+    const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
+    num_rows = compaction_spec.num_rows;
+    variable_col_bytes = compaction_spec.variable_col_bytes;
+    hot_slices = compaction_spec.hot_slices;
+    hot_first_row_id = hot_store_->FirstRowID();
+    // Snapshot the hot batches covered by the spec. These share the column data with the hot
+    // store, so this only costs a few refcount increments per batch.
+    size_t batch_idx = 0;
+    for (const auto& hot_slice : hot_slices) {
+      if (hot_batches.size() == batch_idx) {
+        hot_batches.push_back(hot_store_->at(batch_idx).ShallowCopy());
+      }
+      if (hot_slice.last_slice_for_batch) {
+        ++batch_idx;
+      }
     }
+  }
 
-    compactor_.UnsafeAppendBatchSlice(hot_store_->front(), hot_slice.start_row, hot_slice.end_row);
+  // Build the cold batch without holding any table lock, so that writers and readers are not
+  // blocked on the copy.
+  PX_RETURN_IF_ERROR(compactor_.Reserve(num_rows, variable_col_bytes));
+  size_t batch_idx = 0;
+  size_t num_hot_batches_to_pop = 0;
+  for (const auto& hot_slice : hot_slices) {
+    compactor_.UnsafeAppendBatchSlice(hot_batches[batch_idx], hot_slice.start_row,
+                                      hot_slice.end_row);
     if (hot_slice.last_slice_for_batch) {
-      hot_store_->PopFront();
+      ++batch_idx;
+      ++num_hot_batches_to_pop;
     }
   }
-
   PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
 
-  cold_store_->EmplaceBack(first_row_id, out_columns);
-
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
-  if (num_rows_to_remove > 0) {
-    hot_store_->RemovePrefix(num_rows_to_remove);
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    // Only compactions (which are serialized) and expiration remove rows from the front of the hot
+    // store. So if the first row changed, some of the snapshotted rows were expired and the
+    // compacted batch is stale.
+    if (hot_store_->Size() == 0 || hot_store_->FirstRowID() != hot_first_row_id) {
+      metrics_.compactions_discarded_counter.Increment();
+      return true;
+    }
+    cold_store_->EmplaceBack(hot_first_row_id + hot_slices.front().start_row,
+                             std::move(out_columns));
+    for (size_t i = 0; i < num_hot_batches_to_pop; ++i) {
+      hot_store_->PopFront();
+    }
+    auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
+    if (num_rows_to_remove > 0) {
+      hot_store_->RemovePrefix(num_rows_to_remove);
+    }
   }
 
   {
@@ -453,26 +562,27 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
     compacted_batches_++;
     metrics_.compacted_batches_counter.Increment();
   }
-  return Status::OK();
+  return true;
 }
 
 Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
-  bool next_ready = false;
+  absl::MutexLock compaction_lock(&compaction_lock_);
+  auto start = std::chrono::steady_clock::now();
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    next_ready = batch_size_accountant_->CompactedBatchReady();
+    metrics_.compaction_backlog_bytes_gauge.Set(batch_size_accountant_->HotBytes());
   }
-  while (next_ready) {
-    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    // We have to check CompactedBatchReady() again, in case hot batches were expired since the last
-    // check.
-    if (!batch_size_accountant_->CompactedBatchReady()) {
+  for (int64_t i = 0; i < kMaxBatchesPerCompactionCall; ++i) {
+    PX_ASSIGN_OR_RETURN(bool compacted, CompactSingleBatch(mem_pool));
+    if (!compacted) {
       break;
     }
-    PX_RETURN_IF_ERROR(CompactSingleBatchUnlocked(mem_pool));
-    next_ready = batch_size_accountant_->CompactedBatchReady();
   }
+  auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  metrics_.compaction_duration_ns_counter.Increment(duration);
+  metrics_.compaction_last_duration_ns_gauge.Set(duration);
   return Status::OK();
 }
 
@@ -22,7 +22,9 @@
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -64,8 +66,13 @@ struct TableStats {
   int64_t batches_expired;
   int64_t bytes_added;
   int64_t compacted_batches;
+  // The current size limit of the table. When the TableStore has a memory budget, this is the
+  // table's adaptive quota.
   int64_t max_table_size;
   int64_t min_time;
+  // The oldest start time requested by a cursor since the memory budget last sampled it, or -1 if
+  // the table hasn't been queried with a start time.
+  int64_t oldest_queried_time;
 };
 
 /**
@@ -78,12 +85,20 @@ struct TableStats {
  * and `Time and Row Indexing` below).
  *
  * Synchronization Scheme:
- * The hot and cold partitions are synchronized separately with spinlocks.
+ * The hot and cold partitions are synchronized separately with spinlocks. Compactions are
+ * serialized with a separate mutex, so that the spinlocks are never held while a compacted batch is
+ * being built. Expirations are serialized with another mutex, since both the writer (to make room
+ * for a new batch) and SetMaxTableSize (from the thread rebalancing the memory budget) expire
+ * batches.
  *
  * Compaction Scheme:
  * Hot batches are compacted into batches of size roughly `compacted_batch_size_` +/- the size of a
  * single row.  The compaction routine should be called periodically but that is not the
- * responsibility of this class.
+ * responsibility of this class. Each compacted batch is built in three steps: the hot batches that
+ * make up the batch are snapshotted (by reference) under the hot lock, the cold batch is built from
+ * the snapshot without holding any table lock, and finally the cold batch is published while
+ * briefly holding both locks. If hot batches were expired while the cold batch was being built, the
+ * cold batch is discarded and the compaction is retried.
  *
  * Time and Row Indexing:
  * The first and last values of the time columns for each batch are stored in
@@ -282,6 +297,26 @@ class Table : public NotCopyable {
    */
   Status TransferRecordBatch(std::unique_ptr<px::types::ColumnWrapperRecordBatch> record_batch);
 
+  /**
+   * Transfers the given arrow arrays (from Stirling) into the Table. Unlike
+   * TransferRecordBatch(), the data does not need to be converted to arrow later on.
+   *
+   * @param record_batch the columns to be appended to the Table.
+   * @return status
+   */
+  Status TransferArrowRecordBatch(std::unique_ptr<px::types::ArrowArrayRecordBatch> record_batch);
+
+  /**
+   * Checks that the given arrow arrays can be stored in a table with the given relation: there is
+   * one array per column, of the column's type, and all of them have the same length.
+   *
+   * @param rel the relation of the table.
+   * @param record_batch the columns to check.
+   * @return InvalidArgument error if they don't match.
+   */
+  static Status ValidateArrowRecordBatch(const schema::Relation& rel,
+                                         const px::types::ArrowArrayRecordBatch& record_batch);
+
   schema::Relation GetRelation() const;
   StatusOr<std::vector<RecordBatchSPtr>> GetTableAsRecordBatches() const;
 
@@ -294,6 +329,21 @@ class Table : public NotCopyable {
 
   TableStats GetTableStats() const;
 
+  /**
+   * Changes the maximum size of the table, expiring the oldest batches if the table is now over
+   * the limit.
+   * @param max_table_size the new maximum number of bytes that the table can hold.
+   * @return error if expiring batches fails.
+   */
+  Status SetMaxTableSize(int64_t max_table_size);
+
+  /**
+   * Returns the oldest start time requested by a cursor since the last call to this method, and
+   * resets it. Used to size the table by query demand.
+   * @return the oldest queried time, or std::nullopt if there were no queries with a start time.
+   */
+  std::optional<Time> TakeOldestQueriedTime();
+
   /**
    * Compacts hot batches into compacted_batch_size_ sized cold batches. Each call to
    * CompactHotToCold will create a maximum of kMaxBatchesPerCompactionCall cold batches.
@@ -311,7 +361,7 @@ class Table : public NotCopyable {
   int64_t batches_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t bytes_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t compacted_batches_ ABSL_GUARDED_BY(stats_lock_) = 0;
-  int64_t max_table_size_ = 0;
+  std::atomic<int64_t> max_table_size_ = 0;
   const int64_t compacted_batch_size_;
   mutable absl::base_internal::SpinLock hot_lock_;
   std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>> hot_store_
@@ -332,16 +382,27 @@ class Table : public NotCopyable {
   Status ExpireBatch();
   Status ExpireHot();
   StatusOr<bool> ExpireCold();
-  Status ExpireRowBatches(int64_t row_batch_size);
-  Status CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  Status ExpireRowBatches(int64_t row_batch_size) ABSL_LOCKS_EXCLUDED(expiry_lock_);
+  // Compacts the next compacted batch from the hot store into the cold store. Returns false if
+  // there was no compacted batch ready.
+  StatusOr<bool> CompactSingleBatch(arrow::MemoryPool* mem_pool)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(compaction_lock_);
   Status UpdateTableMetricGauges();
 
   Time MaxTime() const;
+  void RecordQueriedTime(Time time) const;
+
+  static inline constexpr Time kNotQueried = std::numeric_limits<Time>::max();
+  // Oldest start time requested by a cursor, see TakeOldestQueriedTime().
+  mutable std::atomic<Time> oldest_queried_time_ = kNotQueried;
 
   std::unique_ptr<internal::BatchSizeAccountant> batch_size_accountant_ ABSL_GUARDED_BY(hot_lock_);
 
-  internal::ArrowArrayCompactor compactor_;
+  absl::Mutex compaction_lock_;
+  // Held for a whole expiry loop, so that concurrent expirations don't both expire the same excess
+  // bytes.
+  absl::Mutex expiry_lock_;
+  internal::ArrowArrayCompactor compactor_ ABSL_GUARDED_BY(compaction_lock_);
 
   friend class Cursor;
 };
@@ -19,6 +19,7 @@
 #include <absl/synchronization/barrier.h>
 #include <absl/synchronization/notification.h>
 #include <benchmark/benchmark.h>
+#include <algorithm>
 #include <chrono>
 #include <deque>
 #include <numeric>
@@ -360,6 +361,41 @@ static void BM_TableThreaded(benchmark::State& state) {
   state.counters["Write"] = benchmark::Counter(write_average_time);
 }
 
+// Measures write latency while a compaction thread continuously compacts large batches. Before
+// compaction was made non-blocking, writers would spin for the duration of each batch copy.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableWriteDuringCompaction(benchmark::State& state) {
+  int64_t compaction_size = state.range(0);
+  int64_t table_size = 64 * 1024 * 1024;
+  int64_t batch_length = 256;
+  std::shared_ptr<Table> table_ptr = MakeTable(table_size, compaction_size);
+  int64_t time_counter = FillTableHot(table_ptr.get(), table_size / 2, batch_length);
+
+  auto done = std::make_shared<absl::Notification>();
+  std::thread compaction_thread([table_ptr, done]() {
+    while (!done->HasBeenNotified()) {
+      PX_CHECK_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+    }
+  });
+
+  std::vector<double> write_times;
+  for (auto _ : state) {
+    auto batch = MakeHotBatch(batch_length, &time_counter);
+    auto start = std::chrono::high_resolution_clock::now();
+    PX_CHECK_OK(table_ptr->TransferRecordBatch(std::move(batch)));
+    auto end = std::chrono::high_resolution_clock::now();
+    auto elapsed_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+    state.SetIterationTime(elapsed_seconds.count());
+    write_times.push_back(elapsed_seconds.count());
+  }
+  done->Notify();
+  compaction_thread.join();
+
+  std::sort(write_times.begin(), write_times.end());
+  state.counters["WriteP99"] = benchmark::Counter(write_times[write_times.size() * 99 / 100]);
+  state.counters["WriteMax"] = benchmark::Counter(write_times.back());
+}
+
 BENCHMARK(BM_TableReadAllHot);
 BENCHMARK(BM_TableReadAllCold);
 BENCHMARK(BM_TableReadLastBatchAllHot)->Iterations(1000);
@@ -368,5 +404,9 @@ BENCHMARK(BM_TableWriteEmpty);
 BENCHMARK(BM_TableWriteFull);
 BENCHMARK(BM_TableCompaction);
 BENCHMARK(BM_TableThreaded)->UseManualTime()->Iterations(1);
+BENCHMARK(BM_TableWriteDuringCompaction)
+    ->UseManualTime()
+    ->RangeMultiplier(16)
+    ->Range(64 * 1024, 16 * 1024 * 1024);
 
 }  // namespace px::table_store
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/table_compaction_scheduler.h"
+
+#include <utility>
+
+#include "src/common/metrics/metrics.h"
+
+DEFINE_int32(table_store_compaction_threads,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_THREADS", 2),
+             "The number of background threads used to compact tables. If 0, tables are compacted "
+             "on the agent's event loop.");
+
+namespace px {
+namespace table_store {
+
+TableCompactionScheduler::TableCompactionScheduler(size_t num_threads, arrow::MemoryPool* mem_pool)
+    : mem_pool_(mem_pool),
+      queue_size_gauge_(BuildGauge("table_store_compaction_queue_size",
+                                   "Number of tables waiting to be compacted")) {
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&TableCompactionScheduler::RunWorker, this);
+  }
+}
+
+TableCompactionScheduler::~TableCompactionScheduler() { Stop(); }
+
+void TableCompactionScheduler::Schedule(const std::vector<std::shared_ptr<Table>>& tables) {
+  if (threads_.empty()) {
+    for (const auto& table : tables) {
+      Compact(table.get());
+    }
+    return;
+  }
+
+  // Get the backlog before taking the lock, since it requires taking the table's locks.
+  std::vector<QueuedTable> to_queue;
+  to_queue.reserve(tables.size());
+  for (const auto& table : tables) {
+    to_queue.push_back(QueuedTable{table->GetTableStats().hot_bytes, table});
+  }
+
+  absl::MutexLock lock(&lock_);
+  if (stopped_) {
+    return;
+  }
+  for (auto& queued_table : to_queue) {
+    if (pending_.insert(queued_table.table.get()).second) {
+      queue_.push(std::move(queued_table));
+    }
+  }
+  queue_size_gauge_.Set(queue_.size());
+}
+
+void TableCompactionScheduler::Stop() {
+  {
+    absl::MutexLock lock(&lock_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+
+  absl::MutexLock lock(&lock_);
+  while (!queue_.empty()) {
+    pending_.erase(queue_.top().table.get());
+    queue_.pop();
+  }
+  queue_size_gauge_.Set(0);
+}
+
+void TableCompactionScheduler::WaitForIdle() {
+  absl::MutexLock lock(&lock_, absl::Condition(this, &TableCompactionScheduler::Idle));
+}
+
+void TableCompactionScheduler::Compact(Table* table) {
+  auto s = table->CompactHotToCold(mem_pool_);
+  LOG_IF(ERROR, !s.ok()) << s.msg();
+}
+
+void TableCompactionScheduler::RunWorker() {
+  while (true) {
+    std::shared_ptr<Table> table;
+    {
+      absl::MutexLock lock(&lock_,
+                           absl::Condition(this, &TableCompactionScheduler::WorkAvailable));
+      if (stopped_) {
+        return;
+      }
+      table = queue_.top().table;
+      queue_.pop();
+      queue_size_gauge_.Set(queue_.size());
+    }
+
+    Compact(table.get());
+
+    absl::MutexLock lock(&lock_);
+    pending_.erase(table.get());
+  }
+}
+
+}  // namespace table_store
+}  // namespace px
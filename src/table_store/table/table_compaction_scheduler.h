@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+#include <arrow/memory_pool.h>
+#include <prometheus/gauge.h>
+
+#include <memory>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table.h"
+
+DECLARE_int32(table_store_compaction_threads);
+
+namespace px {
+namespace table_store {
+
+/**
+ * TableCompactionScheduler runs Table::CompactHotToCold on a small pool of background threads, so
+ * that compaction doesn't compete with the work on the thread that triggers it (e.g. the agent's
+ * event loop).
+ *
+ * Queued tables are compacted in order of their hot bytes backlog, largest first. A table is only
+ * ever queued once: if compaction falls behind, scheduling a table that is still queued or being
+ * compacted is a no-op.
+ */
+class TableCompactionScheduler : public NotCopyable {
+ public:
+  /**
+   * @param num_threads the number of background threads. If 0, tables are compacted on the thread
+   * that calls Schedule().
+   * @param mem_pool arrow MemoryPool to be used for creating new cold batches.
+   */
+  TableCompactionScheduler(size_t num_threads, arrow::MemoryPool* mem_pool);
+  ~TableCompactionScheduler();
+
+  /**
+   * Queues the given tables for compaction.
+   */
+  void Schedule(const std::vector<std::shared_ptr<Table>>& tables);
+
+  /**
+   * Stops the background threads, waiting for any running compactions to finish. Queued tables that
+   * haven't started compacting are dropped.
+   */
+  void Stop();
+
+  /**
+   * Blocks until there are no queued or running compactions.
+   */
+  void WaitForIdle();
+
+ private:
+  struct QueuedTable {
+    int64_t hot_bytes;
+    std::shared_ptr<Table> table;
+
+    bool operator<(const QueuedTable& other) const { return hot_bytes < other.hot_bytes; }
+  };
+
+  void Compact(Table* table);
+  void RunWorker();
+  bool WorkAvailable() const ABSL_SHARED_LOCKS_REQUIRED(lock_) {
+    return stopped_ || !queue_.empty();
+  }
+  bool Idle() const ABSL_SHARED_LOCKS_REQUIRED(lock_) { return pending_.empty(); }
+
+  arrow::MemoryPool* mem_pool_;
+
+  absl::Mutex lock_;
+  std::priority_queue<QueuedTable> queue_ ABSL_GUARDED_BY(lock_);
+  // Tables that are either queued or being compacted.
+  absl::flat_hash_set<const Table*> pending_ ABSL_GUARDED_BY(lock_);
+  bool stopped_ ABSL_GUARDED_BY(lock_) = false;
+
+  std::vector<std::thread> threads_;
+
+  prometheus::Gauge& queue_size_gauge_;
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/table_store/table/table_compaction_scheduler.h"
+
+namespace px {
+namespace table_store {
+
+class TableCompactionSchedulerTest : public ::testing::TestWithParam<size_t> {
+ protected:
+  static constexpr int64_t kBatchLength = 8;
+  static constexpr int64_t kBatchBytes = kBatchLength * sizeof(int64_t);
+
+  std::shared_ptr<Table> MakeTable(int64_t num_batches) {
+    schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+    // Each compacted batch holds two hot batches.
+    auto table = std::make_shared<Table>("test_table", rel, 1024 * 1024, 2 * kBatchBytes);
+    for (int64_t i = 0; i < num_batches; ++i) {
+      auto col = std::make_shared<types::Time64NSValueColumnWrapper>(kBatchLength);
+      col->Clear();
+      for (int64_t j = 0; j < kBatchLength; ++j) {
+        col->Append(types::Time64NSValue(i * kBatchLength + j));
+      }
+      auto batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+      batch->push_back(col);
+      EXPECT_OK(table->TransferRecordBatch(std::move(batch)));
+    }
+    return table;
+  }
+};
+
+TEST_P(TableCompactionSchedulerTest, CompactsAllTables) {
+  TableCompactionScheduler scheduler(GetParam(), arrow::default_memory_pool());
+
+  std::vector<std::shared_ptr<Table>> tables = {MakeTable(2), MakeTable(8), MakeTable(4)};
+  scheduler.Schedule(tables);
+  scheduler.WaitForIdle();
+
+  EXPECT_EQ(1, tables[0]->GetTableStats().compacted_batches);
+  EXPECT_EQ(4, tables[1]->GetTableStats().compacted_batches);
+  EXPECT_EQ(2, tables[2]->GetTableStats().compacted_batches);
+  for (const auto& table : tables) {
+    EXPECT_EQ(0, table->GetTableStats().hot_bytes);
+  }
+}
+
+TEST_P(TableCompactionSchedulerTest, ScheduleTwice) {
+  TableCompactionScheduler scheduler(GetParam(), arrow::default_memory_pool());
+
+  std::vector<std::shared_ptr<Table>> tables = {MakeTable(4)};
+  scheduler.Schedule(tables);
+  scheduler.Schedule(tables);
+  scheduler.WaitForIdle();
+
+  EXPECT_EQ(2, tables[0]->GetTableStats().compacted_batches);
+  EXPECT_EQ(0, tables[0]->GetTableStats().hot_bytes);
+}
+
+TEST_P(TableCompactionSchedulerTest, ScheduleAfterStop) {
+  TableCompactionScheduler scheduler(GetParam(), arrow::default_memory_pool());
+  scheduler.Stop();
+
+  std::vector<std::shared_ptr<Table>> tables = {MakeTable(4)};
+  scheduler.Schedule(tables);
+  scheduler.WaitForIdle();
+
+  // Without background threads, compaction happens inline regardless.
+  EXPECT_EQ(GetParam() == 0 ? 2 : 0, tables[0]->GetTableStats().compacted_batches);
+}
+
+INSTANTIATE_TEST_SUITE_P(NumThreads, TableCompactionSchedulerTest, ::testing::Values(0, 1, 4));
+
+}  // namespace table_store
+}  // namespace px
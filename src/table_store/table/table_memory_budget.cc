@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/table_memory_budget.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace px {
+namespace table_store {
+
+Status TableMemoryBudget::Rebalance(const std::vector<std::shared_ptr<Table>>& tables,
+                                    int64_t now_ns) {
+  if (tables.empty()) {
+    return Status::OK();
+  }
+
+  absl::flat_hash_map<const Table*, TableState> new_states;
+  std::vector<double> weights;
+  weights.reserve(tables.size());
+  bool all_sampled = true;
+  for (const auto& table : tables) {
+    auto stats = table->GetTableStats();
+    auto oldest_queried_time = table->TakeOldestQueriedTime();
+
+    TableState state{stats.bytes_added, now_ns, 0};
+    auto it = table_states_.find(table.get());
+    if (it == table_states_.end()) {
+      all_sampled = false;
+    } else if (now_ns > it->second.sample_time_ns) {
+      double elapsed_s = static_cast<double>(now_ns - it->second.sample_time_ns) / 1e9;
+      double rate = static_cast<double>(stats.bytes_added - it->second.bytes_added) / elapsed_s;
+      state.ingest_bytes_per_sec = kIngestRateSmoothing * rate +
+                                   (1 - kIngestRateSmoothing) * it->second.ingest_bytes_per_sec;
+    } else {
+      state = it->second;
+    }
+
+    double demand_factor = 1.0;
+    if (oldest_queried_time.has_value() && stats.min_time > 0 && now_ns > stats.min_time) {
+      double lookback = static_cast<double>(now_ns - oldest_queried_time.value());
+      double retention = static_cast<double>(now_ns - stats.min_time);
+      demand_factor = std::clamp(lookback / retention, 1.0, kMaxDemandFactor);
+    }
+    weights.push_back(state.ingest_bytes_per_sec * demand_factor);
+    new_states[table.get()] = state;
+  }
+  // Dropping the states of tables that are no longer passed in, keeps this from holding on to
+  // pointers of deleted tables.
+  table_states_ = std::move(new_states);
+
+  // Until every table has an ingest rate, keep the existing quotas.
+  if (!all_sampled) {
+    return Status::OK();
+  }
+
+  int64_t num_tables = tables.size();
+  int64_t min_bytes = std::min(min_table_bytes_, total_bytes_ / num_tables);
+  double distributable = static_cast<double>(total_bytes_ - min_bytes * num_tables);
+  double total_weight = 0;
+  for (auto weight : weights) {
+    total_weight += weight;
+  }
+
+  std::vector<int64_t> quotas;
+  quotas.reserve(tables.size());
+  for (const auto& weight : weights) {
+    double share = total_weight > 0 ? weight / total_weight : 1.0 / num_tables;
+    quotas.push_back(min_bytes + static_cast<int64_t>(distributable * share));
+  }
+
+  std::vector<int64_t> current_quotas;
+  current_quotas.reserve(tables.size());
+  for (const auto& table : tables) {
+    current_quotas.push_back(table->GetTableStats().max_table_size);
+  }
+  // Apply all the shrinking quotas first, so that the budget is never exceeded in between.
+  for (bool shrinking : {true, false}) {
+    for (const auto& [i, table] : Enumerate(tables)) {
+      if (quotas[i] != current_quotas[i] && (quotas[i] < current_quotas[i]) == shrinking) {
+        PX_RETURN_IF_ERROR(table->SetMaxTableSize(quotas[i]));
+      }
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace table_store
+}  // namespace px
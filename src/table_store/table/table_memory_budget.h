@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * TableMemoryBudget divides a fixed number of bytes between a set of tables, instead of giving
+ * every table the same fixed size limit.
+ *
+ * Each call to Rebalance() samples how many bytes were written to each table since the previous
+ * call, and gives each table a share of the budget proportional to its (smoothed) ingest rate.
+ * Without query demand, this gives every table roughly the same retention window, so quiet tables
+ * don't hold on to budget they can't use. A table that was queried for data older than what it
+ * currently retains has its share scaled up by how much further back the query reached (capped at
+ * kMaxDemandFactor), so that the tables people actually look at keep more history.
+ *
+ * Every table is guaranteed at least `min_table_bytes`. Tables whose new quota is smaller than
+ * their current size are expired down to the quota immediately.
+ */
+class TableMemoryBudget {
+ public:
+  static constexpr int64_t kDefaultMinTableBytes = 1024 * 1024;
+  static constexpr double kMaxDemandFactor = 4.0;
+  // Weight of the newest sample in the exponentially smoothed ingest rate.
+  static constexpr double kIngestRateSmoothing = 0.5;
+
+  explicit TableMemoryBudget(int64_t total_bytes,
+                             int64_t min_table_bytes = kDefaultMinTableBytes)
+      : total_bytes_(total_bytes), min_table_bytes_(min_table_bytes) {}
+
+  /**
+   * Recomputes the quota of each of the given tables and applies it with Table::SetMaxTableSize.
+   * The first call for a table only records its ingest baseline.
+   * @param tables the tables that share the budget.
+   * @param now_ns the current time, in the same clock as the tables' time_ columns.
+   * @return error if applying a quota fails.
+   */
+  Status Rebalance(const std::vector<std::shared_ptr<Table>>& tables, int64_t now_ns);
+
+  int64_t total_bytes() const { return total_bytes_; }
+
+ private:
+  struct TableState {
+    int64_t bytes_added = 0;
+    int64_t sample_time_ns = 0;
+    double ingest_bytes_per_sec = 0;
+  };
+
+  const int64_t total_bytes_;
+  const int64_t min_table_bytes_;
+  absl::flat_hash_map<const Table*, TableState> table_states_;
+};
+
+}  // namespace table_store
+}  // namespace px
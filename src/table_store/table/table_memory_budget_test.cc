@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/table_store/table/table_memory_budget.h"
+
+namespace px {
+namespace table_store {
+
+constexpr int64_t kBatchLength = 1024;
+constexpr int64_t kBatchBytes = kBatchLength * sizeof(int64_t);
+constexpr int64_t kSecond = 1000 * 1000 * 1000;
+
+class TableMemoryBudgetTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<Table> MakeTable(int64_t max_size) {
+    schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+    return std::make_shared<Table>("test_table", rel, max_size, kBatchBytes);
+  }
+
+  void WriteBatches(Table* table, int64_t num_batches, int64_t start_time) {
+    for (int64_t i = 0; i < num_batches; ++i) {
+      auto col = std::make_shared<types::Time64NSValueColumnWrapper>(kBatchLength);
+      col->Clear();
+      for (int64_t j = 0; j < kBatchLength; ++j) {
+        col->Append(types::Time64NSValue(start_time + i * kBatchLength + j));
+      }
+      auto batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+      batch->push_back(col);
+      EXPECT_OK(table->TransferRecordBatch(std::move(batch)));
+    }
+  }
+};
+
+TEST_F(TableMemoryBudgetTest, QuotasFollowIngestRate) {
+  TableMemoryBudget budget(110 * kBatchBytes, /*min_table_bytes*/ 0);
+  std::vector<std::shared_ptr<Table>> tables = {MakeTable(1024 * kBatchBytes),
+                                                MakeTable(1024 * kBatchBytes)};
+
+  // The first rebalance only samples the tables.
+  ASSERT_OK(budget.Rebalance(tables, kSecond));
+  EXPECT_EQ(1024 * kBatchBytes, tables[0]->GetTableStats().max_table_size);
+  EXPECT_EQ(1024 * kBatchBytes, tables[1]->GetTableStats().max_table_size);
+
+  WriteBatches(tables[0].get(), 10, kSecond);
+  WriteBatches(tables[1].get(), 1, kSecond);
+  ASSERT_OK(budget.Rebalance(tables, 2 * kSecond));
+  EXPECT_EQ(100 * kBatchBytes, tables[0]->GetTableStats().max_table_size);
+  EXPECT_EQ(10 * kBatchBytes, tables[1]->GetTableStats().max_table_size);
+}
+
+TEST_F(TableMemoryBudgetTest, QueryDemandIncreasesQuota) {
+  TableMemoryBudget budget(90 * kBatchBytes, /*min_table_bytes*/ 0);
+  std::vector<std::shared_ptr<Table>> tables = {MakeTable(1024 * kBatchBytes),
+                                                MakeTable(1024 * kBatchBytes)};
+  ASSERT_OK(budget.Rebalance(tables, kSecond));
+
+  WriteBatches(tables[0].get(), 1, kSecond);
+  WriteBatches(tables[1].get(), 1, kSecond);
+
+  // Both tables retain one second of data. Query the first table for two seconds of data.
+  Table::Cursor cursor(tables[0].get(),
+                       Table::Cursor::StartSpec{Table::Cursor::StartSpec::StartType::StartAtTime,
+                                                0},
+                       Table::Cursor::StopSpec{});
+  EXPECT_EQ(0, tables[0]->GetTableStats().oldest_queried_time);
+
+  ASSERT_OK(budget.Rebalance(tables, 2 * kSecond));
+  EXPECT_EQ(60 * kBatchBytes, tables[0]->GetTableStats().max_table_size);
+  EXPECT_EQ(30 * kBatchBytes, tables[1]->GetTableStats().max_table_size);
+  // Rebalancing consumes the query demand.
+  EXPECT_EQ(-1, tables[0]->GetTableStats().oldest_queried_time);
+}
+
+TEST_F(TableMemoryBudgetTest, ShrinkingQuotaExpiresData) {
+  TableMemoryBudget budget(20 * kBatchBytes, /*min_table_bytes*/ 2 * kBatchBytes);
+  std::vector<std::shared_ptr<Table>> tables = {MakeTable(1024 * kBatchBytes),
+                                                MakeTable(1024 * kBatchBytes)};
+  ASSERT_OK(budget.Rebalance(tables, kSecond));
+
+  WriteBatches(tables[0].get(), 16, kSecond);
+  WriteBatches(tables[1].get(), 16, kSecond);
+  ASSERT_OK(budget.Rebalance(tables, 2 * kSecond));
+
+  for (const auto& table : tables) {
+    auto stats = table->GetTableStats();
+    EXPECT_EQ(10 * kBatchBytes, stats.max_table_size);
+    EXPECT_EQ(10 * kBatchBytes, stats.bytes);
+    EXPECT_EQ(6, stats.batches_expired);
+  }
+}
+
+TEST_F(TableMemoryBudgetTest, IdleTablesSplitEvenly) {
+  TableMemoryBudget budget(20 * kBatchBytes, /*min_table_bytes*/ kBatchBytes);
+  std::vector<std::shared_ptr<Table>> tables = {MakeTable(1024 * kBatchBytes),
+                                                MakeTable(1024 * kBatchBytes)};
+  ASSERT_OK(budget.Rebalance(tables, kSecond));
+  ASSERT_OK(budget.Rebalance(tables, 2 * kSecond));
+  EXPECT_EQ(10 * kBatchBytes, tables[0]->GetTableStats().max_table_size);
+  EXPECT_EQ(10 * kBatchBytes, tables[1]->GetTableStats().max_table_size);
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -67,4 +67,34 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                              .Name("min_time")
                              .Help("The current retention window for data in this table")
                              .Register(*registry)
-                             .Add({{"name", table_name}})) {}
+                             .Add({{"name", table_name}})),
+      writer_stall_ns_counter(
+          prometheus::BuildCounter()
+              .Name("table_writer_stall_ns")
+              .Help("Total time writers spent waiting to acquire the table's hot lock")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
+      compactions_discarded_counter(
+          prometheus::BuildCounter()
+              .Name("table_compactions_discarded")
+              .Help("Compacted batches discarded because their hot rows expired during compaction")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
+      compaction_duration_ns_counter(
+          prometheus::BuildCounter()
+              .Name("table_compaction_duration_ns")
+              .Help("Total time spent compacting the table in the table's lifetime")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
+      compaction_last_duration_ns_gauge(
+          prometheus::BuildGauge()
+              .Name("table_compaction_last_duration_ns")
+              .Help("Time taken by the most recent compaction of the table")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
+      compaction_backlog_bytes_gauge(
+          prometheus::BuildGauge()
+              .Name("table_compaction_backlog_bytes")
+              .Help("Hot data bytes in the table at the start of the most recent compaction")
+              .Register(*registry)
+              .Add({{"name", table_name}})) {}
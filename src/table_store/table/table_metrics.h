@@ -34,4 +34,9 @@ struct TableMetrics {
   prometheus::Counter& compacted_batches_counter;
   prometheus::Gauge& max_table_size_gauge;
   prometheus::Gauge& retention_ns_gauge;
+  prometheus::Counter& writer_stall_ns_counter;
+  prometheus::Counter& compactions_discarded_counter;
+  prometheus::Counter& compaction_duration_ns_counter;
+  prometheus::Gauge& compaction_last_duration_ns_gauge;
+  prometheus::Gauge& compaction_backlog_bytes_gauge;
 };
@@ -17,6 +17,9 @@
  */
 
 #include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -65,6 +68,22 @@ Status TableStore::AppendData(uint64_t table_id, types::TabletID tablet_id,
   return table->TransferRecordBatch(std::move(record_batch));
 }
 
+Status TableStore::AppendArrowData(uint64_t table_id, types::TabletID tablet_id,
+                                   std::unique_ptr<px::types::ArrowArrayRecordBatch> record_batch) {
+  Table* table = GetTable(table_id, tablet_id);
+  // We create new tablets only if the table at `table_id` exists, otherwise errors out.
+  if (table == nullptr) {
+    // Don't create a tablet for data that the table can't hold.
+    auto table_info_iter = id_to_table_info_map_.find(table_id);
+    if (table_info_iter != id_to_table_info_map_.end() && !record_batch->empty()) {
+      PX_RETURN_IF_ERROR(
+          Table::ValidateArrowRecordBatch(table_info_iter->second.relation, *record_batch));
+    }
+    PX_ASSIGN_OR_RETURN(table, CreateNewTablet(table_id, tablet_id));
+  }
+  return table->TransferArrowRecordBatch(std::move(record_batch));
+}
+
 table_store::Table* TableStore::GetTable(const std::string& table_name,
                                          const types::TabletID& tablet_id) const {
   auto name_to_table_iter = name_to_table_map_.find(NameTablet{table_name, tablet_id});
@@ -165,5 +184,36 @@ Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool) {
   return Status::OK();
 }
 
+void TableStore::ScheduleCompaction(TableCompactionScheduler* scheduler) const {
+  std::vector<std::shared_ptr<Table>> tables;
+  tables.reserve(name_to_table_map_.size());
+  for (const auto& it : name_to_table_map_) {
+    tables.push_back(it.second);
+  }
+  scheduler->Schedule(tables);
+}
+
+void TableStore::SetMemoryBudget(int64_t total_bytes,
+                                 absl::flat_hash_set<std::string> fixed_size_tables) {
+  memory_budget_ = std::make_unique<TableMemoryBudget>(total_bytes);
+  fixed_size_tables_ = std::move(fixed_size_tables);
+}
+
+Status TableStore::RebalanceMemoryBudget() {
+  if (memory_budget_ == nullptr) {
+    return Status::OK();
+  }
+  std::vector<std::shared_ptr<Table>> tables;
+  for (const auto& [key, table] : name_to_table_map_) {
+    if (!fixed_size_tables_.contains(key.name_)) {
+      tables.push_back(table);
+    }
+  }
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  return memory_budget_->Rebalance(tables, now_ns);
+}
+
 }  // namespace table_store
 }  // namespace px
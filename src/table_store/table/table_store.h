@@ -25,6 +25,7 @@
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
 #include "src/common/base/base.h"
 #include "src/shared/types/column_wrapper.h"
@@ -32,6 +33,8 @@
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/schema.h"
 #include "src/table_store/table/table.h"
+#include "src/table_store/table/table_compaction_scheduler.h"
+#include "src/table_store/table/table_memory_budget.h"
 #include "src/table_store/table/tablets_group.h"
 
 namespace px {
@@ -152,6 +155,13 @@ class TableStore {
   Status AppendData(uint64_t table_id, types::TabletID tablet_id,
                     std::unique_ptr<px::types::ColumnWrapperRecordBatch> record_batch);
 
+  /**
+   * @brief Same as AppendData, but for data that is already in arrow arrays, which are stored
+   * without conversion.
+   */
+  Status AppendArrowData(uint64_t table_id, types::TabletID tablet_id,
+                         std::unique_ptr<px::types::ArrowArrayRecordBatch> record_batch);
+
   Status SchemaAsProto(schemapb::Schema* schema) const;
 
   /**
@@ -167,6 +177,25 @@ class TableStore {
 
   Status RunCompaction(arrow::MemoryPool* mem_pool);
 
+  /**
+   * Queues every table (including each tablet) for compaction on the given scheduler, instead of
+   * compacting them on the calling thread like RunCompaction.
+   */
+  void ScheduleCompaction(TableCompactionScheduler* scheduler) const;
+
+  /**
+   * Shares the given number of bytes between all tables (and tablets) except the ones named in
+   * `fixed_size_tables`, which keep the size they were created with. Quotas are only adjusted on
+   * calls to RebalanceMemoryBudget(). See TableMemoryBudget.
+   */
+  void SetMemoryBudget(int64_t total_bytes, absl::flat_hash_set<std::string> fixed_size_tables);
+
+  /**
+   * Recomputes the per-table quotas of the memory budget, if one was set, from recent ingest rates
+   * and queries.
+   */
+  Status RebalanceMemoryBudget();
+
  private:
   void RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
                          const schema::Relation& table_relation,
@@ -197,6 +226,10 @@ class TableStore {
   absl::flat_hash_map<std::string, schema::Relation> name_to_relation_map_;
   // Mapping from id to name and relation pair for adding new tablets.
   absl::flat_hash_map<uint64_t, TableInfo> id_to_table_info_map_;
+
+  std::unique_ptr<TableMemoryBudget> memory_budget_;
+  // Tables that are excluded from memory_budget_.
+  absl::flat_hash_set<std::string> fixed_size_tables_;
 };
 
 }  // namespace table_store
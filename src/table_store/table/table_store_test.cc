@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/row_descriptor.h"
 #include "src/table_store/table/table_store.h"
@@ -32,6 +33,7 @@ namespace table_store {
 
 using table_store::Table;
 using table_store::schema::RowDescriptor;
+using types::ArrowArrayRecordBatch;
 using types::ColumnWrapperRecordBatch;
 
 class TableStoreTest : public ::testing::Test {
@@ -61,6 +63,15 @@ class TableStoreTest : public ::testing::Test {
     return wrapper_batch_1;
   }
 
+  std::unique_ptr<ArrowArrayRecordBatch> MakeRel1ArrowBatch() {
+    auto batch = std::make_unique<ArrowArrayRecordBatch>();
+    batch->push_back(types::ToArrow(std::vector<types::BoolValue>{true, true, false},
+                                    arrow::default_memory_pool()));
+    batch->push_back(types::ToArrow(std::vector<types::Float64Value>{1.1, 5.0, 2.9},
+                                    arrow::default_memory_pool()));
+    return batch;
+  }
+
   std::shared_ptr<Table> table1;
   std::shared_ptr<Table> table2;
   schema::Relation rel1;
@@ -146,6 +157,42 @@ TEST_F(TableStoreTest, table_id_aliasing) {
   EXPECT_EQ(table->GetTableStats().batches_added, 2);
 }
 
+TEST_F(TableStoreTest, append_arrow_data) {
+  auto table_store = TableStore();
+  const uint64_t kTableID = 1;
+  table_store.AddTable(table1, "a", kTableID);
+
+  EXPECT_OK(table_store.AppendArrowData(kTableID, "", MakeRel1ArrowBatch()));
+  Table* table = table_store.GetTable(kTableID);
+  EXPECT_EQ(table->GetTableStats().bytes, 27);
+  EXPECT_EQ(table->GetTableStats().batches_added, 1);
+
+  // Too few columns.
+  auto missing_col = MakeRel1ArrowBatch();
+  missing_col->pop_back();
+  EXPECT_NOT_OK(table_store.AppendArrowData(kTableID, "", std::move(missing_col)));
+
+  // Too many columns.
+  auto extra_col = MakeRel1ArrowBatch();
+  extra_col->push_back(extra_col->back());
+  EXPECT_NOT_OK(table_store.AppendArrowData(kTableID, "", std::move(extra_col)));
+
+  // A column of the wrong type.
+  auto wrong_type = MakeRel1ArrowBatch();
+  (*wrong_type)[1] =
+      types::ToArrow(std::vector<types::Int64Value>{1, 5, 2}, arrow::default_memory_pool());
+  EXPECT_NOT_OK(table_store.AppendArrowData(kTableID, "", std::move(wrong_type)));
+
+  // Columns of different lengths.
+  auto wrong_length = MakeRel1ArrowBatch();
+  (*wrong_length)[1] = (*wrong_length)[1]->Slice(0, 2);
+  EXPECT_NOT_OK(table_store.AppendArrowData(kTableID, "", std::move(wrong_length)));
+
+  // None of the invalid batches were added.
+  EXPECT_EQ(table->GetTableStats().bytes, 27);
+  EXPECT_EQ(table->GetTableStats().batches_added, 1);
+}
+
 using TableStoreDeathTest = TableStoreTest;
 TEST_F(TableStoreDeathTest, rewrite_fails) {
   auto table_store = TableStore();
@@ -276,6 +323,26 @@ TEST_F(TableStoreTabletsTest, add_tablet_on_append_data) {
   EXPECT_EQ(tablet2->GetTableStats().batches_added, 0);
 }
 
+// An invalid batch for a tablet that doesn't exist yet is rejected without creating the tablet.
+TEST_F(TableStoreTabletsTest, append_invalid_arrow_data_to_new_tablet) {
+  auto table_store = TableStore();
+  uint64_t table_id = 123;
+  types::TabletID tablet1_id = "456";
+  types::TabletID tablet2_id = "789";
+  table_store.AddTable(tablet1_1, "a", table_id, tablet1_id);
+
+  auto wrong_type = MakeRel1ArrowBatch();
+  (*wrong_type)[0] =
+      types::ToArrow(std::vector<types::Int64Value>{1, 5, 2}, arrow::default_memory_pool());
+  EXPECT_NOT_OK(table_store.AppendArrowData(table_id, tablet2_id, std::move(wrong_type)));
+  EXPECT_EQ(table_store.GetTable("a", tablet2_id), nullptr);
+
+  EXPECT_OK(table_store.AppendArrowData(table_id, tablet2_id, MakeRel1ArrowBatch()));
+  Table* tablet2 = table_store.GetTable("a", tablet2_id);
+  ASSERT_NE(tablet2, nullptr);
+  EXPECT_EQ(tablet2->GetTableStats().batches_added, 1);
+}
+
 using TableStoreTabletsDeathTest = TableStoreTabletsTest;
 TEST_F(TableStoreTabletsDeathTest, tablet_test) {
   auto table_store = TableStore();
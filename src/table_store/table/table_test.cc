@@ -864,6 +864,86 @@ TEST(TableTest, threaded) {
   reader_thread.join();
 }
 
+// The memory budget resizes a table from its own thread, while the table is being written to.
+// Both expire batches, and neither should fail, nor expire more than the limit requires.
+TEST(TableTest, threaded_set_max_table_size) {
+  schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+  static constexpr int64_t kRowsPerBatch = 128;
+  static constexpr int64_t kBatchBytes = kRowsPerBatch * sizeof(int64_t);
+  static constexpr int64_t kLargeSize = 64 * kBatchBytes;
+  static constexpr int64_t kSmallSize = 16 * kBatchBytes;
+  std::shared_ptr<Table> table_ptr =
+      std::make_shared<Table>("test_table", rel, kLargeSize, 5 * 1024);
+
+  auto done = std::make_shared<absl::Notification>();
+
+  std::thread writer_thread([table_ptr, done]() {
+    NotifyOnDeath notifier(done.get());
+    int64_t time_counter = 0;
+    for (int i = 0; i < 20000; ++i) {
+      auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+      auto col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(kRowsPerBatch);
+      for (int64_t row_idx = 0; row_idx < kRowsPerBatch; ++row_idx) {
+        (*col_wrapper)[row_idx] = time_counter++;
+      }
+      wrapper_batch->push_back(col_wrapper);
+      EXPECT_OK(table_ptr->TransferRecordBatch(std::move(wrapper_batch)));
+    }
+    done->Notify();
+  });
+
+  std::thread rebalancer_thread([table_ptr, done]() {
+    bool small = false;
+    while (!done->HasBeenNotified()) {
+      // Shrinking the table to a single batch makes the writer expire all other batches too.
+      EXPECT_OK(table_ptr->SetMaxTableSize(small ? kBatchBytes : kLargeSize));
+      small = !small;
+    }
+  });
+
+  writer_thread.join();
+  rebalancer_thread.join();
+
+  TableStats stats = table_ptr->GetTableStats();
+  EXPECT_LE(stats.bytes, stats.max_table_size);
+  EXPECT_EQ(stats.bytes, stats.num_batches * kBatchBytes);
+  EXPECT_EQ(stats.batches_added - stats.batches_expired, stats.num_batches);
+}
+
+// Expirations that overlap must not expire the same excess bytes twice.
+TEST(TableTest, concurrent_set_max_table_size_expires_once) {
+  schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+  constexpr int64_t kRowsPerBatch = 128;
+  constexpr int64_t kBatchBytes = kRowsPerBatch * sizeof(int64_t);
+  constexpr int64_t kLargeSize = 256 * kBatchBytes;
+  constexpr int64_t kSmallSize = 16 * kBatchBytes;
+  constexpr int kNumThreads = 4;
+
+  for (int round = 0; round < 100; ++round) {
+    auto table = std::make_shared<Table>("test_table", rel, kLargeSize, 5 * 1024);
+    for (int64_t i = 0; i < kLargeSize / kBatchBytes; ++i) {
+      auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+      auto col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(kRowsPerBatch);
+      wrapper_batch->push_back(col_wrapper);
+      ASSERT_OK(table->TransferRecordBatch(std::move(wrapper_batch)));
+    }
+
+    absl::Notification start;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&table, &start]() {
+        start.WaitForNotification();
+        EXPECT_OK(table->SetMaxTableSize(kSmallSize));
+      });
+    }
+    start.Notify();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(table->GetTableStats().bytes, kSmallSize) << "round " << round;
+  }
+}
+
 // This test was add when `NextBatch` and `BatchSlice`'s were still around, and there was a bug with
 // generation handling of `BatchSlice`'s. Maintaining so as not to decrease test coverage, but this
 // bug should no longer even be plausible.
@@ -741,7 +741,10 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
                 "The maximum size of this table"),
         ColInfo("min_time", types::DataType::TIME64NS, types::PatternType::GENERAL,
                 "The minimum timestamp currently present in this table. -1 if there is no time_ "
-                "column on the table."));
+                "column on the table."),
+        ColInfo("oldest_queried_time", types::DataType::TIME64NS, types::PatternType::GENERAL,
+                "The oldest start time that queries asked this table for since the table store "
+                "memory budget last sampled it. -1 if there were no such queries."));
   }
   Status Init(FunctionContext*) {
     table_ids_ = table_store_->GetTableIDs();
@@ -769,6 +772,7 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
     rw->Append<IndexOf("cold_size")>(info.cold_bytes);
     rw->Append<IndexOf("max_table_size")>(info.max_table_size);
     rw->Append<IndexOf("min_time")>(info.min_time);
+    rw->Append<IndexOf("oldest_queried_time")>(info.oldest_queried_time);
 
     ++current_idx_;
     return static_cast<size_t>(current_idx_) < table_ids_.size();
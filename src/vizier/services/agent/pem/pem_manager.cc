@@ -43,6 +43,12 @@ DEFINE_int32(table_store_proc_exit_events_limit_bytes,
              gflags::Int32FromEnv("PL_TABLE_STORE_PROC_EXIT_EVENTS_LIMIT_BYTES", 10 * 1024 * 1024),
              "The maximum amount of data to store in the proc_exit_events table.");
 
+DEFINE_bool(table_store_adaptive_table_sizes,
+            gflags::BoolFromEnv("PL_TABLE_STORE_ADAPTIVE_TABLE_SIZES", false),
+            "If true, the table store data limit (minus the Stirling error and proc_exit_events "
+            "tables) is shared between tables based on their ingest rate and how far back they "
+            "are queried, instead of using fixed per-table sizes.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -57,6 +63,9 @@ Status PEMManager::PostRegisterHookImpl() {
   stirling_->RegisterDataPushCallback(std::bind(&table_store::TableStore::AppendData, table_store(),
                                                 std::placeholders::_1, std::placeholders::_2,
                                                 std::placeholders::_3));
+  stirling_->RegisterArrowDataPushCallback(
+      std::bind(&table_store::TableStore::AppendArrowData, table_store(), std::placeholders::_1,
+                std::placeholders::_2, std::placeholders::_3));
 
   // Enable use of USR1/USR2 for controlling Stirling debug.
   stirling_->RegisterUserDebugSignalHandlers();
@@ -127,6 +136,13 @@ Status PEMManager::InitSchemas() {
     table_store()->AddTable(std::move(table_ptr), relation_info.name, relation_info.id);
     PX_RETURN_IF_ERROR(relation_info_manager()->AddRelationInfo(relation_info));
   }
+
+  if (FLAGS_table_store_adaptive_table_sizes) {
+    // The tables above start out with their fixed sizes, and are resized on each rebalance.
+    table_store()->SetMemoryBudget(memory_limit - stirling_error_table_size -
+                                       probe_status_table_size - proc_exit_events_table_size,
+                                   {"stirling_error", "probe_status", "proc_exit_events"});
+  }
   return Status::OK();
 }
 
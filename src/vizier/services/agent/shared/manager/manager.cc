@@ -195,6 +195,9 @@ Status Manager::Stop(std::chrono::milliseconds timeout) {
   stop_called_ = true;
 
   dispatcher_->Stop();
+  if (tablestore_compaction_scheduler_ != nullptr) {
+    tablestore_compaction_scheduler_->Stop();
+  }
   auto s = StopImpl(timeout);
 
   // Wait for a limited amount of time for main thread to stop processing.
@@ -325,12 +328,16 @@ Status Manager::PostRegisterHook(uint32_t asid) {
 
   PX_RETURN_IF_ERROR(metrics_nats_connector_->Connect(dispatcher_.get()));
 
+  // TODO(james): when we change ExecState::exec_mem_pool to not return just the default pool, we
+  // will need to figure out how to use the correct memory pool here, but for now we can just use
+  // the default pool.
+  tablestore_compaction_scheduler_ = std::make_unique<table_store::TableCompactionScheduler>(
+      FLAGS_table_store_compaction_threads, arrow::default_memory_pool());
   tablestore_compaction_timer_ = dispatcher()->CreateTimer([this]() {
-    // TODO(james): when we change ExecState::exec_mem_pool to not return just the default pool, we
-    // will need to figure out how to use the correct memory pool here, but for now we can just use
-    // the default pool.
-    auto status = table_store()->RunCompaction(arrow::default_memory_pool());
+    // This is a no-op unless the table store has a memory budget.
+    auto status = table_store()->RebalanceMemoryBudget();
     LOG_IF(ERROR, !status.ok()) << status.msg();
+    table_store()->ScheduleCompaction(tablestore_compaction_scheduler_.get());
     if (tablestore_compaction_timer_) {
       tablestore_compaction_timer_->EnableTimer(kTableStoreCompactionPeriod);
     }
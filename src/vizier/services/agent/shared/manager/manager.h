@@ -33,6 +33,7 @@
 #include "src/common/system/kernel_version.h"
 #include "src/common/uuid/uuid.h"
 #include "src/shared/metadata/metadata.h"
+#include "src/table_store/table/table_compaction_scheduler.h"
 #include "src/vizier/funcs/context/vizier_context.h"
 #include "src/vizier/messages/messagespb/messages.pb.h"
 #include "src/vizier/services/agent/shared/base/base_manager.h"
@@ -213,6 +214,8 @@ class Manager : public BaseManager {
 
   // Timer to manage table store compaction.
   px::event::TimerUPtr tablestore_compaction_timer_;
+  // Runs the compactions triggered by tablestore_compaction_timer_ off of the event loop.
+  std::unique_ptr<table_store::TableCompactionScheduler> tablestore_compaction_scheduler_;
 
   px::metrics::MemoryMetrics memory_metrics_;
   // Timer to collect MemoryMetrics for this agent.
@@ -273,6 +273,7 @@ func QueryResultStatsToVizierStats(e *queryresultspb.QueryExecutionStats, compil
 		},
 		BytesProcessed:   e.BytesProcessed,
 		RecordsProcessed: e.RecordsProcessed,
+		Warnings:         e.Warnings,
 	}
 }
 
@@ -38,6 +38,10 @@ var defaultQueryFlags = map[string]interface{}{
 	"explain":                   false,
 	"analyze":                   false,
 	"max_output_rows_per_table": 10000,
+	// How often the PEM side of a distributed aggregate sends its state to Kelvin. 0 disables.
+	"partial_result_flush_interval_ms": 0,
+	// How long to wait for the remaining agents once the first one finishes. 0 waits for all.
+	"straggler_timeout_ms": 0,
 }
 
 // QueryFlags represents a set of Pixie configuration flags.
@@ -119,9 +123,11 @@ func (f *QueryFlags) set(key string, value string) error {
 // GetPlanOptions creates the plan option proto from the specified query flags.
 func (f *QueryFlags) GetPlanOptions() *planpb.PlanOptions {
 	return &planpb.PlanOptions{
-		Explain:               f.GetBool("explain"),
-		Analyze:               f.GetBool("analyze"),
-		MaxOutputRowsPerTable: f.GetInt64("max_output_rows_per_table"),
+		Explain:                      f.GetBool("explain"),
+		Analyze:                      f.GetBool("analyze"),
+		MaxOutputRowsPerTable:        f.GetInt64("max_output_rows_per_table"),
+		PartialResultFlushIntervalMs: f.GetInt64("partial_result_flush_interval_ms"),
+		StragglerTimeoutMs:           f.GetInt64("straggler_timeout_ms"),
 	}
 }
 
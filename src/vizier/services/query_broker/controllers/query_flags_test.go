@@ -32,6 +32,7 @@ import px
 
 #px:set analyze=true
 #px:set max_output_rows_per_table=9999
+#px:set straggler_timeout_ms=500
 
 df = px.DataFrame(table='process_stats', start_time='-5s')
 `
@@ -109,4 +110,6 @@ func TestParseQueryFlags_PlanOptions(t *testing.T) {
 	options := qf.GetPlanOptions()
 	assert.Equal(t, options.Explain, false)
 	assert.Equal(t, options.Analyze, true)
+	assert.Equal(t, options.StragglerTimeoutMs, int64(500))
+	assert.Equal(t, options.PartialResultFlushIntervalMs, int64(0))
 }